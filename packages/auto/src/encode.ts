@@ -8,9 +8,16 @@ import {
   mapToAVIFEncodeOptions,
   mapToJXLEncodeOptions,
   DEFAULT_ENCODE_OPTIONS,
+  keepSourceEncodeOptions,
   type AutoEncodeOptions,
 } from './options';
 import { decode } from './decode';
+import { detectFormat } from './format-detection';
+import {
+  canTranscodeNatively,
+  isTranscoderAvailable,
+  transcodeNativeIfSupported,
+} from './transcoder';
 
 /**
  * Encode image to specified format
@@ -64,18 +71,33 @@ export async function encodeSimple(
 }
 
 /**
- * Transcode: decode one format and encode to another
+ * Transcode: decode one format and encode to another.
+ *
+ * AVIF <-> JXL runs in the native transcoder when it is available and
+ * supports every option given, so pixels never leave the WASM heap.
+ * Otherwise, or when the input needs something the native pipeline does
+ * not implement (e.g. colour conversion of ICC-tagged AVIF), the image is
+ * decoded to JS and re-encoded with `encode()`.
+ * On both paths, unset bitDepth / colorSpace / transferFunction keep the
+ * source's.
  */
 export async function transcode(
   input: Uint8Array | ArrayBuffer,
   targetFormat: 'avif' | 'jxl',
   options?: Omit<AutoEncodeOptions, 'format'>,
 ): Promise<Uint8Array> {
+  const data = input instanceof ArrayBuffer ? new Uint8Array(input) : input;
+
+  if (
+    detectFormat(data) !== 'unknown' &&
+    canTranscodeNatively(targetFormat, options) &&
+    (await isTranscoderAvailable())
+  ) {
+    const output = await transcodeNativeIfSupported(data, targetFormat, options);
+    if (output) return output;
+  }
+
   const decoded = await decode(input);
 
-  return encode(decoded, {
-    format: targetFormat,
-    ...options,
-  });
+  return encode(decoded, keepSourceEncodeOptions(decoded, targetFormat, options));
 }
-
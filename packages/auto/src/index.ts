@@ -38,6 +38,23 @@ export { decode, decodeToImageData, getImageInfo } from './decode';
 
 export { encode, encodeSimple, transcode } from './encode';
 
+// ============================================================================
+// Native transcoder
+// ============================================================================
+
+export {
+  init as initTranscoder,
+  isTranscoderAvailable,
+  canTranscodeNatively,
+  transcodeNative,
+  transcodeNativeIfSupported,
+} from './transcoder';
+export type {
+  InitConfig as TranscoderInitConfig,
+  TranscodeTargetFormat,
+  TranscodeTargetOptions,
+} from './transcoder';
+
 // ============================================================================
 // Types
 // ============================================================================
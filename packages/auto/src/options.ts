@@ -1,6 +1,7 @@
 import type { AVIFEncodeOptions, AVIFDecodeOptions } from '@dimkatet/jcodecs-avif';
 import type { JXLEncodeOptions, JXLDecodeOptions } from '@dimkatet/jcodecs-jxl';
 import type { ImageFormat } from './format-detection';
+import type { AutoImageData } from './types';
 
 // ============================================================================
 // Common option types
@@ -168,6 +169,42 @@ export function mapToJXLEncodeOptions(opts: AutoEncodeOptions): JXLEncodeOptions
   };
 }
 
+/**
+ * Options for re-encoding a decoded image so that, unless `options` says
+ * otherwise, it keeps the source's bit depth and colour. This matches the
+ * native transcoder, so transcode() gives the same result on both paths.
+ * Colours without an encode option (e.g. BT.601 primaries) fall back to
+ * the encode defaults.
+ */
+export function keepSourceEncodeOptions(
+  source: AutoImageData,
+  targetFormat: 'avif' | 'jxl',
+  options: Omit<AutoEncodeOptions, 'format'> = {},
+): AutoEncodeOptions {
+  const depth = source.bitDepth <= 8 ? 8 : source.bitDepth <= 10 ? 10 : source.bitDepth <= 12 ? 12 : 16;
+  return {
+    ...options,
+    format: targetFormat,
+    bitDepth: options.bitDepth ?? (targetFormat === 'avif' ? Math.min(depth, 12) as 8 | 10 | 12 : depth),
+    colorSpace: options.colorSpace ?? SOURCE_COLOR_SPACES[source.metadata.colorPrimaries],
+    transferFunction:
+      options.transferFunction ?? SOURCE_TRANSFER_FUNCTIONS[source.metadata.transferFunction],
+  };
+}
+
+const SOURCE_COLOR_SPACES: Record<string, ColorSpace | undefined> = {
+  bt709: 'srgb',
+  'display-p3': 'display-p3',
+  bt2020: 'rec2020',
+};
+
+const SOURCE_TRANSFER_FUNCTIONS: Record<string, TransferFunctionOption | undefined> = {
+  srgb: 'srgb',
+  pq: 'pq',
+  hlg: 'hlg',
+  linear: 'linear',
+};
+
 // ============================================================================
 // Default options
 // ============================================================================
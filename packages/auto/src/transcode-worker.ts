@@ -0,0 +1,40 @@
+/**
+ * Transcode Worker - runs the native AVIF <-> JXL transcoder in a Web Worker
+ */
+import { createCodecWorker } from '@dimkatet/jcodecs-core/codec-worker';
+import {
+  init as initTranscoder,
+  transcodeNativeIfSupported,
+  type TranscodeTargetFormat,
+  type TranscodeTargetOptions,
+} from './transcoder';
+
+export interface TranscodeWorkerInitPayload {
+  /** Custom URL for transcoder JS (WASM is embedded) */
+  transcoderUrl?: string;
+  /** If true, skips initialization on creation */
+  lazyInit?: boolean;
+}
+
+let transcoderUrl: string | undefined;
+
+const handlers = {
+  init: async (payload: TranscodeWorkerInitPayload) => {
+    ({ transcoderUrl } = payload);
+    if (payload.lazyInit) return;
+    await initTranscoder({ jsUrl: transcoderUrl });
+  },
+  transcode: (payload: {
+    data: Uint8Array;
+    targetFormat: TranscodeTargetFormat;
+    options?: TranscodeTargetOptions;
+  }) => {
+    const { data, targetFormat, options } = payload;
+    // null: the caller falls back to decode + encode
+    return transcodeNativeIfSupported(data, targetFormat, options, { jsUrl: transcoderUrl });
+  },
+};
+
+export type TranscodeWorkerHandlers = typeof handlers;
+
+createCodecWorker<TranscodeWorkerHandlers>(handlers);
@@ -0,0 +1,279 @@
+/**
+ * Native AVIF <-> JXL transcoder
+ *
+ * Runs decode -> optional colour / bit-depth conversion -> encode inside one
+ * WASM module (see src/wasm/transcode.cpp). Decoded pixels stay in the
+ * module's heap; only the input file and the encoded output cross into JS.
+ */
+
+import {
+  copyToWasm,
+  isMultiThreadSupported,
+  validateThreadCount,
+} from '@dimkatet/jcodecs-core';
+import type { AutoEncodeOptions, ColorSpace, TransferFunctionOption } from './options';
+import type { MainModule, TranscodeOptions, TranscodeResult } from './wasm/transcode';
+import { mtTranscoderUrl, stTranscoderUrl } from './urls';
+
+type WasmModule = typeof import('./wasm/transcode_mt');
+
+export type TranscodeTargetFormat = 'avif' | 'jxl';
+export type TranscodeTargetOptions = Omit<AutoEncodeOptions, 'format'>;
+
+let transcoderModule: MainModule | null = null;
+let isMultiThreadedModule = false;
+let maxThreads = 1;
+let initPromise: Promise<void> | null = null;
+
+export interface InitConfig {
+  /** URL to the transcoder JS file (transcode.js). WASM is embedded. */
+  jsUrl?: string;
+  /** Prefer to use of multi-threaded transcoder */
+  preferMT?: boolean;
+}
+
+/**
+ * Initialize the transcoder module.
+ */
+export async function init({
+  jsUrl,
+  preferMT,
+}: InitConfig = {}): Promise<void> {
+  if (transcoderModule) return;
+
+  if (initPromise) {
+    await initPromise;
+    return;
+  }
+
+  const useMT = preferMT && isMultiThreadSupported();
+  const url = jsUrl ?? (useMT ? mtTranscoderUrl : stTranscoderUrl);
+
+  initPromise = (async () => {
+    isMultiThreadedModule = jsUrl ? jsUrl.includes('_mt') : !!useMT;
+    // mainScriptUrlOrBlob needed for pthread workers to find the main JS file
+    const moduleConfig: Record<string, unknown> = {
+      mainScriptUrlOrBlob: isMultiThreadedModule ? url : undefined,
+    };
+    const module: WasmModule = await import(/* @vite-ignore */ url);
+    const createModule = module.default;
+    transcoderModule = await createModule(moduleConfig);
+    maxThreads = transcoderModule.MAX_THREADS ?? 1;
+  })();
+
+  await initPromise;
+}
+
+/**
+ * Check whether the transcoder module can be loaded. A failed load is
+ * remembered, so later calls return quickly.
+ */
+export async function isTranscoderAvailable(config?: InitConfig): Promise<boolean> {
+  try {
+    await init(config);
+    return true;
+  } catch {
+    return false;
+  }
+}
+
+// Options the native pipeline understands, per level
+const COMMON_OPTIONS = new Set([
+  'quality',
+  'bitDepth',
+  'maxThreads',
+  'lossless',
+  'colorSpace',
+  'transferFunction',
+  'avif',
+  'jxl',
+]);
+const CODEC_OPTIONS: Record<TranscodeTargetFormat, Set<string>> = {
+  avif: new Set([
+    'quality',
+    'qualityAlpha',
+    'speed',
+    'lossless',
+    'bitDepth',
+    'chromaSubsampling',
+    'maxThreads',
+    'colorSpace',
+    'transferFunction',
+  ]),
+  jxl: new Set([
+    'quality',
+    'effort',
+    'lossless',
+    'bitDepth',
+    'maxThreads',
+    'colorSpace',
+    'transferFunction',
+  ]),
+};
+
+function onlyKnownOptions(options: object, known: Set<string>): boolean {
+  return Object.entries(options).every(
+    ([key, value]) => value === undefined || known.has(key),
+  );
+}
+
+/**
+ * Whether the native pipeline covers every option that was set. Anything
+ * else (e.g. `avif.tune`, `jxl.progressive`, metadata) needs the JS
+ * decode + encode path.
+ */
+export function canTranscodeNatively(
+  targetFormat: TranscodeTargetFormat,
+  options: TranscodeTargetOptions = {},
+): boolean {
+  if (!onlyKnownOptions(options, COMMON_OPTIONS)) return false;
+  const codecOptions = options[targetFormat];
+  return !codecOptions || onlyKnownOptions(codecOptions, CODEC_OPTIONS[targetFormat]);
+}
+
+interface NativeOptions {
+  quality?: number;
+  qualityAlpha?: number;
+  lossless?: boolean;
+  bitDepth?: number;
+  maxThreads?: number;
+  colorSpace?: ColorSpace;
+  transferFunction?: TransferFunctionOption;
+  speed?: number;
+  effort?: number;
+  chromaSubsampling?: string;
+}
+
+/**
+ * Convert chroma subsampling string to number
+ */
+function chromaToNumber(chroma: string | undefined): number {
+  switch (chroma) {
+    case '4:4:4':
+      return 444;
+    case '4:2:2':
+      return 422;
+    case '4:0:0':
+      return 400;
+    default:
+      return 420;
+  }
+}
+
+/**
+ * Merge common and target-codec options, validate maxThreads and convert to
+ * the WASM struct. Unset bitDepth / colorSpace / transferFunction keep the
+ * source's, so the default transcode does no pixel conversion.
+ */
+function buildWasmOptions(
+  targetFormat: TranscodeTargetFormat,
+  options: TranscodeTargetOptions,
+): TranscodeOptions {
+  const { avif, jxl, ...common } = options;
+  const opts: NativeOptions = {
+    ...common,
+    ...((targetFormat === 'avif' ? avif : jxl) as NativeOptions | undefined),
+  };
+
+  const validation = validateThreadCount(
+    opts.maxThreads ?? 0,
+    maxThreads,
+    isMultiThreadedModule,
+    'jcodecs-auto',
+  );
+  if (validation.warning) {
+    console.warn(validation.warning);
+  }
+
+  return {
+    format: targetFormat,
+    quality: opts.quality ?? 75,
+    // Alpha stays lossless unless asked otherwise, as in the AVIF encoder
+    qualityAlpha: opts.qualityAlpha ?? 100,
+    lossless: opts.lossless ?? false,
+    bitDepth: opts.bitDepth ?? 0,
+    colorSpace: opts.colorSpace ?? '',
+    transferFunction: opts.transferFunction ?? '',
+    speed: opts.speed ?? 6,
+    effort: opts.effort ?? 7,
+    chromaSubsampling: chromaToNumber(opts.chromaSubsampling),
+    // 0 = auto: use the whole pthread pool of an MT module
+    maxThreads: validation.validatedCount || maxThreads,
+  };
+}
+
+/**
+ * Copy encoded output from WASM heap and free it
+ */
+function readOutput(module: MainModule, result: TranscodeResult): Uint8Array {
+  const output = new Uint8Array(result.dataSize);
+  output.set(
+    new Uint8Array(module.HEAPU8.buffer, result.dataPtr, result.dataSize),
+  );
+  module._free(result.dataPtr);
+  return output;
+}
+
+/**
+ * Run the native transcode and copy the output out, or return the failed
+ * result.
+ */
+async function runTranscode(
+  input: Uint8Array | ArrayBuffer,
+  targetFormat: TranscodeTargetFormat,
+  options: TranscodeTargetOptions,
+  config: InitConfig | undefined,
+): Promise<Uint8Array | TranscodeResult> {
+  await init(config);
+  const module = transcoderModule!;
+
+  const data = input instanceof ArrayBuffer ? new Uint8Array(input) : input;
+  const wasmOptions = buildWasmOptions(targetFormat, options);
+
+  const inputPtr = copyToWasm(module, data);
+  let result: TranscodeResult;
+  try {
+    result = module.transcode(inputPtr, data.byteLength, wasmOptions);
+  } finally {
+    module._free(inputPtr);
+  }
+
+  return result.error ? result : readOutput(module, result);
+}
+
+/**
+ * Transcode an AVIF or JXL file to `targetFormat` inside the WASM module.
+ *
+ * Only the first frame of an animation is transcoded. Use
+ * `canTranscodeNatively()` to check the options first.
+ */
+export async function transcodeNative(
+  input: Uint8Array | ArrayBuffer,
+  targetFormat: TranscodeTargetFormat,
+  options: TranscodeTargetOptions = {},
+  config?: InitConfig,
+): Promise<Uint8Array> {
+  const output = await runTranscode(input, targetFormat, options, config);
+  if (!(output instanceof Uint8Array)) {
+    throw new Error(`Transcode error: ${output.error}`);
+  }
+  return output;
+}
+
+/**
+ * Like `transcodeNative()`, but resolves to null when the input needs
+ * something the native pipeline does not implement, such as colour
+ * conversion of ICC-tagged AVIF or a transfer function JPEG XL cannot
+ * signal. decode() + encode() handle those inputs.
+ */
+export async function transcodeNativeIfSupported(
+  input: Uint8Array | ArrayBuffer,
+  targetFormat: TranscodeTargetFormat,
+  options: TranscodeTargetOptions = {},
+  config?: InitConfig,
+): Promise<Uint8Array | null> {
+  const output = await runTranscode(input, targetFormat, options, config);
+  if (output instanceof Uint8Array) return output;
+  if (output.unsupported) return null;
+  throw new Error(`Transcode error: ${output.error}`);
+}
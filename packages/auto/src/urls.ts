@@ -0,0 +1,13 @@
+/**
+ * WASM module URLs - single source of truth
+ *
+ * URLs are resolved at import time using import.meta.url.
+ * This ensures correct paths in bundled consumer projects.
+ */
+
+// Transcoder URLs (AVIF + JXL in one module)
+export const mtTranscoderUrl = new URL('./transcode_mt.js', import.meta.url).href;
+export const stTranscoderUrl = new URL('./transcode.js', import.meta.url).href;
+
+// Worker URL
+export const transcodeWorkerUrl = new URL('./transcode-worker.js', import.meta.url);
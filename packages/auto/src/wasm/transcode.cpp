@@ -0,0 +1,1168 @@
+#include <emscripten/bind.h>
+#include <emscripten.h>
+#include <avif/avif.h>
+#include <jxl/cms.h>
+#include <jxl/decode.h>
+#include <jxl/decode_cxx.h>
+#include <jxl/encode.h>
+#include <jxl/encode_cxx.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "jxl_arena.h"
+#include "jxl_thread_pool.h"
+
+using namespace emscripten;
+
+// Max threads constant (defined via CMake for MT builds)
+#ifndef MAX_THREADS
+#define MAX_THREADS 1  // Single-threaded fallback
+#endif
+
+// AVIF <-> JPEG XL transcoder. Decode, optional colour conversion and encode
+// all run in this module's heap: the decoded pixels are handed from stage to
+// stage by pointer and never travel through JS.
+
+// ============================================================================
+// Transcode Options
+// ============================================================================
+
+struct TranscodeOptions
+{
+    std::string format;           // Target format: "avif" or "jxl"
+    float quality;                // 0-100 (100 = best quality)
+    float qualityAlpha;           // AVIF: alpha quality 0-100 (100 = lossless)
+    bool lossless;
+    int bitDepth;                 // 0 = source depth, else 8, 10, 12, 16 (AVIF stops at 12)
+    std::string colorSpace;       // "" = keep source, "srgb", "display-p3", "rec2020"
+    std::string transferFunction; // "" = keep source, "srgb", "pq", "hlg", "linear"
+    int speed;                    // AVIF: 0-10 (10 = fastest)
+    int effort;                   // JXL: 1-10 (10 = slowest/best compression)
+    int chromaSubsampling;        // AVIF: 444, 422, 420, 400
+    int maxThreads;
+};
+
+struct TranscodeTimings
+{
+    double decode;   // Includes YUV->RGB for AVIF sources
+    double convert;  // Colour conversion, 0 when skipped
+    double encode;   // Includes RGB->YUV for AVIF targets
+    double total;
+};
+
+struct TranscodeResult
+{
+    uintptr_t dataPtr;        // Encoded file (caller must free via Module._free)
+    size_t dataSize;
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;        // 3 (RGB) or 4 (RGBA)
+    uint32_t bitDepth;        // Bit depth of the encoded file
+    std::string sourceFormat; // "avif" or "jxl"
+    std::string error;
+    bool unsupported;         // `error` is a limit of this pipeline, decode + encode can handle the input
+    TranscodeTimings timings;
+};
+
+// ============================================================================
+// Decoded image
+// ============================================================================
+
+using PixelPtr = std::unique_ptr<uint8_t, decltype(&free)>;
+
+// Colour description carried from the decoder to the encoder, as CICP code
+// points (shared by both formats here). An ICC profile takes precedence.
+struct ColorTags
+{
+    avifColorPrimaries primaries = AVIF_COLOR_PRIMARIES_BT709;
+    avifTransferCharacteristics transfer = AVIF_TRANSFER_CHARACTERISTICS_SRGB;
+    std::vector<uint8_t> icc;
+};
+
+// Interleaved RGB(A) passed between the stages. Samples lie in
+// [0, 2^depth - 1] and are uint8 for depth 8, uint16 above.
+struct DecodedImage
+{
+    PixelPtr pixels{nullptr, &free};
+    size_t size = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t channels = 0;
+    int depth = 8;        // 8, 10, 12 or 16
+    int sourceDepth = 8;  // Bits per sample coded in the source file
+    ColorTags color;
+};
+
+// Smallest sample depth libavif and libjxl both take for RGB buffers
+int bufferDepthFor(int bits)
+{
+    if (bits <= 8)
+        return 8;
+    if (bits <= 10)
+        return 10;
+    if (bits <= 12)
+        return 12;
+    return 16;
+}
+
+// ============================================================================
+// Colour encoding helpers
+// ============================================================================
+
+avifColorPrimaries parsePrimaries(const std::string &cs)
+{
+    if (cs == "display-p3" || cs == "p3")
+        return AVIF_COLOR_PRIMARIES_SMPTE432;
+    if (cs == "rec2020" || cs == "bt2020")
+        return AVIF_COLOR_PRIMARIES_BT2020;
+    return AVIF_COLOR_PRIMARIES_BT709;  // sRGB
+}
+
+avifTransferCharacteristics parseTransfer(const std::string &tf)
+{
+    if (tf == "pq")
+        return AVIF_TRANSFER_CHARACTERISTICS_PQ;
+    if (tf == "hlg")
+        return AVIF_TRANSFER_CHARACTERISTICS_HLG;
+    if (tf == "linear")
+        return AVIF_TRANSFER_CHARACTERISTICS_LINEAR;
+    return AVIF_TRANSFER_CHARACTERISTICS_SRGB;
+}
+
+// Unspecified code points are read as sRGB, as libavif does
+void normalizeTags(ColorTags &tags)
+{
+    if (tags.primaries == AVIF_COLOR_PRIMARIES_UNSPECIFIED || tags.primaries == AVIF_COLOR_PRIMARIES_UNKNOWN)
+        tags.primaries = AVIF_COLOR_PRIMARIES_BT709;
+    if (tags.transfer == AVIF_TRANSFER_CHARACTERISTICS_UNSPECIFIED || tags.transfer == AVIF_TRANSFER_CHARACTERISTICS_UNKNOWN)
+        tags.transfer = AVIF_TRANSFER_CHARACTERISTICS_SRGB;
+}
+
+// CICP equivalent of a JXL colour encoding. Returns false when there is
+// none (custom primaries, odd gammas); the caller then keeps the ICC profile.
+bool jxlToCicp(const JxlColorEncoding &enc, ColorTags &tags)
+{
+    if (enc.color_space != JXL_COLOR_SPACE_RGB && enc.color_space != JXL_COLOR_SPACE_GRAY)
+        return false;
+
+    if (enc.color_space == JXL_COLOR_SPACE_GRAY)
+    {
+        // Gray is expanded to RGB on output; only the white point matters
+        if (enc.white_point != JXL_WHITE_POINT_D65)
+            return false;
+        tags.primaries = AVIF_COLOR_PRIMARIES_BT709;
+    }
+    else if (enc.primaries == JXL_PRIMARIES_SRGB && enc.white_point == JXL_WHITE_POINT_D65)
+        tags.primaries = AVIF_COLOR_PRIMARIES_BT709;
+    else if (enc.primaries == JXL_PRIMARIES_2100 && enc.white_point == JXL_WHITE_POINT_D65)
+        tags.primaries = AVIF_COLOR_PRIMARIES_BT2020;
+    else if (enc.primaries == JXL_PRIMARIES_P3 && enc.white_point == JXL_WHITE_POINT_D65)
+        tags.primaries = AVIF_COLOR_PRIMARIES_SMPTE432;
+    else if (enc.primaries == JXL_PRIMARIES_P3 && enc.white_point == JXL_WHITE_POINT_DCI)
+        tags.primaries = AVIF_COLOR_PRIMARIES_SMPTE431;
+    else
+        return false;
+
+    switch (enc.transfer_function)
+    {
+    case JXL_TRANSFER_FUNCTION_709:
+        tags.transfer = AVIF_TRANSFER_CHARACTERISTICS_BT709;
+        return true;
+    case JXL_TRANSFER_FUNCTION_SRGB:
+        tags.transfer = AVIF_TRANSFER_CHARACTERISTICS_SRGB;
+        return true;
+    case JXL_TRANSFER_FUNCTION_LINEAR:
+        tags.transfer = AVIF_TRANSFER_CHARACTERISTICS_LINEAR;
+        return true;
+    case JXL_TRANSFER_FUNCTION_PQ:
+        tags.transfer = AVIF_TRANSFER_CHARACTERISTICS_PQ;
+        return true;
+    case JXL_TRANSFER_FUNCTION_HLG:
+        tags.transfer = AVIF_TRANSFER_CHARACTERISTICS_HLG;
+        return true;
+    case JXL_TRANSFER_FUNCTION_DCI:
+        tags.transfer = AVIF_TRANSFER_CHARACTERISTICS_SMPTE428;
+        return true;
+    case JXL_TRANSFER_FUNCTION_GAMMA:
+        // Gamma is stored as its reciprocal
+        if (std::fabs(enc.gamma - 1.0 / 2.2) < 1e-3)
+        {
+            tags.transfer = AVIF_TRANSFER_CHARACTERISTICS_BT470M;
+            return true;
+        }
+        if (std::fabs(enc.gamma - 1.0 / 2.8) < 1e-3)
+        {
+            tags.transfer = AVIF_TRANSFER_CHARACTERISTICS_BT470BG;
+            return true;
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+// JXL colour encoding for CICP tags. Returns false for transfer
+// characteristics JPEG XL cannot signal.
+bool cicpToJxl(const ColorTags &tags, JxlColorEncoding &enc)
+{
+    JxlColorEncodingSetToSRGB(&enc, JXL_FALSE);
+
+    switch (tags.primaries)
+    {
+    case AVIF_COLOR_PRIMARIES_BT709:
+    case AVIF_COLOR_PRIMARIES_UNSPECIFIED:
+        break;
+    case AVIF_COLOR_PRIMARIES_BT2020:
+        enc.primaries = JXL_PRIMARIES_2100;
+        break;
+    case AVIF_COLOR_PRIMARIES_SMPTE432:
+        enc.primaries = JXL_PRIMARIES_P3;
+        break;
+    case AVIF_COLOR_PRIMARIES_SMPTE431:
+        enc.primaries = JXL_PRIMARIES_P3;
+        enc.white_point = JXL_WHITE_POINT_DCI;
+        break;
+    default:
+    {
+        // rX, rY, gX, gY, bX, bY, wX, wY
+        float xy[8];
+        avifColorPrimariesGetValues(tags.primaries, xy);
+        enc.primaries = JXL_PRIMARIES_CUSTOM;
+        enc.primaries_red_xy[0] = xy[0];
+        enc.primaries_red_xy[1] = xy[1];
+        enc.primaries_green_xy[0] = xy[2];
+        enc.primaries_green_xy[1] = xy[3];
+        enc.primaries_blue_xy[0] = xy[4];
+        enc.primaries_blue_xy[1] = xy[5];
+        enc.white_point = JXL_WHITE_POINT_CUSTOM;
+        enc.white_point_xy[0] = xy[6];
+        enc.white_point_xy[1] = xy[7];
+        break;
+    }
+    }
+
+    switch (tags.transfer)
+    {
+    case AVIF_TRANSFER_CHARACTERISTICS_SRGB:
+    case AVIF_TRANSFER_CHARACTERISTICS_UNSPECIFIED:
+        return true;
+    case AVIF_TRANSFER_CHARACTERISTICS_BT709:
+    case AVIF_TRANSFER_CHARACTERISTICS_BT601:
+    case AVIF_TRANSFER_CHARACTERISTICS_BT2020_10BIT:
+    case AVIF_TRANSFER_CHARACTERISTICS_BT2020_12BIT:
+        enc.transfer_function = JXL_TRANSFER_FUNCTION_709;
+        return true;
+    case AVIF_TRANSFER_CHARACTERISTICS_LINEAR:
+        enc.transfer_function = JXL_TRANSFER_FUNCTION_LINEAR;
+        return true;
+    case AVIF_TRANSFER_CHARACTERISTICS_PQ:
+        enc.transfer_function = JXL_TRANSFER_FUNCTION_PQ;
+        return true;
+    case AVIF_TRANSFER_CHARACTERISTICS_HLG:
+        enc.transfer_function = JXL_TRANSFER_FUNCTION_HLG;
+        return true;
+    case AVIF_TRANSFER_CHARACTERISTICS_SMPTE428:
+        enc.transfer_function = JXL_TRANSFER_FUNCTION_DCI;
+        return true;
+    case AVIF_TRANSFER_CHARACTERISTICS_BT470M:
+        enc.transfer_function = JXL_TRANSFER_FUNCTION_GAMMA;
+        enc.gamma = 1.0 / 2.2;
+        return true;
+    case AVIF_TRANSFER_CHARACTERISTICS_BT470BG:
+        enc.transfer_function = JXL_TRANSFER_FUNCTION_GAMMA;
+        enc.gamma = 1.0 / 2.8;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// The encoding the caller asked for, filling unset parts from the source.
+// Returns false when the source encoding is kept as is.
+bool resolveTargetColor(const TranscodeOptions &options, const ColorTags &source, ColorTags &target)
+{
+    if (options.colorSpace.empty() && options.transferFunction.empty())
+        return false;
+
+    target.primaries = options.colorSpace.empty() ? source.primaries : parsePrimaries(options.colorSpace);
+    target.transfer = options.transferFunction.empty() ? source.transfer : parseTransfer(options.transferFunction);
+    target.icc.clear();
+    normalizeTags(target);
+    return true;
+}
+
+// ============================================================================
+// Colour conversion (AVIF sources)
+// ============================================================================
+
+// libjxl converts JXL sources while decoding. AVIF sources are CICP tagged,
+// so they are converted analytically in place: linearize, change primaries,
+// re-encode. Linear light is relative to SDR reference white (203 nits, as
+// in BT.2408); values the target cannot hold are clipped, not tone mapped.
+
+constexpr float kSdrWhiteNits = 203.0f;
+constexpr float kHlgPeakNits = 1000.0f;
+
+float srgbToLinear(float v)
+{
+    return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(float l)
+{
+    return l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+}
+
+float bt709ToLinear(float v)
+{
+    return v < 0.081f ? v / 4.5f : std::pow((v + 0.099f) / 1.099f, 1.0f / 0.45f);
+}
+
+float linearToBt709(float l)
+{
+    return l < 0.018f ? l * 4.5f : 1.099f * std::pow(l, 0.45f) - 0.099f;
+}
+
+// SMPTE ST 2084, in nits
+constexpr float kPqM1 = 0.1593017578125f;
+constexpr float kPqM2 = 78.84375f;
+constexpr float kPqC1 = 0.8359375f;
+constexpr float kPqC2 = 18.8515625f;
+constexpr float kPqC3 = 18.6875f;
+
+float pqToNits(float v)
+{
+    float p = std::pow(v, 1.0f / kPqM2);
+    float num = std::max(p - kPqC1, 0.0f);
+    return 10000.0f * std::pow(num / (kPqC2 - kPqC3 * p), 1.0f / kPqM1);
+}
+
+float nitsToPq(float nits)
+{
+    float p = std::pow(std::min(nits / 10000.0f, 1.0f), kPqM1);
+    return std::pow((kPqC1 + kPqC2 * p) / (1.0f + kPqC3 * p), kPqM2);
+}
+
+// BT.2100 HLG on a 1000-nit display. The OOTF is applied per channel
+// rather than on luminance, which keeps hues close enough for a transcode.
+constexpr float kHlgA = 0.17883277f;
+constexpr float kHlgB = 0.28466892f;
+constexpr float kHlgC = 0.55991073f;
+constexpr float kHlgGamma = 1.2f;
+
+float hlgToNits(float v)
+{
+    float e = v <= 0.5f ? v * v / 3.0f : (std::exp((v - kHlgC) / kHlgA) + kHlgB) / 12.0f;
+    return kHlgPeakNits * std::pow(e, kHlgGamma);
+}
+
+float nitsToHlg(float nits)
+{
+    float e = std::pow(std::min(nits / kHlgPeakNits, 1.0f), 1.0f / kHlgGamma);
+    return e <= 1.0f / 12.0f ? std::sqrt(3.0f * e) : kHlgA * std::log(12.0f * e - kHlgB) + kHlgC;
+}
+
+enum class Curve
+{
+    Unsupported,
+    Srgb,
+    Bt709,
+    Linear,
+    Pq,
+    Hlg,
+};
+
+Curve curveFor(avifTransferCharacteristics tc)
+{
+    switch (tc)
+    {
+    case AVIF_TRANSFER_CHARACTERISTICS_SRGB:
+        return Curve::Srgb;
+    case AVIF_TRANSFER_CHARACTERISTICS_BT709:
+    case AVIF_TRANSFER_CHARACTERISTICS_BT601:
+    case AVIF_TRANSFER_CHARACTERISTICS_BT2020_10BIT:
+    case AVIF_TRANSFER_CHARACTERISTICS_BT2020_12BIT:
+        return Curve::Bt709;
+    case AVIF_TRANSFER_CHARACTERISTICS_LINEAR:
+        return Curve::Linear;
+    case AVIF_TRANSFER_CHARACTERISTICS_PQ:
+        return Curve::Pq;
+    case AVIF_TRANSFER_CHARACTERISTICS_HLG:
+        return Curve::Hlg;
+    default:
+        return Curve::Unsupported;
+    }
+}
+
+// Encoded value [0, 1] to linear light relative to SDR white
+float toLinear(Curve curve, float v)
+{
+    switch (curve)
+    {
+    case Curve::Srgb:
+        return srgbToLinear(v);
+    case Curve::Bt709:
+        return bt709ToLinear(v);
+    case Curve::Pq:
+        return pqToNits(v) / kSdrWhiteNits;
+    case Curve::Hlg:
+        return hlgToNits(v) / kSdrWhiteNits;
+    default:
+        return v;
+    }
+}
+
+// Linear light relative to SDR white to an encoded value, clipped to [0, 1]
+float fromLinear(Curve curve, float l)
+{
+    l = std::max(l, 0.0f);
+    float v;
+    switch (curve)
+    {
+    case Curve::Srgb:
+        v = linearToSrgb(std::min(l, 1.0f));
+        break;
+    case Curve::Bt709:
+        v = linearToBt709(std::min(l, 1.0f));
+        break;
+    case Curve::Pq:
+        v = nitsToPq(l * kSdrWhiteNits);
+        break;
+    case Curve::Hlg:
+        v = nitsToHlg(l * kSdrWhiteNits);
+        break;
+    default:
+        v = l;
+        break;
+    }
+    return std::min(std::max(v, 0.0f), 1.0f);
+}
+
+// fromLinear() tabulated on the float bit pattern: kSegments linear pieces
+// per octave over [2^kMinExp, 2^kMaxExp). Saves a pow() per sample; the
+// interpolation error is about one 16-bit code (a few at the HLG clip point).
+class EncodeTable
+{
+public:
+    explicit EncodeTable(Curve curve)
+        : zero_(fromLinear(curve, 0.0f)),
+          table_(static_cast<size_t>(kMaxExp - kMinExp) * kSegments + 1)
+    {
+        for (size_t i = 0; i < table_.size(); ++i)
+        {
+            int octave = kMinExp + static_cast<int>(i / kSegments);
+            float x = std::ldexp(1.0f + static_cast<float>(i % kSegments) / kSegments, octave);
+            table_[i] = fromLinear(curve, x);
+        }
+    }
+
+    float operator()(float x) const
+    {
+        const float minX = std::ldexp(1.0f, kMinExp);
+        if (!(x > minX))  // Also catches NaN
+            return x > 0.0f ? zero_ + (table_[0] - zero_) * (x / minX) : zero_;
+        if (x >= std::ldexp(1.0f, kMaxExp))
+            return table_.back();
+
+        uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        int exponent = static_cast<int>(bits >> 23) - 127;
+        uint32_t mantissa = bits & 0x7FFFFF;
+        size_t index = static_cast<size_t>(exponent - kMinExp) * kSegments + (mantissa >> kFracBits);
+        float frac = static_cast<float>(mantissa & ((1u << kFracBits) - 1)) * (1.0f / (1u << kFracBits));
+        return table_[index] + (table_[index + 1] - table_[index]) * frac;
+    }
+
+private:
+    static constexpr int kMinExp = -20;
+    static constexpr int kMaxExp = 6;  // PQ peak is 10000 / 203 = 49x SDR white
+    static constexpr uint32_t kSegmentBits = 8;
+    static constexpr uint32_t kSegments = 1u << kSegmentBits;
+    static constexpr uint32_t kFracBits = 23 - kSegmentBits;
+
+    float zero_;
+    std::vector<float> table_;
+};
+
+using Matrix3 = float[9];
+
+bool invert3(const Matrix3 m, Matrix3 out)
+{
+    float det = m[0] * (m[4] * m[8] - m[5] * m[7]) -
+                m[1] * (m[3] * m[8] - m[5] * m[6]) +
+                m[2] * (m[3] * m[7] - m[4] * m[6]);
+    if (std::fabs(det) < 1e-12f)
+        return false;
+    float inv = 1.0f / det;
+    out[0] = (m[4] * m[8] - m[5] * m[7]) * inv;
+    out[1] = (m[2] * m[7] - m[1] * m[8]) * inv;
+    out[2] = (m[1] * m[5] - m[2] * m[4]) * inv;
+    out[3] = (m[5] * m[6] - m[3] * m[8]) * inv;
+    out[4] = (m[0] * m[8] - m[2] * m[6]) * inv;
+    out[5] = (m[2] * m[3] - m[0] * m[5]) * inv;
+    out[6] = (m[3] * m[7] - m[4] * m[6]) * inv;
+    out[7] = (m[1] * m[6] - m[0] * m[7]) * inv;
+    out[8] = (m[0] * m[4] - m[1] * m[3]) * inv;
+    return true;
+}
+
+void multiply3(const Matrix3 a, const Matrix3 b, Matrix3 out)
+{
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c)
+            out[r * 3 + c] = a[r * 3] * b[c] + a[r * 3 + 1] * b[3 + c] + a[r * 3 + 2] * b[6 + c];
+}
+
+// RGB -> XYZ for CICP primaries, derived from their chromaticities.
+// Returns false unless the white point is D65: converting between white
+// points would need chromatic adaptation, which is not done here.
+bool rgbToXyz(avifColorPrimaries primaries, Matrix3 out)
+{
+    float xy[8];
+    avifColorPrimariesGetValues(primaries, xy);
+    if (std::fabs(xy[6] - 0.3127f) > 1e-3f || std::fabs(xy[7] - 0.3290f) > 1e-3f)
+        return false;
+
+    Matrix3 m;
+    for (int i = 0; i < 3; ++i)
+    {
+        float x = xy[i * 2];
+        float y = xy[i * 2 + 1];
+        m[i] = x / y;
+        m[3 + i] = 1.0f;
+        m[6 + i] = (1.0f - x - y) / y;
+    }
+    Matrix3 inv;
+    if (!invert3(m, inv))
+        return false;
+
+    const float white[3] = {xy[6] / xy[7], 1.0f, (1.0f - xy[6] - xy[7]) / xy[7]};
+    for (int c = 0; c < 3; ++c)
+    {
+        float scale = inv[c * 3] * white[0] + inv[c * 3 + 1] * white[1] + inv[c * 3 + 2] * white[2];
+        for (int r = 0; r < 3; ++r)
+            out[r * 3 + c] = m[r * 3 + c] * scale;
+    }
+    return true;
+}
+
+template <typename T>
+void convertPixels(
+    T *pixels,
+    size_t pixelCount,
+    uint32_t channels,
+    const std::vector<float> &decode,
+    const Matrix3 m,
+    const EncodeTable &encode,
+    float maxValue)
+{
+    for (size_t i = 0; i < pixelCount; ++i, pixels += channels)
+    {
+        float r = decode[pixels[0]];
+        float g = decode[pixels[1]];
+        float b = decode[pixels[2]];
+        pixels[0] = static_cast<T>(encode(m[0] * r + m[1] * g + m[2] * b) * maxValue + 0.5f);
+        pixels[1] = static_cast<T>(encode(m[3] * r + m[4] * g + m[5] * b) * maxValue + 0.5f);
+        pixels[2] = static_cast<T>(encode(m[6] * r + m[7] * g + m[8] * b) * maxValue + 0.5f);
+    }
+}
+
+// Convert `image` to `target` in place. Returns an error message, empty on
+// success. Every error is a conversion this pipeline does not implement.
+std::string convertColor(DecodedImage &image, const ColorTags &target)
+{
+    if (!image.color.icc.empty())
+        return "Colour conversion of ICC-tagged AVIF images is not supported";
+
+    ColorTags source = image.color;
+    normalizeTags(source);
+    if (source.primaries == target.primaries && source.transfer == target.transfer)
+    {
+        image.color = target;
+        return "";
+    }
+
+    Curve from = curveFor(source.transfer);
+    Curve to = curveFor(target.transfer);
+    if (from == Curve::Unsupported || to == Curve::Unsupported)
+        return "Colour conversion is not supported for this transfer function";
+
+    Matrix3 srcToXyz, dstToXyz, xyzToDst, m;
+    if (!rgbToXyz(source.primaries, srcToXyz) || !rgbToXyz(target.primaries, dstToXyz) ||
+        !invert3(dstToXyz, xyzToDst))
+        return "Colour conversion is not supported for these primaries";
+    multiply3(xyzToDst, srcToXyz, m);
+
+    // Source codes are bounded by the buffer depth, so a full table is small
+    const uint32_t codes = 1u << image.depth;
+    const float maxValue = static_cast<float>(codes - 1);
+    std::vector<float> decode(codes);
+    for (uint32_t i = 0; i < codes; ++i)
+        decode[i] = toLinear(from, static_cast<float>(i) / maxValue);
+    EncodeTable encode(to);
+
+    const size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+    if (image.depth > 8)
+        convertPixels(reinterpret_cast<uint16_t *>(image.pixels.get()), pixelCount, image.channels,
+                      decode, m, encode, maxValue);
+    else
+        convertPixels(image.pixels.get(), pixelCount, image.channels, decode, m, encode, maxValue);
+
+    image.color = target;
+    return "";
+}
+
+// ============================================================================
+// Decode
+// ============================================================================
+
+// Decode the first image of an AVIF file to RGB(A) at its own depth
+std::string decodeAvif(const uint8_t *data, size_t size, int maxThreads, DecodedImage &out)
+{
+    avifDecoder *decoder = avifDecoderCreate();
+    if (!decoder)
+        return "Failed to create AVIF decoder";
+    std::unique_ptr<avifDecoder, decltype(&avifDecoderDestroy)> guard(decoder, &avifDecoderDestroy);
+
+    decoder->maxThreads = maxThreads > 0 ? maxThreads : 1;
+    decoder->codecChoice = AVIF_CODEC_CHOICE_AUTO;
+    decoder->strictFlags = AVIF_STRICT_DISABLED;
+    decoder->ignoreExif = AVIF_TRUE;
+    decoder->ignoreXMP = AVIF_TRUE;
+
+    avifResult res = avifDecoderSetIOMemory(decoder, data, size);
+    if (res != AVIF_RESULT_OK)
+        return std::string("IO error: ") + avifResultToString(res);
+    res = avifDecoderParse(decoder);
+    if (res != AVIF_RESULT_OK)
+        return std::string("Parse error: ") + avifResultToString(res);
+    res = avifDecoderNextImage(decoder);
+    if (res != AVIF_RESULT_OK)
+        return std::string("Decode error: ") + avifResultToString(res);
+
+    const avifImage *image = decoder->image;
+    out.width = image->width;
+    out.height = image->height;
+    out.channels = image->alphaPlane ? 4 : 3;
+    out.sourceDepth = static_cast<int>(image->depth);
+    out.depth = bufferDepthFor(out.sourceDepth);
+    out.color.primaries = image->colorPrimaries;
+    out.color.transfer = image->transferCharacteristics;
+    if (image->icc.size > 0)
+        out.color.icc.assign(image->icc.data, image->icc.data + image->icc.size);
+
+    avifRGBImage rgb;
+    avifRGBImageSetDefaults(&rgb, image);
+    rgb.depth = out.depth;
+    rgb.format = out.channels == 4 ? AVIF_RGB_FORMAT_RGBA : AVIF_RGB_FORMAT_RGB;
+    rgb.alphaPremultiplied = AVIF_FALSE;
+    rgb.isFloat = AVIF_FALSE;
+    rgb.rowBytes = rgb.width * avifRGBImagePixelSize(&rgb);
+
+    out.size = static_cast<size_t>(rgb.rowBytes) * rgb.height;
+    out.pixels.reset(static_cast<uint8_t *>(malloc(out.size)));
+    if (!out.pixels)
+        return "Failed to allocate pixel buffer";
+    rgb.pixels = out.pixels.get();
+
+    res = avifImageYUVToRGB(image, &rgb);
+    if (res != AVIF_RESULT_OK)
+        return std::string("YUV to RGB error: ") + avifResultToString(res);
+    return "";
+}
+
+// Read the colour encoding of the decoded pixels into `tags`
+void readJxlColor(JxlDecoder *dec, ColorTags &tags)
+{
+    JxlColorEncoding enc;
+    if (JxlDecoderGetColorAsEncodedProfile(dec, JXL_COLOR_PROFILE_TARGET_DATA, &enc) == JXL_DEC_SUCCESS &&
+        jxlToCicp(enc, tags))
+        return;
+
+    size_t iccSize = 0;
+    if (JxlDecoderGetICCProfileSize(dec, JXL_COLOR_PROFILE_TARGET_DATA, &iccSize) == JXL_DEC_SUCCESS && iccSize > 0)
+    {
+        tags.icc.resize(iccSize);
+        if (JxlDecoderGetColorAsICCProfile(dec, JXL_COLOR_PROFILE_TARGET_DATA, tags.icc.data(), iccSize) != JXL_DEC_SUCCESS)
+            tags.icc.clear();
+    }
+}
+
+// Decode the first frame of a JXL file to RGB(A). With a `target` encoding
+// libjxl converts colour while decoding (through its CMS when needed).
+std::string decodeJxl(
+    const uint8_t *data,
+    size_t size,
+    const TranscodeOptions &options,
+    DecodedImage &out,
+    bool &converted)
+{
+    converted = false;
+    auto dec = JxlDecoderMake(sharedArena().manager());
+    if (!dec)
+        return "Failed to create JXL decoder";
+
+    PoolRunnerPtr runner;
+#if MAX_THREADS > 1
+    if (options.maxThreads > 1)
+    {
+        runner = makePoolRunner(static_cast<size_t>(options.maxThreads));
+        if (JxlDecoderSetParallelRunner(dec.get(), PoolRunner::run, runner.get()) != JXL_DEC_SUCCESS)
+            return "Failed to set parallel runner";
+    }
+#endif
+
+    const bool convert = !options.colorSpace.empty() || !options.transferFunction.empty();
+    if (convert && JxlDecoderSetCms(dec.get(), *JxlGetDefaultCms()) != JXL_DEC_SUCCESS)
+        return "Failed to set colour management system";
+
+    if (JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_BASIC_INFO | JXL_DEC_COLOR_ENCODING | JXL_DEC_FULL_IMAGE) != JXL_DEC_SUCCESS)
+        return "Failed to subscribe to events";
+    JxlDecoderSetUnpremultiplyAlpha(dec.get(), JXL_TRUE);
+    JxlDecoderSetInput(dec.get(), data, size);
+    JxlDecoderCloseInput(dec.get());
+
+    JxlPixelFormat format = {0, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+    for (;;)
+    {
+        JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
+
+        if (status == JXL_DEC_ERROR)
+            return "Decoder error";
+        else if (status == JXL_DEC_NEED_MORE_INPUT)
+            return "Incomplete input data";
+        else if (status == JXL_DEC_BASIC_INFO)
+        {
+            JxlBasicInfo info;
+            if (JxlDecoderGetBasicInfo(dec.get(), &info) != JXL_DEC_SUCCESS)
+                return "Failed to get basic info";
+            out.width = info.xsize;
+            out.height = info.ysize;
+            out.channels = info.alpha_bits > 0 ? 4 : 3;
+            // Float sources are quantized to 16 bits
+            out.sourceDepth = info.exponent_bits_per_sample > 0 ? 16 : static_cast<int>(info.bits_per_sample);
+            out.depth = bufferDepthFor(out.sourceDepth);
+            format.num_channels = out.channels;
+            format.data_type = out.depth > 8 ? JXL_TYPE_UINT16 : JXL_TYPE_UINT8;
+        }
+        else if (status == JXL_DEC_COLOR_ENCODING)
+        {
+            readJxlColor(dec.get(), out.color);
+
+            ColorTags target;
+            if (convert && resolveTargetColor(options, out.color, target))
+            {
+                JxlColorEncoding enc;
+                if (!cicpToJxl(target, enc))
+                    return "Unsupported target colour encoding";
+                if (JxlDecoderSetOutputColorProfile(dec.get(), &enc, nullptr, 0) != JXL_DEC_SUCCESS)
+                    return "Failed to set output colour profile";
+                out.color = target;
+                converted = true;
+            }
+        }
+        else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER)
+        {
+            size_t bufferSize;
+            if (JxlDecoderImageOutBufferSize(dec.get(), &format, &bufferSize) != JXL_DEC_SUCCESS)
+                return "Failed to get output buffer size";
+
+            out.pixels.reset(static_cast<uint8_t *>(malloc(bufferSize)));
+            if (!out.pixels)
+                return "Failed to allocate pixel buffer";
+            out.size = bufferSize;
+
+            if (JxlDecoderSetImageOutBuffer(dec.get(), &format, out.pixels.get(), bufferSize) != JXL_DEC_SUCCESS)
+                return "Failed to set output buffer";
+
+            // Same sample range as the AVIF path: [0, 2^depth - 1]
+            JxlBitDepth bitDepth = {JXL_BIT_DEPTH_CUSTOM, static_cast<uint32_t>(out.depth), 0};
+            if (JxlDecoderSetImageOutBitDepth(dec.get(), &bitDepth) != JXL_DEC_SUCCESS)
+                return "Failed to set output bit depth";
+        }
+        else if (status == JXL_DEC_FULL_IMAGE || status == JXL_DEC_SUCCESS)
+        {
+            // Animations contribute their first frame
+            break;
+        }
+    }
+
+    if (!out.pixels)
+        return "No image data decoded";
+    return "";
+}
+
+// ============================================================================
+// Encode
+// ============================================================================
+
+// Output depth for a target that supports depths up to `maxDepth`
+int targetDepth(const TranscodeOptions &options, const DecodedImage &image, int maxDepth)
+{
+    int depth = options.bitDepth > 0 ? options.bitDepth : image.sourceDepth;
+    return std::min(std::max(depth, 8), maxDepth);
+}
+
+avifPixelFormat pixelFormatFromCode(int chromaSubsampling)
+{
+    switch (chromaSubsampling)
+    {
+    case 444:
+        return AVIF_PIXEL_FORMAT_YUV444;
+    case 422:
+        return AVIF_PIXEL_FORMAT_YUV422;
+    case 400:
+        return AVIF_PIXEL_FORMAT_YUV400;
+    default:
+        return AVIF_PIXEL_FORMAT_YUV420;
+    }
+}
+
+// Convert to YUV, release the RGB buffer and encode
+std::string encodeAvif(DecodedImage &src, const TranscodeOptions &options, TranscodeResult &result)
+{
+    int depth = targetDepth(options, src, 12);
+    depth = depth <= 8 ? 8 : depth <= 10 ? 10 : 12;
+    // Lossless requires 4:4:4
+    avifPixelFormat yuvFormat = options.lossless ? AVIF_PIXEL_FORMAT_YUV444 : pixelFormatFromCode(options.chromaSubsampling);
+
+    avifImage *image = avifImageCreate(src.width, src.height, depth, yuvFormat);
+    if (!image)
+        return "Failed to create avifImage";
+    std::unique_ptr<avifImage, decltype(&avifImageDestroy)> guard(image, &avifImageDestroy);
+
+    image->yuvRange = AVIF_RANGE_FULL;
+    if (src.color.icc.empty())
+    {
+        image->colorPrimaries = src.color.primaries;
+        image->transferCharacteristics = src.color.transfer;
+    }
+    else
+    {
+        image->colorPrimaries = AVIF_COLOR_PRIMARIES_UNSPECIFIED;
+        image->transferCharacteristics = AVIF_TRANSFER_CHARACTERISTICS_UNSPECIFIED;
+        avifResult res = avifImageSetProfileICC(image, src.color.icc.data(), src.color.icc.size());
+        if (res != AVIF_RESULT_OK)
+            return std::string("Failed to set ICC profile: ") + avifResultToString(res);
+    }
+    if (options.lossless)
+        image->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_IDENTITY;
+    else if (src.color.primaries == AVIF_COLOR_PRIMARIES_BT2020)
+        image->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_BT2020_NCL;
+    else
+        image->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_BT709;
+
+    // libavif rescales from the buffer depth to the image depth here
+    avifRGBImage rgb;
+    avifRGBImageSetDefaults(&rgb, image);
+    rgb.depth = src.depth;
+    rgb.format = src.channels == 4 ? AVIF_RGB_FORMAT_RGBA : AVIF_RGB_FORMAT_RGB;
+    rgb.alphaPremultiplied = AVIF_FALSE;
+    rgb.isFloat = AVIF_FALSE;
+    rgb.rowBytes = rgb.width * avifRGBImagePixelSize(&rgb);
+    rgb.pixels = src.pixels.get();
+
+    avifResult res = avifImageRGBToYUV(image, &rgb);
+    // The YUV planes are all the encoder needs from here on
+    src.pixels.reset();
+    if (res != AVIF_RESULT_OK)
+        return std::string("RGB to YUV error: ") + avifResultToString(res);
+
+    avifEncoder *encoder = avifEncoderCreate();
+    if (!encoder)
+        return "Failed to create AVIF encoder";
+    std::unique_ptr<avifEncoder, decltype(&avifEncoderDestroy)> encoderGuard(encoder, &avifEncoderDestroy);
+
+    encoder->maxThreads = options.maxThreads > 0 ? options.maxThreads : 1;
+    encoder->speed = options.speed;
+    if (options.lossless)
+    {
+        encoder->quality = AVIF_QUALITY_LOSSLESS;
+        encoder->qualityAlpha = AVIF_QUALITY_LOSSLESS;
+    }
+    else
+    {
+        encoder->quality = static_cast<int>(options.quality);
+        encoder->qualityAlpha = static_cast<int>(options.qualityAlpha);
+    }
+    encoder->autoTiling = AVIF_TRUE;
+
+    avifRWData output = AVIF_DATA_EMPTY;
+    res = avifEncoderWrite(encoder, image, &output);
+    if (res != AVIF_RESULT_OK)
+    {
+        avifRWDataFree(&output);
+        return std::string("Encode error: ") + avifResultToString(res);
+    }
+
+    // libavif allocates with malloc, so its buffer is handed to JS as is
+    result.dataPtr = reinterpret_cast<uintptr_t>(output.data);
+    result.dataSize = output.size;
+    result.bitDepth = static_cast<uint32_t>(depth);
+    return "";
+}
+
+// Run the encoder to the end into one growing malloc'd buffer, handed to JS
+std::string drainJxlOutput(JxlEncoder *enc, TranscodeResult &result)
+{
+    size_t capacity = 64 * 1024;
+    uint8_t *buffer = static_cast<uint8_t *>(malloc(capacity));
+    if (!buffer)
+        return "Failed to allocate output buffer";
+
+    uint8_t *next = buffer;
+    size_t avail = capacity;
+    JxlEncoderStatus status;
+    while ((status = JxlEncoderProcessOutput(enc, &next, &avail)) == JXL_ENC_NEED_MORE_OUTPUT)
+    {
+        size_t used = static_cast<size_t>(next - buffer);
+        capacity *= 2;
+        uint8_t *grown = static_cast<uint8_t *>(realloc(buffer, capacity));
+        if (!grown)
+        {
+            free(buffer);
+            return "Failed to allocate output buffer";
+        }
+        buffer = grown;
+        next = buffer + used;
+        avail = capacity - used;
+    }
+    if (status != JXL_ENC_SUCCESS)
+    {
+        free(buffer);
+        return "Encoding failed";
+    }
+
+    size_t size = static_cast<size_t>(next - buffer);
+    // Shrinking never moves data that matters, failure keeps the old block
+    if (uint8_t *shrunk = static_cast<uint8_t *>(realloc(buffer, std::max<size_t>(size, 1))))
+        buffer = shrunk;
+    result.dataPtr = reinterpret_cast<uintptr_t>(buffer);
+    result.dataSize = size;
+    return "";
+}
+
+// Hand the RGB buffer to libjxl, release it and encode
+std::string encodeJxl(DecodedImage &src, const TranscodeOptions &options, TranscodeResult &result)
+{
+    auto enc = JxlEncoderMake(sharedArena().manager());
+    if (!enc)
+        return "Failed to create JXL encoder";
+
+    PoolRunnerPtr runner;
+#if MAX_THREADS > 1
+    if (options.maxThreads > 1)
+    {
+        runner = makePoolRunner(static_cast<size_t>(options.maxThreads));
+        if (JxlEncoderSetParallelRunner(enc.get(), PoolRunner::run, runner.get()) != JXL_ENC_SUCCESS)
+            return "Failed to set parallel runner";
+    }
+#endif
+
+    const int depth = targetDepth(options, src, 16);
+    JxlBasicInfo info;
+    JxlEncoderInitBasicInfo(&info);
+    info.xsize = src.width;
+    info.ysize = src.height;
+    info.bits_per_sample = static_cast<uint32_t>(depth);
+    info.exponent_bits_per_sample = 0;
+    info.num_color_channels = 3;
+    info.alpha_bits = src.channels == 4 ? info.bits_per_sample : 0;
+    info.num_extra_channels = src.channels == 4 ? 1 : 0;
+    // Lossless must keep the samples in their own colour space, not XYB
+    info.uses_original_profile = options.lossless ? JXL_TRUE : JXL_FALSE;
+    if (JxlEncoderSetBasicInfo(enc.get(), &info) != JXL_ENC_SUCCESS)
+        return "Failed to set basic info";
+
+    if (!src.color.icc.empty())
+    {
+        if (JxlEncoderSetICCProfile(enc.get(), src.color.icc.data(), src.color.icc.size()) != JXL_ENC_SUCCESS)
+            return "Failed to set ICC profile";
+    }
+    else
+    {
+        // Unknown tags mean sRGB, as convertColor() reads them
+        ColorTags tags = src.color;
+        normalizeTags(tags);
+        JxlColorEncoding color;
+        if (!cicpToJxl(tags, color))
+        {
+            result.unsupported = true;
+            return "Source transfer characteristics have no JPEG XL equivalent";
+        }
+        if (JxlEncoderSetColorEncoding(enc.get(), &color) != JXL_ENC_SUCCESS)
+            return "Failed to set color encoding";
+    }
+
+    JxlEncoderFrameSettings *settings = JxlEncoderFrameSettingsCreate(enc.get(), nullptr);
+    if (!settings)
+        return "Failed to create frame settings";
+
+    if (options.lossless)
+    {
+        JxlEncoderSetFrameLossless(settings, JXL_TRUE);
+        JxlEncoderSetFrameDistance(settings, 0.0f);
+    }
+    else
+    {
+        // Same mapping as the JXL encoder: quality 100 -> 0.0, 0 -> 15.0
+        float quality = std::min(std::max(options.quality, 0.0f), 100.0f);
+        JxlEncoderSetFrameDistance(settings, (100.0f - quality) * 0.15f);
+    }
+    int effort = std::min(std::max(options.effort, 1), 10);
+    JxlEncoderFrameSettingsSetOption(settings, JXL_ENC_FRAME_SETTING_EFFORT, effort);
+
+    // Samples span the buffer depth; libjxl rescales to bits_per_sample
+    JxlBitDepth bitDepth = {JXL_BIT_DEPTH_CUSTOM, static_cast<uint32_t>(src.depth), 0};
+    if (JxlEncoderSetFrameBitDepth(settings, &bitDepth) != JXL_ENC_SUCCESS)
+        return "Failed to set input bit depth";
+
+    JxlPixelFormat format = {src.channels, src.depth > 8 ? JXL_TYPE_UINT16 : JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+    JxlEncoderStatus status = JxlEncoderAddImageFrame(settings, &format, src.pixels.get(), src.size);
+    // libjxl has taken its own copy of the frame
+    src.pixels.reset();
+    if (status != JXL_ENC_SUCCESS)
+        return "Failed to add image frame";
+    JxlEncoderCloseInput(enc.get());
+
+    std::string error = drainJxlOutput(enc.get(), result);
+    if (error.empty())
+        result.bitDepth = static_cast<uint32_t>(depth);
+    return error;
+}
+
+// ============================================================================
+// Main transcode function
+// ============================================================================
+
+bool isAvif(const uint8_t *data, size_t size)
+{
+    avifROData input = {data, size};
+    return avifPeekCompatibleFileType(&input) == AVIF_TRUE;
+}
+
+bool isJxl(const uint8_t *data, size_t size)
+{
+    JxlSignature signature = JxlSignatureCheck(data, size);
+    return signature == JXL_SIG_CODESTREAM || signature == JXL_SIG_CONTAINER;
+}
+
+TranscodeResult transcode(uintptr_t inputPtr, size_t inputSize, const TranscodeOptions &options)
+{
+    double tStart = emscripten_get_now();
+    TranscodeResult result = {};
+    result.dataPtr = 0;
+    result.dataSize = 0;
+
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(inputPtr);
+    if (data == nullptr || inputSize == 0)
+    {
+        result.error = "Invalid input: empty data";
+        return result;
+    }
+    if (options.format != "avif" && options.format != "jxl")
+    {
+        result.error = "Invalid target format: must be \"avif\" or \"jxl\"";
+        return result;
+    }
+
+    // libjxl allocations are released in bulk when the call returns
+    ArenaScope arenaScope(sharedArena());
+    DecodedImage image;
+    bool converted = false;
+
+    double t0 = emscripten_get_now();
+    if (isAvif(data, inputSize))
+    {
+        result.sourceFormat = "avif";
+        result.error = decodeAvif(data, inputSize, options.maxThreads, image);
+    }
+    else if (isJxl(data, inputSize))
+    {
+        result.sourceFormat = "jxl";
+        result.error = decodeJxl(data, inputSize, options, image, converted);
+    }
+    else
+    {
+        result.error = "Unsupported input format";
+    }
+    result.timings.decode = emscripten_get_now() - t0;
+    if (!result.error.empty())
+        return result;
+
+    result.width = image.width;
+    result.height = image.height;
+    result.channels = image.channels;
+
+    t0 = emscripten_get_now();
+    ColorTags target;
+    if (!converted && resolveTargetColor(options, image.color, target))
+    {
+        result.error = convertColor(image, target);
+        if (!result.error.empty())
+        {
+            result.unsupported = true;
+            return result;
+        }
+    }
+    result.timings.convert = emscripten_get_now() - t0;
+
+    t0 = emscripten_get_now();
+    if (options.format == "avif")
+        result.error = encodeAvif(image, options, result);
+    else
+        result.error = encodeJxl(image, options, result);
+    result.timings.encode = emscripten_get_now() - t0;
+
+    result.timings.total = emscripten_get_now() - tStart;
+    return result;
+}
+
+// ============================================================================
+// Emscripten Bindings
+// ============================================================================
+
+EMSCRIPTEN_BINDINGS(transcoder)
+{
+    value_object<TranscodeOptions>("TranscodeOptions")
+        .field("format", &TranscodeOptions::format)
+        .field("quality", &TranscodeOptions::quality)
+        .field("qualityAlpha", &TranscodeOptions::qualityAlpha)
+        .field("lossless", &TranscodeOptions::lossless)
+        .field("bitDepth", &TranscodeOptions::bitDepth)
+        .field("colorSpace", &TranscodeOptions::colorSpace)
+        .field("transferFunction", &TranscodeOptions::transferFunction)
+        .field("speed", &TranscodeOptions::speed)
+        .field("effort", &TranscodeOptions::effort)
+        .field("chromaSubsampling", &TranscodeOptions::chromaSubsampling)
+        .field("maxThreads", &TranscodeOptions::maxThreads);
+
+    value_object<TranscodeTimings>("TranscodeTimings")
+        .field("decode", &TranscodeTimings::decode)
+        .field("convert", &TranscodeTimings::convert)
+        .field("encode", &TranscodeTimings::encode)
+        .field("total", &TranscodeTimings::total);
+
+    value_object<TranscodeResult>("TranscodeResult")
+        .field("dataPtr", &TranscodeResult::dataPtr)
+        .field("dataSize", &TranscodeResult::dataSize)
+        .field("width", &TranscodeResult::width)
+        .field("height", &TranscodeResult::height)
+        .field("channels", &TranscodeResult::channels)
+        .field("bitDepth", &TranscodeResult::bitDepth)
+        .field("sourceFormat", &TranscodeResult::sourceFormat)
+        .field("error", &TranscodeResult::error)
+        .field("unsupported", &TranscodeResult::unsupported)
+        .field("timings", &TranscodeResult::timings);
+
+    function("transcode", &transcode);
+
+    // Export max threads constant
+    constant("MAX_THREADS", MAX_THREADS);
+}
@@ -0,0 +1,65 @@
+// TypeScript bindings for emscripten-generated code.  Automatically generated at compile time.
+declare namespace RuntimeExports {
+    /**
+     * @param {string|null=} returnType
+     * @param {Array=} argTypes
+     * @param {Array=} args
+     * @param {Object=} opts
+     */
+    function ccall(ident: any, returnType?: (string | null) | undefined, argTypes?: any[] | undefined, args?: any[] | undefined, opts?: any | undefined): any;
+    /**
+     * @param {string=} returnType
+     * @param {Array=} argTypes
+     * @param {Object=} opts
+     */
+    function cwrap(ident: any, returnType?: string | undefined, argTypes?: any[] | undefined, opts?: any | undefined): any;
+    let HEAPU8: any;
+    let HEAPU16: any;
+}
+interface WasmModule {
+  _malloc(_0: number): number;
+  _free(_0: number): void;
+}
+
+type EmbindString = ArrayBuffer|Uint8Array|Uint8ClampedArray|Int8Array|string;
+export type TranscodeOptions = {
+  format: EmbindString,
+  quality: number,
+  qualityAlpha: number,
+  lossless: boolean,
+  bitDepth: number,
+  colorSpace: EmbindString,
+  transferFunction: EmbindString,
+  speed: number,
+  effort: number,
+  chromaSubsampling: number,
+  maxThreads: number
+};
+
+export type TranscodeTimings = {
+  decode: number,
+  convert: number,
+  encode: number,
+  total: number
+};
+
+export type TranscodeResult = {
+  dataPtr: number,
+  dataSize: number,
+  width: number,
+  height: number,
+  channels: number,
+  bitDepth: number,
+  sourceFormat: EmbindString,
+  error: EmbindString,
+  unsupported: boolean,
+  timings: TranscodeTimings
+};
+
+interface EmbindModule {
+  MAX_THREADS: number;
+  transcode(_0: number, _1: number, _2: TranscodeOptions): TranscodeResult;
+}
+
+export type MainModule = WasmModule & typeof RuntimeExports & EmbindModule;
+export default function MainModuleFactory (options?: unknown): Promise<MainModule>;
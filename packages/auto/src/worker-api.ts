@@ -5,10 +5,15 @@
  * worker pools from @jcodecs/avif and @jcodecs/jxl packages.
  */
 import { isMultiThreadSupported } from '@dimkatet/jcodecs-core';
+import { CodecWorkerClient } from '@dimkatet/jcodecs-core/codec-worker-client';
 import { detectFormat, type ImageFormat } from './format-detection';
 import type { AutoImageData } from './types';
+import { keepSourceEncodeOptions } from './options';
 import type { AutoDecodeOptions, AutoEncodeOptions, AVIFEncodeOptions, JXLEncodeOptions } from './options';
 import { UnsupportedFormatError, CodecNotInstalledError } from './errors';
+import { canTranscodeNatively } from './transcoder';
+import type { TranscodeWorkerHandlers } from './transcode-worker';
+import { mtTranscoderUrl, stTranscoderUrl, transcodeWorkerUrl } from './urls';
 
 // ============================================================================
 // Types
@@ -38,6 +43,11 @@ export interface AutoWorkerPoolConfig extends WorkerPoolConfig {
   avif?: WorkerPoolConfig;
   /** JXL-specific configuration overrides */
   jxl?: WorkerPoolConfig;
+  /**
+   * Native transcoder pool overrides, or false to always transcode by
+   * decode + encode
+   */
+  transcoder?: WorkerPoolConfig | false;
 }
 
 // Codec worker client types (imported dynamically)
@@ -47,6 +57,7 @@ type AVIFWorkerClient = Awaited<
 type JXLWorkerClient = Awaited<
   ReturnType<typeof import('@dimkatet/jcodecs-jxl/worker-api').createWorkerPool>
 >;
+type TranscodeWorkerClient = CodecWorkerClient<TranscodeWorkerHandlers>;
 
 /**
  * Auto worker client - facade over codec-specific worker pools
@@ -72,6 +83,9 @@ interface InternalState {
     jxl?: JXLWorkerClient;
   };
   initPromises: Map<ImageFormat, Promise<void>>;
+  // Native transcoder pool: undefined = not tried yet, null = unavailable
+  transcoder?: TranscodeWorkerClient | null;
+  transcoderInit?: Promise<TranscodeWorkerClient | null>;
   // Cached module references
   modules: {
     avif?: typeof import('@dimkatet/jcodecs-avif/worker-api');
@@ -163,6 +177,49 @@ async function initPool(
   return promise;
 }
 
+async function createTranscoderPool(
+  state: InternalState,
+): Promise<TranscodeWorkerClient | null> {
+  if (state.config.transcoder === false) return null;
+
+  const config = mergeConfig(
+    { poolSize: state.config.poolSize, preferMT: state.config.preferMT },
+    state.config.transcoder,
+  );
+  const useMT = isMultiThreadSupported() && config.preferMT;
+
+  const client = new CodecWorkerClient<TranscodeWorkerHandlers>();
+  try {
+    await client.init({
+      workerUrl: transcodeWorkerUrl,
+      poolSize: config.poolSize,
+      initPayload: {
+        transcoderUrl: useMT ? mtTranscoderUrl : stTranscoderUrl,
+      },
+    });
+    return client;
+  } catch {
+    // Transcoder not built/shipped or failed to load: decode + encode instead
+    client.terminate();
+    return null;
+  }
+}
+
+async function getTranscoderPool(
+  state: InternalState,
+): Promise<TranscodeWorkerClient | null> {
+  if (state.transcoder !== undefined) return state.transcoder;
+
+  if (!state.transcoderInit) {
+    state.transcoderInit = createTranscoderPool(state).then((client) => {
+      state.transcoder = client;
+      state.transcoderInit = undefined;
+      return client;
+    });
+  }
+  return state.transcoderInit;
+}
+
 async function ensurePoolInitialized(
   state: InternalState,
   format: ImageFormat,
@@ -333,9 +390,12 @@ export async function encodeInWorker(
 }
 
 /**
- * Transcode image in worker (decode + encode).
+ * Transcode image in worker.
  *
- * Decodes input with auto-detection, then encodes to target format.
+ * AVIF <-> JXL runs as a single call on the native transcoder pool when it
+ * is available and supports every option given (see `transcode()`).
+ * Otherwise, or when the native pipeline does not support the input, decodes
+ * with auto-detection, then encodes to target format.
  */
 export async function transcodeInWorker(
   client: AutoWorkerClient,
@@ -343,14 +403,38 @@ export async function transcodeInWorker(
   targetFormat: 'avif' | 'jxl',
   options?: Omit<AutoEncodeOptions, 'format'>,
 ): Promise<Uint8Array> {
+  const state = clientStates.get(client);
+  if (!state) {
+    throw new Error('Invalid AutoWorkerClient');
+  }
+
+  const data =
+    input instanceof ArrayBuffer ? new Uint8Array(input) : input;
+
+  if (detectFormat(data) !== 'unknown' && canTranscodeNatively(targetFormat, options)) {
+    const transcoder = await getTranscoderPool(state);
+    if (transcoder) {
+      // Copy so the caller's buffer survives the transfer
+      const copy = data.slice();
+      const output = await transcoder.call(
+        'transcode',
+        { data: copy, targetFormat, options },
+        [copy.buffer],
+      );
+      if (output) return output;
+    }
+  }
+
   // Decode with auto-detection
   const imageData = await decodeInWorker(client, input);
 
-  // Encode to target format
-  return encodeInWorker(client, imageData, {
-    ...options,
-    format: targetFormat,
-  });
+  // Encode to target format, keeping the source's depth and colour as the
+  // native transcoder does
+  return encodeInWorker(
+    client,
+    imageData,
+    keepSourceEncodeOptions(imageData, targetFormat, options),
+  );
 }
 
 /**
@@ -392,7 +476,9 @@ export function terminateWorkerPool(client: AutoWorkerClient): void {
 
   state.pools.avif?.terminate();
   state.pools.jxl?.terminate();
+  state.transcoder?.terminate();
   state.pools = {};
+  state.transcoder = undefined;
   state.initPromises.clear();
   clientStates.delete(client);
 }
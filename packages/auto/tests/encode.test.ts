@@ -1,10 +1,16 @@
 import { describe, it, expect, vi, beforeEach, afterEach } from 'vitest';
 import { encode, encodeSimple, transcode } from '../src/encode';
 import { CodecNotInstalledError } from '../src/errors';
+import {
+  canTranscodeNatively,
+  isTranscoderAvailable,
+  transcodeNativeIfSupported,
+} from '../src/transcoder';
 import {
   createMockCodecAdapter,
   AVIF_MAGIC_BYTES,
   JXL_MAGIC_BYTES,
+  MOCK_JXL_METADATA,
 } from './__mocks__/codec-adapter';
 import {
   createMockImageData,
@@ -27,6 +33,13 @@ vi.mock('../src/codec-registry', () => ({
   }),
 }));
 
+// Native transcoder is unavailable unless a test says otherwise
+vi.mock('../src/transcoder', async (importOriginal) => ({
+  ...(await importOriginal<typeof import('../src/transcoder')>()),
+  isTranscoderAvailable: vi.fn().mockResolvedValue(false),
+  transcodeNativeIfSupported: vi.fn().mockResolvedValue(new Uint8Array([0xff, 0x0a])),
+}));
+
 describe('encode', () => {
   beforeEach(() => {
     vi.clearAllMocks();
@@ -229,6 +242,7 @@ describe('encodeSimple', () => {
 describe('transcode', () => {
   beforeEach(() => {
     vi.clearAllMocks();
+    vi.mocked(isTranscoderAvailable).mockResolvedValue(false);
   });
 
   it('decodes AVIF and encodes to JXL', async () => {
@@ -262,4 +276,145 @@ describe('transcode', () => {
       expect.objectContaining({ lossless: true })
     );
   });
+
+  describe('fallback defaults', () => {
+    const hdrSource = {
+      data: new Uint16Array(10 * 10 * 3),
+      dataType: 'uint16',
+      bitDepth: 10,
+      width: 10,
+      height: 10,
+      channels: 3,
+      metadata: { ...MOCK_JXL_METADATA, colorPrimaries: 'bt2020', transferFunction: 'pq', isHDR: true },
+    };
+
+    it('keeps the source depth and colour like the native path', async () => {
+      mockJxlAdapter.decode.mockResolvedValueOnce(hdrSource);
+
+      await transcode(JXL_CODESTREAM, 'avif');
+
+      expect(mockAvifAdapter.encode).toHaveBeenCalledWith(
+        expect.any(Object),
+        expect.objectContaining({ bitDepth: 10, colorSpace: 'rec2020', transferFunction: 'pq' })
+      );
+    });
+
+    it('lets explicit options override the source', async () => {
+      mockJxlAdapter.decode.mockResolvedValueOnce(hdrSource);
+
+      await transcode(JXL_CODESTREAM, 'avif', { bitDepth: 8, colorSpace: 'srgb' });
+
+      expect(mockAvifAdapter.encode).toHaveBeenCalledWith(
+        expect.any(Object),
+        expect.objectContaining({ bitDepth: 8, colorSpace: 'srgb', transferFunction: 'pq' })
+      );
+    });
+
+    it('caps AVIF output at 12 bits', async () => {
+      mockJxlAdapter.decode.mockResolvedValueOnce({ ...hdrSource, bitDepth: 16 });
+
+      await transcode(JXL_CODESTREAM, 'avif');
+
+      expect(mockAvifAdapter.encode).toHaveBeenCalledWith(
+        expect.any(Object),
+        expect.objectContaining({ bitDepth: 12 })
+      );
+    });
+  });
+
+  describe('native transcoder', () => {
+    it('transcodes in one native call when available', async () => {
+      vi.mocked(isTranscoderAvailable).mockResolvedValue(true);
+
+      const result = await transcode(AVIF_SAMPLE, 'jxl', { quality: 90 });
+
+      expect(result).toEqual(new Uint8Array([0xff, 0x0a]));
+      expect(transcodeNativeIfSupported).toHaveBeenCalledWith(AVIF_SAMPLE, 'jxl', { quality: 90 });
+      expect(mockAvifAdapter.decode).not.toHaveBeenCalled();
+      expect(mockJxlAdapter.encode).not.toHaveBeenCalled();
+    });
+
+    it('accepts ArrayBuffer input', async () => {
+      vi.mocked(isTranscoderAvailable).mockResolvedValue(true);
+
+      await transcode(JXL_CODESTREAM.slice().buffer, 'avif');
+
+      expect(transcodeNativeIfSupported).toHaveBeenCalledWith(JXL_CODESTREAM, 'avif', undefined);
+    });
+
+    it('falls back to decode + encode when the transcoder fails to load', async () => {
+      await transcode(AVIF_SAMPLE, 'jxl');
+
+      expect(transcodeNativeIfSupported).not.toHaveBeenCalled();
+      expect(mockAvifAdapter.decode).toHaveBeenCalled();
+      expect(mockJxlAdapter.encode).toHaveBeenCalled();
+    });
+
+    it('falls back to decode + encode when the input is unsupported natively', async () => {
+      vi.mocked(isTranscoderAvailable).mockResolvedValue(true);
+      vi.mocked(transcodeNativeIfSupported).mockResolvedValueOnce(null);
+
+      await transcode(AVIF_SAMPLE, 'jxl', { colorSpace: 'rec2020' });
+
+      expect(transcodeNativeIfSupported).toHaveBeenCalledTimes(1);
+      expect(mockAvifAdapter.decode).toHaveBeenCalled();
+      expect(mockJxlAdapter.encode).toHaveBeenCalledWith(
+        expect.any(Object),
+        expect.objectContaining({ colorSpace: 'rec2020' })
+      );
+    });
+
+    it('passes real native errors through', async () => {
+      vi.mocked(isTranscoderAvailable).mockResolvedValue(true);
+      vi.mocked(transcodeNativeIfSupported).mockRejectedValueOnce(
+        new Error('Transcode error: Parse error: BMFF parsing failed')
+      );
+
+      await expect(transcode(AVIF_SAMPLE, 'jxl')).rejects.toThrow(/Parse error/);
+      expect(mockAvifAdapter.decode).not.toHaveBeenCalled();
+    });
+
+    it('falls back for options the transcoder does not support', async () => {
+      vi.mocked(isTranscoderAvailable).mockResolvedValue(true);
+
+      await transcode(JXL_CODESTREAM, 'avif', { avif: { tune: 'ssim' } });
+
+      expect(transcodeNativeIfSupported).not.toHaveBeenCalled();
+      expect(mockJxlAdapter.decode).toHaveBeenCalled();
+      expect(mockAvifAdapter.encode).toHaveBeenCalledWith(
+        expect.any(Object),
+        expect.objectContaining({ tune: 'ssim' })
+      );
+    });
+  });
+});
+
+describe('canTranscodeNatively', () => {
+  it('accepts common options', () => {
+    expect(canTranscodeNatively('jxl')).toBe(true);
+    expect(
+      canTranscodeNatively('avif', {
+        quality: 80,
+        bitDepth: 10,
+        colorSpace: 'rec2020',
+        transferFunction: 'pq',
+      })
+    ).toBe(true);
+  });
+
+  it('accepts the target codec\'s supported options', () => {
+    expect(
+      canTranscodeNatively('avif', { avif: { speed: 8, chromaSubsampling: '4:4:4', qualityAlpha: 90 } })
+    ).toBe(true);
+    expect(canTranscodeNatively('jxl', { jxl: { effort: 3 } })).toBe(true);
+  });
+
+  it('rejects unsupported target codec options', () => {
+    expect(canTranscodeNatively('avif', { avif: { tune: 'ssim' } })).toBe(false);
+    expect(canTranscodeNatively('jxl', { jxl: { progressive: true } })).toBe(false);
+  });
+
+  it('ignores options for the other codec and undefined values', () => {
+    expect(canTranscodeNatively('jxl', { avif: { tune: 'ssim' }, quality: undefined })).toBe(true);
+  });
 });
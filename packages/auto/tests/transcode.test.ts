@@ -0,0 +1,127 @@
+/**
+ * Browser tests for transcode(): the native transcoder and the decode +
+ * encode fallback must produce the same depth and colour, and inputs the
+ * native pipeline does not cover must still transcode.
+ *
+ * Needs the real codec packages and src/wasm/transcode.js (pnpm build:wasm).
+ */
+
+import { describe, it, expect, vi } from 'vitest';
+import { decode } from '../src/decode';
+import { transcode } from '../src/encode';
+import * as transcoder from '../src/transcoder';
+
+vi.mock('../src/transcoder', async (importOriginal) => {
+  const actual = await importOriginal<typeof import('../src/transcoder')>();
+  return {
+    ...actual,
+    isTranscoderAvailable: vi.fn(actual.isTranscoderAvailable),
+    transcodeNativeIfSupported: vi.fn(actual.transcodeNativeIfSupported),
+  };
+});
+
+/**
+ * Copy of an AVIF file with the transfer characteristics in its nclx
+ * `colr` box replaced
+ */
+function withTransfer(avif: Uint8Array, transfer: number): Uint8Array {
+  const copy = avif.slice();
+  const tag = new TextEncoder().encode('colrnclx');
+  const at = copy.findIndex((_, i) => tag.every((byte, j) => copy[i + j] === byte));
+  if (at < 0) {
+    throw new Error('No nclx colr box');
+  }
+  // 'colr' 'nclx' primaries(u16) transfer(u16) matrix(u16) fullRange(u8)
+  new DataView(copy.buffer).setUint16(at + 10, transfer);
+  return copy;
+}
+
+async function loadFixture(filename: string): Promise<Uint8Array> {
+  const response = await fetch(`/${filename}`);
+  if (!response.ok) {
+    throw new Error(`Failed to load fixture: ${filename}`);
+  }
+  const buffer = await response.arrayBuffer();
+  return new Uint8Array(buffer);
+}
+
+const nativeAvailable = await transcoder.isTranscoderAvailable({
+  jsUrl: new URL('../src/wasm/transcode.js', import.meta.url).href,
+});
+
+describe.skipIf(!nativeAvailable)('transcode: native vs fallback', () => {
+  async function bothPaths(
+    input: Uint8Array,
+    targetFormat: 'avif' | 'jxl',
+    options?: Parameters<typeof transcode>[2],
+  ) {
+    vi.mocked(transcoder.transcodeNativeIfSupported).mockClear();
+    const native = await transcode(input, targetFormat, options);
+    expect(transcoder.transcodeNativeIfSupported).toHaveBeenCalledTimes(1);
+
+    vi.mocked(transcoder.isTranscoderAvailable).mockResolvedValueOnce(false);
+    const fallback = await transcode(input, targetFormat, options);
+    expect(transcoder.transcodeNativeIfSupported).toHaveBeenCalledTimes(1);
+
+    return Promise.all([decode(native), decode(fallback)]);
+  }
+
+  it.each([
+    ['colors_sdr_srgb.avif', 'jxl'],
+    ['colors_hdr_rec2020.avif', 'jxl'],
+    ['pq_gradient.jxl', 'avif'],
+    ['splines.jxl', 'avif'],
+  ] as const)('%s -> %s keeps the same depth and colour', async (fixture, targetFormat) => {
+    const [native, fallback] = await bothPaths(await loadFixture(fixture), targetFormat);
+
+    expect(native.width).toBe(fallback.width);
+    expect(native.height).toBe(fallback.height);
+    expect(native.bitDepth).toBe(fallback.bitDepth);
+    expect(native.metadata.colorPrimaries).toBe(fallback.metadata.colorPrimaries);
+    expect(native.metadata.transferFunction).toBe(fallback.metadata.transferFunction);
+  });
+
+  it('applies explicit depth and colour the same way', async () => {
+    const [native, fallback] = await bothPaths(await loadFixture('colors_sdr_srgb.avif'), 'jxl', {
+      bitDepth: 10,
+      colorSpace: 'rec2020',
+    });
+
+    expect(native.bitDepth).toBe(10);
+    expect(fallback.bitDepth).toBe(10);
+    expect(native.metadata.colorPrimaries).toBe(fallback.metadata.colorPrimaries);
+    expect(native.metadata.transferFunction).toBe(fallback.metadata.transferFunction);
+  });
+
+  describe('inputs the native pipeline does not cover', () => {
+    // Logarithmic (100:1), which JPEG XL cannot signal and the native
+    // colour conversion does not implement
+    const LOG100 = 9;
+
+    it.each([
+      ['jxl', undefined],
+      ['avif', { colorSpace: 'display-p3' }],
+    ] as const)('falls back to decode + encode for -> %s', async (targetFormat, options) => {
+      const input = withTransfer(await loadFixture('colors_sdr_srgb.avif'), LOG100);
+      vi.mocked(transcoder.transcodeNativeIfSupported).mockClear();
+
+      const output = await transcode(input, targetFormat, options);
+
+      expect(transcoder.transcodeNativeIfSupported).toHaveBeenCalledTimes(1);
+      await expect(
+        vi.mocked(transcoder.transcodeNativeIfSupported).mock.results[0].value,
+      ).resolves.toBeNull();
+
+      const source = await decode(input);
+      const decoded = await decode(output);
+      expect(decoded.width).toBe(source.width);
+      expect(decoded.height).toBe(source.height);
+    });
+
+    it('still throws for a broken input', async () => {
+      const input = (await loadFixture('colors_sdr_srgb.avif')).slice(0, 200);
+
+      await expect(transcode(input, 'jxl')).rejects.toThrow();
+    });
+  });
+});
@@ -10,6 +10,9 @@ export default defineConfig({
     types: 'src/types.ts',
     options: 'src/options.ts',
     errors: 'src/errors.ts',
+    transcoder: 'src/transcoder.ts',
+    urls: 'src/urls.ts',
+    'transcode-worker': 'src/transcode-worker.ts',
   },
   format: ['esm', 'cjs'],
   dts: true,
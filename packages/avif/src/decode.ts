@@ -3,6 +3,17 @@ import {
   validateThreadCount,
   copyToWasm,
   copyFromWasmByType,
+  validateCrop,
+  readChunks,
+  readPrefixUntil,
+  compareImagesInWasm,
+  compareWithWasm,
+} from "@dimkatet/jcodecs-core";
+import type {
+  ExtendedImageData,
+  ImageMetrics,
+  MetricsOptions,
+  RangeReader,
 } from "@dimkatet/jcodecs-core";
 import type { AVIFDecodeOptions } from "./options";
 import { DEFAULT_DECODE_OPTIONS } from "./options";
@@ -10,8 +21,21 @@ import type {
   AVIFImageData,
   AVIFImageInfo,
   AVIFDataType,
+  AVIFYUVImage,
+  AVIFYUVPlane,
 } from "./types";
-import type { MainModule } from "./wasm/avif_dec";
+import type { ChromaSubsampling } from "./options";
+import type {
+  MainModule,
+  ConversionOptions,
+  DecodeResult,
+  AvifDecoderSession,
+  ImageInfo,
+  YuvPlane,
+  AvifSequenceDecoder,
+  AvifStreamingDecoder,
+  StreamStatus,
+} from "./wasm/avif_dec";
 import {
   isProfilingEnabled,
   logDecodeProfile,
@@ -90,6 +114,7 @@ export async function decode(
     console.warn(validation.warning);
   }
   opts.maxThreads = validation.validatedCount;
+  const crop = validateCrop(opts.crop);
 
   // Copy input data to WASM heap
   const t1 = isProfilingEnabled() ? performance.now() : 0;
@@ -98,7 +123,14 @@ export async function decode(
 
   let result;
   try {
-    result = module.decode(inputPtr, data.length, opts.bitDepth, opts.maxThreads);
+    result = module.decode(
+      inputPtr,
+      data.length,
+      opts.bitDepth,
+      opts.maxThreads,
+      crop,
+      conversionOptions(opts),
+    );
   } finally {
     module._free(inputPtr);
   }
@@ -109,18 +141,12 @@ export async function decode(
   }
 
   const outputDepth = result.depth;
-  let outputDataType: AVIFDataType = 'uint8';
-  let bytesPerElement = 1;
-  if (outputDepth > 8) {
-    // Auto: use uint16 for >8 bit
-    outputDataType = "uint16";
-    bytesPerElement = 2;
-  }
-
-  const elementCount = result.dataSize / bytesPerElement;
-  const pixelData = copyFromWasmByType(module, result.dataPtr, elementCount, outputDataType);
-
-  module._free(result.dataPtr);
+  const { pixelData, outputDataType } = readPixels(
+    module,
+    result.dataPtr,
+    result.dataSize,
+    outputDepth,
+  );
   const t4 = isProfilingEnabled() ? performance.now() : 0;
 
   const metadata = convertMetadata(result.metadata, module);
@@ -136,6 +162,8 @@ export async function decode(
       wasmDecode: t3 - t2,
       copyFromWasm: t4 - t3,
       convertMetadata: t5 - t4,
+      yuvToRgb: result.timings.yuvToRgb,
+      libyuvEligible: result.timings.libyuvEligible,
       total: t5 - t0,
     });
   }
@@ -151,6 +179,34 @@ export async function decode(
   };
 }
 
+function conversionOptions(
+  opts: Pick<AVIFDecodeOptions, "chromaUpsampling" | "avoidLibYUV">,
+): ConversionOptions {
+  return {
+    chromaUpsampling: opts.chromaUpsampling ?? DEFAULT_DECODE_OPTIONS.chromaUpsampling,
+    avoidLibYUV: opts.avoidLibYUV ?? DEFAULT_DECODE_OPTIONS.avoidLibYUV,
+  };
+}
+
+/**
+ * Copy decoded pixels out of the WASM heap and free the native buffer
+ */
+function readPixels(
+  module: MainModule,
+  dataPtr: number,
+  dataSize: number,
+  depth: number,
+) {
+  // Auto: use uint16 for >8 bit
+  const outputDataType: AVIFDataType = depth > 8 ? "uint16" : "uint8";
+  const bytesPerElement = depth > 8 ? 2 : 1;
+
+  const pixelData = copyFromWasmByType(module, dataPtr, dataSize / bytesPerElement, outputDataType);
+  module._free(dataPtr);
+
+  return { pixelData, outputDataType };
+}
+
 /**
  * Decode AVIF to standard ImageData (8-bit RGBA)
  */
@@ -179,6 +235,91 @@ export async function decodeToImageData(
   return new ImageData(rgbaData, result.width, result.height);
 }
 
+/**
+ * Decode AVIF to its Y, U, V and alpha planes, skipping YUV to RGB
+ * conversion. Intended for GPU upload paths that convert in a shader.
+ */
+export async function decodeYUV(
+  input: Uint8Array | ArrayBuffer,
+  options: Pick<AVIFDecodeOptions, "maxThreads"> = {},
+  config?: InitConfig,
+): Promise<AVIFYUVImage> {
+  await init(config);
+
+  const data = input instanceof ArrayBuffer ? new Uint8Array(input) : input;
+  const module = decoderModule!;
+
+  const validation = validateThreadCount(
+    options.maxThreads ?? DEFAULT_DECODE_OPTIONS.maxThreads,
+    maxThreads,
+    isMultiThreadedModule,
+    "jcodecs-avif",
+  );
+  if (validation.warning) {
+    console.warn(validation.warning);
+  }
+
+  const inputPtr = copyToWasm(module, data);
+  let result;
+  try {
+    result = module.decodeYUV(inputPtr, data.length, validation.validatedCount);
+  } finally {
+    module._free(inputPtr);
+  }
+
+  if (result.error) {
+    throw new Error(`AVIF decode error: ${result.error}`);
+  }
+
+  // One copy for all planes; each plane is a view into it
+  const { pixelData, outputDataType } = readPixels(
+    module,
+    result.dataPtr,
+    result.dataSize,
+    result.depth,
+  );
+  const bytesPerSample = result.depth > 8 ? 2 : 1;
+  const toPlane = (plane: YuvPlane): AVIFYUVPlane | undefined => {
+    if (plane.width === 0) return undefined;
+    const start = plane.offset / bytesPerSample;
+    const stride = plane.stride / bytesPerSample;
+    return {
+      data: pixelData.subarray(start, start + stride * plane.height),
+      width: plane.width,
+      height: plane.height,
+      stride,
+    };
+  };
+
+  return {
+    width: result.width,
+    height: result.height,
+    bitDepth: result.depth,
+    dataType: outputDataType,
+    format: result.format as ChromaSubsampling,
+    chromaShiftX: result.chromaShiftX,
+    chromaShiftY: result.chromaShiftY,
+    chromaSamplePosition:
+      result.chromaSamplePosition as AVIFYUVImage["chromaSamplePosition"],
+    y: toPlane(result.y)!,
+    u: toPlane(result.u),
+    v: toPlane(result.v),
+    alpha: toPlane(result.alpha),
+    alphaPremultiplied: result.alphaPremultiplied,
+    metadata: convertMetadata(result.metadata, module),
+  };
+}
+
+function toImageInfo(result: ImageInfo, module: MainModule): AVIFImageInfo {
+  return {
+    width: result.width,
+    height: result.height,
+    bitDepth: result.depth,
+    channels: result.channels,
+    metadata: convertMetadata(result.metadata, module),
+  };
+}
+
 /**
  * Get image info without full decoding
  */
@@ -200,7 +341,103 @@ export async function getImageInfo(
     module._free(inputPtr);
   }
 
+  if (result.error) {
+    throw new Error(`AVIF decode error: ${result.error}`);
+  }
+  return toImageInfo(result, module);
+}
+
+export interface AVIFInfoProbe {
+  /** Header info, or null if the prefix is too short */
+  info: AVIFImageInfo | null;
+  /** Prefix length to try next when `info` is null */
+  bytesNeeded: number;
+}
+
+function probeWithModule(
+  module: MainModule,
+  prefix: Uint8Array,
+  isComplete: boolean,
+): AVIFInfoProbe {
+  const inputPtr = copyToWasm(module, prefix);
+  let result;
+  try {
+    result = module.probeImageInfo(inputPtr, prefix.length, isComplete);
+  } finally {
+    module._free(inputPtr);
+  }
+
+  if (result.error) {
+    throw new Error(`AVIF decode error: ${result.error}`);
+  }
+  return {
+    info: result.complete ? toImageInfo(result.info, module) : null,
+    bytesNeeded: result.bytesNeeded,
+  };
+}
+
+/**
+ * Read header info from the first bytes of a file. If `prefix` is too
+ * short, `info` is null and `bytesNeeded` tells how long a prefix to try
+ * next. Pass `isComplete` when `prefix` is the whole file.
+ */
+export async function probeImageInfo(
+  prefix: Uint8Array | ArrayBuffer,
+  { isComplete = false }: { isComplete?: boolean } = {},
+): Promise<AVIFInfoProbe> {
+  await init();
+  const data = prefix instanceof ArrayBuffer ? new Uint8Array(prefix) : prefix;
+  return probeWithModule(decoderModule!, data, isComplete);
+}
+
+/**
+ * Read header info fetching only the bytes it needs through `read`
+ * (e.g. HTTP Range requests or blob slices), starting with `initialBytes`.
+ */
+export async function getImageInfoFromRanges(
+  read: RangeReader,
+  { initialBytes = 4096 }: { initialBytes?: number } = {},
+): Promise<AVIFImageInfo> {
+  await init();
+  const module = decoderModule!;
+
+  return readPrefixUntil(
+    read,
+    (prefix, isComplete) => {
+      const { info, bytesNeeded } = probeWithModule(module, prefix, isComplete);
+      return { result: info, bytesNeeded };
+    },
+    initialBytes,
+  );
+}
+
+// ============================================================================
+// Decoder session
+// ============================================================================
+
+export interface AVIFDecoderSessionOptions
+  extends Pick<AVIFDecodeOptions, "maxThreads"> {
+  /**
+   * Inputs smaller than this many bytes decode on one thread, skipping
+   * dav1d thread startup, which outweighs decoding for thumbnails.
+   * @default 65536
+   */
+  singleThreadBelow?: number;
+}
+
+export type AVIFSessionDecodeOptions = Omit<AVIFDecodeOptions, "maxThreads" | "ignoreColorProfile">;
+
+function toImageData(result: DecodeResult, module: MainModule): AVIFImageData {
+  const { pixelData, outputDataType } = readPixels(
+    module,
+    result.dataPtr,
+    result.dataSize,
+    result.depth,
+  );
+
   return {
+    data: pixelData,
+    dataType: outputDataType,
     width: result.width,
     height: result.height,
     bitDepth: result.depth,
@@ -209,6 +446,541 @@ export async function getImageInfo(
   };
 }
 
+/**
+ * Long-lived decoder that keeps one configured native decoder between
+ * images. Use for batch decoding of many (small) files; call `dispose()`
+ * when done to release native resources.
+ */
+export class AVIFDecoderSession {
+  private session: AvifDecoderSession | null;
+
+  /** @internal Use {@link createDecoderSession} */
+  constructor(
+    private readonly module: MainModule,
+    singleThreadBelow: number,
+  ) {
+    this.session = new module.AvifDecoderSession(1, singleThreadBelow);
+  }
+
+  /** Change the number of decode threads used for larger inputs */
+  setMaxThreads(count: number): void {
+    const validation = validateThreadCount(
+      count,
+      maxThreads,
+      isMultiThreadedModule,
+      "jcodecs-avif",
+    );
+    if (validation.warning) {
+      console.warn(validation.warning);
+    }
+    this.native().setThreadCount(validation.validatedCount);
+  }
+
+  decode(
+    input: Uint8Array | ArrayBuffer,
+    options: AVIFSessionDecodeOptions = {},
+  ): AVIFImageData {
+    const session = this.native();
+    const data = input instanceof ArrayBuffer ? new Uint8Array(input) : input;
+    const crop = validateCrop(options.crop);
+    const inputPtr = copyToWasm(this.module, data);
+
+    let result;
+    try {
+      result = session.decode(
+        inputPtr,
+        data.length,
+        options.bitDepth ?? DEFAULT_DECODE_OPTIONS.bitDepth,
+        crop,
+        conversionOptions(options),
+      );
+    } finally {
+      this.module._free(inputPtr);
+    }
+
+    if (result.error) {
+      throw new Error(`AVIF decode error: ${result.error}`);
+    }
+    return toImageData(result, this.module);
+  }
+
+  getImageInfo(input: Uint8Array | ArrayBuffer): AVIFImageInfo {
+    const session = this.native();
+    const data = input instanceof ArrayBuffer ? new Uint8Array(input) : input;
+    const inputPtr = copyToWasm(this.module, data);
+
+    let result;
+    try {
+      result = session.getImageInfo(inputPtr, data.length);
+    } finally {
+      this.module._free(inputPtr);
+    }
+
+    if (result.error) {
+      throw new Error(`AVIF decode error: ${result.error}`);
+    }
+    return toImageInfo(result, this.module);
+  }
+
+  /** Release the native decoder */
+  dispose(): void {
+    this.session?.delete();
+    this.session = null;
+  }
+
+  private native(): AvifDecoderSession {
+    if (!this.session) {
+      throw new Error("AVIFDecoderSession has been disposed");
+    }
+    return this.session;
+  }
+}
+
+/**
+ * Create a persistent decoder session (see {@link AVIFDecoderSession}).
+ */
+export async function createDecoderSession(
+  options: AVIFDecoderSessionOptions = {},
+  config?: InitConfig,
+): Promise<AVIFDecoderSession> {
+  await init(config);
+
+  const session = new AVIFDecoderSession(
+    decoderModule!,
+    options.singleThreadBelow ?? 65536,
+  );
+  session.setMaxThreads(options.maxThreads ?? DEFAULT_DECODE_OPTIONS.maxThreads);
+  return session;
+}
+
+// ============================================================================
+// Image sequences (animated AVIF)
+// ============================================================================
+
+export type AVIFFrame = AVIFImageData & {
+  index: number;
+  /** Presentation timestamp */
+  ptsMs: number;
+  durationMs: number;
+  isKeyframe: boolean;
+};
+
+export interface AVIFSequenceInfo extends AVIFImageInfo {
+  frameCount: number;
+  /** Media timescale in ticks per second */
+  timescale: number;
+  durationMs: number;
+  /** -1 = loop forever, -2 = unknown */
+  repetitionCount: number;
+  /** Frame indices that decode without earlier frames, ascending */
+  keyframes: number[];
+}
+
+/**
+ * Iterates over the frames of an AVIF image sequence (`avis`), keeping one
+ * native decoder open. `seek()` restarts from the nearest keyframe at most,
+ * so random access never re-decodes from frame 0. Still images are a
+ * one-frame sequence. Call `dispose()` when done.
+ */
+export class AVIFSequenceDecoder implements Iterable<AVIFFrame> {
+  readonly info: AVIFSequenceInfo;
+  private decoder: AvifSequenceDecoder | null;
+
+  /** @internal Use {@link decodeSequence} */
+  constructor(
+    private readonly module: MainModule,
+    decoder: AvifSequenceDecoder,
+  ) {
+    this.decoder = decoder;
+
+    const info = decoder.getInfo();
+    if (info.error) {
+      decoder.delete();
+      throw new Error(`AVIF decode error: ${info.error}`);
+    }
+
+    this.info = {
+      width: info.width,
+      height: info.height,
+      bitDepth: info.depth,
+      channels: info.channels,
+      metadata: convertMetadata(info.metadata, module),
+      frameCount: info.frameCount,
+      timescale: info.timescale,
+      durationMs: info.durationMs,
+      repetitionCount: info.repetitionCount,
+      keyframes: decoder.getKeyframes() as number[],
+    };
+  }
+
+  /** Index of the frame the next call to `next()` returns */
+  get position(): number {
+    return this.native().getFrameIndex();
+  }
+
+  /** Decode the next frame, or return null after the last one */
+  next(): AVIFFrame | null {
+    const frame = this.native().next();
+    if (frame.error) {
+      throw new Error(`AVIF decode error: ${frame.error}`);
+    }
+    if (frame.done) {
+      return null;
+    }
+
+    const { pixelData, outputDataType } = readPixels(
+      this.module,
+      frame.dataPtr,
+      frame.dataSize,
+      frame.depth,
+    );
+
+    return {
+      data: pixelData,
+      dataType: outputDataType,
+      width: frame.width,
+      height: frame.height,
+      bitDepth: frame.depth,
+      channels: frame.channels,
+      metadata: this.info.metadata,
+      index: frame.index,
+      ptsMs: frame.ptsMs,
+      durationMs: frame.durationMs,
+      isKeyframe: frame.isKeyframe,
+    };
+  }
+
+  /** Make the next call to `next()` return frame `index` */
+  seek(index: number): void {
+    if (!this.native().seek(index)) {
+      throw new RangeError(`Frame ${index} out of range (0..${this.info.frameCount - 1})`);
+    }
+  }
+
+  /** Keyframe that decoding frame `index` has to start from */
+  nearestKeyframe(index: number): number {
+    return this.native().nearestKeyframe(index);
+  }
+
+  *[Symbol.iterator](): Iterator<AVIFFrame> {
+    for (let frame = this.next(); frame; frame = this.next()) {
+      yield frame;
+    }
+  }
+
+  /** Release the native decoder */
+  dispose(): void {
+    this.decoder?.delete();
+    this.decoder = null;
+  }
+
+  private native(): AvifSequenceDecoder {
+    if (!this.decoder) {
+      throw new Error("AVIFSequenceDecoder has been disposed");
+    }
+    return this.decoder;
+  }
+}
+
+/**
+ * Open an (animated) AVIF for frame-by-frame decoding.
+ */
+export async function decodeSequence(
+  input: Uint8Array | ArrayBuffer,
+  options: Omit<AVIFDecodeOptions, "crop"> = {},
+  config?: InitConfig,
+): Promise<AVIFSequenceDecoder> {
+  await init(config);
+
+  const data = input instanceof ArrayBuffer ? new Uint8Array(input) : input;
+  const opts = { ...DEFAULT_DECODE_OPTIONS, ...options };
+  const module = decoderModule!;
+
+  const validation = validateThreadCount(
+    opts.maxThreads,
+    maxThreads,
+    isMultiThreadedModule,
+    "jcodecs-avif",
+  );
+  if (validation.warning) {
+    console.warn(validation.warning);
+  }
+
+  // The native decoder keeps its own copy of the input
+  const inputPtr = copyToWasm(module, data);
+  let decoder;
+  try {
+    decoder = new module.AvifSequenceDecoder(
+      inputPtr,
+      data.length,
+      opts.bitDepth,
+      validation.validatedCount,
+      conversionOptions(opts),
+    );
+  } finally {
+    module._free(inputPtr);
+  }
+
+  return new AVIFSequenceDecoder(module, decoder);
+}
+
+// ============================================================================
+// Streaming (incremental) decode
+// ============================================================================
+
+/**
+ * Intermediate render produced while streaming an AVIF. Always full size;
+ * rows from `rowsDecoded` down are not decoded yet.
+ */
+export type AVIFPartialImage = Omit<AVIFImageData, "metadata"> & {
+  rowsDecoded: number;
+};
+
+export type AVIFStreamState = "needMoreInput" | "progress" | "complete";
+
+export interface AVIFStreamUpdate {
+  state: AVIFStreamState;
+  /** Current render, present once any rows are decoded */
+  image?: AVIFPartialImage;
+}
+
+export interface AVIFStreamOptions
+  extends Omit<AVIFDecodeOptions, "crop" | "ignoreColorProfile"> {
+  /** Total file size if known (e.g. from Content-Length) */
+  totalSize?: number;
+}
+
+function readStreamStatus(status: StreamStatus, module: MainModule): AVIFStreamUpdate {
+  if (status.state === "error") {
+    throw new Error(`AVIF decode error: ${status.error}`);
+  }
+
+  const update: AVIFStreamUpdate = { state: status.state as AVIFStreamState };
+  if (status.dataPtr !== 0) {
+    // The buffer stays owned by the decoder, copy without freeing
+    const dataType: AVIFDataType = status.depth > 8 ? "uint16" : "uint8";
+    const bytesPerElement = status.depth > 8 ? 2 : 1;
+    update.image = {
+      data: copyFromWasmByType(module, status.dataPtr, status.dataSize / bytesPerElement, dataType),
+      dataType,
+      width: status.width,
+      height: status.height,
+      bitDepth: status.depth,
+      channels: status.channels,
+      rowsDecoded: status.rowsDecoded,
+    };
+  }
+  return update;
+}
+
+/**
+ * Incremental decoder: feed bytes as they arrive. Grid images (e.g. camera
+ * photos stored as 512x512 tiles) report rows of cells as soon as their
+ * data is in; other images complete once the whole item has arrived.
+ * Call `dispose()` when done.
+ */
+export class AVIFStreamingDecoder {
+  private decoder: AvifStreamingDecoder | null;
+
+  /** @internal Use {@link createStreamingDecoder} */
+  constructor(
+    private readonly module: MainModule,
+    bitDepth: number,
+    maxThreads: number,
+    totalSize: number,
+    conversion: ConversionOptions,
+  ) {
+    this.decoder = new module.AvifStreamingDecoder(bitDepth, maxThreads, totalSize, conversion);
+  }
+
+  /** Append a chunk of the file and decode as far as possible */
+  push(chunk: Uint8Array): AVIFStreamUpdate {
+    const decoder = this.native();
+    const chunkPtr = copyToWasm(this.module, chunk);
+    try {
+      return readStreamStatus(decoder.push(chunkPtr, chunk.length), this.module);
+    } finally {
+      this.module._free(chunkPtr);
+    }
+  }
+
+  /** Signal end of input. Throws if the data ends before the image does. */
+  close(): AVIFStreamUpdate {
+    return readStreamStatus(this.native().close(), this.module);
+  }
+
+  /** Take the final image. Only valid after a "complete" update. */
+  result(): AVIFImageData {
+    const result = this.native().takeResult();
+    if (result.error) {
+      throw new Error(`AVIF decode error: ${result.error}`);
+    }
+    return toImageData(result, this.module);
+  }
+
+  /** Release the native decoder */
+  dispose(): void {
+    this.decoder?.delete();
+    this.decoder = null;
+  }
+
+  private native(): AvifStreamingDecoder {
+    if (!this.decoder) {
+      throw new Error("AVIFStreamingDecoder has been disposed");
+    }
+    return this.decoder;
+  }
+}
+
+/**
+ * Create an incremental decoder (see {@link AVIFStreamingDecoder}).
+ */
+export async function createStreamingDecoder(
+  options: AVIFStreamOptions = {},
+  config?: InitConfig,
+): Promise<AVIFStreamingDecoder> {
+  await init(config);
+
+  const opts = { ...DEFAULT_DECODE_OPTIONS, ...options };
+  const validation = validateThreadCount(
+    opts.maxThreads,
+    maxThreads,
+    isMultiThreadedModule,
+    "jcodecs-avif",
+  );
+  if (validation.warning) {
+    console.warn(validation.warning);
+  }
+
+  return new AVIFStreamingDecoder(
+    decoderModule!,
+    opts.bitDepth,
+    validation.validatedCount,
+    options.totalSize ?? 0,
+    conversionOptions(opts),
+  );
+}
+
+/**
+ * Decode an AVIF from a stream of chunks (e.g. `fetch().body`), reporting
+ * partially decoded grid images through `onProgress`.
+ */
+export async function decodeStream(
+  stream: AsyncIterable<Uint8Array> | ReadableStream<Uint8Array>,
+  options: AVIFStreamOptions & {
+    onProgress?: (image: AVIFPartialImage) => void;
+  } = {},
+  config?: InitConfig,
+): Promise<AVIFImageData> {
+  const decoder = await createStreamingDecoder(options, config);
+  try {
+    let update: AVIFStreamUpdate = { state: "needMoreInput" };
+    for await (const chunk of readChunks(stream)) {
+      update = decoder.push(chunk);
+      if (update.state === "progress" && update.image) {
+        options.onProgress?.(update.image);
+      }
+      if (update.state === "complete") break;
+    }
+    if (update.state !== "complete") {
+      update = decoder.close();
+    }
+    return decoder.result();
+  } finally {
+    decoder.dispose();
+  }
+}
+
+/**
+ * Measure how close `distorted` is to `reference` (PSNR, SSIM,
+ * SSIMULACRA2). Runs natively in the decoder module; both images must have
+ * the same size and channel count, sample types may differ.
+ */
+export async function compareImages(
+  reference: ExtendedImageData,
+  distorted: ExtendedImageData,
+  options: MetricsOptions = {},
+  config?: InitConfig,
+): Promise<ImageMetrics> {
+  await init(config);
+  return compareImagesInWasm(decoderModule!, reference, distorted, options);
+}
+
+export interface AVIFCompareOptions extends MetricsOptions {
+  /** Options for decoding the AVIF under test */
+  decode?: AVIFDecodeOptions;
+}
+
+/**
+ * Decode an AVIF and compare it against the original pixels. The decoded
+ * image stays in the WASM heap and is measured there, so only the reference
+ * is copied in.
+ */
+export async function decodeAndCompare(
+  input: Uint8Array | ArrayBuffer,
+  reference: ExtendedImageData,
+  options: AVIFCompareOptions = {},
+  config?: InitConfig,
+): Promise<ImageMetrics> {
+  await init(config);
+
+  const { decode: decodeOptions, ...metricsOptions } = options;
+  const data = input instanceof ArrayBuffer ? new Uint8Array(input) : input;
+  const opts = { ...DEFAULT_DECODE_OPTIONS, ...decodeOptions };
+  const module = decoderModule!;
+
+  const validation = validateThreadCount(
+    opts.maxThreads,
+    maxThreads,
+    isMultiThreadedModule,
+    "jcodecs-avif",
+  );
+  if (validation.warning) {
+    console.warn(validation.warning);
+  }
+
+  const inputPtr = copyToWasm(module, data);
+  let result;
+  try {
+    result = module.decode(
+      inputPtr,
+      data.length,
+      opts.bitDepth,
+      validation.validatedCount,
+      validateCrop(opts.crop),
+      conversionOptions(opts),
+    );
+  } finally {
+    module._free(inputPtr);
+  }
+
+  if (result.error) {
+    throw new Error(`AVIF decode error: ${result.error}`);
+  }
+  if (result.metadata.iccProfilePtr !== 0) {
+    module._free(result.metadata.iccProfilePtr);
+  }
+
+  try {
+    return compareWithWasm(
+      module,
+      reference,
+      {
+        dataPtr: result.dataPtr,
+        dataSize: result.dataSize,
+        width: result.width,
+        height: result.height,
+        channels: result.channels,
+        dataType: result.depth > 8 ? "uint16" : "uint8",
+        bitDepth: result.depth,
+      },
+      metricsOptions,
+    );
+  } finally {
+    module._free(result.dataPtr);
+  }
+}
+
 export function isInitialized(): boolean {
   return decoderModule !== null;
 }
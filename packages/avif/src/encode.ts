@@ -5,12 +5,35 @@ import {
   validateThreadCount,
 } from "@dimkatet/jcodecs-core";
 import { defaultMetadata } from "./metadata";
-import type { AVIFEncodeOptions, ChromaSubsampling } from "./options";
-import { DEFAULT_ENCODE_OPTIONS } from "./options";
+import type {
+  AVIFEncodeOptions,
+  AVIFSequenceEncodeOptions,
+  AVIFTargetSizeOptions,
+  ChromaSubsampling,
+} from "./options";
+import {
+  DEFAULT_ENCODE_OPTIONS,
+  DEFAULT_SEQUENCE_OPTIONS,
+  DEFAULT_TARGET_SIZE_OPTIONS,
+} from "./options";
 import { isProfilingEnabled, logEncodeProfile } from "./profiling";
-import type { AVIFEncodeInput } from "./types";
+import type {
+  AVIFEncodeInput,
+  AVIFTargetSizeResult,
+  AVIFYUVEncodeInput,
+  AVIFYUVPlaneInput,
+} from "./types";
 import { validateDataType, validateDataTypeMatch } from "./validation";
-import type { EncodeOptions, MainModule } from "./wasm/avif_enc";
+import type {
+  AvifEncoderSession,
+  AvifSequenceEncoder,
+  EncodeOptions,
+  EncodeResult,
+  MainModule,
+  TargetSizeResult,
+  SequenceOptions,
+  YuvPlaneInput,
+} from "./wasm/avif_enc";
 import { mtEncoderUrl, stEncoderUrl } from "./urls";
 
 type WasmModule = typeof import("./wasm/avif_enc_mt");
@@ -77,6 +100,53 @@ function chromaToNumber(chroma: ChromaSubsampling): number {
   }
 }
 
+/**
+ * Validate maxThreads and convert options to the WASM struct
+ */
+function buildWasmOptions(
+  opts: Required<Omit<AVIFEncodeOptions, "metadata" | "onProgress">>,
+): EncodeOptions {
+  const validation = validateThreadCount(
+    opts.maxThreads,
+    maxThreads,
+    isMultiThreadedModule,
+    "jcodecs-avif",
+  );
+  if (validation.warning) {
+    console.warn(validation.warning);
+  }
+
+  return {
+    quality: opts.quality,
+    qualityAlpha: opts.qualityAlpha,
+    speed: opts.speed,
+    tune: opts.tune,
+    lossless: opts.lossless,
+    chromaSubsampling: chromaToNumber(opts.chromaSubsampling),
+    bitDepth: opts.bitDepth,
+    colorSpace: opts.colorSpace,
+    transferFunction: opts.transferFunction,
+    maxThreads: validation.validatedCount,
+    chromaDownsampling: opts.chromaDownsampling,
+    avoidLibYUV: opts.avoidLibYUV,
+  };
+}
+
+/**
+ * Copy the encoded file out of the WASM heap and free the native buffer
+ */
+function readOutput(
+  module: MainModule,
+  result: EncodeResult | TargetSizeResult,
+): Uint8Array {
+  const output = new Uint8Array(result.dataSize);
+  output.set(
+    new Uint8Array(module.HEAPU8.buffer, result.dataPtr, result.dataSize),
+  );
+  module._free(result.dataPtr);
+  return output;
+}
+
 /**
  * Encode image data to AVIF format
  */
@@ -94,18 +164,7 @@ export async function encode(
 
   const opts = { ...DEFAULT_ENCODE_OPTIONS, ...options };
   const module = encoderModule!;
-
-  // Validate maxThreads
-  const validation = validateThreadCount(
-    opts.maxThreads,
-    maxThreads,
-    isMultiThreadedModule,
-    "jcodecs-avif",
-  );
-  if (validation.warning) {
-    console.warn(validation.warning);
-  }
-  opts.maxThreads = validation.validatedCount;
+  const wasmOptions = buildWasmOptions(opts);
 
   validateDataType(imageData.dataType);
   validateDataTypeMatch(imageData);
@@ -116,20 +175,6 @@ export async function encode(
   const inputSize = imageData.data.byteLength;
   const t2 = isProfilingEnabled() ? performance.now() : 0;
 
-  // Prepare WASM options
-  const wasmOptions: EncodeOptions = {
-    quality: opts.quality,
-    qualityAlpha: opts.qualityAlpha,
-    speed: opts.speed,
-    tune: opts.tune,
-    lossless: opts.lossless,
-    chromaSubsampling: chromaToNumber(opts.chromaSubsampling),
-    bitDepth: opts.bitDepth,
-    colorSpace: opts.colorSpace,
-    transferFunction: opts.transferFunction,
-    maxThreads: opts.maxThreads,
-  };
-
   let result;
   try {
     result = module.encode(
@@ -151,11 +196,7 @@ export async function encode(
   }
 
   // Copy output data from WASM heap
-  const output = new Uint8Array(result.dataSize);
-  output.set(
-    new Uint8Array(module.HEAPU8.buffer, result.dataPtr, result.dataSize),
-  );
-  module._free(result.dataPtr);
+  const output = readOutput(module, result);
   const t4 = isProfilingEnabled() ? performance.now() : 0;
 
   if (isProfilingEnabled()) {
@@ -168,6 +209,8 @@ export async function encode(
       copyToWasm: t2 - t1,
       wasmEncode: t3 - t2,
       copyFromWasm: t4 - t3,
+      rgbToYuv: result.timings.rgbToYuv,
+      libyuvEligible: result.timings.libyuvEligible,
       total: t4 - t0,
     });
   }
@@ -180,6 +223,431 @@ export async function encode(
   return output;
 }
 
+/**
+ * Encode to the highest quality that fits in `options.maxBytes`. The
+ * quality search runs natively: RGB to YUV conversion happens once and only
+ * the AV1 encode is repeated per candidate, typically 4-7 times.
+ */
+export async function encodeToSize(
+  encodeInput: AVIFEncodeInput,
+  options: AVIFTargetSizeOptions,
+  config?: InitConfig,
+): Promise<AVIFTargetSizeResult> {
+  await init(config);
+  const imageData =
+    encodeInput instanceof ImageData
+      ? getExtendedImageData(encodeInput, defaultMetadata)
+      : encodeInput;
+
+  const { maxBytes, minQuality, maxQuality, tolerance, ...encodeOptions } = {
+    ...DEFAULT_TARGET_SIZE_OPTIONS,
+    ...options,
+  };
+  if (!(maxBytes > 0)) {
+    throw new Error("AVIF encode error: maxBytes must be greater than 0");
+  }
+
+  const opts = { ...DEFAULT_ENCODE_OPTIONS, ...encodeOptions, lossless: false };
+  const module = encoderModule!;
+  const wasmOptions = buildWasmOptions(opts);
+
+  validateDataType(imageData.dataType);
+  validateDataTypeMatch(imageData);
+
+  const inputPtr = copyToWasm(module, imageData.data);
+  let result;
+  try {
+    result = module.encodeToSize(
+      inputPtr,
+      imageData.data.byteLength,
+      imageData.width,
+      imageData.height,
+      imageData.channels,
+      imageData.bitDepth,
+      wasmOptions,
+      { maxBytes, minQuality, maxQuality, tolerance },
+    );
+  } finally {
+    module._free(inputPtr);
+  }
+
+  if (result.error) {
+    throw new Error(`AVIF encode error: ${result.error}`);
+  }
+
+  return {
+    data: readOutput(module, result),
+    quality: result.quality,
+    attempts: result.attempts,
+    targetMet: result.targetMet,
+  };
+}
+
+/**
+ * Encode Y/U/V(/A) planes to AVIF as they are, skipping RGB to YUV
+ * conversion. The planes are copied into the WASM heap once and handed to
+ * libavif without further copies. `chromaSubsampling` and `bitDepth`
+ * options are ignored in favour of the input's format and bit depth.
+ */
+export async function encodeYUV(
+  input: AVIFYUVEncodeInput,
+  options: Omit<AVIFEncodeOptions, "chromaSubsampling" | "bitDepth"> = {},
+  config?: InitConfig,
+): Promise<Uint8Array> {
+  await init(config);
+
+  const opts = { ...DEFAULT_ENCODE_OPTIONS, ...options };
+  const module = encoderModule!;
+  const wasmOptions = buildWasmOptions(opts);
+
+  const { width, height, bitDepth, format } = input;
+  if (bitDepth !== 8 && bitDepth !== 10 && bitDepth !== 12) {
+    throw new Error(`AVIF encode error: Invalid bit depth ${bitDepth}, must be 8, 10 or 12`);
+  }
+  const shiftX = format === "4:2:0" || format === "4:2:2" ? 1 : 0;
+  const shiftY = format === "4:2:0" ? 1 : 0;
+  const chromaWidth = (width + shiftX) >> shiftX;
+  const chromaHeight = (height + shiftY) >> shiftY;
+
+  const planes: [string, AVIFYUVPlaneInput | undefined, number, number][] = [
+    ["y", input.y, width, height],
+    ["alpha", input.alpha, width, height],
+  ];
+  if (format !== "4:0:0") {
+    if (!input.u || !input.v) {
+      throw new Error("AVIF encode error: U and V planes are required");
+    }
+    planes.push(["u", input.u, chromaWidth, chromaHeight]);
+    planes.push(["v", input.v, chromaWidth, chromaHeight]);
+  }
+
+  // Validate and lay out all planes in one heap allocation
+  const ArrayType = bitDepth > 8 ? Uint16Array : Uint8Array;
+  let totalSize = 0;
+  for (const [name, plane, planeWidth, planeHeight] of planes) {
+    if (!plane) continue;
+    if (!(plane.data instanceof ArrayType)) {
+      throw new Error(
+        `AVIF encode error: ${name} plane must be a ${ArrayType.name} for ${bitDepth}-bit input`,
+      );
+    }
+    if (
+      plane.stride < planeWidth ||
+      plane.data.length < plane.stride * (planeHeight - 1) + planeWidth
+    ) {
+      throw new Error(`AVIF encode error: ${name} plane is too small`);
+    }
+    totalSize += plane.data.byteLength;
+  }
+
+  const basePtr = module._malloc(totalSize);
+  if (!basePtr) {
+    throw new Error("AVIF encode error: Failed to allocate input buffer");
+  }
+  const absent: YuvPlaneInput = { ptr: 0, stride: 0 };
+  const wasmPlanes: Record<string, YuvPlaneInput> = {
+    y: absent,
+    u: absent,
+    v: absent,
+    alpha: absent,
+  };
+  let offset = 0;
+  for (const [name, plane] of planes) {
+    if (!plane) continue;
+    const bytes = new Uint8Array(
+      plane.data.buffer,
+      plane.data.byteOffset,
+      plane.data.byteLength,
+    );
+    module.HEAPU8.set(bytes, basePtr + offset);
+    wasmPlanes[name] = {
+      ptr: basePtr + offset,
+      stride: plane.stride * plane.data.BYTES_PER_ELEMENT,
+    };
+    offset += bytes.length;
+  }
+
+  let result;
+  try {
+    result = module.encodeYUV(
+      width,
+      height,
+      {
+        format: chromaToNumber(format),
+        depth: bitDepth,
+        matrixCoefficients: input.matrixCoefficients ?? "",
+        fullRange: input.fullRange ?? true,
+        y: wasmPlanes.y,
+        u: wasmPlanes.u,
+        v: wasmPlanes.v,
+        alpha: wasmPlanes.alpha,
+        alphaPremultiplied: input.alphaPremultiplied ?? false,
+      },
+      wasmOptions,
+    );
+  } finally {
+    module._free(basePtr);
+  }
+
+  if (result.error) {
+    throw new Error(`AVIF encode error: ${result.error}`);
+  }
+
+  const output = readOutput(module, result);
+  if (opts.onProgress) {
+    opts.onProgress(1, "complete");
+  }
+  return output;
+}
+
+// ============================================================================
+// Encoder session
+// ============================================================================
+
+export interface AVIFEncoderSessionOptions
+  extends Omit<AVIFEncodeOptions, "metadata" | "onProgress"> {
+  /**
+   * Images with fewer pixels than this encode on one thread, skipping
+   * encoder thread startup, which outweighs encoding for small previews.
+   * @default 65536 (256x256)
+   */
+  singleThreadBelowPixels?: number;
+}
+
+/**
+ * Encodes many independent stills with one configuration, keeping the
+ * native YUV image allocated between same-sized inputs. Call `dispose()`
+ * when done to release native resources.
+ */
+export class AVIFEncoderSession {
+  private session: AvifEncoderSession | null;
+
+  /** @internal Use {@link createEncoderSession} */
+  constructor(
+    private readonly module: MainModule,
+    wasmOptions: EncodeOptions,
+    singleThreadBelowPixels: number,
+  ) {
+    this.session = new module.AvifEncoderSession(wasmOptions, singleThreadBelowPixels);
+  }
+
+  encode(encodeInput: AVIFEncodeInput): Uint8Array {
+    const session = this.native();
+    const imageData =
+      encodeInput instanceof ImageData
+        ? getExtendedImageData(encodeInput, defaultMetadata)
+        : encodeInput;
+
+    validateDataType(imageData.dataType);
+    validateDataTypeMatch(imageData);
+
+    const inputPtr = copyToWasm(this.module, imageData.data);
+    let result;
+    try {
+      result = session.encode(
+        inputPtr,
+        imageData.data.byteLength,
+        imageData.width,
+        imageData.height,
+        imageData.channels,
+        imageData.bitDepth,
+      );
+    } finally {
+      this.module._free(inputPtr);
+    }
+
+    if (result.error) {
+      throw new Error(`AVIF encode error: ${result.error}`);
+    }
+    return readOutput(this.module, result);
+  }
+
+  /** Release the native session */
+  dispose(): void {
+    this.session?.delete();
+    this.session = null;
+  }
+
+  private native(): AvifEncoderSession {
+    if (!this.session) {
+      throw new Error("AVIFEncoderSession has been disposed");
+    }
+    return this.session;
+  }
+}
+
+/**
+ * Create an encoder session (see {@link AVIFEncoderSession}).
+ */
+export async function createEncoderSession(
+  options: AVIFEncoderSessionOptions = {},
+  config?: InitConfig,
+): Promise<AVIFEncoderSession> {
+  await init(config);
+
+  const { singleThreadBelowPixels = 65536, ...imageOptions } = options;
+  const opts = { ...DEFAULT_ENCODE_OPTIONS, ...imageOptions };
+
+  return new AVIFEncoderSession(
+    encoderModule!,
+    buildWasmOptions(opts),
+    singleThreadBelowPixels,
+  );
+}
+
+// ============================================================================
+// Image sequences (animated AVIF)
+// ============================================================================
+
+export interface AVIFFrameOptions {
+  /** Frame duration in timescale ticks (milliseconds by default) */
+  duration: number;
+  /** Start a new keyframe at this frame, e.g. at a scene cut */
+  forceKeyframe?: boolean;
+}
+
+/**
+ * Builds an animated AVIF frame by frame, keeping one native encoder alive
+ * so each frame is inter-predicted from the previous ones. Every frame must
+ * match the width, height, channels and bit depth of the first. Call
+ * `finish()` to get the file, or `dispose()` to abandon it.
+ */
+export class AVIFSequenceEncoder {
+  private encoder: AvifSequenceEncoder | null = null;
+  private shape: { width: number; height: number; channels: number; bitDepth: number } | null = null;
+
+  /** @internal Use {@link createSequenceEncoder} */
+  constructor(
+    private readonly module: MainModule,
+    private readonly wasmOptions: EncodeOptions,
+    private readonly sequenceOptions: SequenceOptions,
+  ) {}
+
+  /** Number of frames added so far */
+  get frameCount(): number {
+    return this.encoder?.getFrameCount() ?? 0;
+  }
+
+  addFrame(encodeInput: AVIFEncodeInput, options: AVIFFrameOptions): void {
+    const imageData =
+      encodeInput instanceof ImageData
+        ? getExtendedImageData(encodeInput, defaultMetadata)
+        : encodeInput;
+
+    validateDataType(imageData.dataType);
+    validateDataTypeMatch(imageData);
+
+    const encoder = this.native(imageData);
+    const inputPtr = copyToWasm(this.module, imageData.data);
+    let error;
+    try {
+      error = encoder.addFrame(
+        inputPtr,
+        imageData.data.byteLength,
+        options.duration,
+        options.forceKeyframe ?? false,
+      );
+    } finally {
+      this.module._free(inputPtr);
+    }
+
+    if (error) {
+      throw new Error(`AVIF encode error: ${error}`);
+    }
+  }
+
+  /** Encode the remaining frames and return the AVIF file */
+  finish(): Uint8Array {
+    if (!this.encoder) {
+      throw new Error("AVIF encode error: No frames added");
+    }
+
+    const result = this.encoder.finish();
+    this.dispose();
+    if (result.error) {
+      throw new Error(`AVIF encode error: ${result.error}`);
+    }
+
+    return readOutput(this.module, result);
+  }
+
+  /** Release the native encoder */
+  dispose(): void {
+    this.encoder?.delete();
+    this.encoder = null;
+    this.shape = null;
+  }
+
+  // The native encoder is created lazily from the first frame's layout
+  private native(image: {
+    width: number;
+    height: number;
+    channels: number;
+    bitDepth: number;
+  }): AvifSequenceEncoder {
+    if (this.shape) {
+      const s = this.shape;
+      if (
+        image.width !== s.width ||
+        image.height !== s.height ||
+        image.channels !== s.channels ||
+        image.bitDepth !== s.bitDepth
+      ) {
+        throw new Error(
+          `AVIF encode error: frame ${image.width}x${image.height}x${image.channels} @${image.bitDepth}bit ` +
+            `does not match sequence ${s.width}x${s.height}x${s.channels} @${s.bitDepth}bit`,
+        );
+      }
+      return this.encoder!;
+    }
+
+    const encoder = new this.module.AvifSequenceEncoder(
+      image.width,
+      image.height,
+      image.channels,
+      image.bitDepth,
+      this.wasmOptions,
+      this.sequenceOptions,
+    );
+    const error = encoder.getError();
+    if (error) {
+      encoder.delete();
+      throw new Error(`AVIF encode error: ${error}`);
+    }
+
+    this.encoder = encoder;
+    this.shape = {
+      width: image.width,
+      height: image.height,
+      channels: image.channels,
+      bitDepth: image.bitDepth,
+    };
+    return encoder;
+  }
+}
+
+/**
+ * Start encoding an animated AVIF.
+ */
+export async function createSequenceEncoder(
+  options: AVIFSequenceEncodeOptions = {},
+  config?: InitConfig,
+): Promise<AVIFSequenceEncoder> {
+  await init(config);
+
+  const { timescale, keyframeInterval, repetitionCount, ...imageOptions } = {
+    ...DEFAULT_SEQUENCE_OPTIONS,
+    ...options,
+  };
+  const opts = { ...DEFAULT_ENCODE_OPTIONS, ...imageOptions };
+
+  return new AVIFSequenceEncoder(encoderModule!, buildWasmOptions(opts), {
+    timescale,
+    keyframeInterval,
+    repetitionCount,
+  });
+}
+
 /**
  * Encode ImageData to AVIF with simple options
  */
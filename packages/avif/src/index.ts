@@ -2,34 +2,77 @@
 export {
   encode,
   encodeSimple,
+  encodeYUV,
+  encodeToSize,
+  createEncoderSession,
+  AVIFEncoderSession,
+  createSequenceEncoder,
+  AVIFSequenceEncoder,
   init as initEncoder,
   isInitialized as isEncoderInitialized,
 } from './encode';
 
-export type { InitConfig as EncoderInitConfig } from './encode';
+export type {
+  InitConfig as EncoderInitConfig,
+  AVIFFrameOptions,
+  AVIFEncoderSessionOptions,
+} from './encode';
 
 export {
   decode,
   decodeToImageData,
+  decodeYUV,
   getImageInfo,
+  probeImageInfo,
+  getImageInfoFromRanges,
+  createDecoderSession,
+  AVIFDecoderSession,
+  decodeSequence,
+  AVIFSequenceDecoder,
+  createStreamingDecoder,
+  decodeStream,
+  AVIFStreamingDecoder,
+  compareImages,
+  decodeAndCompare,
   init as initDecoder,
   isInitialized as isDecoderInitialized,
   isMultiThreaded as isDecoderMultiThreaded,
 } from './decode';
 
-export type { InitConfig as DecoderInitConfig } from './decode';
+export type {
+  InitConfig as DecoderInitConfig,
+  AVIFInfoProbe,
+  AVIFDecoderSessionOptions,
+  AVIFSessionDecodeOptions,
+  AVIFFrame,
+  AVIFSequenceInfo,
+  AVIFPartialImage,
+  AVIFStreamState,
+  AVIFStreamUpdate,
+  AVIFStreamOptions,
+  AVIFCompareOptions,
+} from './decode';
 
 // Options
 export type {
   AVIFEncodeOptions,
+  AVIFSequenceEncodeOptions,
+  AVIFTargetSizeOptions,
   AVIFDecodeOptions,
   ChromaSubsampling,
+  ChromaUpsampling,
+  ChromaDownsampling,
   ColorSpace,
   EncoderTune,
   TransferFunctionOption,
 } from './options';
 
-export { DEFAULT_ENCODE_OPTIONS, DEFAULT_DECODE_OPTIONS } from './options';
+export {
+  DEFAULT_ENCODE_OPTIONS,
+  DEFAULT_SEQUENCE_OPTIONS,
+  DEFAULT_TARGET_SIZE_OPTIONS,
+  DEFAULT_DECODE_OPTIONS,
+} from './options';
 
 export { enableProfiling } from './profiling'
 
@@ -38,6 +81,11 @@ export type {
   AVIFMetadata,
   AVIFImageData,
   AVIFImageInfo,
+  AVIFYUVImage,
+  AVIFYUVPlane,
+  AVIFYUVEncodeInput,
+  AVIFTargetSizeResult,
+  AVIFYUVPlaneInput,
   ColorPrimaries,
   TransferFunction,
   MatrixCoefficients,
@@ -60,4 +108,10 @@ export type { WorkerPoolConfig, AVIFWorkerClient } from './worker-api';
 
 // Re-export from core
 export { isMultiThreadSupported } from '@dimkatet/jcodecs-core';
-export type { ExtendedImageData, ImageInfo } from '@dimkatet/jcodecs-core';
+export type {
+  ExtendedImageData,
+  ImageInfo,
+  RangeReader,
+  ImageMetrics,
+  MetricsOptions,
+} from '@dimkatet/jcodecs-core';
@@ -1,4 +1,4 @@
-import type { ProgressCallback } from '@dimkatet/jcodecs-core';
+import type { CropRect, ProgressCallback } from '@dimkatet/jcodecs-core';
 import type { AVIFMetadata } from './types';
 
 /**
@@ -21,6 +21,26 @@ export type EncoderTune = 'default' | 'ssim' | 'psnr';
  */
 export type TransferFunctionOption = 'srgb' | 'pq' | 'hlg' | 'linear';
 
+/**
+ * Chroma upsampling filter for YUV to RGB conversion
+ */
+export type ChromaUpsampling =
+  | 'automatic'
+  | 'fastest'
+  | 'best-quality'
+  | 'nearest'
+  | 'bilinear';
+
+/**
+ * Chroma downsampling filter for RGB to YUV conversion
+ */
+export type ChromaDownsampling =
+  | 'automatic'
+  | 'fastest'
+  | 'best-quality'
+  | 'average'
+  | 'sharp-yuv';
+
 /**
  * AVIF encoding options
  */
@@ -99,6 +119,23 @@ export interface AVIFEncodeOptions {
    */
   tune?: EncoderTune;
 
+  /**
+   * Chroma downsampling for RGB to YUV conversion.
+   * - 'automatic', 'fastest', 'best-quality', 'average': averaging filter
+   * - 'sharp-yuv': libsharpyuv, sharper edges in 4:2:0 at a higher cost.
+   *   Fails if libavif was built without libsharpyuv.
+   * @default 'automatic'
+   */
+  chromaDownsampling?: ChromaDownsampling;
+
+  /**
+   * Skip libyuv and use libavif's built-in RGB to YUV conversion.
+   * libyuv only handles 8-bit input with a BT.601 matrix, so sRGB and
+   * Display P3 encodes (BT.709) use the built-in path either way.
+   * @default false
+   */
+  avoidLibYUV?: boolean;
+
   /**
    * Image metadata to embed in the output.
    */
@@ -110,6 +147,64 @@ export interface AVIFEncodeOptions {
   onProgress?: ProgressCallback;
 }
 
+/**
+ * Options for encoding an image sequence (animated AVIF).
+ * Per-image options apply to every frame.
+ */
+export interface AVIFSequenceEncodeOptions
+  extends Omit<AVIFEncodeOptions, 'onProgress'> {
+  /**
+   * Ticks per second. Frame durations are given in these units.
+   * @default 1000 (milliseconds)
+   */
+  timescale?: number;
+
+  /**
+   * Maximum number of frames between keyframes. Shorter intervals make
+   * seeking cheaper at the cost of size.
+   * 0 = let the encoder decide.
+   * @default 0
+   */
+  keyframeInterval?: number;
+
+  /**
+   * How many times the animation repeats after the first play.
+   * -1 = loop forever.
+   * @default -1
+   */
+  repetitionCount?: number;
+}
+
+/**
+ * Options for `encodeToSize()`. Quality is searched between `minQuality`
+ * and `maxQuality`; the other encode options apply to every candidate.
+ */
+export interface AVIFTargetSizeOptions
+  extends Omit<AVIFEncodeOptions, 'quality' | 'lossless'> {
+  /** Size budget for the encoded file, in bytes */
+  maxBytes: number;
+
+  /**
+   * Lowest quality to try. Returned (with `targetMet: false`) when even
+   * it exceeds the budget.
+   * @default 10
+   */
+  minQuality?: number;
+
+  /**
+   * Highest quality to try.
+   * @default 90
+   */
+  maxQuality?: number;
+
+  /**
+   * Stop searching once a candidate lands within this fraction below
+   * `maxBytes` (0.05 = anything from 95% to 100% of the budget).
+   * @default 0.05
+   */
+  tolerance?: number;
+}
+
 /**
  * AVIF decoding options
  */
@@ -139,6 +234,30 @@ export interface AVIFDecodeOptions {
    * @default 0
    */
   maxThreads?: number;
+
+  /**
+   * Decode only this region. YUV to RGB conversion and the output buffer
+   * cover just the crop.
+   * @default undefined (full image)
+   */
+  crop?: CropRect;
+
+  /**
+   * Chroma upsampling for YUV to RGB conversion of 4:2:0/4:2:2 images.
+   * - 'automatic': bilinear, through libyuv when it can
+   * - 'fastest' / 'nearest': nearest neighbour, the cheapest option
+   * - 'best-quality' / 'bilinear': bilinear filter
+   * @default 'automatic'
+   */
+  chromaUpsampling?: ChromaUpsampling;
+
+  /**
+   * Skip libyuv and use libavif's built-in YUV to RGB conversion.
+   * libyuv covers 8-bit output from 8/10-bit images; other cases use the
+   * built-in path either way.
+   * @default false
+   */
+  avoidLibYUV?: boolean;
 }
 
 /**
@@ -157,13 +276,39 @@ export const DEFAULT_ENCODE_OPTIONS: Required<
   lossless: false,
   maxThreads: 0,
   tune: 'default',
+  chromaDownsampling: 'automatic',
+  avoidLibYUV: false,
+};
+
+/**
+ * Default target size search options
+ */
+export const DEFAULT_TARGET_SIZE_OPTIONS: Required<
+  Pick<AVIFTargetSizeOptions, 'minQuality' | 'maxQuality' | 'tolerance'>
+> = {
+  minQuality: 10,
+  maxQuality: 90,
+  tolerance: 0.05,
+};
+
+/**
+ * Default sequence-specific encode options
+ */
+export const DEFAULT_SEQUENCE_OPTIONS: Required<
+  Pick<AVIFSequenceEncodeOptions, 'timescale' | 'keyframeInterval' | 'repetitionCount'>
+> = {
+  timescale: 1000,
+  keyframeInterval: 0,
+  repetitionCount: -1,
 };
 
 /**
  * Default decode options
  */
-export const DEFAULT_DECODE_OPTIONS: Required<AVIFDecodeOptions> = {
+export const DEFAULT_DECODE_OPTIONS: Required<Omit<AVIFDecodeOptions, 'crop'>> = {
   bitDepth: 0,
   ignoreColorProfile: false,
   maxThreads: 0,
+  chromaUpsampling: 'automatic',
+  avoidLibYUV: false,
 };
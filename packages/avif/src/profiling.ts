@@ -25,6 +25,13 @@ export interface DecodeProfile {
   wasmDecode: number;
   copyFromWasm: number;
   convertMetadata: number;
+  /** Part of wasmDecode spent in YUV to RGB conversion */
+  yuvToRgb: number;
+  /**
+   * Whether the conversion was eligible for libyuv. An estimate from the
+   * image and conversion settings; libavif does not report the path taken.
+   */
+  libyuvEligible: boolean;
   total: number;
 }
 
@@ -40,6 +47,7 @@ export function logDecodeProfile(profile: DecodeProfile): void {
       `  ─────────────────────────────\n` +
       `  Copy to WASM:   ${profile.copyToWasm.toFixed(2)} ms\n` +
       `  WASM decode:    ${profile.wasmDecode.toFixed(2)} ms\n` +
+      `    YUV → RGB:    ${profile.yuvToRgb.toFixed(2)} ms (${profile.libyuvEligible ? "libyuv, est." : "built-in"})\n` +
       `  Copy from WASM: ${profile.copyFromWasm.toFixed(2)} ms\n` +
       `  Convert meta:   ${profile.convertMetadata.toFixed(2)} ms\n` +
       `  ─────────────────────────────\n` +
@@ -60,6 +68,13 @@ export interface EncodeProfile {
   copyToWasm: number;
   wasmEncode: number;
   copyFromWasm: number;
+  /** Part of wasmEncode spent in RGB to YUV conversion */
+  rgbToYuv: number;
+  /**
+   * Whether the conversion was eligible for libyuv. An estimate from the
+   * image and conversion settings; libavif does not report the path taken.
+   */
+  libyuvEligible: boolean;
   total: number;
 }
 
@@ -73,6 +88,7 @@ export function logEncodeProfile(profile: EncodeProfile): void {
       `  ─────────────────────────────\n` +
       `  Copy to WASM:   ${profile.copyToWasm.toFixed(2)} ms\n` +
       `  WASM encode:    ${profile.wasmEncode.toFixed(2)} ms\n` +
+      `    RGB → YUV:    ${profile.rgbToYuv.toFixed(2)} ms (${profile.libyuvEligible ? "libyuv, est." : "built-in"})\n` +
       `  Copy from WASM: ${profile.copyFromWasm.toFixed(2)} ms\n` +
       `  ─────────────────────────────\n` +
       `  TOTAL:          ${profile.total.toFixed(2)} ms`,
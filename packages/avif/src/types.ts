@@ -1,4 +1,5 @@
 import type { ExtendedImageData, ImageInfo } from '@dimkatet/jcodecs-core';
+import type { ChromaSubsampling } from './options';
 
 // ============================================================================
 // CICP types (Coding-Independent Code Points)
@@ -127,6 +128,86 @@ export type AVIFImageData = ExtendedImageData<AVIFDataType, AVIFMetadata>;
 /** AVIF image info (without pixel data) */
 export type AVIFImageInfo = ImageInfo<AVIFMetadata>;
 
+/** One plane of an AVIFYUVImage, rows tightly packed */
+export interface AVIFYUVPlane {
+  data: Uint8Array | Uint16Array;
+  width: number;
+  height: number;
+  /** Samples per row (equals width) */
+  stride: number;
+}
+
+/**
+ * Decoded AVIF planes before YUV to RGB conversion. Convert with
+ * `metadata.matrixCoefficients` and `metadata.fullRange`; chroma planes
+ * are subsampled by `chromaShiftX`/`chromaShiftY`.
+ */
+export interface AVIFYUVImage {
+  width: number;
+  height: number;
+  bitDepth: number;
+  /** uint8 for 8-bit images, uint16 otherwise */
+  dataType: AVIFDataType;
+  format: ChromaSubsampling;
+  chromaShiftX: number;
+  chromaShiftY: number;
+  chromaSamplePosition: 'unknown' | 'vertical' | 'colocated';
+  y: AVIFYUVPlane;
+  /** Absent for 4:0:0 */
+  u?: AVIFYUVPlane;
+  /** Absent for 4:0:0 */
+  v?: AVIFYUVPlane;
+  /** Alpha plane (always full range), absent if the image has none */
+  alpha?: AVIFYUVPlane;
+  alphaPremultiplied: boolean;
+  metadata: AVIFMetadata;
+}
+
+/** One plane of an AVIFYUVEncodeInput */
+export interface AVIFYUVPlaneInput {
+  /** Uint8Array for 8-bit input, Uint16Array for 10/12-bit */
+  data: Uint8Array | Uint16Array;
+  /** Samples per row, at least the plane width */
+  stride: number;
+}
+
+/**
+ * Planes for `encodeYUV()`, encoded without RGB to YUV conversion. An
+ * AVIFYUVImage spread together with its metadata
+ * (`{ ...yuv, ...yuv.metadata }`) fits this shape.
+ */
+export interface AVIFYUVEncodeInput {
+  width: number;
+  height: number;
+  /** 8, 10 or 12 */
+  bitDepth: number;
+  format: ChromaSubsampling;
+  y: AVIFYUVPlaneInput;
+  /** Required unless format is 4:0:0 */
+  u?: AVIFYUVPlaneInput;
+  /** Required unless format is 4:0:0 */
+  v?: AVIFYUVPlaneInput;
+  /** Full-resolution alpha plane */
+  alpha?: AVIFYUVPlaneInput;
+  /** Matrix the planes were produced with (default: from `colorSpace` option) */
+  matrixCoefficients?: MatrixCoefficients;
+  /** @default true */
+  fullRange?: boolean;
+  /** @default false */
+  alphaPremultiplied?: boolean;
+}
+
+/** Result of `encodeToSize()` */
+export interface AVIFTargetSizeResult {
+  data: Uint8Array;
+  /** Quality of the returned encode */
+  quality: number;
+  /** Number of candidate encodes the search ran */
+  attempts: number;
+  /** false when even `minQuality` exceeded `maxBytes` */
+  targetMet: boolean;
+}
+
 /** AVIF encode input (can be standard ImageData or extended) */
 export type AVIFEncodeInput = AVIFImageData | ImageData;
 
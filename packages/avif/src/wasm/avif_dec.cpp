@@ -2,11 +2,15 @@
 #include <emscripten/val.h>
 #include <emscripten.h>
 #include <avif/avif.h>
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <string>
 #include <vector>
 
+#include "metrics.h"
+
 using namespace emscripten;
 
 // Max threads constant (defined via CMake for MT builds)
@@ -137,8 +141,15 @@ struct DecodeTimings
     double parse;
     double decode;
     double yuvToRgb;
-    double memcpy;
     double total;
+    bool libyuvEligible;  // Estimate: YUV->RGB was handed to libyuv (see libyuvEligible())
+};
+
+// How YUV is converted to RGB
+struct ConversionOptions
+{
+    std::string chromaUpsampling;  // "automatic", "fastest", "best-quality", "nearest", "bilinear"
+    bool avoidLibYUV;              // Force libavif's built-in path
 };
 
 // ============================================================================
@@ -213,6 +224,7 @@ struct ImageInfo
     uint32_t depth;
     uint32_t channels;
     ImageMetadata metadata;
+    std::string error;
 };
 
 // Helper to extract metadata from avifImage
@@ -270,69 +282,302 @@ ImageMetadata extractMetadata(const avifImage *image)
     return meta;
 }
 
-DecodeResult decode(
-    uintptr_t inputPtr,
-    size_t inputSize,
+// Sequence-level info reported by AvifSequenceDecoder
+struct SequenceInfo
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t channels;
+    uint32_t frameCount;
+    double timescale;   // Media timescale (ticks per second)
+    double durationMs;
+    int repetitionCount;  // -1 = infinite, -2 = unknown
+    uint32_t keyframeCount;
+    ImageMetadata metadata;
+    std::string error;
+};
+
+struct SequenceFrame
+{
+    uintptr_t dataPtr;  // Caller must free via Module._free
+    size_t dataSize;
+    uint32_t index;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t channels;
+    double ptsMs;
+    double durationMs;
+    bool isKeyframe;
+    bool done;  // No frame left, no pixels returned
+    std::string error;
+};
+
+// Region of interest in image coordinates; width/height of 0 means full image
+struct CropRect
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+};
+
+// Clip `crop` to the image. Returns false if nothing of it is inside.
+// A zero-size crop selects the whole image.
+bool clipCrop(CropRect &crop, uint32_t imageWidth, uint32_t imageHeight)
+{
+    if (crop.width == 0 || crop.height == 0)
+    {
+        crop = {0, 0, imageWidth, imageHeight};
+        return true;
+    }
+    if (crop.x >= imageWidth || crop.y >= imageHeight)
+        return false;
+
+    crop.width = std::min(crop.width, imageWidth - crop.x);
+    crop.height = std::min(crop.height, imageHeight - crop.y);
+    return true;
+}
+
+// Output bit depth for a requested depth (0 = source depth)
+int resolveOutputDepth(int targetBitDepth, uint32_t imageDepth)
+{
+    int depth = targetBitDepth > 0 ? targetBitDepth : static_cast<int>(imageDepth);
+    if (depth < 8)
+        depth = 8;
+    if (depth > 16)
+        depth = 16;
+    return depth;
+}
+
+avifChromaUpsampling parseChromaUpsampling(const std::string &mode)
+{
+    if (mode == "fastest")
+        return AVIF_CHROMA_UPSAMPLING_FASTEST;
+    if (mode == "best-quality")
+        return AVIF_CHROMA_UPSAMPLING_BEST_QUALITY;
+    if (mode == "nearest")
+        return AVIF_CHROMA_UPSAMPLING_NEAREST;
+    if (mode == "bilinear")
+        return AVIF_CHROMA_UPSAMPLING_BILINEAR;
+    return AVIF_CHROMA_UPSAMPLING_AUTOMATIC;
+}
+
+// RGB conversion target for `image` with 1-4 interleaved output channels
+void setupRGB(
+    avifRGBImage &rgb,
+    const avifImage *image,
+    int outputDepth,
+    uint32_t channels,
+    const ConversionOptions &conversion)
+{
+    avifRGBImageSetDefaults(&rgb, image);
+    rgb.depth = outputDepth;
+    rgb.format = (channels == 4) ? AVIF_RGB_FORMAT_RGBA : (channels == 3) ? AVIF_RGB_FORMAT_RGB
+                                                                          : AVIF_RGB_FORMAT_GRAY;
+    rgb.alphaPremultiplied = AVIF_FALSE;
+    rgb.isFloat = AVIF_FALSE;
+    rgb.chromaUpsampling = parseChromaUpsampling(conversion.chromaUpsampling);
+    rgb.avoidLibYUV = conversion.avoidLibYUV ? AVIF_TRUE : AVIF_FALSE;
+}
+
+// An estimate, not a report: libavif does not say which path
+// avifImageYUVToRGB took. True when the conversion falls in the cases
+// libavif 1.3 hands to libyuv: 8-bit RGB/RGBA output from 8- or 10-bit
+// YUV, monochrome or with a matrix libyuv has tables for, and chroma
+// that needs no upsampling or is upsampled in the automatic/fastest/
+// nearest modes. An explicit bilinear or best-quality filter on 4:2:0 or
+// 4:2:2 counts as built-in, since libyuv only has filtered conversions
+// for some layouts and libavif falls back otherwise.
+bool libyuvEligible(const avifImage *image, const avifRGBImage &rgb)
+{
+    if (avifLibYUVVersion() == 0 || rgb.avoidLibYUV)
+        return false;
+    if (rgb.depth != 8 || rgb.format == AVIF_RGB_FORMAT_GRAY)
+        return false;
+    if (image->depth != 8 && image->depth != 10)
+        return false;
+    if (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV400)
+        return true;
+    if ((image->yuvFormat == AVIF_PIXEL_FORMAT_YUV420 || image->yuvFormat == AVIF_PIXEL_FORMAT_YUV422) &&
+        (rgb.chromaUpsampling == AVIF_CHROMA_UPSAMPLING_BILINEAR ||
+         rgb.chromaUpsampling == AVIF_CHROMA_UPSAMPLING_BEST_QUALITY))
+        return false;
+    switch (image->matrixCoefficients)
+    {
+    case AVIF_MATRIX_COEFFICIENTS_BT709:
+    case AVIF_MATRIX_COEFFICIENTS_BT470BG:
+    case AVIF_MATRIX_COEFFICIENTS_BT601:
+    case AVIF_MATRIX_COEFFICIENTS_BT2020_NCL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Convert a decoded image (or the `crop` part of it, already clipped) to
+// interleaved RGB/RGBA/gray in a new malloc'd buffer the caller owns.
+// Returns an error message, empty on success.
+std::string convertToPixels(
+    const avifImage *image,
+    const CropRect &crop,
     int targetBitDepth,
-    int maxThreads)
+    uint32_t channels,
+    const ConversionOptions &conversion,
+    uint8_t *&pixels,
+    size_t &dataSize,
+    int &outputDepth,
+    DecodeTimings &timings)
 {
-    double tStart = emscripten_get_now();
-    DecodeTimings timings;
-    const uint8_t *avifData = reinterpret_cast<const uint8_t *>(inputPtr);
-    DecodeResult result;
-    result.dataPtr = 0;
-    result.dataSize = 0;
-    result.width = 0;
-    result.height = 0;
-    result.depth = 8;
-    result.channels = 0;
-    avifDecoder *decoder = avifDecoderCreate();
-    if (!decoder)
+    // A crop converts only a view of the decoded planes. View offsets must
+    // sit on chroma sample boundaries, so round the origin down and trim
+    // the extra column/row after conversion.
+    uint32_t alignX = (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV420 ||
+                       image->yuvFormat == AVIF_PIXEL_FORMAT_YUV422) ? 1 : 0;
+    uint32_t alignY = (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV420) ? 1 : 0;
+    avifCropRect viewRect;
+    viewRect.x = crop.x & ~alignX;
+    viewRect.y = crop.y & ~alignY;
+    viewRect.width = crop.width + (crop.x - viewRect.x);
+    viewRect.height = crop.height + (crop.y - viewRect.y);
+
+    avifImage *view = nullptr;
+    const avifImage *source = image;
+    if (crop.width != image->width || crop.height != image->height)
     {
-        result.error = "Failed to create decoder";
-        return result;
+        view = avifImageCreateEmpty();
+        if (!view)
+            return "Failed to create image view";
+
+        avifResult res = avifImageSetViewRect(view, image, &viewRect);
+        if (res != AVIF_RESULT_OK)
+        {
+            avifImageDestroy(view);
+            return std::string("Crop error: ") + avifResultToString(res);
+        }
+        source = view;
+    }
+
+    // Convert to RGB(A)
+    avifRGBImage rgb;
+    outputDepth = resolveOutputDepth(targetBitDepth, image->depth);
+    setupRGB(rgb, source, outputDepth, channels, conversion);
+
+    // Allocate the output buffer ourselves so the YUV->RGB conversion writes
+    // straight into memory handed to JS (caller must free via Module._free)
+    const uint32_t pixelSize = avifRGBImagePixelSize(&rgb);
+    rgb.rowBytes = rgb.width * pixelSize;
+    rgb.pixels = static_cast<uint8_t *>(malloc(static_cast<size_t>(rgb.rowBytes) * rgb.height));
+    if (!rgb.pixels)
+    {
+        if (view)
+            avifImageDestroy(view);
+        return "Failed to allocate output buffer";
+    }
+
+    double t0 = emscripten_get_now();
+    avifResult res = avifImageYUVToRGB(source, &rgb);
+    timings.yuvToRgb += emscripten_get_now() - t0;
+    timings.libyuvEligible = libyuvEligible(source, rgb);
+    if (view)
+        avifImageDestroy(view);
+    if (res != AVIF_RESULT_OK)
+    {
+        free(rgb.pixels);
+        return std::string("YUV to RGB error: ") + avifResultToString(res);
     }
 
+    // Drop the alignment column/row in place; rows only move backwards
+    const size_t outRowBytes = static_cast<size_t>(crop.width) * pixelSize;
+    const uint32_t dx = crop.x - viewRect.x;
+    const uint32_t dy = crop.y - viewRect.y;
+    if (dx != 0 || dy != 0)
+    {
+        for (uint32_t row = 0; row < crop.height; ++row)
+        {
+            std::memmove(rgb.pixels + row * outRowBytes,
+                         rgb.pixels + (row + dy) * static_cast<size_t>(rgb.rowBytes) + dx * pixelSize,
+                         outRowBytes);
+        }
+    }
+
+    pixels = rgb.pixels;
+    dataSize = outRowBytes * crop.height;
+    return "";
+}
+
+// Create a decoder with the settings shared by all decode paths
+avifDecoder *createDecoder(int maxThreads)
+{
+    avifDecoder *decoder = avifDecoderCreate();
+    if (!decoder)
+        return nullptr;
+
     decoder->maxThreads = maxThreads > 0 ? maxThreads : 1;
     decoder->codecChoice = AVIF_CODEC_CHOICE_AUTO;
     decoder->strictFlags = AVIF_STRICT_DISABLED;
     decoder->ignoreExif = AVIF_TRUE;
     decoder->ignoreXMP = AVIF_TRUE;
+    return decoder;
+}
 
+// Point `decoder` at `data`, parse it and decode the first image into
+// decoder->image. Returns an error message, empty on success.
+std::string decodeFirstImage(
+    avifDecoder *decoder,
+    const uint8_t *data,
+    size_t size,
+    DecodeTimings &timings)
+{
     double t0 = emscripten_get_now();
-    avifResult res = avifDecoderSetIOMemory(
-        decoder,
-        avifData,
-        inputSize);
+    avifResult res = avifDecoderSetIOMemory(decoder, data, size);
     timings.io = emscripten_get_now() - t0;
     if (res != AVIF_RESULT_OK)
-    {
-        result.error = std::string("IO error: ") + avifResultToString(res);
-        avifDecoderDestroy(decoder);
-        return result;
-    }
+        return std::string("IO error: ") + avifResultToString(res);
+
     t0 = emscripten_get_now();
     res = avifDecoderParse(decoder);
     timings.parse = emscripten_get_now() - t0;
     if (res != AVIF_RESULT_OK)
-    {
-        result.error = std::string("Parse error: ") + avifResultToString(res);
-        avifDecoderDestroy(decoder);
-        return result;
-    }
+        return std::string("Parse error: ") + avifResultToString(res);
+
     t0 = emscripten_get_now();
     res = avifDecoderNextImage(decoder);
     timings.decode = emscripten_get_now() - t0;
     if (res != AVIF_RESULT_OK)
+        return std::string("Decode error: ") + avifResultToString(res);
+    return "";
+}
+
+DecodeResult emptyDecodeResult()
+{
+    DecodeResult result;
+    result.dataPtr = 0;
+    result.dataSize = 0;
+    result.width = 0;
+    result.height = 0;
+    result.depth = 8;
+    result.channels = 0;
+    return result;
+}
+
+// Fill `result` from a decoded image: crop, layout, metadata and pixels
+void convertDecodedImage(
+    const avifImage *image,
+    CropRect crop,
+    int targetBitDepth,
+    const ConversionOptions &conversion,
+    DecodeResult &result,
+    DecodeTimings &timings)
+{
+    if (!clipCrop(crop, image->width, image->height))
     {
-        result.error = std::string("Decode error: ") + avifResultToString(res);
-        avifDecoderDestroy(decoder);
-        return result;
+        result.error = "Crop rectangle is outside the image";
+        return;
     }
-
-    avifImage *image = decoder->image;
-    result.width = image->width;
-    result.height = image->height;
+    result.width = crop.width;
+    result.height = crop.height;
     result.depth = image->depth;
 
     const uint8_t colorChannels = (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV400) ? 1 : 3;
@@ -340,147 +585,1006 @@ DecodeResult decode(
     result.channels = colorChannels + alphaChannel;
     result.metadata = extractMetadata(image);
 
-    // Convert to RGB(A)
-    avifRGBImage rgb;
-    avifRGBImageSetDefaults(&rgb, image);
-
-    // Determine output bit depth
-    int outputDepth = targetBitDepth > 0 ? targetBitDepth : image->depth;
-    if (outputDepth < 8)
-        outputDepth = 8;
-    if (outputDepth > 16)
-        outputDepth = 16;
+    uint8_t *pixels = nullptr;
+    size_t dataSize = 0;
+    int outputDepth = 0;
+    result.error = convertToPixels(image, crop, targetBitDepth, result.channels, conversion,
+                                   pixels, dataSize, outputDepth, timings);
+    if (!result.error.empty())
+        return;
 
-    rgb.depth = outputDepth;
-    rgb.format = (result.channels == 4) ? AVIF_RGB_FORMAT_RGBA : (result.channels == 3) ? AVIF_RGB_FORMAT_RGB
-                                                                                        : AVIF_RGB_FORMAT_GRAY;
-    rgb.alphaPremultiplied = AVIF_FALSE;
-    rgb.isFloat = AVIF_FALSE;
+    result.dataPtr = reinterpret_cast<uintptr_t>(pixels);
+    result.dataSize = dataSize;
+    result.depth = outputDepth;
+}
 
-    avifRGBImageAllocatePixels(&rgb);
+DecodeResult decode(
+    uintptr_t inputPtr,
+    size_t inputSize,
+    int targetBitDepth,
+    int maxThreads,
+    CropRect crop,
+    const ConversionOptions &conversion)
+{
+    double tStart = emscripten_get_now();
+    DecodeTimings timings = {0};
+    const uint8_t *avifData = reinterpret_cast<const uint8_t *>(inputPtr);
+    DecodeResult result = emptyDecodeResult();
 
-    t0 = emscripten_get_now();
-    res = avifImageYUVToRGB(image, &rgb);
-    timings.yuvToRgb = emscripten_get_now() - t0;
-    if (res != AVIF_RESULT_OK)
+    avifDecoder *decoder = createDecoder(maxThreads);
+    if (!decoder)
     {
-        result.error = std::string("YUV to RGB error: ") + avifResultToString(res);
-        avifRGBImageFreePixels(&rgb);
-        avifDecoderDestroy(decoder);
+        result.error = "Failed to create decoder";
         return result;
     }
 
-    // Allocate memory for pixel data (caller must free via Module._free)
-    size_t dataSize = rgb.rowBytes * rgb.height;
-    void *dataPtr = malloc(dataSize);
-    // uint8_t* dataPtr = static_cast<uint8_t*>(malloc(dataSize));
-    if (!dataPtr)
-    {
-        result.error = "Failed to allocate output buffer";
-        avifRGBImageFreePixels(&rgb);
-        avifDecoderDestroy(decoder);
-        return result;
-    }
-    t0 = emscripten_get_now();
-    std::memcpy(dataPtr, rgb.pixels, dataSize);
-    timings.memcpy = emscripten_get_now() - t0;
-    result.dataPtr = reinterpret_cast<uintptr_t>(dataPtr);
-    result.dataSize = dataSize;
-    result.depth = outputDepth;
+    result.error = decodeFirstImage(decoder, avifData, inputSize, timings);
+    if (result.error.empty())
+        convertDecodedImage(decoder->image, crop, targetBitDepth, conversion, result, timings);
 
-    avifRGBImageFreePixels(&rgb);
     avifDecoderDestroy(decoder);
     timings.total = emscripten_get_now() - tStart;
     result.timings = timings;
     return result;
 }
 
-ImageInfo getImageInfo(uintptr_t inputPtr, size_t inputSize)
+// Header fields, available once avifDecoderParse succeeded. Planes are not
+// decoded yet, so alpha comes from the parsed item properties.
+void fillImageInfo(const avifDecoder *decoder, ImageInfo &info)
+{
+    const avifImage *image = decoder->image;
+
+    info.width = image->width;
+    info.height = image->height;
+    info.depth = image->depth;
+
+    const uint8_t colorChannels = (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV400) ? 1 : 3;
+    const uint8_t alphaChannel = decoder->alphaPresent ? 1 : 0;
+    info.channels = colorChannels + alphaChannel;
+    info.metadata = extractMetadata(image);
+}
+
+// Parse `data` with `decoder` and fill `info`. On failure the fields stay
+// zeroed and info.error is set.
+void parseImageInfo(avifDecoder *decoder, const uint8_t *data, size_t size, ImageInfo &info)
 {
-    const uint8_t *avifData = reinterpret_cast<const uint8_t *>(inputPtr);
-    ImageInfo info;
     info.width = 0;
     info.height = 0;
     info.depth = 0;
     info.channels = 0;
 
-    avifDecoder *decoder = avifDecoderCreate();
-    if (!decoder)
-        return info;
-
-    decoder->maxThreads = 1;
-    decoder->strictFlags = AVIF_STRICT_DISABLED;
-    decoder->ignoreExif = AVIF_TRUE;
-    decoder->ignoreXMP = AVIF_TRUE;
-
-    avifResult res = avifDecoderSetIOMemory(
-        decoder,
-        avifData,
-        inputSize);
-
+    avifResult res = avifDecoderSetIOMemory(decoder, data, size);
     if (res != AVIF_RESULT_OK)
     {
-        avifDecoderDestroy(decoder);
-        return info;
+        info.error = std::string("IO error: ") + avifResultToString(res);
+        return;
     }
-
     res = avifDecoderParse(decoder);
     if (res != AVIF_RESULT_OK)
     {
-        avifDecoderDestroy(decoder);
-        return info;
+        info.error = std::string("Parse error: ") + avifResultToString(res);
+        return;
     }
 
-    avifImage *image = decoder->image;
+    fillImageInfo(decoder, info);
+}
 
-    info.width = image->width;
-    info.height = image->height;
-    info.depth = image->depth;
+ImageInfo getImageInfo(uintptr_t inputPtr, size_t inputSize)
+{
+    const uint8_t *avifData = reinterpret_cast<const uint8_t *>(inputPtr);
+    ImageInfo info;
+    info.width = 0;
+    info.height = 0;
+    info.depth = 0;
+    info.channels = 0;
 
-    const uint8_t colorChannels = (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV400) ? 1 : 3;
-    const uint8_t alphaChannel = (image->alphaPlane != nullptr) ? 1 : 0;
-    info.channels = colorChannels + alphaChannel;
-    info.metadata = extractMetadata(image);
+    avifDecoder *decoder = createDecoder(1);
+    if (!decoder)
+    {
+        info.error = "Failed to create decoder";
+        return info;
+    }
+
+    parseImageInfo(decoder, avifData, inputSize, info);
 
     avifDecoderDestroy(decoder);
     return info;
 }
 
-EMSCRIPTEN_BINDINGS(avif_decoder)
+// ============================================================================
+// Raw YUV output
+// ============================================================================
+
+// One plane inside YuvDecodeResult's buffer. Rows are tightly packed, so
+// stride is width * bytes per sample. A plane that is absent has width 0.
+struct YuvPlane
 {
-    // Mastering display metadata
-    value_object<MasteringDisplay>("MasteringDisplay")
-        .field("redX", &MasteringDisplay::redX)
-        .field("redY", &MasteringDisplay::redY)
-        .field("greenX", &MasteringDisplay::greenX)
-        .field("greenY", &MasteringDisplay::greenY)
-        .field("blueX", &MasteringDisplay::blueX)
-        .field("blueY", &MasteringDisplay::blueY)
-        .field("whiteX", &MasteringDisplay::whiteX)
-        .field("whiteY", &MasteringDisplay::whiteY)
-        .field("minLuminance", &MasteringDisplay::minLuminance)
-        .field("maxLuminance", &MasteringDisplay::maxLuminance)
-        .field("present", &MasteringDisplay::present);
+    size_t offset;    // Byte offset from dataPtr
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;  // Bytes per row
+};
 
-    // Image metadata
-    value_object<ImageMetadata>("ImageMetadata")
-        .field("colorPrimaries", &ImageMetadata::colorPrimaries)
-        .field("transferFunction", &ImageMetadata::transferFunction)
-        .field("matrixCoefficients", &ImageMetadata::matrixCoefficients)
-        .field("fullRange", &ImageMetadata::fullRange)
-        .field("maxCLL", &ImageMetadata::maxCLL)
-        .field("maxPALL", &ImageMetadata::maxPALL)
-        .field("masteringDisplay", &ImageMetadata::masteringDisplay)
-        .field("iccProfilePtr", &ImageMetadata::iccProfilePtr)
-        .field("iccProfileSize", &ImageMetadata::iccProfileSize)
-        .field("isHDR", &ImageMetadata::isHDR);
+struct YuvDecodeResult
+{
+    uintptr_t dataPtr;  // All planes in one buffer, caller must free via Module._free
+    size_t dataSize;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    std::string format;  // "4:4:4", "4:2:2", "4:2:0" or "4:0:0"
+    uint32_t chromaShiftX;
+    uint32_t chromaShiftY;
+    std::string chromaSamplePosition;  // "unknown", "vertical" or "colocated"
+    YuvPlane y;
+    YuvPlane u;
+    YuvPlane v;
+    YuvPlane alpha;
+    bool alphaPremultiplied;
+    ImageMetadata metadata;
+    DecodeTimings timings;
+    std::string error;
+};
 
-    // Decode result
-    value_object<DecodeResult>("DecodeResult")
-        .field("dataPtr", &DecodeResult::dataPtr)
-        .field("dataSize", &DecodeResult::dataSize)
-        .field("width", &DecodeResult::width)
-        .field("height", &DecodeResult::height)
+std::string pixelFormatToString(avifPixelFormat format)
+{
+    switch (format)
+    {
+    case AVIF_PIXEL_FORMAT_YUV444:
+        return "4:4:4";
+    case AVIF_PIXEL_FORMAT_YUV422:
+        return "4:2:2";
+    case AVIF_PIXEL_FORMAT_YUV420:
+        return "4:2:0";
+    case AVIF_PIXEL_FORMAT_YUV400:
+        return "4:0:0";
+    default:
+        return "unknown";
+    }
+}
+
+std::string chromaSamplePositionToString(avifChromaSamplePosition position)
+{
+    switch (position)
+    {
+    case AVIF_CHROMA_SAMPLE_POSITION_VERTICAL:
+        return "vertical";
+    case AVIF_CHROMA_SAMPLE_POSITION_COLOCATED:
+        return "colocated";
+    default:
+        return "unknown";
+    }
+}
+
+// Decode the first image and return its planes without YUV->RGB
+// conversion, for clients that convert on the GPU. Samples are uint8 for
+// 8-bit images and uint16 otherwise.
+YuvDecodeResult decodeYUV(uintptr_t inputPtr, size_t inputSize, int maxThreads)
+{
+    double tStart = emscripten_get_now();
+    DecodeTimings timings = {0};
+    const uint8_t *avifData = reinterpret_cast<const uint8_t *>(inputPtr);
+    YuvDecodeResult result;
+    result.dataPtr = 0;
+    result.dataSize = 0;
+    result.width = 0;
+    result.height = 0;
+    result.depth = 0;
+    result.chromaShiftX = 0;
+    result.chromaShiftY = 0;
+    result.y = result.u = result.v = result.alpha = YuvPlane{0, 0, 0, 0};
+    result.alphaPremultiplied = false;
+
+    avifDecoder *decoder = createDecoder(maxThreads);
+    if (!decoder)
+    {
+        result.error = "Failed to create decoder";
+        return result;
+    }
+    result.error = decodeFirstImage(decoder, avifData, inputSize, timings);
+    if (!result.error.empty())
+    {
+        avifDecoderDestroy(decoder);
+        return result;
+    }
+
+    const avifImage *image = decoder->image;
+    avifPixelFormatInfo formatInfo;
+    avifGetPixelFormatInfo(image->yuvFormat, &formatInfo);
+
+    result.width = image->width;
+    result.height = image->height;
+    result.depth = image->depth;
+    result.format = pixelFormatToString(image->yuvFormat);
+    if (!formatInfo.monochrome)
+    {
+        result.chromaShiftX = formatInfo.chromaShiftX;
+        result.chromaShiftY = formatInfo.chromaShiftY;
+    }
+    result.chromaSamplePosition = chromaSamplePositionToString(image->yuvChromaSamplePosition);
+    result.alphaPremultiplied = image->alphaPremultiplied == AVIF_TRUE;
+    result.metadata = extractMetadata(image);
+
+    const uint32_t bytesPerSample = avifImageUsesU16(image) ? 2 : 1;
+    const int channels[] = {AVIF_CHAN_Y, AVIF_CHAN_U, AVIF_CHAN_V, AVIF_CHAN_A};
+    YuvPlane *planes[] = {&result.y, &result.u, &result.v, &result.alpha};
+
+    size_t totalSize = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        if (!avifImagePlane(image, channels[i]))
+            continue;
+        YuvPlane &plane = *planes[i];
+        plane.offset = totalSize;
+        plane.width = avifImagePlaneWidth(image, channels[i]);
+        plane.height = avifImagePlaneHeight(image, channels[i]);
+        plane.stride = plane.width * bytesPerSample;
+        totalSize += static_cast<size_t>(plane.stride) * plane.height;
+    }
+
+    uint8_t *buffer = static_cast<uint8_t *>(malloc(totalSize));
+    if (!buffer)
+    {
+        result.error = "Failed to allocate output buffer";
+        avifDecoderDestroy(decoder);
+        return result;
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        const YuvPlane &plane = *planes[i];
+        if (plane.width == 0)
+            continue;
+        const uint8_t *src = avifImagePlane(image, channels[i]);
+        const uint32_t srcRowBytes = avifImagePlaneRowBytes(image, channels[i]);
+        uint8_t *dst = buffer + plane.offset;
+        if (srcRowBytes == plane.stride)
+        {
+            std::memcpy(dst, src, static_cast<size_t>(plane.stride) * plane.height);
+            continue;
+        }
+        for (uint32_t row = 0; row < plane.height; ++row)
+            std::memcpy(dst + static_cast<size_t>(row) * plane.stride,
+                        src + static_cast<size_t>(row) * srcRowBytes, plane.stride);
+    }
+
+    result.dataPtr = reinterpret_cast<uintptr_t>(buffer);
+    result.dataSize = totalSize;
+
+    avifDecoderDestroy(decoder);
+    timings.total = emscripten_get_now() - tStart;
+    result.timings = timings;
+    return result;
+}
+
+// ============================================================================
+// Persistent decoder session
+// ============================================================================
+
+// Keeps one configured avifDecoder across images, reset by each new parse,
+// so batches of small files skip decoder allocation and setup. libavif
+// rebuilds its dav1d context on every parse, so dav1d's worker threads
+// cannot be kept alive; instead inputs smaller than `singleThreadBelow`
+// bytes decode on one thread, where dav1d starts no workers at all.
+class AvifDecoderSession
+{
+public:
+    AvifDecoderSession(int maxThreads, double singleThreadBelow)
+        : decoder_(createDecoder(1)), singleThreadBelow_(singleThreadBelow)
+    {
+        setThreadCount(maxThreads);
+    }
+
+    ~AvifDecoderSession()
+    {
+        if (decoder_)
+            avifDecoderDestroy(decoder_);
+    }
+
+    AvifDecoderSession(const AvifDecoderSession &) = delete;
+    AvifDecoderSession &operator=(const AvifDecoderSession &) = delete;
+
+    // Clamped to MAX_THREADS (PTHREAD_POOL_SIZE) to avoid pool exhaustion
+    void setThreadCount(int maxThreads)
+    {
+        threadCount_ = std::max(1, std::min(maxThreads, MAX_THREADS));
+    }
+
+    int getThreadCount() const
+    {
+        return threadCount_;
+    }
+
+    DecodeResult decode(
+        uintptr_t inputPtr,
+        size_t inputSize,
+        int targetBitDepth,
+        CropRect crop,
+        const ConversionOptions &conversion)
+    {
+        double tStart = emscripten_get_now();
+        DecodeTimings timings = {0};
+        DecodeResult result = emptyDecodeResult();
+        if (!decoder_)
+        {
+            result.error = "Failed to create decoder";
+            return result;
+        }
+
+        decoder_->maxThreads = inputSize < singleThreadBelow_ ? 1 : threadCount_;
+        result.error = decodeFirstImage(
+            decoder_, reinterpret_cast<const uint8_t *>(inputPtr), inputSize, timings);
+        if (result.error.empty())
+            convertDecodedImage(decoder_->image, crop, targetBitDepth, conversion, result, timings);
+
+        timings.total = emscripten_get_now() - tStart;
+        result.timings = timings;
+        return result;
+    }
+
+    ImageInfo getImageInfo(uintptr_t inputPtr, size_t inputSize)
+    {
+        ImageInfo info = {};
+        if (!decoder_)
+        {
+            info.error = "Failed to create decoder";
+            return info;
+        }
+
+        // Parsing decodes nothing, threads would only add startup cost
+        decoder_->maxThreads = 1;
+        parseImageInfo(decoder_, reinterpret_cast<const uint8_t *>(inputPtr), inputSize, info);
+        return info;
+    }
+
+private:
+    avifDecoder *decoder_;
+    double singleThreadBelow_;
+    int threadCount_ = 1;
+};
+
+// ============================================================================
+// Image sequence (avis) decoder
+// ============================================================================
+
+// Keeps one avifDecoder (and its dav1d context) open over an image
+// sequence and returns frames one at a time. Seeking goes through
+// avifDecoderNthImage, which restarts from the nearest keyframe at most,
+// so seek cost is bounded by the keyframe interval, not the frame index.
+// Still images are reported as a one-frame sequence.
+class AvifSequenceDecoder
+{
+public:
+    AvifSequenceDecoder(
+        uintptr_t inputPtr,
+        size_t inputSize,
+        int targetBitDepth,
+        int maxThreads,
+        const ConversionOptions &conversion)
+        : decoder_(createDecoder(maxThreads)), targetBitDepth_(targetBitDepth), conversion_(conversion)
+    {
+        // The decoder reads from memory lazily, keep our own copy
+        const uint8_t *data = reinterpret_cast<const uint8_t *>(inputPtr);
+        input_.assign(data, data + inputSize);
+
+        if (!decoder_)
+        {
+            info_.error = "Failed to create decoder";
+            return;
+        }
+
+        avifResult res = avifDecoderSetIOMemory(decoder_, input_.data(), input_.size());
+        if (res != AVIF_RESULT_OK)
+        {
+            info_.error = std::string("IO error: ") + avifResultToString(res);
+            return;
+        }
+        res = avifDecoderParse(decoder_);
+        if (res != AVIF_RESULT_OK)
+        {
+            info_.error = std::string("Parse error: ") + avifResultToString(res);
+            return;
+        }
+
+        const avifImage *image = decoder_->image;
+        info_.width = image->width;
+        info_.height = image->height;
+        info_.depth = image->depth;
+        info_.channels = ((image->yuvFormat == AVIF_PIXEL_FORMAT_YUV400) ? 1 : 3) +
+                         (decoder_->alphaPresent ? 1 : 0);
+        info_.frameCount = static_cast<uint32_t>(decoder_->imageCount);
+        info_.timescale = static_cast<double>(decoder_->timescale);
+        info_.durationMs = decoder_->duration * 1000.0;
+        info_.repetitionCount = decoder_->repetitionCount;
+
+        // Sync sample table lookup only, no decoding
+        for (uint32_t i = 0; i < info_.frameCount; ++i)
+        {
+            if (avifDecoderIsKeyframe(decoder_, i))
+                keyframes_.push_back(i);
+        }
+        info_.keyframeCount = static_cast<uint32_t>(keyframes_.size());
+    }
+
+    ~AvifSequenceDecoder()
+    {
+        if (decoder_)
+            avifDecoderDestroy(decoder_);
+    }
+
+    AvifSequenceDecoder(const AvifSequenceDecoder &) = delete;
+    AvifSequenceDecoder &operator=(const AvifSequenceDecoder &) = delete;
+
+    SequenceInfo getInfo() const
+    {
+        SequenceInfo info = info_;
+        if (info.error.empty())
+            info.metadata = extractMetadata(decoder_->image);
+        return info;
+    }
+
+    // Frame indices that can be decoded without earlier frames
+    val getKeyframes() const
+    {
+        val result = val::array();
+        for (size_t i = 0; i < keyframes_.size(); ++i)
+            result.set(i, keyframes_[i]);
+        return result;
+    }
+
+    // Keyframe a decode of `index` would have to start from
+    uint32_t nearestKeyframe(uint32_t index) const
+    {
+        if (!decoder_ || index >= info_.frameCount)
+            return 0;
+        return avifDecoderNearestKeyframe(decoder_, index);
+    }
+
+    // Decode the next frame, or return done = true after the last one
+    SequenceFrame next()
+    {
+        SequenceFrame frame = {};
+        frame.index = nextIndex_;
+
+        if (!info_.error.empty())
+        {
+            frame.error = info_.error;
+            return frame;
+        }
+        if (nextIndex_ >= info_.frameCount)
+        {
+            frame.done = true;
+            return frame;
+        }
+
+        // Sequential frames continue the decoder, anything else seeks
+        avifResult res = (decodedIndex_ >= 0 && nextIndex_ == static_cast<uint32_t>(decodedIndex_) + 1)
+                             ? avifDecoderNextImage(decoder_)
+                             : avifDecoderNthImage(decoder_, nextIndex_);
+        if (res != AVIF_RESULT_OK)
+        {
+            frame.error = std::string("Decode error: ") + avifResultToString(res);
+            return frame;
+        }
+        decodedIndex_ = static_cast<int>(nextIndex_);
+
+        const avifImage *image = decoder_->image;
+        CropRect crop = {0, 0, image->width, image->height};
+        frame.width = image->width;
+        frame.height = image->height;
+        frame.channels = info_.channels;
+
+        uint8_t *pixels = nullptr;
+        int outputDepth = 0;
+        DecodeTimings timings = {0};
+        frame.error = convertToPixels(image, crop, targetBitDepth_, frame.channels, conversion_,
+                                      pixels, frame.dataSize, outputDepth, timings);
+        if (!frame.error.empty())
+            return frame;
+
+        frame.dataPtr = reinterpret_cast<uintptr_t>(pixels);
+        frame.depth = outputDepth;
+        frame.ptsMs = decoder_->imageTiming.pts * 1000.0;
+        frame.durationMs = decoder_->imageTiming.duration * 1000.0;
+        frame.isKeyframe = avifDecoderIsKeyframe(decoder_, nextIndex_) == AVIF_TRUE;
+
+        ++nextIndex_;
+        return frame;
+    }
+
+    // Make the next call to next() return frame `index`. Returns false if
+    // out of range. Decoding happens lazily in next().
+    bool seek(uint32_t index)
+    {
+        if (!info_.error.empty() || index >= info_.frameCount)
+            return false;
+        nextIndex_ = index;
+        return true;
+    }
+
+    uint32_t getFrameIndex() const { return nextIndex_; }
+
+private:
+    avifDecoder *decoder_;
+    std::vector<uint8_t> input_;
+    std::vector<uint32_t> keyframes_;
+    SequenceInfo info_ = {};
+    int targetBitDepth_;
+    ConversionOptions conversion_;
+    uint32_t nextIndex_ = 0;
+    int decodedIndex_ = -1;  // Frame currently held by the decoder
+};
+
+// ============================================================================
+// Streaming (incremental) decoder
+// ============================================================================
+
+// avifIO over input that arrives in chunks from JS. Reads beyond the bytes
+// received so far return AVIF_RESULT_WAITING_ON_IO until close() marks the
+// end of the stream. Chunks are stored as pushed and never move, so a read
+// inside one chunk points straight at it; a read spanning chunks is
+// assembled in a scratch buffer, valid until the next read as libavif
+// expects from a non-persistent IO.
+class ChunkedIO
+{
+public:
+    // Allocates an avifIO that owns this object. Pass it to
+    // avifDecoderSetIO, which frees it with the decoder.
+    static ChunkedIO *create(uint64_t sizeHint)
+    {
+        ChunkedIO *self = new ChunkedIO();
+        self->io_.destroy = &ChunkedIO::destroy;
+        self->io_.read = &ChunkedIO::read;
+        self->io_.write = nullptr;
+        self->io_.sizeHint = sizeHint;
+        self->io_.persistent = AVIF_FALSE;
+        self->io_.data = self;
+        return self;
+    }
+
+    avifIO *io() { return &io_; }
+
+    void append(const uint8_t *data, size_t size)
+    {
+        if (size == 0)
+            return;
+        starts_.push_back(size_);
+        chunks_.emplace_back(data, data + size);
+        size_ += size;
+    }
+
+    void close() { closed_ = true; }
+
+    bool closed() const { return closed_; }
+    uint64_t size() const { return size_; }
+
+    // Furthest byte libavif has asked for so far (exclusive)
+    uint64_t requestedEnd() const { return requestedEnd_; }
+
+private:
+    ChunkedIO() = default;
+
+    static void destroy(avifIO *io)
+    {
+        delete static_cast<ChunkedIO *>(io->data);
+    }
+
+    static avifResult read(avifIO *io, uint32_t readFlags, uint64_t offset, size_t size, avifROData *out)
+    {
+        ChunkedIO *self = static_cast<ChunkedIO *>(io->data);
+        if (readFlags != 0)
+            return AVIF_RESULT_IO_ERROR;
+
+        self->requestedEnd_ = std::max(self->requestedEnd_, offset + size);
+        if (offset > self->size_)
+            return self->closed_ ? AVIF_RESULT_IO_ERROR : AVIF_RESULT_WAITING_ON_IO;
+
+        uint64_t available = self->size_ - offset;
+        if (size > available)
+        {
+            // Short reads are only allowed at the real end of the file
+            if (!self->closed_)
+                return AVIF_RESULT_WAITING_ON_IO;
+            size = static_cast<size_t>(available);
+        }
+
+        out->size = size;
+        if (size == 0)
+        {
+            out->data = nullptr;
+            return AVIF_RESULT_OK;
+        }
+
+        // Chunk containing `offset`
+        size_t index = std::upper_bound(self->starts_.begin(), self->starts_.end(), offset) - self->starts_.begin() - 1;
+        size_t within = static_cast<size_t>(offset - self->starts_[index]);
+        const std::vector<uint8_t> &chunk = self->chunks_[index];
+        if (within + size <= chunk.size())
+        {
+            out->data = chunk.data() + within;
+            return AVIF_RESULT_OK;
+        }
+
+        self->scratch_.resize(size);
+        size_t copied = 0;
+        for (; copied < size; ++index, within = 0)
+        {
+            const std::vector<uint8_t> &part = self->chunks_[index];
+            size_t n = std::min(size - copied, part.size() - within);
+            std::memcpy(self->scratch_.data() + copied, part.data() + within, n);
+            copied += n;
+        }
+        out->data = self->scratch_.data();
+        return AVIF_RESULT_OK;
+    }
+
+    avifIO io_ = {};
+    std::vector<std::vector<uint8_t>> chunks_;
+    std::vector<uint64_t> starts_; // Stream offset of each chunk
+    std::vector<uint8_t> scratch_;
+    uint64_t size_ = 0;
+    uint64_t requestedEnd_ = 0;
+    bool closed_ = false;
+};
+
+// Result of probeImageInfo on a (possibly partial) file
+struct InfoProbe
+{
+    bool complete;      // `info` holds the header fields
+    double bytesNeeded; // Prefix size to try next when not complete
+    ImageInfo info;
+    std::string error;
+};
+
+// Header info from a prefix of the file. libavif asks for exact byte
+// ranges (box headers, then the whole `meta` box), so when the prefix is
+// too short the furthest byte it requested is exactly what is missing.
+InfoProbe probeImageInfo(uintptr_t inputPtr, size_t inputSize, bool inputComplete)
+{
+    InfoProbe probe = {};
+
+    avifDecoder *decoder = createDecoder(1);
+    if (!decoder)
+    {
+        probe.error = "Failed to create decoder";
+        return probe;
+    }
+
+    ChunkedIO *io = ChunkedIO::create(0);
+    avifDecoderSetIO(decoder, io->io());
+    io->append(reinterpret_cast<const uint8_t *>(inputPtr), inputSize);
+    if (inputComplete)
+        io->close();
+
+    avifResult res = avifDecoderParse(decoder);
+    if (res == AVIF_RESULT_WAITING_ON_IO)
+    {
+        probe.bytesNeeded = static_cast<double>(std::max<uint64_t>(io->requestedEnd(), inputSize + 1));
+    }
+    else if (res != AVIF_RESULT_OK)
+    {
+        probe.error = std::string("Parse error: ") + avifResultToString(res);
+    }
+    else
+    {
+        probe.complete = true;
+        fillImageInfo(decoder, probe.info);
+    }
+
+    avifDecoderDestroy(decoder);
+    return probe;
+}
+
+struct StreamStatus
+{
+    std::string state; // "needMoreInput", "progress", "complete", "error"
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t channels;
+    uint32_t rowsDecoded;  // Rows of the buffer that hold decoded pixels
+    uintptr_t dataPtr;     // Full-size buffer owned by the decoder, 0 until rows exist
+    size_t dataSize;
+    std::string error;
+};
+
+// Decodes the primary image while the file is still arriving. Input comes
+// through ChunkedIO; with allowIncremental, libavif decodes grid cells as
+// soon as their data is present and avifDecoderDecodedRowCount tells how
+// many top rows are final, so those rows are converted to RGB right away.
+// Band edges are converted without the chroma rows below them, so the
+// finished image is converted once more in full to match decode() exactly.
+class AvifStreamingDecoder
+{
+public:
+    AvifStreamingDecoder(
+        int targetBitDepth,
+        int maxThreads,
+        double totalSize,
+        const ConversionOptions &conversion)
+        : decoder_(createDecoder(maxThreads)), targetBitDepth_(targetBitDepth), conversion_(conversion)
+    {
+        if (!decoder_)
+        {
+            error_ = "Failed to create decoder";
+            return;
+        }
+
+        decoder_->allowIncremental = AVIF_TRUE;
+
+        // The decoder owns the IO from here on
+        io_ = ChunkedIO::create(totalSize > 0 ? static_cast<uint64_t>(totalSize) : 0);
+        avifDecoderSetIO(decoder_, io_->io());
+    }
+
+    ~AvifStreamingDecoder()
+    {
+        if (decoder_)
+            avifDecoderDestroy(decoder_);
+        free(pixels_);
+    }
+
+    AvifStreamingDecoder(const AvifStreamingDecoder &) = delete;
+    AvifStreamingDecoder &operator=(const AvifStreamingDecoder &) = delete;
+
+    // Append a chunk of input and decode as far as it allows
+    StreamStatus push(uintptr_t chunkPtr, size_t chunkSize)
+    {
+        if (!error_.empty() || complete_ || io_->closed())
+            return status();
+
+        io_->append(reinterpret_cast<const uint8_t *>(chunkPtr), chunkSize);
+        return process();
+    }
+
+    // Signal end of input and finish decoding
+    StreamStatus close()
+    {
+        if (!error_.empty() || complete_ || io_->closed())
+            return status();
+
+        io_->close();
+        return process();
+    }
+
+    // Transfer the final image to the caller (same shape as decode()).
+    // Only valid once a call returned state "complete".
+    DecodeResult takeResult()
+    {
+        DecodeResult result = {};
+        if (!complete_ || !pixels_)
+        {
+            result.error = error_.empty() ? "Image not complete" : error_;
+            return result;
+        }
+
+        result.width = width_;
+        result.height = height_;
+        result.depth = outputDepth_;
+        result.channels = channels_;
+        result.dataPtr = reinterpret_cast<uintptr_t>(pixels_);
+        result.dataSize = pixelsSize_;
+        result.metadata = extractMetadata(decoder_->image);
+        pixels_ = nullptr;
+
+        timings_.total = timings_.parse + timings_.decode + timings_.yuvToRgb;
+        result.timings = timings_;
+        return result;
+    }
+
+private:
+    StreamStatus process()
+    {
+        if (!parsed_)
+        {
+            double t0 = emscripten_get_now();
+            avifResult res = avifDecoderParse(decoder_);
+            timings_.parse += emscripten_get_now() - t0;
+
+            if (res == AVIF_RESULT_WAITING_ON_IO)
+                return waiting();
+            if (res != AVIF_RESULT_OK)
+            {
+                error_ = std::string("Parse error: ") + avifResultToString(res);
+                return status();
+            }
+            if (!allocate())
+                return status();
+            parsed_ = true;
+        }
+
+        double t0 = emscripten_get_now();
+        avifResult res = avifDecoderNextImage(decoder_);
+        timings_.decode += emscripten_get_now() - t0;
+
+        if (res == AVIF_RESULT_OK)
+        {
+            // Final full conversion replaces the band renders
+            if (convertRows(0, height_))
+                complete_ = true;
+            rowsDecoded_ = complete_ ? height_ : rowsDecoded_;
+            return status();
+        }
+        if (res != AVIF_RESULT_WAITING_ON_IO)
+        {
+            error_ = std::string("Decode error: ") + avifResultToString(res);
+            return status();
+        }
+
+        uint32_t rows = avifDecoderDecodedRowCount(decoder_);
+        if (rows <= rowsDecoded_)
+            return waiting();
+
+        // Restart on a chroma row so the band's view is valid
+        uint32_t alignY = (decoder_->image->yuvFormat == AVIF_PIXEL_FORMAT_YUV420) ? 1 : 0;
+        uint32_t y = rowsDecoded_ & ~alignY;
+        if (!convertRows(y, rows - y))
+            return status();
+        rowsDecoded_ = rows;
+
+        StreamStatus st = waiting();
+        if (st.state == "needMoreInput")
+            st.state = "progress";
+        return st;
+    }
+
+    // Still waiting on IO: an error once input is closed
+    StreamStatus waiting()
+    {
+        if (io_->closed())
+            error_ = "Incomplete input data";
+        return status();
+    }
+
+    bool allocate()
+    {
+        const avifImage *image = decoder_->image;
+        width_ = image->width;
+        height_ = image->height;
+        channels_ = ((image->yuvFormat == AVIF_PIXEL_FORMAT_YUV400) ? 1 : 3) +
+                    (decoder_->alphaPresent ? 1 : 0);
+        outputDepth_ = resolveOutputDepth(targetBitDepth_, image->depth);
+
+        size_t bytesPerSample = outputDepth_ > 8 ? 2 : 1;
+        pixelsSize_ = static_cast<size_t>(width_) * height_ * channels_ * bytesPerSample;
+        pixels_ = static_cast<uint8_t *>(malloc(pixelsSize_));
+        if (!pixels_)
+        {
+            error_ = "Failed to allocate output buffer";
+            return false;
+        }
+        return true;
+    }
+
+    // Convert image rows [y, y + rows) into the matching rows of pixels_
+    bool convertRows(uint32_t y, uint32_t rows)
+    {
+        const avifImage *image = decoder_->image;
+        avifImage *view = nullptr;
+        const avifImage *source = image;
+        if (y != 0 || rows != image->height)
+        {
+            view = avifImageCreateEmpty();
+            avifCropRect rect = {0, y, image->width, rows};
+            avifResult res = view ? avifImageSetViewRect(view, image, &rect) : AVIF_RESULT_OUT_OF_MEMORY;
+            if (res != AVIF_RESULT_OK)
+            {
+                if (view)
+                    avifImageDestroy(view);
+                error_ = std::string("YUV to RGB error: ") + avifResultToString(res);
+                return false;
+            }
+            source = view;
+        }
+
+        avifRGBImage rgb;
+        setupRGB(rgb, source, outputDepth_, channels_, conversion_);
+        rgb.rowBytes = rgb.width * avifRGBImagePixelSize(&rgb);
+        rgb.pixels = pixels_ + static_cast<size_t>(y) * rgb.rowBytes;
+
+        double t0 = emscripten_get_now();
+        avifResult res = avifImageYUVToRGB(source, &rgb);
+        timings_.yuvToRgb += emscripten_get_now() - t0;
+        timings_.libyuvEligible = libyuvEligible(source, rgb);
+        if (view)
+            avifImageDestroy(view);
+
+        if (res != AVIF_RESULT_OK)
+        {
+            error_ = std::string("YUV to RGB error: ") + avifResultToString(res);
+            return false;
+        }
+        return true;
+    }
+
+    StreamStatus status() const
+    {
+        StreamStatus st = {};
+        st.width = width_;
+        st.height = height_;
+        st.depth = outputDepth_;
+        st.channels = channels_;
+        st.rowsDecoded = rowsDecoded_;
+        // Only expose the buffer once something has been rendered into it
+        bool rendered = pixels_ && rowsDecoded_ > 0;
+        st.dataPtr = rendered ? reinterpret_cast<uintptr_t>(pixels_) : 0;
+        st.dataSize = rendered ? pixelsSize_ : 0;
+
+        if (!error_.empty())
+        {
+            st.state = "error";
+            st.error = error_;
+        }
+        else if (complete_)
+        {
+            st.state = "complete";
+        }
+        else
+        {
+            st.state = "needMoreInput";
+        }
+        return st;
+    }
+
+    avifDecoder *decoder_;
+    ChunkedIO *io_ = nullptr; // Owned by decoder_
+    int targetBitDepth_;
+    ConversionOptions conversion_;
+    bool parsed_ = false;
+    bool complete_ = false;
+    std::string error_;
+
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+    uint32_t channels_ = 0;
+    int outputDepth_ = 8;
+    uint32_t rowsDecoded_ = 0;
+    uint8_t *pixels_ = nullptr;
+    size_t pixelsSize_ = 0;
+    DecodeTimings timings_ = {};
+};
+
+EMSCRIPTEN_BINDINGS(avif_decoder)
+{
+    // Mastering display metadata
+    value_object<MasteringDisplay>("MasteringDisplay")
+        .field("redX", &MasteringDisplay::redX)
+        .field("redY", &MasteringDisplay::redY)
+        .field("greenX", &MasteringDisplay::greenX)
+        .field("greenY", &MasteringDisplay::greenY)
+        .field("blueX", &MasteringDisplay::blueX)
+        .field("blueY", &MasteringDisplay::blueY)
+        .field("whiteX", &MasteringDisplay::whiteX)
+        .field("whiteY", &MasteringDisplay::whiteY)
+        .field("minLuminance", &MasteringDisplay::minLuminance)
+        .field("maxLuminance", &MasteringDisplay::maxLuminance)
+        .field("present", &MasteringDisplay::present);
+
+    // Image metadata
+    value_object<ImageMetadata>("ImageMetadata")
+        .field("colorPrimaries", &ImageMetadata::colorPrimaries)
+        .field("transferFunction", &ImageMetadata::transferFunction)
+        .field("matrixCoefficients", &ImageMetadata::matrixCoefficients)
+        .field("fullRange", &ImageMetadata::fullRange)
+        .field("maxCLL", &ImageMetadata::maxCLL)
+        .field("maxPALL", &ImageMetadata::maxPALL)
+        .field("masteringDisplay", &ImageMetadata::masteringDisplay)
+        .field("iccProfilePtr", &ImageMetadata::iccProfilePtr)
+        .field("iccProfileSize", &ImageMetadata::iccProfileSize)
+        .field("isHDR", &ImageMetadata::isHDR);
+
+    value_object<CropRect>("CropRect")
+        .field("x", &CropRect::x)
+        .field("y", &CropRect::y)
+        .field("width", &CropRect::width)
+        .field("height", &CropRect::height);
+
+    // Decode result
+    value_object<DecodeResult>("DecodeResult")
+        .field("dataPtr", &DecodeResult::dataPtr)
+        .field("dataSize", &DecodeResult::dataSize)
+        .field("width", &DecodeResult::width)
+        .field("height", &DecodeResult::height)
         .field("depth", &DecodeResult::depth)
         .field("channels", &DecodeResult::channels)
         .field("metadata", &DecodeResult::metadata)
@@ -493,18 +1597,143 @@ EMSCRIPTEN_BINDINGS(avif_decoder)
         .field("height", &ImageInfo::height)
         .field("depth", &ImageInfo::depth)
         .field("channels", &ImageInfo::channels)
-        .field("metadata", &ImageInfo::metadata);
+        .field("metadata", &ImageInfo::metadata)
+        .field("error", &ImageInfo::error);
+
+    value_object<InfoProbe>("InfoProbe")
+        .field("complete", &InfoProbe::complete)
+        .field("bytesNeeded", &InfoProbe::bytesNeeded)
+        .field("info", &InfoProbe::info)
+        .field("error", &InfoProbe::error);
 
     value_object<DecodeTimings>("DecodeTimings")
         .field("io", &DecodeTimings::io)
         .field("parse", &DecodeTimings::parse)
         .field("decode", &DecodeTimings::decode)
         .field("yuvToRgb", &DecodeTimings::yuvToRgb)
-        .field("memcpy", &DecodeTimings::memcpy)
-        .field("total", &DecodeTimings::total);
+        .field("total", &DecodeTimings::total)
+        .field("libyuvEligible", &DecodeTimings::libyuvEligible);
+
+    value_object<ConversionOptions>("ConversionOptions")
+        .field("chromaUpsampling", &ConversionOptions::chromaUpsampling)
+        .field("avoidLibYUV", &ConversionOptions::avoidLibYUV);
+
+    value_object<SequenceInfo>("SequenceInfo")
+        .field("width", &SequenceInfo::width)
+        .field("height", &SequenceInfo::height)
+        .field("depth", &SequenceInfo::depth)
+        .field("channels", &SequenceInfo::channels)
+        .field("frameCount", &SequenceInfo::frameCount)
+        .field("timescale", &SequenceInfo::timescale)
+        .field("durationMs", &SequenceInfo::durationMs)
+        .field("repetitionCount", &SequenceInfo::repetitionCount)
+        .field("keyframeCount", &SequenceInfo::keyframeCount)
+        .field("metadata", &SequenceInfo::metadata)
+        .field("error", &SequenceInfo::error);
+
+    value_object<SequenceFrame>("SequenceFrame")
+        .field("dataPtr", &SequenceFrame::dataPtr)
+        .field("dataSize", &SequenceFrame::dataSize)
+        .field("index", &SequenceFrame::index)
+        .field("width", &SequenceFrame::width)
+        .field("height", &SequenceFrame::height)
+        .field("depth", &SequenceFrame::depth)
+        .field("channels", &SequenceFrame::channels)
+        .field("ptsMs", &SequenceFrame::ptsMs)
+        .field("durationMs", &SequenceFrame::durationMs)
+        .field("isKeyframe", &SequenceFrame::isKeyframe)
+        .field("done", &SequenceFrame::done)
+        .field("error", &SequenceFrame::error);
+
+    value_object<YuvPlane>("YuvPlane")
+        .field("offset", &YuvPlane::offset)
+        .field("width", &YuvPlane::width)
+        .field("height", &YuvPlane::height)
+        .field("stride", &YuvPlane::stride);
+
+    value_object<YuvDecodeResult>("YuvDecodeResult")
+        .field("dataPtr", &YuvDecodeResult::dataPtr)
+        .field("dataSize", &YuvDecodeResult::dataSize)
+        .field("width", &YuvDecodeResult::width)
+        .field("height", &YuvDecodeResult::height)
+        .field("depth", &YuvDecodeResult::depth)
+        .field("format", &YuvDecodeResult::format)
+        .field("chromaShiftX", &YuvDecodeResult::chromaShiftX)
+        .field("chromaShiftY", &YuvDecodeResult::chromaShiftY)
+        .field("chromaSamplePosition", &YuvDecodeResult::chromaSamplePosition)
+        .field("y", &YuvDecodeResult::y)
+        .field("u", &YuvDecodeResult::u)
+        .field("v", &YuvDecodeResult::v)
+        .field("alpha", &YuvDecodeResult::alpha)
+        .field("alphaPremultiplied", &YuvDecodeResult::alphaPremultiplied)
+        .field("metadata", &YuvDecodeResult::metadata)
+        .field("timings", &YuvDecodeResult::timings)
+        .field("error", &YuvDecodeResult::error);
 
     function("decode", &decode);
+    function("decodeYUV", &decodeYUV);
     function("getImageInfo", &getImageInfo);
+    function("probeImageInfo", &probeImageInfo);
+
+    // Image quality metrics (shared engine, see core/src/wasm/metrics.h)
+    value_object<metrics::MetricsInput>("MetricsInput")
+        .field("dataPtr", &metrics::MetricsInput::dataPtr)
+        .field("dataSize", &metrics::MetricsInput::dataSize)
+        .field("width", &metrics::MetricsInput::width)
+        .field("height", &metrics::MetricsInput::height)
+        .field("channels", &metrics::MetricsInput::channels)
+        .field("dataType", &metrics::MetricsInput::dataType)
+        .field("bitDepth", &metrics::MetricsInput::bitDepth);
+
+    value_object<metrics::MetricsOptions>("MetricsOptions")
+        .field("psnr", &metrics::MetricsOptions::psnr)
+        .field("ssim", &metrics::MetricsOptions::ssim)
+        .field("ssimulacra2", &metrics::MetricsOptions::ssimulacra2)
+        .field("downscale", &metrics::MetricsOptions::downscale);
+
+    value_object<metrics::MetricsResult>("MetricsResult")
+        .field("psnr", &metrics::MetricsResult::psnr)
+        .field("ssim", &metrics::MetricsResult::ssim)
+        .field("ssimulacra2", &metrics::MetricsResult::ssimulacra2)
+        .field("width", &metrics::MetricsResult::width)
+        .field("height", &metrics::MetricsResult::height)
+        .field("time", &metrics::MetricsResult::time)
+        .field("error", &metrics::MetricsResult::error);
+
+    function("compareImages", &metrics::compareImages);
+
+    class_<AvifDecoderSession>("AvifDecoderSession")
+        .constructor<int, double>()
+        .function("decode", &AvifDecoderSession::decode)
+        .function("getImageInfo", &AvifDecoderSession::getImageInfo)
+        .function("setThreadCount", &AvifDecoderSession::setThreadCount)
+        .function("getThreadCount", &AvifDecoderSession::getThreadCount);
+
+    class_<AvifSequenceDecoder>("AvifSequenceDecoder")
+        .constructor<uintptr_t, size_t, int, int, const ConversionOptions &>()
+        .function("getInfo", &AvifSequenceDecoder::getInfo)
+        .function("getKeyframes", &AvifSequenceDecoder::getKeyframes)
+        .function("nearestKeyframe", &AvifSequenceDecoder::nearestKeyframe)
+        .function("next", &AvifSequenceDecoder::next)
+        .function("seek", &AvifSequenceDecoder::seek)
+        .function("getFrameIndex", &AvifSequenceDecoder::getFrameIndex);
+
+    value_object<StreamStatus>("StreamStatus")
+        .field("state", &StreamStatus::state)
+        .field("width", &StreamStatus::width)
+        .field("height", &StreamStatus::height)
+        .field("depth", &StreamStatus::depth)
+        .field("channels", &StreamStatus::channels)
+        .field("rowsDecoded", &StreamStatus::rowsDecoded)
+        .field("dataPtr", &StreamStatus::dataPtr)
+        .field("dataSize", &StreamStatus::dataSize)
+        .field("error", &StreamStatus::error);
+
+    class_<AvifStreamingDecoder>("AvifStreamingDecoder")
+        .constructor<int, int, double, const ConversionOptions &>()
+        .function("push", &AvifStreamingDecoder::push)
+        .function("close", &AvifStreamingDecoder::close)
+        .function("takeResult", &AvifStreamingDecoder::takeResult);
 
     // Export max threads constant
     constant("MAX_THREADS", MAX_THREADS);
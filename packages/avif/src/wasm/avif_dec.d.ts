@@ -22,6 +22,35 @@ interface WasmModule {
 }
 
 type EmbindString = ArrayBuffer|Uint8Array|Uint8ClampedArray|Int8Array|string;
+export interface ClassHandle {
+  isAliasOf(other: ClassHandle): boolean;
+  delete(): void;
+  deleteLater(): this;
+  isDeleted(): boolean;
+  clone(): this;
+}
+export interface AvifDecoderSession extends ClassHandle {
+  decode(_0: number, _1: number, _2: number, _3: CropRect, _4: ConversionOptions): DecodeResult;
+  getImageInfo(_0: number, _1: number): ImageInfo;
+  setThreadCount(_0: number): void;
+  getThreadCount(): number;
+}
+
+export interface AvifSequenceDecoder extends ClassHandle {
+  getInfo(): SequenceInfo;
+  getKeyframes(): any;
+  nearestKeyframe(_0: number): number;
+  next(): SequenceFrame;
+  seek(_0: number): boolean;
+  getFrameIndex(): number;
+}
+
+export interface AvifStreamingDecoder extends ClassHandle {
+  push(_0: number, _1: number): StreamStatus;
+  close(): StreamStatus;
+  takeResult(): DecodeResult;
+}
+
 export type MasteringDisplay = {
   redX: number,
   redY: number,
@@ -41,8 +70,13 @@ export type DecodeTimings = {
   parse: number,
   decode: number,
   yuvToRgb: number,
-  memcpy: number,
-  total: number
+  total: number,
+  libyuvEligible: boolean
+};
+
+export type ConversionOptions = {
+  chromaUpsampling: EmbindString,
+  avoidLibYUV: boolean
 };
 
 export type ImageMetadata = {
@@ -63,7 +97,51 @@ export type ImageInfo = {
   height: number,
   depth: number,
   channels: number,
-  metadata: ImageMetadata
+  metadata: ImageMetadata,
+  error: EmbindString
+};
+
+export type InfoProbe = {
+  complete: boolean,
+  bytesNeeded: number,
+  info: ImageInfo,
+  error: EmbindString
+};
+
+export type CropRect = {
+  x: number,
+  y: number,
+  width: number,
+  height: number
+};
+
+export type SequenceInfo = {
+  width: number,
+  height: number,
+  depth: number,
+  channels: number,
+  frameCount: number,
+  timescale: number,
+  durationMs: number,
+  repetitionCount: number,
+  keyframeCount: number,
+  metadata: ImageMetadata,
+  error: EmbindString
+};
+
+export type SequenceFrame = {
+  dataPtr: number,
+  dataSize: number,
+  index: number,
+  width: number,
+  height: number,
+  depth: number,
+  channels: number,
+  ptsMs: number,
+  durationMs: number,
+  isKeyframe: boolean,
+  done: boolean,
+  error: EmbindString
 };
 
 export type DecodeResult = {
@@ -78,10 +156,88 @@ export type DecodeResult = {
   error: EmbindString
 };
 
+export type YuvPlane = {
+  offset: number,
+  width: number,
+  height: number,
+  stride: number
+};
+
+export type YuvDecodeResult = {
+  dataPtr: number,
+  dataSize: number,
+  width: number,
+  height: number,
+  depth: number,
+  format: EmbindString,
+  chromaShiftX: number,
+  chromaShiftY: number,
+  chromaSamplePosition: EmbindString,
+  y: YuvPlane,
+  u: YuvPlane,
+  v: YuvPlane,
+  alpha: YuvPlane,
+  alphaPremultiplied: boolean,
+  metadata: ImageMetadata,
+  timings: DecodeTimings,
+  error: EmbindString
+};
+
+export type StreamStatus = {
+  state: EmbindString,
+  width: number,
+  height: number,
+  depth: number,
+  channels: number,
+  rowsDecoded: number,
+  dataPtr: number,
+  dataSize: number,
+  error: EmbindString
+};
+
+export type MetricsInput = {
+  dataPtr: number,
+  dataSize: number,
+  width: number,
+  height: number,
+  channels: number,
+  dataType: EmbindString,
+  bitDepth: number
+};
+
+export type MetricsOptions = {
+  psnr: boolean,
+  ssim: boolean,
+  ssimulacra2: boolean,
+  downscale: number
+};
+
+export type MetricsResult = {
+  psnr: number,
+  ssim: number,
+  ssimulacra2: number,
+  width: number,
+  height: number,
+  time: number,
+  error: EmbindString
+};
+
 interface EmbindModule {
   MAX_THREADS: number;
   getImageInfo(_0: number, _1: number): ImageInfo;
-  decode(_0: number, _1: number, _2: number, _3: number): DecodeResult;
+  probeImageInfo(_0: number, _1: number, _2: boolean): InfoProbe;
+  decode(_0: number, _1: number, _2: number, _3: number, _4: CropRect, _5: ConversionOptions): DecodeResult;
+  decodeYUV(_0: number, _1: number, _2: number): YuvDecodeResult;
+  compareImages(_0: MetricsInput, _1: MetricsInput, _2: MetricsOptions): MetricsResult;
+  AvifDecoderSession: {
+    new(_0: number, _1: number): AvifDecoderSession;
+  };
+  AvifSequenceDecoder: {
+    new(_0: number, _1: number, _2: number, _3: number, _4: ConversionOptions): AvifSequenceDecoder;
+  };
+  AvifStreamingDecoder: {
+    new(_0: number, _1: number, _2: number, _3: ConversionOptions): AvifStreamingDecoder;
+  };
 }
 
 export type MainModule = WasmModule & typeof RuntimeExports & EmbindModule;
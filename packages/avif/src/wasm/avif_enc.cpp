@@ -2,7 +2,9 @@
 #include <emscripten/val.h>
 #include <emscripten.h>
 #include <avif/avif.h>
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <string>
 
@@ -29,6 +31,8 @@ struct EncodeOptions
     std::string colorSpace;       // "srgb", "display-p3", "rec2020"
     std::string transferFunction; // "srgb", "pq", "hlg", "linear"
     int maxThreads;               // Maximum threads to use
+    std::string chromaDownsampling; // "automatic", "fastest", "best-quality", "average", "sharp-yuv"
+    bool avoidLibYUV;               // Force libavif's built-in RGB->YUV path
 };
 
 struct EncodeTimings
@@ -36,6 +40,7 @@ struct EncodeTimings
     double rgbToYuv;
     double encode;
     double total;
+    bool libyuvEligible;  // Estimate: RGB->YUV was handed to libyuv (see libyuvEligible())
 };
 
 struct EncodeResult
@@ -98,91 +103,156 @@ avifMatrixCoefficients getMatrixCoefficients(const std::string &cs)
     return AVIF_MATRIX_COEFFICIENTS_BT709; // sRGB uses BT.709
 }
 
+// Inverse of the decoder's matrixToString. Unknown names return
+// AVIF_MATRIX_COEFFICIENTS_UNSPECIFIED.
+avifMatrixCoefficients parseMatrixCoefficients(const std::string &mc)
+{
+    if (mc == "identity")
+        return AVIF_MATRIX_COEFFICIENTS_IDENTITY;
+    if (mc == "bt709")
+        return AVIF_MATRIX_COEFFICIENTS_BT709;
+    if (mc == "fcc")
+        return AVIF_MATRIX_COEFFICIENTS_FCC;
+    if (mc == "bt470bg")
+        return AVIF_MATRIX_COEFFICIENTS_BT470BG;
+    if (mc == "bt601")
+        return AVIF_MATRIX_COEFFICIENTS_BT601;
+    if (mc == "smpte240")
+        return AVIF_MATRIX_COEFFICIENTS_SMPTE240;
+    if (mc == "ycgco")
+        return AVIF_MATRIX_COEFFICIENTS_YCGCO;
+    if (mc == "bt2020-ncl")
+        return AVIF_MATRIX_COEFFICIENTS_BT2020_NCL;
+    if (mc == "bt2020-cl")
+        return AVIF_MATRIX_COEFFICIENTS_BT2020_CL;
+    if (mc == "smpte2085")
+        return AVIF_MATRIX_COEFFICIENTS_SMPTE2085;
+    if (mc == "chroma-derived-ncl")
+        return AVIF_MATRIX_COEFFICIENTS_CHROMA_DERIVED_NCL;
+    if (mc == "chroma-derived-cl")
+        return AVIF_MATRIX_COEFFICIENTS_CHROMA_DERIVED_CL;
+    if (mc == "ictcp")
+        return AVIF_MATRIX_COEFFICIENTS_ICTCP;
+    return AVIF_MATRIX_COEFFICIENTS_UNSPECIFIED;
+}
+
 // ============================================================================
-// Main encode function
+// Shared encode helpers
 // ============================================================================
 
-EncodeResult encode(
-    uintptr_t pixelsPtr,
-    size_t pixelsSize,
-    uint32_t width,
-    uint32_t height,
-    uint32_t channels, // 3 (RGB) or 4 (RGBA)
-    int inputBitDepth, // 8 or 16
-    const EncodeOptions &options)
+// 444, 422, 420 or 400 to a pixel format; anything else is 4:2:0
+avifPixelFormat pixelFormatFromCode(int chromaSubsampling)
 {
-    double tStart = emscripten_get_now();
-    EncodeResult result;
-    result.dataPtr = 0;
-    result.dataSize = 0;
-    result.timings = {0, 0, 0};
-
-    const uint8_t *pixels = reinterpret_cast<const uint8_t *>(pixelsPtr);
-
-    if (pixels == nullptr || pixelsSize == 0 || width == 0 || height == 0)
-    {
-        result.error = "Invalid input: null pixels or zero dimensions";
-        return result;
-    }
-
-    // Validate channels
-    if (channels != 3 && channels != 4)
-    {
-        result.error = "Invalid channels: must be 3 (RGB) or 4 (RGBA)";
-        return result;
-    }
-
-    // Validate input size
-    int bytesPerChannel = inputBitDepth > 8 ? 2 : 1;
-    size_t expectedSize = width * height * channels * bytesPerChannel;
-    if (pixelsSize < expectedSize)
-    {
-        result.error = "Invalid input: pixel data too small";
-        return result;
-    }
-
-    // Determine pixel format
-    avifPixelFormat yuvFormat;
-    switch (options.chromaSubsampling)
+    switch (chromaSubsampling)
     {
     case 444:
-        yuvFormat = AVIF_PIXEL_FORMAT_YUV444;
-        break;
+        return AVIF_PIXEL_FORMAT_YUV444;
     case 422:
-        yuvFormat = AVIF_PIXEL_FORMAT_YUV422;
-        break;
+        return AVIF_PIXEL_FORMAT_YUV422;
     case 400:
-        yuvFormat = AVIF_PIXEL_FORMAT_YUV400;
-        break;
+        return AVIF_PIXEL_FORMAT_YUV400;
     default:
-        yuvFormat = AVIF_PIXEL_FORMAT_YUV420;
-        break;
+        return AVIF_PIXEL_FORMAT_YUV420;
     }
+}
 
+avifPixelFormat getYuvFormat(const EncodeOptions &options)
+{
     // Lossless requires 4:4:4
     if (options.lossless)
-    {
-        yuvFormat = AVIF_PIXEL_FORMAT_YUV444;
-    }
-
-    int outputDepth = options.bitDepth;
-    if (outputDepth < 8)
-        outputDepth = 8;
-    if (outputDepth > 12)
-        outputDepth = 12;
+        return AVIF_PIXEL_FORMAT_YUV444;
+    return pixelFormatFromCode(options.chromaSubsampling);
+}
 
-    avifImage *image = avifImageCreate(width, height, outputDepth, yuvFormat);
+// Create an image without planes, with the color properties from `options`
+avifImage *createImage(
+    uint32_t width,
+    uint32_t height,
+    int depth,
+    avifPixelFormat format,
+    const EncodeOptions &options)
+{
+    avifImage *image = avifImageCreate(width, height, depth, format);
     if (!image)
-    {
-        result.error = "Failed to create avifImage";
-        return result;
-    }
+        return nullptr;
 
     // Set color properties based on options
     image->colorPrimaries = getColorPrimaries(options.colorSpace);
     image->transferCharacteristics = getTransferCharacteristics(options.transferFunction, options.colorSpace);
     image->matrixCoefficients = getMatrixCoefficients(options.colorSpace);
     image->yuvRange = AVIF_RANGE_FULL;
+    return image;
+}
+
+// Create an empty YUV image with the depth and layout from `options`
+avifImage *createImage(uint32_t width, uint32_t height, const EncodeOptions &options)
+{
+    int outputDepth = options.bitDepth;
+    if (outputDepth < 8)
+        outputDepth = 8;
+    if (outputDepth > 12)
+        outputDepth = 12;
+
+    return createImage(width, height, outputDepth, getYuvFormat(options), options);
+}
+
+avifChromaDownsampling parseChromaDownsampling(const std::string &mode)
+{
+    if (mode == "fastest")
+        return AVIF_CHROMA_DOWNSAMPLING_FASTEST;
+    if (mode == "best-quality")
+        return AVIF_CHROMA_DOWNSAMPLING_BEST_QUALITY;
+    if (mode == "average")
+        return AVIF_CHROMA_DOWNSAMPLING_AVERAGE;
+    if (mode == "sharp-yuv")
+        return AVIF_CHROMA_DOWNSAMPLING_SHARP_YUV;
+    return AVIF_CHROMA_DOWNSAMPLING_AUTOMATIC;
+}
+
+// An estimate, not a report: libavif does not say which path
+// avifImageRGBToYUV took. True when the conversion falls in the cases
+// libavif 1.3 hands to libyuv: 8-bit RGB to 8-bit YUV, a BT.601 matrix
+// (libyuv has no RGB->YUV tables for other matrices, so BT.709 always
+// converts built-in) and automatic/fastest/average downsampling.
+bool libyuvEligible(const avifImage *image, const avifRGBImage &rgb)
+{
+    return avifLibYUVVersion() != 0 &&
+           !rgb.avoidLibYUV &&
+           rgb.depth == 8 &&
+           image->depth == 8 &&
+           (rgb.chromaDownsampling == AVIF_CHROMA_DOWNSAMPLING_AUTOMATIC ||
+            rgb.chromaDownsampling == AVIF_CHROMA_DOWNSAMPLING_FASTEST ||
+            rgb.chromaDownsampling == AVIF_CHROMA_DOWNSAMPLING_AVERAGE) &&
+           (image->matrixCoefficients == AVIF_MATRIX_COEFFICIENTS_BT601 ||
+            image->matrixCoefficients == AVIF_MATRIX_COEFFICIENTS_BT470BG);
+}
+
+// Validate interleaved RGB(A) input and convert it into `image`'s planes
+// (allocated on first use, reused afterwards). Returns an error message,
+// empty on success.
+std::string convertToYuv(
+    avifImage *image,
+    uintptr_t pixelsPtr,
+    size_t pixelsSize,
+    uint32_t channels,
+    int inputBitDepth,
+    const EncodeOptions &options,
+    EncodeTimings &timings)
+{
+    const uint8_t *pixels = reinterpret_cast<const uint8_t *>(pixelsPtr);
+
+    if (pixels == nullptr || pixelsSize == 0)
+        return "Invalid input: null pixels or zero dimensions";
+
+    // Validate channels
+    if (channels != 3 && channels != 4)
+        return "Invalid channels: must be 3 (RGB) or 4 (RGBA)";
+
+    // Validate input size
+    int bytesPerChannel = inputBitDepth > 8 ? 2 : 1;
+    size_t expectedSize = static_cast<size_t>(image->width) * image->height * channels * bytesPerChannel;
+    if (pixelsSize < expectedSize)
+        return "Invalid input: pixel data too small";
 
     // Setup RGB input
     avifRGBImage rgb;
@@ -191,31 +261,27 @@ EncodeResult encode(
     rgb.format = (channels == 4) ? AVIF_RGB_FORMAT_RGBA : AVIF_RGB_FORMAT_RGB;
     rgb.alphaPremultiplied = AVIF_FALSE;
     rgb.isFloat = AVIF_FALSE;
-    rgb.rowBytes = width * channels * bytesPerChannel;
+    rgb.chromaDownsampling = parseChromaDownsampling(options.chromaDownsampling);
+    rgb.avoidLibYUV = options.avoidLibYUV ? AVIF_TRUE : AVIF_FALSE;
+    rgb.rowBytes = image->width * channels * bytesPerChannel;
     rgb.pixels = const_cast<uint8_t *>(pixels);
 
+    if (rgb.chromaDownsampling == AVIF_CHROMA_DOWNSAMPLING_SHARP_YUV && avifLibSharpYUVVersion() == 0)
+        return "Sharp YUV downsampling is not available in this build";
+
     // Convert RGB to YUV
     double t0 = emscripten_get_now();
     avifResult res = avifImageRGBToYUV(image, &rgb);
-    result.timings.rgbToYuv = emscripten_get_now() - t0;
+    timings.rgbToYuv += emscripten_get_now() - t0;
+    timings.libyuvEligible = libyuvEligible(image, rgb);
 
     if (res != AVIF_RESULT_OK)
-    {
-        result.error = std::string("RGB to YUV error: ") + avifResultToString(res);
-        avifImageDestroy(image);
-        return result;
-    }
-
-    // Create encoder
-    avifEncoder *encoder = avifEncoderCreate();
-    if (!encoder)
-    {
-        result.error = "Failed to create encoder";
-        avifImageDestroy(image);
-        return result;
-    }
+        return std::string("RGB to YUV error: ") + avifResultToString(res);
+    return "";
+}
 
-    // Configure encoder
+void configureEncoder(avifEncoder *encoder, const EncodeOptions &options)
+{
     encoder->maxThreads = options.maxThreads;
     encoder->speed = options.speed;
 
@@ -240,45 +306,580 @@ EncodeResult encode(
         avifEncoderSetCodecSpecificOption(encoder, "tune", "psnr");
     }
     encoder->autoTiling = AVIF_TRUE;
+}
+
+// Copy encoder output to a malloc'd buffer for JS to read
+bool takeOutput(avifRWData &output, EncodeResult &result)
+{
+    uint8_t *outputBuffer = static_cast<uint8_t *>(malloc(output.size));
+    if (!outputBuffer)
+    {
+        result.error = "Failed to allocate output buffer";
+        return false;
+    }
+
+    std::memcpy(outputBuffer, output.data, output.size);
+    result.dataPtr = reinterpret_cast<uintptr_t>(outputBuffer);
+    result.dataSize = output.size;
+    return true;
+}
+
+// Encode a single still image into `result`
+void writeImage(const avifImage *image, const EncodeOptions &options, EncodeResult &result)
+{
+    avifEncoder *encoder = avifEncoderCreate();
+    if (!encoder)
+    {
+        result.error = "Failed to create encoder";
+        return;
+    }
+    configureEncoder(encoder, options);
 
-    // Encode
     avifRWData output = AVIF_DATA_EMPTY;
-    t0 = emscripten_get_now();
-    res = avifEncoderWrite(encoder, image, &output);
+    double t0 = emscripten_get_now();
+    avifResult res = avifEncoderWrite(encoder, image, &output);
     result.timings.encode = emscripten_get_now() - t0;
 
     if (res != AVIF_RESULT_OK)
     {
         result.error = std::string("Encode error: ") + avifResultToString(res);
-        avifRWDataFree(&output);
-        avifEncoderDestroy(encoder);
+    }
+    else
+    {
+        takeOutput(output, result);
+    }
+
+    avifRWDataFree(&output);
+    avifEncoderDestroy(encoder);
+}
+
+// ============================================================================
+// Main encode function
+// ============================================================================
+
+EncodeResult encode(
+    uintptr_t pixelsPtr,
+    size_t pixelsSize,
+    uint32_t width,
+    uint32_t height,
+    uint32_t channels, // 3 (RGB) or 4 (RGBA)
+    int inputBitDepth, // 8 or 16
+    const EncodeOptions &options)
+{
+    double tStart = emscripten_get_now();
+    EncodeResult result;
+    result.dataPtr = 0;
+    result.dataSize = 0;
+    result.timings = {0, 0, 0, false};
+
+    if (width == 0 || height == 0)
+    {
+        result.error = "Invalid input: null pixels or zero dimensions";
+        return result;
+    }
+
+    avifImage *image = createImage(width, height, options);
+    if (!image)
+    {
+        result.error = "Failed to create avifImage";
+        return result;
+    }
+
+    result.error = convertToYuv(image, pixelsPtr, pixelsSize, channels, inputBitDepth, options, result.timings);
+    if (!result.error.empty())
+    {
         avifImageDestroy(image);
         return result;
     }
 
-    // Copy output to malloc'd buffer for JS to read
-    uint8_t *outputBuffer = static_cast<uint8_t *>(malloc(output.size));
-    if (!outputBuffer)
+    writeImage(image, options, result);
+    avifImageDestroy(image);
+
+    result.timings.total = emscripten_get_now() - tStart;
+    return result;
+}
+
+// ============================================================================
+// Target file size
+// ============================================================================
+
+struct TargetSizeOptions
+{
+    double maxBytes;  // Size budget for the output file
+    int minQuality;   // Search range, 0-100
+    int maxQuality;
+    double tolerance; // Stop once within this fraction below maxBytes
+};
+
+struct TargetSizeResult
+{
+    uintptr_t dataPtr; // Pointer to encoded data (caller must free)
+    size_t dataSize;
+    int quality;       // Quality of the returned encode
+    int attempts;      // Number of candidate encodes
+    bool targetMet;    // false: even minQuality exceeds maxBytes
+    std::string error;
+    EncodeTimings timings;
+};
+
+// Make `candidate` the returned encode, dropping the previous one
+void keepCandidate(TargetSizeResult &result, EncodeResult &candidate, int quality)
+{
+    free(reinterpret_cast<void *>(result.dataPtr));
+    result.dataPtr = candidate.dataPtr;
+    result.dataSize = candidate.dataSize;
+    result.quality = quality;
+    candidate.dataPtr = 0;
+}
+
+// Binary search over quality for the best encode that fits in maxBytes.
+// RGB->YUV runs once and every candidate encodes the same avifImage, so a
+// search costs its encodes only. If even minQuality does not fit, that
+// (smallest) encode is returned with targetMet = false.
+TargetSizeResult encodeToSize(
+    uintptr_t pixelsPtr,
+    size_t pixelsSize,
+    uint32_t width,
+    uint32_t height,
+    uint32_t channels,
+    int inputBitDepth,
+    const EncodeOptions &options,
+    const TargetSizeOptions &target)
+{
+    double tStart = emscripten_get_now();
+    TargetSizeResult result = {};
+    result.timings = {0, 0, 0, false};
+
+    if (width == 0 || height == 0)
+    {
+        result.error = "Invalid input: null pixels or zero dimensions";
+        return result;
+    }
+    if (options.lossless)
+    {
+        result.error = "Target size requires lossy encoding";
+        return result;
+    }
+    if (!(target.maxBytes > 0))
+    {
+        result.error = "Invalid target size: must be greater than 0";
+        return result;
+    }
+
+    avifImage *image = createImage(width, height, options);
+    if (!image)
+    {
+        result.error = "Failed to create avifImage";
+        return result;
+    }
+
+    result.error = convertToYuv(image, pixelsPtr, pixelsSize, channels, inputBitDepth, options, result.timings);
+    if (!result.error.empty())
     {
-        result.error = "Failed to allocate output buffer";
-        avifRWDataFree(&output);
-        avifEncoderDestroy(encoder);
         avifImageDestroy(image);
         return result;
     }
 
-    std::memcpy(outputBuffer, output.data, output.size);
-    result.dataPtr = reinterpret_cast<uintptr_t>(outputBuffer);
-    result.dataSize = output.size;
+    int lo = std::max(0, std::min(target.minQuality, 100));
+    int hi = std::max(lo, std::min(target.maxQuality, 100));
+    double accept = target.maxBytes * (1.0 - std::max(0.0, target.tolerance));
+    EncodeOptions candidateOptions = options;
 
-    avifRWDataFree(&output);
-    avifEncoderDestroy(encoder);
+    while (lo <= hi)
+    {
+        int quality = lo + (hi - lo) / 2;
+        candidateOptions.quality = quality;
+
+        EncodeResult candidate = {};
+        candidate.timings = {0, 0, 0, false};
+        writeImage(image, candidateOptions, candidate);
+        result.attempts++;
+        result.timings.encode += candidate.timings.encode;
+        if (!candidate.error.empty())
+        {
+            result.error = candidate.error;
+            break;
+        }
+
+        if (candidate.dataSize <= target.maxBytes)
+        {
+            keepCandidate(result, candidate, quality);
+            result.targetMet = true;
+            if (candidate.dataSize >= accept)
+                break;
+            lo = quality + 1;
+        }
+        else
+        {
+            // Over budget: only worth keeping while nothing fits yet
+            if (!result.targetMet)
+                keepCandidate(result, candidate, quality);
+            hi = quality - 1;
+        }
+        free(reinterpret_cast<void *>(candidate.dataPtr));
+    }
+    avifImageDestroy(image);
+
+    if (!result.error.empty())
+    {
+        free(reinterpret_cast<void *>(result.dataPtr));
+        result.dataPtr = 0;
+        result.dataSize = 0;
+    }
+
+    result.timings.total = emscripten_get_now() - tStart;
+    return result;
+}
+
+// ============================================================================
+// Raw YUV input
+// ============================================================================
+
+// One input plane in the WASM heap; stride is in bytes. ptr 0 = absent.
+struct YuvPlaneInput
+{
+    uintptr_t ptr;
+    uint32_t stride;
+};
+
+struct YuvInput
+{
+    int format;  // 444, 422, 420, 400
+    int depth;   // 8, 10, 12; samples are uint16 above 8
+    std::string matrixCoefficients;  // Empty = derived from colorSpace
+    bool fullRange;
+    YuvPlaneInput y;
+    YuvPlaneInput u;
+    YuvPlaneInput v;
+    YuvPlaneInput alpha;
+    bool alphaPremultiplied;
+};
+
+// Encode Y/U/V(/A) planes as they are. The avifImage borrows the input
+// planes, so there is no RGB->YUV pass and no extra copy; the options'
+// chromaSubsampling and bitDepth are ignored in favour of `input`.
+EncodeResult encodeYUV(uint32_t width, uint32_t height, const YuvInput &input, const EncodeOptions &options)
+{
+    double tStart = emscripten_get_now();
+    EncodeResult result;
+    result.dataPtr = 0;
+    result.dataSize = 0;
+    result.timings = {0, 0, 0, false};
+
+    if (width == 0 || height == 0 || input.y.ptr == 0)
+    {
+        result.error = "Invalid input: null pixels or zero dimensions";
+        return result;
+    }
+    if (input.depth != 8 && input.depth != 10 && input.depth != 12)
+    {
+        result.error = "Invalid bit depth: must be 8, 10 or 12";
+        return result;
+    }
+
+    const avifPixelFormat format = pixelFormatFromCode(input.format);
+    const bool monochrome = format == AVIF_PIXEL_FORMAT_YUV400;
+    if (!monochrome && (input.u.ptr == 0 || input.v.ptr == 0))
+    {
+        result.error = "Invalid input: U and V planes are required";
+        return result;
+    }
+
+    avifImage *image = createImage(width, height, input.depth, format, options);
+    if (!image)
+    {
+        result.error = "Failed to create avifImage";
+        return result;
+    }
+    if (!input.matrixCoefficients.empty())
+        image->matrixCoefficients = parseMatrixCoefficients(input.matrixCoefficients);
+    image->yuvRange = input.fullRange ? AVIF_RANGE_FULL : AVIF_RANGE_LIMITED;
+    image->alphaPremultiplied = input.alphaPremultiplied ? AVIF_TRUE : AVIF_FALSE;
+
+    // Borrow the caller's planes; avifImageDestroy leaves them alone
+    const uint32_t bytesPerSample = input.depth > 8 ? 2 : 1;
+    const YuvPlaneInput *planes[] = {&input.y, &input.u, &input.v};
+    const int planeCount = monochrome ? 1 : 3;
+    for (int i = 0; i < planeCount; ++i)
+    {
+        const uint32_t minStride = avifImagePlaneWidth(image, i) * bytesPerSample;
+        if (planes[i]->stride < minStride)
+        {
+            result.error = "Invalid input: plane stride too small";
+            avifImageDestroy(image);
+            return result;
+        }
+        image->yuvPlanes[i] = reinterpret_cast<uint8_t *>(planes[i]->ptr);
+        image->yuvRowBytes[i] = planes[i]->stride;
+    }
+    image->imageOwnsYUVPlanes = AVIF_FALSE;
+
+    if (input.alpha.ptr != 0)
+    {
+        if (input.alpha.stride < width * bytesPerSample)
+        {
+            result.error = "Invalid input: plane stride too small";
+            avifImageDestroy(image);
+            return result;
+        }
+        image->alphaPlane = reinterpret_cast<uint8_t *>(input.alpha.ptr);
+        image->alphaRowBytes = input.alpha.stride;
+        image->imageOwnsAlphaPlane = AVIF_FALSE;
+    }
+
+    writeImage(image, options, result);
     avifImageDestroy(image);
 
     result.timings.total = emscripten_get_now() - tStart;
     return result;
 }
 
+// ============================================================================
+// Encoder session
+// ============================================================================
+
+// Encodes independent stills with one fixed configuration. libavif cannot
+// reuse an avifEncoder after avifEncoderFinish, so each image still gets a
+// fresh encoder (and aom context). What carries over is the YUV image: its
+// planes stay allocated while consecutive inputs share a shape. Images
+// below `singleThreadBelowPixels` encode on one thread, which avoids aom
+// worker startup on previews where it outweighs the encode itself.
+class AvifEncoderSession
+{
+public:
+    AvifEncoderSession(const EncodeOptions &options, uint32_t singleThreadBelowPixels)
+        : options_(options), singleThreadBelowPixels_(singleThreadBelowPixels)
+    {
+    }
+
+    ~AvifEncoderSession()
+    {
+        if (image_)
+            avifImageDestroy(image_);
+    }
+
+    AvifEncoderSession(const AvifEncoderSession &) = delete;
+    AvifEncoderSession &operator=(const AvifEncoderSession &) = delete;
+
+    EncodeResult encode(
+        uintptr_t pixelsPtr,
+        size_t pixelsSize,
+        uint32_t width,
+        uint32_t height,
+        uint32_t channels,
+        int inputBitDepth)
+    {
+        double tStart = emscripten_get_now();
+        EncodeResult result;
+        result.dataPtr = 0;
+        result.dataSize = 0;
+        result.timings = {0, 0, 0, false};
+
+        if (width == 0 || height == 0)
+        {
+            result.error = "Invalid input: null pixels or zero dimensions";
+            return result;
+        }
+
+        // A channel change would leave a stale alpha plane behind
+        if (!image_ || width != width_ || height != height_ || channels != channels_)
+        {
+            if (image_)
+                avifImageDestroy(image_);
+            image_ = createImage(width, height, options_);
+            if (!image_)
+            {
+                result.error = "Failed to create avifImage";
+                return result;
+            }
+            width_ = width;
+            height_ = height;
+            channels_ = channels;
+        }
+
+        result.error = convertToYuv(image_, pixelsPtr, pixelsSize, channels, inputBitDepth, options_, result.timings);
+        if (!result.error.empty())
+            return result;
+
+        EncodeOptions options = options_;
+        if (static_cast<uint64_t>(width) * height < singleThreadBelowPixels_)
+            options.maxThreads = 1;
+        writeImage(image_, options, result);
+
+        result.timings.total = emscripten_get_now() - tStart;
+        return result;
+    }
+
+private:
+    EncodeOptions options_;
+    uint32_t singleThreadBelowPixels_;
+    avifImage *image_ = nullptr;
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+    uint32_t channels_ = 0;
+};
+
+// ============================================================================
+// Image sequences (animated AVIF)
+// ============================================================================
+
+struct SequenceOptions
+{
+    uint32_t timescale;   // Ticks per second for frame durations
+    int keyframeInterval; // Max frames between keyframes, 0 = encoder decides
+    int repetitionCount;  // -1 = loop forever, otherwise number of repeats
+};
+
+// Keeps one avifEncoder (and its AV1 codec state) alive across frames so
+// later frames are inter-predicted from earlier ones. All frames share the
+// dimensions, layout and color properties given to the constructor.
+class AvifSequenceEncoder
+{
+public:
+    AvifSequenceEncoder(
+        uint32_t width,
+        uint32_t height,
+        uint32_t channels,
+        int inputBitDepth,
+        const EncodeOptions &options,
+        const SequenceOptions &sequence)
+        : options_(options), channels_(channels), inputBitDepth_(inputBitDepth)
+    {
+        timings_ = {0, 0, 0, false};
+
+        if (width == 0 || height == 0)
+        {
+            error_ = "Invalid input: zero dimensions";
+            return;
+        }
+        if (sequence.timescale == 0)
+        {
+            error_ = "Invalid timescale: must be greater than 0";
+            return;
+        }
+
+        image_ = createImage(width, height, options);
+        if (!image_)
+        {
+            error_ = "Failed to create avifImage";
+            return;
+        }
+
+        encoder_ = avifEncoderCreate();
+        if (!encoder_)
+        {
+            error_ = "Failed to create encoder";
+            return;
+        }
+        configureEncoder(encoder_, options);
+        encoder_->timescale = sequence.timescale;
+        encoder_->keyframeInterval = sequence.keyframeInterval;
+        encoder_->repetitionCount = sequence.repetitionCount;
+    }
+
+    ~AvifSequenceEncoder()
+    {
+        if (encoder_)
+            avifEncoderDestroy(encoder_);
+        if (image_)
+            avifImageDestroy(image_);
+    }
+
+    AvifSequenceEncoder(const AvifSequenceEncoder &) = delete;
+    AvifSequenceEncoder &operator=(const AvifSequenceEncoder &) = delete;
+
+    std::string getError() const { return error_; }
+
+    int getFrameCount() const { return frameCount_; }
+
+    // Returns an error message, empty on success
+    std::string addFrame(uintptr_t pixelsPtr, size_t pixelsSize, uint32_t durationInTimescales, bool forceKeyframe)
+    {
+        if (!error_.empty())
+            return error_;
+        if (finished_)
+            return "Sequence already finished";
+        if (durationInTimescales == 0)
+            return "Invalid duration: must be greater than 0";
+
+        std::string err = convertToYuv(image_, pixelsPtr, pixelsSize, channels_, inputBitDepth_, options_, timings_);
+        if (!err.empty())
+            return err;
+
+        avifAddImageFlags flags = forceKeyframe ? AVIF_ADD_IMAGE_FLAG_FORCE_KEYFRAME : AVIF_ADD_IMAGE_FLAG_NONE;
+        double t0 = emscripten_get_now();
+        avifResult res = avifEncoderAddImage(encoder_, image_, durationInTimescales, flags);
+        timings_.encode += emscripten_get_now() - t0;
+
+        // libavif may already hold part of the frame (colour without
+        // alpha), so the sequence can't continue
+        if (res != AVIF_RESULT_OK)
+        {
+            error_ = std::string("Encode error: ") + avifResultToString(res);
+            return error_;
+        }
+
+        frameCount_++;
+        return "";
+    }
+
+    // Flush the codec and write the container. The encoder can't take more
+    // frames afterwards.
+    EncodeResult finish()
+    {
+        EncodeResult result;
+        result.dataPtr = 0;
+        result.dataSize = 0;
+        result.timings = timings_;
+
+        if (!error_.empty())
+        {
+            result.error = error_;
+            return result;
+        }
+        if (finished_)
+        {
+            result.error = "Sequence already finished";
+            return result;
+        }
+        if (frameCount_ == 0)
+        {
+            result.error = "No frames added";
+            return result;
+        }
+        finished_ = true;
+
+        avifRWData output = AVIF_DATA_EMPTY;
+        double t0 = emscripten_get_now();
+        avifResult res = avifEncoderFinish(encoder_, &output);
+        result.timings.encode += emscripten_get_now() - t0;
+
+        if (res != AVIF_RESULT_OK)
+        {
+            result.error = std::string("Encode error: ") + avifResultToString(res);
+        }
+        else
+        {
+            takeOutput(output, result);
+        }
+        avifRWDataFree(&output);
+
+        result.timings.total = result.timings.rgbToYuv + result.timings.encode;
+        return result;
+    }
+
+private:
+    avifEncoder *encoder_ = nullptr;
+    avifImage *image_ = nullptr;
+    EncodeOptions options_;
+    uint32_t channels_;
+    int inputBitDepth_;
+    int frameCount_ = 0;
+    bool finished_ = false;
+    EncodeTimings timings_;
+    std::string error_;
+};
+
 // ============================================================================
 // Emscripten bindings
 // ============================================================================
@@ -295,12 +896,15 @@ EMSCRIPTEN_BINDINGS(avif_encoder)
         .field("bitDepth", &EncodeOptions::bitDepth)
         .field("colorSpace", &EncodeOptions::colorSpace)
         .field("transferFunction", &EncodeOptions::transferFunction)
-        .field("maxThreads", &EncodeOptions::maxThreads);
+        .field("maxThreads", &EncodeOptions::maxThreads)
+        .field("chromaDownsampling", &EncodeOptions::chromaDownsampling)
+        .field("avoidLibYUV", &EncodeOptions::avoidLibYUV);
 
     value_object<EncodeTimings>("EncodeTimings")
         .field("rgbToYuv", &EncodeTimings::rgbToYuv)
         .field("encode", &EncodeTimings::encode)
-        .field("total", &EncodeTimings::total);
+        .field("total", &EncodeTimings::total)
+        .field("libyuvEligible", &EncodeTimings::libyuvEligible);
 
     value_object<EncodeResult>("EncodeResult")
         .field("dataPtr", &EncodeResult::dataPtr)
@@ -310,6 +914,56 @@ EMSCRIPTEN_BINDINGS(avif_encoder)
 
     function("encode", &encode);
 
+    value_object<TargetSizeOptions>("TargetSizeOptions")
+        .field("maxBytes", &TargetSizeOptions::maxBytes)
+        .field("minQuality", &TargetSizeOptions::minQuality)
+        .field("maxQuality", &TargetSizeOptions::maxQuality)
+        .field("tolerance", &TargetSizeOptions::tolerance);
+
+    value_object<TargetSizeResult>("TargetSizeResult")
+        .field("dataPtr", &TargetSizeResult::dataPtr)
+        .field("dataSize", &TargetSizeResult::dataSize)
+        .field("quality", &TargetSizeResult::quality)
+        .field("attempts", &TargetSizeResult::attempts)
+        .field("targetMet", &TargetSizeResult::targetMet)
+        .field("error", &TargetSizeResult::error)
+        .field("timings", &TargetSizeResult::timings);
+
+    function("encodeToSize", &encodeToSize);
+
+    value_object<YuvPlaneInput>("YuvPlaneInput")
+        .field("ptr", &YuvPlaneInput::ptr)
+        .field("stride", &YuvPlaneInput::stride);
+
+    value_object<YuvInput>("YuvInput")
+        .field("format", &YuvInput::format)
+        .field("depth", &YuvInput::depth)
+        .field("matrixCoefficients", &YuvInput::matrixCoefficients)
+        .field("fullRange", &YuvInput::fullRange)
+        .field("y", &YuvInput::y)
+        .field("u", &YuvInput::u)
+        .field("v", &YuvInput::v)
+        .field("alpha", &YuvInput::alpha)
+        .field("alphaPremultiplied", &YuvInput::alphaPremultiplied);
+
+    function("encodeYUV", &encodeYUV);
+
+    class_<AvifEncoderSession>("AvifEncoderSession")
+        .constructor<const EncodeOptions &, uint32_t>()
+        .function("encode", &AvifEncoderSession::encode);
+
+    value_object<SequenceOptions>("SequenceOptions")
+        .field("timescale", &SequenceOptions::timescale)
+        .field("keyframeInterval", &SequenceOptions::keyframeInterval)
+        .field("repetitionCount", &SequenceOptions::repetitionCount);
+
+    class_<AvifSequenceEncoder>("AvifSequenceEncoder")
+        .constructor<uint32_t, uint32_t, uint32_t, int, const EncodeOptions &, const SequenceOptions &>()
+        .function("getError", &AvifSequenceEncoder::getError)
+        .function("getFrameCount", &AvifSequenceEncoder::getFrameCount)
+        .function("addFrame", &AvifSequenceEncoder::addFrame)
+        .function("finish", &AvifSequenceEncoder::finish);
+
     // Export max threads constant
     constant("MAX_THREADS", MAX_THREADS);
 }
@@ -22,10 +22,29 @@ interface WasmModule {
 }
 
 type EmbindString = ArrayBuffer|Uint8Array|Uint8ClampedArray|Int8Array|string;
+export interface ClassHandle {
+  isAliasOf(other: ClassHandle): boolean;
+  delete(): void;
+  deleteLater(): this;
+  isDeleted(): boolean;
+  clone(): this;
+}
+export interface AvifEncoderSession extends ClassHandle {
+  encode(_0: number, _1: number, _2: number, _3: number, _4: number, _5: number): EncodeResult;
+}
+
+export interface AvifSequenceEncoder extends ClassHandle {
+  getFrameCount(): number;
+  getError(): string;
+  addFrame(_0: number, _1: number, _2: number, _3: boolean): string;
+  finish(): EncodeResult;
+}
+
 export type EncodeTimings = {
   rgbToYuv: number,
   encode: number,
-  total: number
+  total: number,
+  libyuvEligible: boolean
 };
 
 export type EncodeOptions = {
@@ -38,7 +57,32 @@ export type EncodeOptions = {
   bitDepth: number,
   colorSpace: EmbindString,
   transferFunction: EmbindString,
-  maxThreads: number
+  maxThreads: number,
+  chromaDownsampling: EmbindString,
+  avoidLibYUV: boolean
+};
+
+export type YuvPlaneInput = {
+  ptr: number,
+  stride: number
+};
+
+export type YuvInput = {
+  format: number,
+  depth: number,
+  matrixCoefficients: EmbindString,
+  fullRange: boolean,
+  y: YuvPlaneInput,
+  u: YuvPlaneInput,
+  v: YuvPlaneInput,
+  alpha: YuvPlaneInput,
+  alphaPremultiplied: boolean
+};
+
+export type SequenceOptions = {
+  timescale: number,
+  keyframeInterval: number,
+  repetitionCount: number
 };
 
 export type EncodeResult = {
@@ -48,9 +92,34 @@ export type EncodeResult = {
   timings: EncodeTimings
 };
 
+export type TargetSizeOptions = {
+  maxBytes: number,
+  minQuality: number,
+  maxQuality: number,
+  tolerance: number
+};
+
+export type TargetSizeResult = {
+  dataPtr: number,
+  dataSize: number,
+  quality: number,
+  attempts: number,
+  targetMet: boolean,
+  error: EmbindString,
+  timings: EncodeTimings
+};
+
 interface EmbindModule {
   MAX_THREADS: number;
   encode(_0: number, _1: number, _2: number, _3: number, _4: number, _5: number, _6: EncodeOptions): EncodeResult;
+  encodeToSize(_0: number, _1: number, _2: number, _3: number, _4: number, _5: number, _6: EncodeOptions, _7: TargetSizeOptions): TargetSizeResult;
+  encodeYUV(_0: number, _1: number, _2: YuvInput, _3: EncodeOptions): EncodeResult;
+  AvifEncoderSession: {
+    new(_0: EncodeOptions, _1: number): AvifEncoderSession;
+  };
+  AvifSequenceEncoder: {
+    new(_0: number, _1: number, _2: number, _3: number, _4: EncodeOptions, _5: SequenceOptions): AvifSequenceEncoder;
+  };
 }
 
 export type MainModule = WasmModule & typeof RuntimeExports & EmbindModule;
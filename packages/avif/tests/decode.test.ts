@@ -6,7 +6,18 @@
  */
 
 import { describe, it, expect, beforeAll } from "vitest";
-import { decode, getImageInfo, initDecoder } from "@dimkatet/jcodecs-avif";
+import {
+  decode,
+  decodeYUV,
+  decodeSequence,
+  decodeStream,
+  createStreamingDecoder,
+  getImageInfo,
+  probeImageInfo,
+  getImageInfoFromRanges,
+  createDecoderSession,
+  initDecoder,
+} from "@dimkatet/jcodecs-avif";
 import type { AVIFImageData, AVIFImageInfo } from "@dimkatet/jcodecs-avif";
 
 async function loadFixture(filename: string): Promise<Uint8Array> {
@@ -208,6 +219,256 @@ describe("AVIF Decoder", () => {
     });
   });
 
+  describe("crop", () => {
+    it("should match the same region of a full decode", async () => {
+      const data = await loadFixture("colors_sdr_srgb.avif");
+      const full = await decode(data);
+      // Odd origin exercises chroma alignment for subsampled images
+      const crop = { x: 3, y: 5, width: 10, height: 7 };
+      const region = await decode(data, { crop });
+
+      expect(region.width).toBe(crop.width);
+      expect(region.height).toBe(crop.height);
+      expect(region.data.length).toBe(crop.width * crop.height * full.channels);
+
+      const ch = full.channels;
+      for (let row = 0; row < crop.height; row++) {
+        const start = ((crop.y + row) * full.width + crop.x) * ch;
+        expect(region.data.subarray(row * crop.width * ch, (row + 1) * crop.width * ch))
+          .toEqual(full.data.subarray(start, start + crop.width * ch));
+      }
+    });
+
+    it("should clip to the image and reject rects outside it", async () => {
+      const data = await loadFixture("colors_sdr_srgb.avif");
+      const info = await getImageInfo(data);
+
+      const clipped = await decode(data, {
+        crop: { x: info.width - 4, y: 0, width: 100, height: 2 },
+      });
+      expect(clipped.width).toBe(4);
+      expect(clipped.height).toBe(2);
+
+      await expect(
+        decode(data, { crop: { x: info.width, y: 0, width: 1, height: 1 } }),
+      ).rejects.toThrow();
+    });
+  });
+
+  describe("sequence decoder", () => {
+    it("should expose a still image as a one-frame sequence", async () => {
+      const data = await loadFixture("colors_sdr_srgb.avif");
+      const reference = await decode(data);
+      const sequence = await decodeSequence(data);
+      try {
+        expect(sequence.info.frameCount).toBe(1);
+        expect(sequence.info.keyframes).toEqual([0]);
+        expect(sequence.info.width).toBe(reference.width);
+
+        const frame = sequence.next();
+        expect(frame).not.toBeNull();
+        expect(frame!.index).toBe(0);
+        expect(frame!.isKeyframe).toBe(true);
+        expect(frame!.data).toEqual(reference.data);
+        expect(sequence.next()).toBeNull();
+      } finally {
+        sequence.dispose();
+      }
+    });
+
+    it("should seek back and reject out-of-range frames", async () => {
+      const data = await loadFixture("colors_sdr_srgb.avif");
+      const sequence = await decodeSequence(data);
+      try {
+        expect([...sequence]).toHaveLength(1);
+        sequence.seek(0);
+        expect(sequence.position).toBe(0);
+        expect(sequence.next()).not.toBeNull();
+        expect(() => sequence.seek(1)).toThrow(RangeError);
+      } finally {
+        sequence.dispose();
+      }
+    });
+  });
+
+  describe("chroma upsampling", () => {
+    it("should decode with every upsampling mode", async () => {
+      const data = await loadFixture("colors_sdr_srgb.avif");
+      const reference = await decode(data);
+
+      for (const chromaUpsampling of ["fastest", "best-quality", "nearest", "bilinear"] as const) {
+        const result = await decode(data, { chromaUpsampling });
+        expect(result.width).toBe(reference.width);
+        expect(result.height).toBe(reference.height);
+        expect(result.data.length).toBe(reference.data.length);
+      }
+    });
+
+    it("should match closely with and without libyuv", async () => {
+      const data = await loadFixture("colors_sdr_srgb.avif");
+      const withLibYUV = await decode(data, { bitDepth: 8 });
+      const builtIn = await decode(data, { bitDepth: 8, avoidLibYUV: true });
+
+      expect(builtIn.data.length).toBe(withLibYUV.data.length);
+      let maxDiff = 0;
+      for (let i = 0; i < builtIn.data.length; i++) {
+        maxDiff = Math.max(maxDiff, Math.abs(builtIn.data[i] - withLibYUV.data[i]));
+      }
+      expect(maxDiff).toBeLessThanOrEqual(8);
+    });
+  });
+
+  describe("YUV output", () => {
+    it("should return planes matching the RGB decode", async () => {
+      const data = await loadFixture("colors_sdr_srgb.avif");
+      const rgb = await decode(data);
+      const yuv = await decodeYUV(data);
+
+      expect(yuv.width).toBe(rgb.width);
+      expect(yuv.height).toBe(rgb.height);
+      expect(yuv.bitDepth).toBe(rgb.bitDepth);
+      expect(yuv.metadata.matrixCoefficients).toBe(rgb.metadata.matrixCoefficients);
+      expect(yuv.metadata.fullRange).toBe(rgb.metadata.fullRange);
+
+      expect(yuv.y.width).toBe(yuv.width);
+      expect(yuv.y.height).toBe(yuv.height);
+      expect(yuv.y.data.length).toBe(yuv.y.stride * yuv.y.height);
+
+      if (yuv.format !== "4:0:0") {
+        const chromaWidth = (yuv.width + yuv.chromaShiftX) >> yuv.chromaShiftX;
+        const chromaHeight = (yuv.height + yuv.chromaShiftY) >> yuv.chromaShiftY;
+        expect(yuv.u!.width).toBe(chromaWidth);
+        expect(yuv.u!.height).toBe(chromaHeight);
+        expect(yuv.v!.data.length).toBe(chromaWidth * chromaHeight);
+      }
+      expect(yuv.alpha !== undefined).toBe(rgb.channels === 4);
+    });
+  });
+
+  describe("decoder session", () => {
+    it("should decode several images with one session", async () => {
+      const session = await createDecoderSession();
+      try {
+        for (const name of ["colors_sdr_srgb.avif", "colors_hdr_p3.avif", "colors_hdr_rec2020.avif"]) {
+          const data = await loadFixture(name);
+          const result = session.decode(data);
+          const reference = await decode(data);
+
+          expect(result.width).toBe(reference.width);
+          expect(result.height).toBe(reference.height);
+          expect(result.bitDepth).toBe(reference.bitDepth);
+          expect(result.data).toEqual(reference.data);
+        }
+      } finally {
+        session.dispose();
+      }
+    });
+
+    it("should match one-shot getImageInfo", async () => {
+      const data = await loadFixture("colors_hdr_p3.avif");
+      const session = await createDecoderSession({ singleThreadBelow: 0 });
+      try {
+        const info = session.getImageInfo(data);
+        const reference = await getImageInfo(data);
+
+        expect(info.width).toBe(reference.width);
+        expect(info.bitDepth).toBe(reference.bitDepth);
+        expect(info.metadata.colorPrimaries).toBe(reference.metadata.colorPrimaries);
+      } finally {
+        session.dispose();
+      }
+    });
+
+    it("should throw on invalid data in getImageInfo", async () => {
+      const session = await createDecoderSession();
+      try {
+        expect(() => session.getImageInfo(new Uint8Array([0, 1, 2, 3, 4, 5]))).toThrow(/AVIF decode error/);
+        // The session stays usable
+        const info = session.getImageInfo(await loadFixture("colors_sdr_srgb.avif"));
+        expect(info.width).toBeGreaterThan(0);
+      } finally {
+        session.dispose();
+      }
+    });
+
+    it("should throw after dispose", async () => {
+      const session = await createDecoderSession();
+      session.dispose();
+      expect(() => session.decode(new Uint8Array(8))).toThrow();
+    });
+  });
+
+  describe("header probing", () => {
+    it("should ask for more bytes when the prefix is too short", async () => {
+      const data = await loadFixture("colors_sdr_srgb.avif");
+      const probe = await probeImageInfo(data.subarray(0, 16));
+
+      expect(probe.info).toBeNull();
+      expect(probe.bytesNeeded).toBeGreaterThan(16);
+    });
+
+    it("should read info from a prefix through range reads", async () => {
+      const data = await loadFixture("colors_sdr_srgb.avif");
+      const reference = await getImageInfo(data);
+      let bytesRead = 0;
+      const info = await getImageInfoFromRanges(
+        async (start, end) => {
+          const range = data.slice(start, end);
+          bytesRead += range.length;
+          return range;
+        },
+        { initialBytes: 32 },
+      );
+
+      expect(info.width).toBe(reference.width);
+      expect(info.height).toBe(reference.height);
+      expect(info.bitDepth).toBe(reference.bitDepth);
+      expect(bytesRead).toBeLessThan(data.length);
+    });
+  });
+
+  describe("streaming decode", () => {
+    async function* chunked(data: Uint8Array, size: number) {
+      for (let i = 0; i < data.length; i += size) {
+        yield data.subarray(i, i + size);
+      }
+    }
+
+    it("should decode a stream of chunks to the same pixels", async () => {
+      const data = await loadFixture("colors_sdr_srgb.avif");
+      const reference = await decode(data);
+      const result = await decodeStream(chunked(data, 97), { totalSize: data.length });
+
+      expect(result.width).toBe(reference.width);
+      expect(result.height).toBe(reference.height);
+      expect(result.channels).toBe(reference.channels);
+      expect(result.data).toEqual(reference.data);
+    });
+
+    it("should wait for more input instead of failing", async () => {
+      const data = await loadFixture("colors_sdr_srgb.avif");
+      const decoder = await createStreamingDecoder();
+      try {
+        expect(decoder.push(data.subarray(0, 16)).state).toBe("needMoreInput");
+        expect(decoder.push(data.subarray(16)).state).toBe("complete");
+        expect(decoder.result().width).toBeGreaterThan(0);
+      } finally {
+        decoder.dispose();
+      }
+    });
+
+    it("should fail on truncated input after close", async () => {
+      const data = await loadFixture("colors_sdr_srgb.avif");
+      const decoder = await createStreamingDecoder();
+      try {
+        expect(decoder.push(data.subarray(0, data.length >> 1)).state).not.toBe("complete");
+        expect(() => decoder.close()).toThrow();
+      } finally {
+        decoder.dispose();
+      }
+    });
+  });
+
   describe("error handling", () => {
     it("should throw error for invalid AVIF data", async () => {
       const invalidData = new Uint8Array([0, 1, 2, 3, 4, 5]);
@@ -220,6 +481,12 @@ describe("AVIF Decoder", () => {
 
       await expect(decode(emptyData)).rejects.toThrow();
     });
+
+    it("should throw error for invalid data in getImageInfo", async () => {
+      const invalidData = new Uint8Array([0, 1, 2, 3, 4, 5]);
+
+      await expect(getImageInfo(invalidData)).rejects.toThrow();
+    });
   });
 
   describe("pixel data integrity", () => {
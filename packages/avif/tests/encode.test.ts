@@ -9,7 +9,15 @@ import { describe, it, expect, beforeAll } from "vitest";
 import {
   encode,
   encodeSimple,
+  encodeYUV,
+  encodeToSize,
   decode,
+  compareImages,
+  decodeAndCompare,
+  decodeYUV,
+  decodeSequence,
+  createSequenceEncoder,
+  createEncoderSession,
   initEncoder,
   initDecoder,
   isEncoderInitialized,
@@ -324,6 +332,296 @@ describe("AVIF Encoder", () => {
     });
   });
 
+  describe("sequence encoding", () => {
+    it("should encode frames that decode back with timing", async () => {
+      const encoder = await createSequenceEncoder({
+        speed: 10,
+        keyframeInterval: 2,
+        repetitionCount: 0,
+      });
+      const colors = [
+        [255, 0, 0],
+        [0, 255, 0],
+        [0, 0, 255],
+      ];
+      for (const [r, g, b] of colors) {
+        encoder.addFrame(createSolidColorImageData(32, 32, r, g, b), {
+          duration: 100,
+        });
+      }
+      expect(encoder.frameCount).toBe(3);
+      const encoded = encoder.finish();
+
+      const sequence = await decodeSequence(encoded);
+      try {
+        expect(sequence.info.frameCount).toBe(3);
+        expect(sequence.info.timescale).toBe(1000);
+        expect(sequence.info.durationMs).toBeCloseTo(300);
+        expect(sequence.info.repetitionCount).toBe(0);
+        expect(sequence.info.keyframes).toContain(2);
+
+        sequence.seek(2);
+        const frame = sequence.next()!;
+        expect(frame.ptsMs).toBeCloseTo(200);
+        expect(Math.abs(frame.data[2] - 255)).toBeLessThan(20);
+      } finally {
+        sequence.dispose();
+      }
+    });
+
+    it("should keep going after a rejected frame duration", async () => {
+      const encoder = await createSequenceEncoder({ speed: 10 });
+      const frame = createTestImageData(16, 16);
+      expect(() => encoder.addFrame(frame, { duration: 0 })).toThrow(/Invalid duration/);
+
+      encoder.addFrame(frame, { duration: 40 });
+      const sequence = await decodeSequence(encoder.finish());
+      try {
+        expect(sequence.info.frameCount).toBe(1);
+      } finally {
+        sequence.dispose();
+      }
+    });
+
+    it("should stop the sequence once the codec rejects a frame", async () => {
+      // Wider than AV1 can code, so only avifEncoderAddImage fails
+      const encoder = await createSequenceEncoder({ speed: 10 });
+      const frame = createTestImageData(65537, 1);
+      expect(() => encoder.addFrame(frame, { duration: 40 })).toThrow(/Encode error/);
+
+      // Later calls report the same failure instead of continuing
+      expect(() => encoder.addFrame(frame, { duration: 40 })).toThrow(/Encode error/);
+      expect(encoder.frameCount).toBe(0);
+      expect(() => encoder.finish()).toThrow(/Encode error/);
+    });
+
+    it("should reject frames with a different size", async () => {
+      const encoder = await createSequenceEncoder();
+      try {
+        encoder.addFrame(createTestImageData(16, 16), { duration: 40 });
+        expect(() =>
+          encoder.addFrame(createTestImageData(8, 8), { duration: 40 }),
+        ).toThrow(/does not match/);
+      } finally {
+        encoder.dispose();
+      }
+    });
+  });
+
+  describe("encoder session", () => {
+    it("should encode several images with one session", async () => {
+      const session = await createEncoderSession({ quality: 60, speed: 9 });
+      try {
+        for (const [width, height] of [[32, 32], [32, 32], [48, 16]]) {
+          const encoded = session.encode(createTestImageData(width, height));
+          const decoded = await decode(encoded);
+
+          expect(decoded.width).toBe(width);
+          expect(decoded.height).toBe(height);
+        }
+      } finally {
+        session.dispose();
+      }
+    });
+
+    it("should match one-shot encode", async () => {
+      const imageData = createTestImageData(40, 40);
+      const session = await createEncoderSession({ quality: 80, speed: 8, maxThreads: 1 });
+      try {
+        const fromSession = session.encode(imageData);
+        const reference = await encode(imageData, { quality: 80, speed: 8, maxThreads: 1 });
+        expect(fromSession).toEqual(reference);
+      } finally {
+        session.dispose();
+      }
+    });
+
+    it("should drop alpha when switching from RGBA to RGB input", async () => {
+      const session = await createEncoderSession();
+      try {
+        session.encode(createTestImageData(16, 16));
+        const rgb: AVIFImageData = {
+          data: new Uint8Array(16 * 16 * 3).fill(100),
+          dataType: "uint8",
+          width: 16,
+          height: 16,
+          channels: 3,
+          bitDepth: 8,
+          metadata: DEFAULT_SRGB_METADATA,
+        };
+        const decoded = await decode(session.encode(rgb));
+        expect(decoded.channels).toBe(3);
+      } finally {
+        session.dispose();
+      }
+    });
+
+    it("should throw after dispose", async () => {
+      const session = await createEncoderSession();
+      session.dispose();
+      expect(() => session.encode(createTestImageData(8, 8))).toThrow();
+    });
+  });
+
+  describe("target size", () => {
+    it("should return the best quality that fits the budget", async () => {
+      const imageData = createTestImageData(128, 128);
+      const options = { speed: 9, maxThreads: 1 };
+      const budget = (await encode(imageData, { ...options, quality: 60 })).length;
+
+      const result = await encodeToSize(imageData, { ...options, maxBytes: budget });
+
+      expect(result.targetMet).toBe(true);
+      expect(result.data.length).toBeLessThanOrEqual(budget);
+      expect(result.attempts).toBeGreaterThan(0);
+      expect(result.data).toEqual(await encode(imageData, { ...options, quality: result.quality }));
+    });
+
+    it("should fall back to minQuality when the budget is unreachable", async () => {
+      const result = await encodeToSize(createTestImageData(64, 64), {
+        maxBytes: 10,
+        minQuality: 20,
+        speed: 9,
+      });
+
+      expect(result.targetMet).toBe(false);
+      expect(result.quality).toBe(20);
+      expect(result.data.length).toBeGreaterThan(10);
+    });
+  });
+
+  describe("quality metrics", () => {
+    function toExtended(imageData: ImageData): AVIFImageData {
+      return {
+        data: new Uint8Array(imageData.data),
+        dataType: "uint8",
+        width: imageData.width,
+        height: imageData.height,
+        channels: 4,
+        bitDepth: 8,
+        metadata: DEFAULT_SRGB_METADATA,
+      };
+    }
+
+    it("should report identical images as a perfect match", async () => {
+      const image = toExtended(createTestImageData(64, 64));
+      const metrics = await compareImages(image, image);
+
+      expect(metrics.psnr).toBe(Infinity);
+      expect(metrics.ssim).toBeCloseTo(1, 6);
+      expect(metrics.ssimulacra2).toBeCloseTo(100, 6);
+    });
+
+    it("should score lower quality encodes lower", async () => {
+      await initDecoder();
+      const imageData = createTestImageData(128, 128);
+      const reference = toExtended(imageData);
+      const options = { speed: 9, maxThreads: 1 };
+
+      const high = await decodeAndCompare(await encode(imageData, { ...options, quality: 90 }), reference);
+      const low = await decodeAndCompare(await encode(imageData, { ...options, quality: 10 }), reference);
+
+      expect(high.psnr!).toBeGreaterThan(low.psnr!);
+      expect(high.ssim!).toBeGreaterThan(low.ssim!);
+      expect(high.ssimulacra2!).toBeGreaterThan(low.ssimulacra2!);
+    });
+
+    it("should only compute the requested metrics, at the downscaled size", async () => {
+      const image = toExtended(createTestImageData(64, 48));
+      const metrics = await compareImages(image, image, { ssim: false, ssimulacra2: false, downscale: 2 });
+
+      expect(metrics.psnr).toBe(Infinity);
+      expect(metrics.ssim).toBeUndefined();
+      expect(metrics.ssimulacra2).toBeUndefined();
+      expect(metrics.width).toBe(32);
+      expect(metrics.height).toBe(24);
+    });
+
+    it("should reject images of different sizes", async () => {
+      await expect(
+        compareImages(toExtended(createTestImageData(16, 16)), toExtended(createTestImageData(16, 8))),
+      ).rejects.toThrow(/differ/);
+    });
+  });
+
+  describe("chroma downsampling", () => {
+    it("should encode with averaging modes and the built-in converter", async () => {
+      const imageData = createTestImageData(64, 64);
+
+      for (const chromaDownsampling of ["fastest", "best-quality", "average"] as const) {
+        const encoded = await encode(imageData, { chromaDownsampling });
+        const decoded = await decode(encoded);
+        expect(decoded.width).toBe(64);
+        expect(decoded.height).toBe(64);
+      }
+
+      const builtIn = await encode(imageData, { avoidLibYUV: true });
+      expect(builtIn.length).toBeGreaterThan(0);
+    });
+  });
+
+  describe("YUV input", () => {
+    it("should encode 4:2:0 planes without RGB input", async () => {
+      const width = 64;
+      const height = 48;
+      const chromaWidth = width / 2;
+      const chromaHeight = height / 2;
+      const y = new Uint8Array(width * height);
+      for (let i = 0; i < y.length; i++) {
+        y[i] = 16 + ((i % width) * 219) / width;
+      }
+
+      const encoded = await encodeYUV(
+        {
+          width,
+          height,
+          bitDepth: 8,
+          format: "4:2:0",
+          y: { data: y, stride: width },
+          u: { data: new Uint8Array(chromaWidth * chromaHeight).fill(128), stride: chromaWidth },
+          v: { data: new Uint8Array(chromaWidth * chromaHeight).fill(128), stride: chromaWidth },
+          matrixCoefficients: "bt709",
+          fullRange: false,
+        },
+        { quality: 90 },
+      );
+
+      const yuv = await decodeYUV(encoded);
+      expect(yuv.width).toBe(width);
+      expect(yuv.height).toBe(height);
+      expect(yuv.format).toBe("4:2:0");
+      expect(yuv.metadata.matrixCoefficients).toBe("bt709");
+      expect(yuv.metadata.fullRange).toBe(false);
+      expect(Math.abs(yuv.y.data[width - 1] - y[width - 1])).toBeLessThan(8);
+    });
+
+    it("should round-trip decoded planes", async () => {
+      const original = await encode(createTestImageData(50, 30), {
+        chromaSubsampling: "4:2:0",
+        bitDepth: 10,
+      });
+      const yuv = await decodeYUV(original);
+      const encoded = await encodeYUV({ ...yuv, ...yuv.metadata }, { quality: 90 });
+      const decoded = await decode(encoded);
+
+      expect(decoded.width).toBe(50);
+      expect(decoded.height).toBe(30);
+      expect(decoded.bitDepth).toBe(10);
+    });
+
+    it("should reject missing chroma planes", async () => {
+      await expect(
+        encodeYUV({
+          width: 8,
+          height: 8,
+          bitDepth: 8,
+          format: "4:4:4",
+          y: { data: new Uint8Array(64), stride: 8 },
+        }),
+      ).rejects.toThrow("U and V planes are required");
+    });
+  });
+
   describe("error handling", () => {
     it("should handle zero-dimension image", async () => {
       // Create minimal valid ImageData then try to break it
@@ -0,0 +1,27 @@
+/**
+ * Region-of-interest helpers shared by the decoders
+ */
+
+import type { CropRect } from './types';
+
+/**
+ * Zero-size rect: tells the native decoders to output the full image
+ */
+export const FULL_IMAGE_RECT: Readonly<CropRect> = { x: 0, y: 0, width: 0, height: 0 };
+
+/**
+ * Validate a user crop and map `undefined` to {@link FULL_IMAGE_RECT}.
+ * Clipping to the image bounds happens natively, once the size is known.
+ */
+export function validateCrop(crop: CropRect | undefined): CropRect {
+  if (!crop) return { ...FULL_IMAGE_RECT };
+
+  const { x, y, width, height } = crop;
+  const valid = [x, y, width, height].every((v) => Number.isInteger(v) && v >= 0);
+  if (!valid || width === 0 || height === 0) {
+    throw new RangeError(
+      `crop must have non-negative integer coordinates and a non-empty size, got ${JSON.stringify(crop)}`,
+    );
+  }
+  return { x, y, width, height };
+}
@@ -3,6 +3,7 @@ export type {
   DataType,
   ExtendedImageData,
   ImageInfo,
+  CropRect,
   ProgressCallback,
   CodecModule,
   EmscriptenModuleConfig,
@@ -29,6 +30,23 @@ export {
 export { isMultiThreadSupported, validateThreadCount } from './threading';
 export type { ThreadValidationResult } from './threading';
 
+// Region of interest
+export { FULL_IMAGE_RECT, validateCrop } from './crop';
+
+// Image quality metrics
+export {
+  DEFAULT_METRICS_OPTIONS,
+  compareInWasm,
+  compareWithWasm,
+  compareImagesInWasm,
+  imageToWasm,
+} from './metrics';
+export type { MetricsOptions, ImageMetrics, WasmImageRef, MetricsModule } from './metrics';
+
+// Streams
+export { readChunks, readPrefixUntil } from './stream';
+export type { RangeReader, PrefixProbe } from './stream';
+
 // Worker pool
 export { WorkerPool } from './worker-pool';
 export type { WorkerTask, WorkerResult } from './worker-pool';
@@ -0,0 +1,167 @@
+/**
+ * Image quality metrics computed inside a codec's WASM module
+ * (see src/wasm/metrics.h, compiled into every decoder)
+ */
+
+import type { DataType, ExtendedImageData } from './types';
+import type { WASMModule } from './memory';
+import { copyToWasm } from './wasm-utils';
+
+export interface MetricsOptions {
+  /** Peak signal-to-noise ratio over all channels (default: true) */
+  psnr?: boolean;
+  /** Gaussian-window SSIM averaged over channels (default: true) */
+  ssim?: boolean;
+  /** SSIMULACRA2 perceptual score (default: true) */
+  ssimulacra2?: boolean;
+  /**
+   * Box-downscale both images by this integer factor before measuring.
+   * A fast mode for large images: 2 is ~4x faster, scores are an estimate.
+   * (default: 1 = full resolution)
+   */
+  downscale?: number;
+}
+
+export const DEFAULT_METRICS_OPTIONS: Required<MetricsOptions> = {
+  psnr: true,
+  ssim: true,
+  ssimulacra2: true,
+  downscale: 1,
+};
+
+/**
+ * Similarity of a distorted image to its reference. Metrics that were not
+ * requested (or, for SSIMULACRA2, images under 8x8) are undefined.
+ */
+export interface ImageMetrics {
+  /** dB; Infinity for identical images */
+  psnr?: number;
+  /** 1 = identical */
+  ssim?: number;
+  /** 100 = identical, ~90 visually lossless, 70 high, 50 medium, <30 low quality */
+  ssimulacra2?: number;
+  /** Resolution the metrics were computed at (after downscale) */
+  width: number;
+  height: number;
+  /** Native compute time in ms */
+  time: number;
+}
+
+/** An interleaved image already in the WASM heap */
+export interface WasmImageRef {
+  dataPtr: number;
+  dataSize: number;
+  width: number;
+  height: number;
+  channels: number;
+  dataType: DataType;
+  bitDepth: number;
+}
+
+interface NativeMetricsResult {
+  psnr: number;
+  ssim: number;
+  ssimulacra2: number;
+  width: number;
+  height: number;
+  time: number;
+  error: string | ArrayBuffer | ArrayBufferView;
+}
+
+/** The part of a codec module that exposes the metrics engine */
+export interface MetricsModule extends Pick<WASMModule, '_malloc' | '_free' | 'HEAPU8'> {
+  compareImages(
+    reference: WasmImageRef,
+    distorted: WasmImageRef,
+    options: Required<MetricsOptions>,
+  ): NativeMetricsResult;
+}
+
+function validateMetricsOptions(options: MetricsOptions): Required<MetricsOptions> {
+  const opts = { ...DEFAULT_METRICS_OPTIONS, ...options };
+  if (!Number.isInteger(opts.downscale) || opts.downscale < 1) {
+    throw new RangeError(`downscale must be a positive integer, got ${opts.downscale}`);
+  }
+  return opts;
+}
+
+function optional(value: number): number | undefined {
+  return Number.isNaN(value) ? undefined : value;
+}
+
+/**
+ * Compare two images that are already in the module's heap. Neither buffer
+ * is freed.
+ */
+export function compareInWasm(
+  module: MetricsModule,
+  reference: WasmImageRef,
+  distorted: WasmImageRef,
+  options: MetricsOptions = {},
+): ImageMetrics {
+  const result = module.compareImages(reference, distorted, validateMetricsOptions(options));
+  if (result.error) {
+    throw new Error(`Metrics error: ${result.error}`);
+  }
+  return {
+    psnr: optional(result.psnr),
+    ssim: optional(result.ssim),
+    ssimulacra2: optional(result.ssimulacra2),
+    width: result.width,
+    height: result.height,
+    time: result.time,
+  };
+}
+
+/**
+ * Copy an image into the module's heap. Free `dataPtr` with `module._free`.
+ */
+export function imageToWasm(
+  module: Pick<WASMModule, '_malloc' | 'HEAPU8'>,
+  image: ExtendedImageData,
+): WasmImageRef {
+  return {
+    dataPtr: copyToWasm(module, image.data),
+    dataSize: image.data.byteLength,
+    width: image.width,
+    height: image.height,
+    channels: image.channels,
+    dataType: image.dataType,
+    bitDepth: image.bitDepth,
+  };
+}
+
+/**
+ * Compare a reference image against an image already in the heap (e.g. a
+ * decoder's output). Only the reference is copied in, and freed afterwards.
+ */
+export function compareWithWasm(
+  module: MetricsModule,
+  reference: ExtendedImageData,
+  distorted: WasmImageRef,
+  options: MetricsOptions = {},
+): ImageMetrics {
+  const ref = imageToWasm(module, reference);
+  try {
+    return compareInWasm(module, ref, distorted, options);
+  } finally {
+    module._free(ref.dataPtr);
+  }
+}
+
+/**
+ * Compare two JS images using a module's metrics engine
+ */
+export function compareImagesInWasm(
+  module: MetricsModule,
+  reference: ExtendedImageData,
+  distorted: ExtendedImageData,
+  options: MetricsOptions = {},
+): ImageMetrics {
+  const dist = imageToWasm(module, distorted);
+  try {
+    return compareWithWasm(module, reference, dist, options);
+  } finally {
+    module._free(dist.dataPtr);
+  }
+}
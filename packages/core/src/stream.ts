@@ -0,0 +1,71 @@
+/**
+ * Helpers for decoding from byte streams
+ */
+
+/**
+ * Iterate over the chunks of an async iterable or a ReadableStream
+ */
+export async function* readChunks(
+  stream: AsyncIterable<Uint8Array> | ReadableStream<Uint8Array>,
+): AsyncGenerator<Uint8Array> {
+  if (!("getReader" in stream)) {
+    yield* stream;
+    return;
+  }
+
+  // ReadableStream async iteration is not available in every browser
+  const reader = stream.getReader();
+  try {
+    for (;;) {
+      const { done, value } = await reader.read();
+      if (done) return;
+      yield value;
+    }
+  } finally {
+    reader.releaseLock();
+  }
+}
+
+/**
+ * Reads bytes `[start, end)` of a resource, e.g. with an HTTP Range request.
+ * Returns fewer bytes only when the resource ends before `end`.
+ */
+export type RangeReader = (start: number, end: number) => Promise<Uint8Array>;
+
+/**
+ * Outcome of probing a prefix: a result, or the prefix length to try next
+ */
+export interface PrefixProbe<T> {
+  result: T | null;
+  bytesNeeded: number;
+}
+
+/**
+ * Read a growing prefix of a resource until `probe` can produce its result.
+ * Only the missing bytes are requested each round.
+ */
+export async function readPrefixUntil<T>(
+  read: RangeReader,
+  probe: (prefix: Uint8Array, isComplete: boolean) => PrefixProbe<T>,
+  initialBytes = 4096,
+): Promise<T> {
+  let prefix = new Uint8Array(0);
+  let wanted = initialBytes;
+
+  for (;;) {
+    const chunk = await read(prefix.length, wanted);
+    const isComplete = prefix.length + chunk.length < wanted;
+
+    const grown = new Uint8Array(prefix.length + chunk.length);
+    grown.set(prefix);
+    grown.set(chunk, prefix.length);
+    prefix = grown;
+
+    const { result, bytesNeeded } = probe(prefix, isComplete);
+    if (result) return result;
+    if (isComplete || bytesNeeded <= prefix.length) {
+      throw new Error(`Resource ended after ${prefix.length} bytes, before the header did`);
+    }
+    wanted = bytesNeeded;
+  }
+}
@@ -66,6 +66,21 @@ export interface ImageInfo<TMeta = unknown> {
   metadata: TMeta;
 }
 
+// ============================================================================
+// Region of interest
+// ============================================================================
+
+/**
+ * Rectangle in image pixel coordinates, used to decode only a region.
+ * Parts outside the image are clipped.
+ */
+export interface CropRect {
+  x: number;
+  y: number;
+  width: number;
+  height: number;
+}
+
 // ============================================================================
 // Utilities
 // ============================================================================
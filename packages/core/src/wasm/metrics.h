@@ -0,0 +1,746 @@
+#pragma once
+
+// Image quality metrics shared by the codec modules: PSNR, SSIM and
+// SSIMULACRA2 over two interleaved images in the WASM heap. Compiled into
+// each module so a decoded buffer can be compared in place, without copying
+// pixels out to JS.
+
+#include <emscripten.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+namespace metrics
+{
+
+// ============================================================================
+// Types
+// ============================================================================
+
+// An interleaved image in the heap. Integer samples are scaled by
+// 2^bitDepth - 1; float samples are used as is (1.0 = white).
+struct MetricsInput
+{
+    uintptr_t dataPtr;
+    size_t dataSize;
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;    // 1-4; 2 and 4 carry alpha
+    std::string dataType; // "uint8", "uint16", "float16", "float32"
+    int bitDepth;         // Integer types only; 0 = full type range
+};
+
+struct MetricsOptions
+{
+    bool psnr;
+    bool ssim;
+    bool ssimulacra2;
+    int downscale; // Box-downscale both images by this factor first (1 = off)
+};
+
+// Metrics that were not requested are NaN
+struct MetricsResult
+{
+    double psnr;        // dB over all channels, +Infinity for identical images
+    double ssim;        // Mean SSIM over all channels, 1 = identical
+    double ssimulacra2; // 100 = identical, ~90 visually lossless, <30 poor
+    uint32_t width;     // Resolution the metrics were computed at
+    uint32_t height;
+    double time;        // ms
+    std::string error;
+};
+
+// One float plane per channel, row-major with stride == width
+struct Planes
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<std::vector<float>> channels;
+};
+
+// ============================================================================
+// SIMD kernels (scalar fallback without -msimd128)
+// ============================================================================
+
+// out[i] = a[i] * b[i]
+inline void multiply(const float *a, const float *b, float *out, size_t n)
+{
+    size_t i = 0;
+#ifdef __wasm_simd128__
+    for (; i + 4 <= n; i += 4)
+        wasm_v128_store(out + i, wasm_f32x4_mul(wasm_v128_load(a + i), wasm_v128_load(b + i)));
+#endif
+    for (; i < n; ++i)
+        out[i] = a[i] * b[i];
+}
+
+// Sum of (a[i] - b[i])^2. Lanes accumulate in float per row-sized block and
+// are flushed to double so large images keep their precision.
+inline double sumSquaredDiff(const float *a, const float *b, size_t n)
+{
+    double sum = 0.0;
+    size_t i = 0;
+#ifdef __wasm_simd128__
+    constexpr size_t kBlock = 1024;
+    while (i + 4 <= n)
+    {
+        size_t end = std::min(n & ~size_t(3), i + kBlock);
+        v128_t acc = wasm_f32x4_splat(0.0f);
+        for (; i < end; i += 4)
+        {
+            v128_t d = wasm_f32x4_sub(wasm_v128_load(a + i), wasm_v128_load(b + i));
+            acc = wasm_f32x4_add(acc, wasm_f32x4_mul(d, d));
+        }
+        sum += static_cast<double>(wasm_f32x4_extract_lane(acc, 0)) + wasm_f32x4_extract_lane(acc, 1) +
+               wasm_f32x4_extract_lane(acc, 2) + wasm_f32x4_extract_lane(acc, 3);
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        double d = static_cast<double>(a[i]) - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+// Separable Gaussian blur, sigma 1.5, edges clamped
+class GaussianBlur
+{
+public:
+    static constexpr int kRadius = 5;
+
+    GaussianBlur()
+    {
+        double sum = 0.0;
+        for (int i = -kRadius; i <= kRadius; ++i)
+        {
+            kernel_[i + kRadius] = static_cast<float>(std::exp(-(i * i) / (2.0 * 1.5 * 1.5)));
+            sum += kernel_[i + kRadius];
+        }
+        for (float &k : kernel_)
+            k = static_cast<float>(k / sum);
+    }
+
+    // `temp` must hold width * height floats
+    void apply(const float *in, float *out, float *temp, uint32_t width, uint32_t height) const
+    {
+        for (uint32_t y = 0; y < height; ++y)
+            horizontal(in + static_cast<size_t>(y) * width, temp + static_cast<size_t>(y) * width, width);
+        for (uint32_t y = 0; y < height; ++y)
+            vertical(temp, out + static_cast<size_t>(y) * width, width, height, y);
+    }
+
+private:
+    void horizontal(const float *row, float *out, uint32_t width) const
+    {
+        const int w = static_cast<int>(width);
+        int x = 0;
+        auto edge = [&](int px)
+        {
+            float sum = 0.0f;
+            for (int i = -kRadius; i <= kRadius; ++i)
+                sum += kernel_[i + kRadius] * row[std::min(std::max(px + i, 0), w - 1)];
+            out[px] = sum;
+        };
+        for (; x < std::min(kRadius, w); ++x)
+            edge(x);
+#ifdef __wasm_simd128__
+        for (; x + 4 + kRadius <= w; x += 4)
+        {
+            v128_t sum = wasm_f32x4_splat(0.0f);
+            for (int i = -kRadius; i <= kRadius; ++i)
+                sum = wasm_f32x4_add(sum, wasm_f32x4_mul(wasm_f32x4_splat(kernel_[i + kRadius]),
+                                                         wasm_v128_load(row + x + i)));
+            wasm_v128_store(out + x, sum);
+        }
+#endif
+        for (; x < w; ++x)
+            edge(x);
+    }
+
+    // Rows are contiguous, so the vertical pass vectorizes across x
+    void vertical(const float *in, float *out, uint32_t width, uint32_t height, uint32_t y) const
+    {
+        const float *rows[2 * kRadius + 1];
+        for (int i = -kRadius; i <= kRadius; ++i)
+        {
+            int64_t ry = std::min<int64_t>(std::max<int64_t>(static_cast<int64_t>(y) + i, 0), height - 1);
+            rows[i + kRadius] = in + static_cast<size_t>(ry) * width;
+        }
+
+        uint32_t x = 0;
+#ifdef __wasm_simd128__
+        for (; x + 4 <= width; x += 4)
+        {
+            v128_t sum = wasm_f32x4_splat(0.0f);
+            for (int i = 0; i <= 2 * kRadius; ++i)
+                sum = wasm_f32x4_add(sum, wasm_f32x4_mul(wasm_f32x4_splat(kernel_[i]), wasm_v128_load(rows[i] + x)));
+            wasm_v128_store(out + x, sum);
+        }
+#endif
+        for (; x < width; ++x)
+        {
+            float sum = 0.0f;
+            for (int i = 0; i <= 2 * kRadius; ++i)
+                sum += kernel_[i] * rows[i][x];
+            out[x] = sum;
+        }
+    }
+
+    float kernel_[2 * kRadius + 1];
+};
+
+// ============================================================================
+// Input conversion
+// ============================================================================
+
+inline float halfToFloat(uint16_t h)
+{
+    uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1f;
+    uint32_t mantissa = h & 0x3ff;
+    uint32_t bits;
+    if (exponent == 0)
+    {
+        if (mantissa == 0)
+        {
+            bits = sign;
+        }
+        else
+        {
+            // Subnormal: renormalize
+            exponent = 127 - 15 + 1;
+            while ((mantissa & 0x400) == 0)
+            {
+                mantissa <<= 1;
+                --exponent;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+        }
+    }
+    else if (exponent == 31)
+    {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+inline size_t bytesPerSample(const std::string &dataType)
+{
+    if (dataType == "uint8")
+        return 1;
+    if (dataType == "uint16" || dataType == "float16")
+        return 2;
+    if (dataType == "float32")
+        return 4;
+    return 0;
+}
+
+// Deinterleave and normalize to [0, 1]. Returns an error message, empty on
+// success.
+inline std::string loadPlanes(const MetricsInput &input, Planes &planes)
+{
+    size_t bytes = bytesPerSample(input.dataType);
+    if (bytes == 0)
+        return "Unsupported dataType: " + input.dataType;
+    if (input.width == 0 || input.height == 0 || input.channels < 1 || input.channels > 4)
+        return "Invalid image shape";
+
+    size_t pixels = static_cast<size_t>(input.width) * input.height;
+    if (input.dataPtr == 0 || input.dataSize < pixels * input.channels * bytes)
+        return "Invalid input: pixel data too small";
+
+    planes.width = input.width;
+    planes.height = input.height;
+    planes.channels.assign(input.channels, std::vector<float>(pixels));
+
+    const uint32_t channels = input.channels;
+    if (input.dataType == "uint8")
+    {
+        const uint8_t *src = reinterpret_cast<const uint8_t *>(input.dataPtr);
+        int depth = input.bitDepth > 0 && input.bitDepth < 8 ? input.bitDepth : 8;
+        float scale = 1.0f / static_cast<float>((1 << depth) - 1);
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            float *dst = planes.channels[c].data();
+            for (size_t i = 0; i < pixels; ++i)
+                dst[i] = src[i * channels + c] * scale;
+        }
+    }
+    else if (input.dataType == "uint16")
+    {
+        const uint16_t *src = reinterpret_cast<const uint16_t *>(input.dataPtr);
+        int depth = input.bitDepth > 0 && input.bitDepth < 16 ? input.bitDepth : 16;
+        float scale = 1.0f / static_cast<float>((1 << depth) - 1);
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            float *dst = planes.channels[c].data();
+            for (size_t i = 0; i < pixels; ++i)
+                dst[i] = src[i * channels + c] * scale;
+        }
+    }
+    else if (input.dataType == "float16")
+    {
+        const uint16_t *src = reinterpret_cast<const uint16_t *>(input.dataPtr);
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            float *dst = planes.channels[c].data();
+            for (size_t i = 0; i < pixels; ++i)
+                dst[i] = halfToFloat(src[i * channels + c]);
+        }
+    }
+    else
+    {
+        const float *src = reinterpret_cast<const float *>(input.dataPtr);
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            float *dst = planes.channels[c].data();
+            for (size_t i = 0; i < pixels; ++i)
+                dst[i] = src[i * channels + c];
+        }
+    }
+    return "";
+}
+
+// Box-average `factor` x `factor` blocks; edge blocks average what exists
+inline void downscalePlane(const std::vector<float> &in, uint32_t width, uint32_t height,
+                           uint32_t factor, std::vector<float> &out, uint32_t outWidth, uint32_t outHeight)
+{
+    out.assign(static_cast<size_t>(outWidth) * outHeight, 0.0f);
+    for (uint32_t oy = 0; oy < outHeight; ++oy)
+    {
+        uint32_t y0 = oy * factor;
+        uint32_t y1 = std::min(height, y0 + factor);
+        float *dst = out.data() + static_cast<size_t>(oy) * outWidth;
+        for (uint32_t y = y0; y < y1; ++y)
+        {
+            const float *row = in.data() + static_cast<size_t>(y) * width;
+            for (uint32_t ox = 0; ox < outWidth; ++ox)
+            {
+                uint32_t x0 = ox * factor;
+                uint32_t x1 = std::min(width, x0 + factor);
+                float sum = 0.0f;
+                for (uint32_t x = x0; x < x1; ++x)
+                    sum += row[x];
+                dst[ox] += sum;
+            }
+        }
+        for (uint32_t ox = 0; ox < outWidth; ++ox)
+        {
+            uint32_t x0 = ox * factor;
+            uint32_t count = (std::min(width, x0 + factor) - x0) * (y1 - y0);
+            dst[ox] /= static_cast<float>(count);
+        }
+    }
+}
+
+inline void downscale(Planes &planes, uint32_t factor)
+{
+    uint32_t outWidth = (planes.width + factor - 1) / factor;
+    uint32_t outHeight = (planes.height + factor - 1) / factor;
+    for (std::vector<float> &plane : planes.channels)
+    {
+        std::vector<float> out;
+        downscalePlane(plane, planes.width, planes.height, factor, out, outWidth, outHeight);
+        plane.swap(out);
+    }
+    planes.width = outWidth;
+    planes.height = outHeight;
+}
+
+// ============================================================================
+// PSNR and SSIM
+// ============================================================================
+
+inline double computePSNR(const Planes &a, const Planes &b)
+{
+    double sse = 0.0;
+    size_t count = 0;
+    for (size_t c = 0; c < a.channels.size(); ++c)
+    {
+        sse += sumSquaredDiff(a.channels[c].data(), b.channels[c].data(), a.channels[c].size());
+        count += a.channels[c].size();
+    }
+    if (sse == 0.0)
+        return std::numeric_limits<double>::infinity();
+    return 10.0 * std::log10(static_cast<double>(count) / sse);
+}
+
+// Gaussian-window SSIM (Wang et al. 2004) per channel, averaged
+inline double computeSSIM(const Planes &a, const Planes &b, const GaussianBlur &blur)
+{
+    constexpr double kC1 = 0.01 * 0.01;
+    constexpr double kC2 = 0.03 * 0.03;
+
+    const uint32_t w = a.width;
+    const uint32_t h = a.height;
+    const size_t n = static_cast<size_t>(w) * h;
+    std::vector<float> mu1(n), mu2(n), s11(n), s22(n), s12(n), prod(n), temp(n);
+
+    double total = 0.0;
+    for (size_t c = 0; c < a.channels.size(); ++c)
+    {
+        const float *p1 = a.channels[c].data();
+        const float *p2 = b.channels[c].data();
+        blur.apply(p1, mu1.data(), temp.data(), w, h);
+        blur.apply(p2, mu2.data(), temp.data(), w, h);
+        multiply(p1, p1, prod.data(), n);
+        blur.apply(prod.data(), s11.data(), temp.data(), w, h);
+        multiply(p2, p2, prod.data(), n);
+        blur.apply(prod.data(), s22.data(), temp.data(), w, h);
+        multiply(p1, p2, prod.data(), n);
+        blur.apply(prod.data(), s12.data(), temp.data(), w, h);
+
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            double m1 = mu1[i], m2 = mu2[i];
+            double m11 = m1 * m1, m22 = m2 * m2, m12 = m1 * m2;
+            double num = (2.0 * m12 + kC1) * (2.0 * (s12[i] - m12) + kC2);
+            double den = (m11 + m22 + kC1) * ((s11[i] - m11) + (s22[i] - m22) + kC2);
+            sum += num / den;
+        }
+        total += sum / static_cast<double>(n);
+    }
+    return total / static_cast<double>(a.channels.size());
+}
+
+// ============================================================================
+// SSIMULACRA2
+// ============================================================================
+
+// Follows the reference implementation (libjxl tools/ssimulacra2): six
+// scales of linear RGB, each converted to positive XYB, scored by an SSIM
+// variant and edge artifact / detail loss maps in 1- and 4-norms, then a
+// fixed weighted sum mapped to a 0-100 scale. Blurs use a true Gaussian
+// rather than libjxl's recursive approximation, so scores may differ from
+// the reference tool in the second decimal.
+class Ssimulacra2
+{
+public:
+    static constexpr int kNumScales = 6;
+
+    explicit Ssimulacra2(const GaussianBlur &blur) : blur_(blur)
+    {
+        for (int i = 0; i <= kLutSize; ++i)
+        {
+            double v = static_cast<double>(i) / kLutSize;
+            lut_[i] = static_cast<float>(v <= 0.04045 ? v / 12.92 : std::pow((v + 0.055) / 1.055, 2.4));
+        }
+    }
+
+    // Images with alpha are blended over a dark and a light background and
+    // the worse score is kept, as the reference tool does
+    double score(const Planes &a, const Planes &b) const
+    {
+        bool hasAlpha = a.channels.size() == 2 || a.channels.size() == 4;
+        if (!hasAlpha)
+            return scoreOpaque(a, b, 0.0f);
+        return std::min(scoreOpaque(a, b, 0.1f), scoreOpaque(a, b, 0.9f));
+    }
+
+private:
+    static constexpr int kLutSize = 4096;
+
+    // Per scale: 3 channels x (2 SSIM + 4 edge) averages
+    struct ScaleScores
+    {
+        double ssim[6];
+        double edge[12];
+    };
+
+    float toLinear(float v) const
+    {
+        float pos = std::min(std::max(v, 0.0f), 1.0f) * kLutSize;
+        int i = std::min(static_cast<int>(pos), kLutSize - 1);
+        float t = pos - static_cast<float>(i);
+        return lut_[i] + (lut_[i + 1] - lut_[i]) * t;
+    }
+
+    // Linear RGB planes, gray replicated and alpha blended over `background`
+    void linearRGB(const Planes &in, float background, Planes &out) const
+    {
+        const size_t n = static_cast<size_t>(in.width) * in.height;
+        const size_t colors = in.channels.size() >= 3 ? 3 : 1;
+        const float *alpha = (in.channels.size() == 2 || in.channels.size() == 4) ? in.channels.back().data() : nullptr;
+
+        out.width = in.width;
+        out.height = in.height;
+        out.channels.assign(3, std::vector<float>(n));
+        for (size_t c = 0; c < 3; ++c)
+        {
+            const float *src = in.channels[colors == 3 ? c : 0].data();
+            float *dst = out.channels[c].data();
+            for (size_t i = 0; i < n; ++i)
+            {
+                float v = alpha ? src[i] * alpha[i] + background * (1.0f - alpha[i]) : src[i];
+                dst[i] = toLinear(v);
+            }
+        }
+    }
+
+    // 2x box downscale in linear light
+    static void halve(const Planes &in, Planes &out)
+    {
+        out.width = (in.width + 1) / 2;
+        out.height = (in.height + 1) / 2;
+        out.channels.resize(3);
+        for (size_t c = 0; c < 3; ++c)
+            downscalePlane(in.channels[c], in.width, in.height, 2, out.channels[c], out.width, out.height);
+    }
+
+    // Linear RGB to XYB in place, shifted so all channels are positive
+    static void toPositiveXYB(Planes &img)
+    {
+        constexpr float kM[9] = {
+            0.30f, 0.622f, 0.078f,
+            0.23f, 0.692f, 0.078f,
+            0.24342268924547819f, 0.20476744424496821f, 0.55180986650955360f};
+        constexpr float kBias = 0.0037930732552754493f;
+        const float biasCbrt = std::cbrt(kBias);
+
+        const size_t n = static_cast<size_t>(img.width) * img.height;
+        float *r = img.channels[0].data();
+        float *g = img.channels[1].data();
+        float *b = img.channels[2].data();
+        for (size_t i = 0; i < n; ++i)
+        {
+            float l = std::cbrt(std::max(kM[0] * r[i] + kM[1] * g[i] + kM[2] * b[i] + kBias, 0.0f)) - biasCbrt;
+            float m = std::cbrt(std::max(kM[3] * r[i] + kM[4] * g[i] + kM[5] * b[i] + kBias, 0.0f)) - biasCbrt;
+            float s = std::cbrt(std::max(kM[6] * r[i] + kM[7] * g[i] + kM[8] * b[i] + kBias, 0.0f)) - biasCbrt;
+            float x = 0.5f * (l - m);
+            float y = 0.5f * (l + m);
+            r[i] = x * 14.0f + 0.42f;
+            g[i] = y + 0.01f;
+            b[i] = (s - y) + 0.55f;
+        }
+    }
+
+    static double pow4(double v)
+    {
+        v *= v;
+        return v * v;
+    }
+
+    void scoreScale(const Planes &xyb1, const Planes &xyb2, ScaleScores &scores) const
+    {
+        constexpr double kC2 = 0.0009;
+        const uint32_t w = xyb1.width;
+        const uint32_t h = xyb1.height;
+        const size_t n = static_cast<size_t>(w) * h;
+        const double perPixel = 1.0 / static_cast<double>(n);
+        std::vector<float> mu1(n), mu2(n), s11(n), s22(n), s12(n), prod(n), temp(n);
+
+        for (size_t c = 0; c < 3; ++c)
+        {
+            const float *p1 = xyb1.channels[c].data();
+            const float *p2 = xyb2.channels[c].data();
+            blur_.apply(p1, mu1.data(), temp.data(), w, h);
+            blur_.apply(p2, mu2.data(), temp.data(), w, h);
+            multiply(p1, p1, prod.data(), n);
+            blur_.apply(prod.data(), s11.data(), temp.data(), w, h);
+            multiply(p2, p2, prod.data(), n);
+            blur_.apply(prod.data(), s22.data(), temp.data(), w, h);
+            multiply(p1, p2, prod.data(), n);
+            blur_.apply(prod.data(), s12.data(), temp.data(), w, h);
+
+            double ssim[2] = {0.0, 0.0};
+            double edge[4] = {0.0, 0.0, 0.0, 0.0};
+            for (size_t i = 0; i < n; ++i)
+            {
+                double m1 = mu1[i], m2 = mu2[i];
+                double m11 = m1 * m1, m22 = m2 * m2, m12 = m1 * m2;
+                // No luminance denominator: errors in darks should not outweigh brights
+                double numM = 1.0 - (m1 - m2) * (m1 - m2);
+                double numS = 2.0 * (s12[i] - m12) + kC2;
+                double denS = (s11[i] - m11) + (s22[i] - m22) + kC2;
+                double d = std::max(1.0 - numM * numS / denS, 0.0);
+                ssim[0] += d;
+                ssim[1] += pow4(d);
+
+                double ratio = (1.0 + std::abs(p2[i] - m2)) / (1.0 + std::abs(p1[i] - m1)) - 1.0;
+                double artifact = std::max(ratio, 0.0);
+                double detailLost = std::max(-ratio, 0.0);
+                edge[0] += artifact;
+                edge[1] += pow4(artifact);
+                edge[2] += detailLost;
+                edge[3] += pow4(detailLost);
+            }
+
+            scores.ssim[c * 2] = perPixel * ssim[0];
+            scores.ssim[c * 2 + 1] = std::sqrt(std::sqrt(perPixel * ssim[1]));
+            scores.edge[c * 4] = perPixel * edge[0];
+            scores.edge[c * 4 + 1] = std::sqrt(std::sqrt(perPixel * edge[1]));
+            scores.edge[c * 4 + 2] = perPixel * edge[2];
+            scores.edge[c * 4 + 3] = std::sqrt(std::sqrt(perPixel * edge[3]));
+        }
+    }
+
+    double scoreOpaque(const Planes &a, const Planes &b, float background) const
+    {
+        Planes linear1, linear2;
+        linearRGB(a, background, linear1);
+        linearRGB(b, background, linear2);
+
+        std::vector<ScaleScores> scales;
+        for (int scale = 0; scale < kNumScales; ++scale)
+        {
+            if (linear1.width < 8 || linear1.height < 8)
+                break;
+
+            // Next scale is taken from linear light before this one turns into XYB
+            Planes next1, next2;
+            if (scale + 1 < kNumScales)
+            {
+                halve(linear1, next1);
+                halve(linear2, next2);
+            }
+
+            toPositiveXYB(linear1);
+            toPositiveXYB(linear2);
+            ScaleScores scores;
+            scoreScale(linear1, linear2, scores);
+            scales.push_back(scores);
+
+            linear1.channels.swap(next1.channels);
+            linear2.channels.swap(next2.channels);
+            linear1.width = next1.width;
+            linear1.height = next1.height;
+            linear2.width = next2.width;
+            linear2.height = next2.height;
+        }
+
+        return finalScore(scales);
+    }
+
+    static double finalScore(const std::vector<ScaleScores> &scales)
+    {
+        static constexpr double kWeights[108] = {
+            0.0, 0.0007376606707406586, 0.0,
+            0.0, 0.0007793481682867309, 0.0,
+            0.0, 0.0004371155730107379, 0.0,
+            1.1041726426657346, 0.00066284834129271, 0.00015231632783718752,
+            0.0, 0.0016406437456599754, 0.0,
+            1.8422455520539298, 11.441172603757666, 0.0,
+            0.0007989109436015163, 0.000176816438078653, 0.0,
+            1.8787594979546387, 10.94906990605142, 0.0,
+            0.0007289346991508072, 0.9677937080626833, 0.0,
+            0.00014003424285435884, 0.9981766977854967, 0.00031949755934435053,
+            0.0004550992113792063, 0.0, 0.0,
+            0.0013648766163243398, 0.0, 0.0,
+            0.0, 0.0, 0.0,
+            7.466890328078848, 0.0, 17.445833984131262,
+            0.0006235601634041466, 0.0, 0.0,
+            6.683678146179332, 0.00037724407979611296, 1.027889937768264,
+            225.20515300849274, 0.0, 0.0,
+            19.213238186143016, 0.0011401524586618361, 0.001237755635509985,
+            176.39317598450694, 0.0, 0.0,
+            24.43300999870476, 0.28520802612117757, 0.0004485436923833408,
+            0.0, 0.0, 0.0,
+            34.77906344483772, 44.835625328877896, 0.0,
+            0.0, 0.0, 0.0,
+            0.0, 0.0, 0.0,
+            0.0, 0.0008680556573291698, 0.0,
+            0.0, 0.0, 0.0,
+            0.0, 0.0005313191874358747, 0.0,
+            0.00016533814161379112, 0.0, 0.0,
+            0.0, 0.0, 0.0,
+            0.0004179171803251336, 0.0017290828234722833, 0.0,
+            0.0020827005846636437, 0.0, 0.0,
+            8.826982764996862, 23.19243343998926, 0.0,
+            95.1080498811086, 0.9863978034400682, 0.9834382792465353,
+            0.0012286405048278493, 171.2667255897307, 0.9807858872435379,
+            0.0, 0.0, 0.0,
+            0.0005130064588990679, 0.0, 0.00010854057858411537};
+
+        // Order: channel, scale, norm; per entry SSIM, artifact, detail loss.
+        // Like the reference, weights are consumed in sequence over the scales
+        // that were computed, so small images shift the indexing.
+        double sum = 0.0;
+        size_t i = 0;
+        for (size_t c = 0; c < 3; ++c)
+        {
+            for (const ScaleScores &s : scales)
+            {
+                for (size_t norm = 0; norm < 2; ++norm)
+                {
+                    sum += kWeights[i++] * std::abs(s.ssim[c * 2 + norm]);
+                    sum += kWeights[i++] * std::abs(s.edge[c * 4 + norm]);
+                    sum += kWeights[i++] * std::abs(s.edge[c * 4 + norm + 2]);
+                }
+            }
+        }
+
+        sum *= 0.9562382616834844;
+        sum = 2.326765642916932 * sum - 0.020884521182843837 * sum * sum +
+              6.248496625763138e-05 * sum * sum * sum;
+        return sum > 0.0 ? 100.0 - 10.0 * std::pow(sum, 0.6276336467831387) : 100.0;
+    }
+
+    const GaussianBlur &blur_;
+    float lut_[kLutSize + 1];
+};
+
+// ============================================================================
+// Entry point
+// ============================================================================
+
+inline MetricsResult compareImages(
+    const MetricsInput &reference,
+    const MetricsInput &distorted,
+    const MetricsOptions &options)
+{
+    double tStart = emscripten_get_now();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    MetricsResult result = {nan, nan, nan, 0, 0, 0, ""};
+
+    if (reference.width != distorted.width || reference.height != distorted.height ||
+        reference.channels != distorted.channels)
+    {
+        result.error = "Images differ in size or channel count";
+        return result;
+    }
+
+    Planes a, b;
+    result.error = loadPlanes(reference, a);
+    if (result.error.empty())
+        result.error = loadPlanes(distorted, b);
+    if (!result.error.empty())
+        return result;
+
+    if (options.downscale > 1)
+    {
+        downscale(a, static_cast<uint32_t>(options.downscale));
+        downscale(b, static_cast<uint32_t>(options.downscale));
+    }
+    result.width = a.width;
+    result.height = a.height;
+
+    GaussianBlur blur;
+    if (options.psnr)
+        result.psnr = computePSNR(a, b);
+    if (options.ssim)
+        result.ssim = computeSSIM(a, b, blur);
+    // Needs at least one 8x8 scale; left NaN for smaller images
+    if (options.ssimulacra2 && a.width >= 8 && a.height >= 8)
+        result.ssimulacra2 = Ssimulacra2(blur).score(a, b);
+
+    result.time = emscripten_get_now() - tStart;
+    return result;
+}
+
+} // namespace metrics
@@ -3,12 +3,26 @@ import {
   validateThreadCount,
   copyToWasm,
   copyFromWasmByType,
+  validateCrop,
+  readChunks,
+  readPrefixUntil,
+  compareImagesInWasm,
+  compareWithWasm,
+} from "@dimkatet/jcodecs-core";
+import type {
+  CropRect,
+  ExtendedImageData,
+  ImageMetrics,
+  MetricsOptions,
+  RangeReader,
 } from "@dimkatet/jcodecs-core";
 import type { JXLDecodeOptions } from "./options";
 import { DEFAULT_DECODE_OPTIONS } from "./options";
 import type {
+  JXLDataType,
   JXLImageData,
   JXLImageInfo,
+  JXLMemoryStats,
   JXLMetadata,
   MasteringDisplay,
   ColorPrimaries,
@@ -16,7 +30,13 @@ import type {
 } from "./types";
 import type {
   MainModule,
+  DecodeResult,
+  ImageInfo,
   ImageMetadata,
+  JxlDecoderSession,
+  JxlFrameIterator,
+  JxlStreamingDecoder,
+  StreamStatus,
   MasteringDisplay as WASMMasteringDisplay,
 } from "./wasm/jxl_dec";
 import { mtDecoderUrl, stDecoderUrl } from "./urls";
@@ -150,6 +170,32 @@ function convertMetadata(
   };
 }
 
+/**
+ * Copy decoded pixels out of the WASM heap and free the native buffer.
+ * Throws if the native decoder reported an error.
+ */
+function readPixels(result: DecodeResult, module: MainModule) {
+  if (result.error) {
+    throw new Error(`JXL decode error: ${result.error}`);
+  }
+
+  const outputDepth = result.depth as 8 | 10 | 12 | 16 | 32;
+
+  // dataType is auto-detected from file format (returned from WASM)
+  const outputDataType = result.dataType as JXLDataType;
+
+  // Calculate element count based on data type
+  const bytesPerElement = outputDataType === 'float32' ? 4 :
+                          outputDataType === 'uint16' || outputDataType === 'float16' ? 2 : 1;
+  const elementCount = result.dataSize / bytesPerElement;
+
+  // Copy pixel data from WASM heap using type-safe helper
+  const pixelData = copyFromWasmByType(module, result.dataPtr, elementCount, outputDataType);
+  module._free(result.dataPtr);
+
+  return { pixelData, outputDataType, outputDepth };
+}
+
 /**
  * Decode JXL image data
  */
@@ -176,6 +222,7 @@ export async function decode(
     console.warn(validation.warning);
   }
   opts.maxThreads = validation.validatedCount;
+  const crop = validateCrop(opts.crop);
 
   // Copy input data to WASM heap
   const t1 = profilingEnabled ? performance.now() : 0;
@@ -184,29 +231,18 @@ export async function decode(
 
   let result;
   try {
-    result = module.decode(inputPtr, data.length, opts.maxThreads);
+    result = module.decode(
+      inputPtr,
+      data.length,
+      opts.maxThreads,
+      crop,
+    );
   } finally {
     module._free(inputPtr);
   }
   const t3 = profilingEnabled ? performance.now() : 0;
 
-  if (result.error) {
-    throw new Error(`JXL decode error: ${result.error}`);
-  }
-
-  const outputDepth = result.depth as 8 | 10 | 12 | 16 | 32;
-
-  // dataType is auto-detected from file format (returned from WASM)
-  const outputDataType = result.dataType as 'uint8' | 'uint16' | 'float16' | 'float32';
-
-  // Calculate element count based on data type
-  const bytesPerElement = outputDataType === 'float32' ? 4 :
-                          outputDataType === 'uint16' || outputDataType === 'float16' ? 2 : 1;
-  const elementCount = result.dataSize / bytesPerElement;
-
-  // Copy pixel data from WASM heap using type-safe helper
-  const pixelData = copyFromWasmByType(module, result.dataPtr, elementCount, outputDataType);
-  module._free(result.dataPtr);
+  const { pixelData, outputDataType, outputDepth } = readPixels(result, module);
   const t4 = profilingEnabled ? performance.now() : 0;
 
   const metadata = convertMetadata(result.metadata, module);
@@ -277,6 +313,16 @@ export async function decodeToImageData(
   return new ImageData(rgbaData, result.width, result.height);
 }
 
+function toImageInfo(result: ImageInfo, module: MainModule): JXLImageInfo {
+  return {
+    width: result.width,
+    height: result.height,
+    bitDepth: result.depth,
+    channels: result.channels,
+    metadata: convertMetadata(result.metadata, module),
+  };
+}
+
 /**
  * Get image info without full decoding
  */
@@ -298,15 +344,762 @@ export async function getImageInfo(
     module._free(inputPtr);
   }
 
+  return toImageInfo(result, module);
+}
+
+export interface JXLInfoProbe {
+  /** Header info, or null if the prefix is too short */
+  info: JXLImageInfo | null;
+  /** Prefix length to try next when `info` is null */
+  bytesNeeded: number;
+}
+
+function probeWithModule(
+  module: MainModule,
+  prefix: Uint8Array,
+  isComplete: boolean,
+): JXLInfoProbe {
+  const inputPtr = copyToWasm(module, prefix);
+  let result;
+  try {
+    result = module.probeImageInfo(inputPtr, prefix.length, isComplete);
+  } finally {
+    module._free(inputPtr);
+  }
+
+  if (result.error) {
+    throw new Error(`JXL decode error: ${result.error}`);
+  }
   return {
+    info: result.complete ? toImageInfo(result.info, module) : null,
+    bytesNeeded: result.bytesNeeded,
+  };
+}
+
+/**
+ * Read header info from the first bytes of a file. If `prefix` is too
+ * short, `info` is null and `bytesNeeded` tells how long a prefix to try
+ * next. Pass `isComplete` when `prefix` is the whole file.
+ */
+export async function probeImageInfo(
+  prefix: Uint8Array | ArrayBuffer,
+  { isComplete = false }: { isComplete?: boolean } = {},
+): Promise<JXLInfoProbe> {
+  await init();
+  const data = prefix instanceof ArrayBuffer ? new Uint8Array(prefix) : prefix;
+  return probeWithModule(decoderModule!, data, isComplete);
+}
+
+/**
+ * Read header info fetching only the bytes it needs through `read`
+ * (e.g. HTTP Range requests or blob slices), starting with `initialBytes`.
+ */
+export async function getImageInfoFromRanges(
+  read: RangeReader,
+  { initialBytes = 4096 }: { initialBytes?: number } = {},
+): Promise<JXLImageInfo> {
+  await init();
+  const module = decoderModule!;
+
+  return readPrefixUntil(
+    read,
+    (prefix, isComplete) => {
+      const { info, bytesNeeded } = probeWithModule(module, prefix, isComplete);
+      return { result: info, bytesNeeded };
+    },
+    initialBytes,
+  );
+}
+
+export type JXLThumbnailSource = "preview" | "dc" | "full";
+
+export interface JXLThumbnailOptions extends JXLDecodeOptions {
+  /**
+   * Downscale factor for the DC path, a power of two from 2 up.
+   * Ignored when the file carries an embedded preview. For full size
+   * use {@link decode}.
+   * @default 8
+   */
+  scale?: number;
+}
+
+export type JXLThumbnail = JXLImageData & {
+  /**
+   * Where the pixels came from: the embedded preview, the progressive DC
+   * pass (decoding stopped early), or a full decode downscaled afterwards.
+   */
+  source: JXLThumbnailSource;
+};
+
+/**
+ * Decode a small version of the image for thumbnails, stopping as early
+ * as possible. Uses the embedded preview when present, otherwise the
+ * 1:8 DC pass, so only a fraction of the full-size memory is needed.
+ */
+export async function decodeThumbnail(
+  input: Uint8Array | ArrayBuffer,
+  options: JXLThumbnailOptions = {},
+  config?: InitConfig,
+): Promise<JXLThumbnail> {
+  await init(config);
+
+  const data = input instanceof ArrayBuffer ? new Uint8Array(input) : input;
+  const opts = { ...DEFAULT_DECODE_OPTIONS, scale: 8, ...options };
+  const module = decoderModule!;
+
+  if (!Number.isInteger(opts.scale) || opts.scale < 2 || (opts.scale & (opts.scale - 1)) !== 0) {
+    throw new RangeError(`scale must be a power of two of at least 2, got ${opts.scale}`);
+  }
+
+  const validation = validateThreadCount(
+    opts.maxThreads,
+    maxThreads,
+    isMultiThreadedModule,
+    "jcodecs-jxl",
+  );
+  if (validation.warning) {
+    console.warn(validation.warning);
+  }
+
+  const inputPtr = copyToWasm(module, data);
+
+  let result;
+  try {
+    result = module.decodeThumbnail(
+      inputPtr,
+      data.length,
+      opts.scale,
+      validation.validatedCount,
+    );
+  } finally {
+    module._free(inputPtr);
+  }
+
+  const { pixelData, outputDataType, outputDepth } = readPixels(result, module);
+
+  return {
+    data: pixelData,
+    dataType: outputDataType,
     width: result.width,
     height: result.height,
-    bitDepth: result.depth,
+    bitDepth: outputDepth,
     channels: result.channels,
     metadata: convertMetadata(result.metadata, module),
+    source: result.source as JXLThumbnailSource,
   };
 }
 
+/**
+ * Rebuild the original JPEG from a JXL created by `recompressJPEG()`.
+ * Throws if the file carries no JPEG reconstruction data.
+ */
+export async function reconstructJPEG(
+  input: Uint8Array | ArrayBuffer,
+  options: Pick<JXLDecodeOptions, "maxThreads"> = {},
+  config?: InitConfig,
+): Promise<Uint8Array> {
+  await init(config);
+
+  const data = input instanceof ArrayBuffer ? new Uint8Array(input) : input;
+  const module = decoderModule!;
+
+  const validation = validateThreadCount(
+    options.maxThreads ?? DEFAULT_DECODE_OPTIONS.maxThreads,
+    maxThreads,
+    isMultiThreadedModule,
+    "jcodecs-jxl",
+  );
+  if (validation.warning) {
+    console.warn(validation.warning);
+  }
+
+  const inputPtr = copyToWasm(module, data);
+  let result;
+  try {
+    result = module.reconstructJPEG(inputPtr, data.length, validation.validatedCount);
+  } finally {
+    module._free(inputPtr);
+  }
+
+  if (result.error) {
+    throw new Error(`JXL decode error: ${result.error}`);
+  }
+
+  const jpeg = module.HEAPU8.slice(result.dataPtr, result.dataPtr + result.dataSize);
+  module._free(result.dataPtr);
+  return jpeg;
+}
+
+/**
+ * Long-lived decoder that keeps one native decoder and thread runner alive
+ * between images. Use for batch decoding of many (small) files; call
+ * `dispose()` when done to release native resources.
+ */
+export class JXLDecoderSession {
+  private session: JxlDecoderSession | null;
+
+  /** @internal Use {@link createDecoderSession} */
+  constructor(
+    private readonly module: MainModule,
+    maxThreads: number,
+  ) {
+    this.session = new module.JxlDecoderSession(maxThreads);
+  }
+
+  /**
+   * Change the number of decode threads. The native runner is only
+   * rebuilt when the count actually changes.
+   */
+  setMaxThreads(count: number): void {
+    const validation = validateThreadCount(
+      count,
+      maxThreads,
+      isMultiThreadedModule,
+      "jcodecs-jxl",
+    );
+    if (validation.warning) {
+      console.warn(validation.warning);
+    }
+    if (!this.native().setThreadCount(validation.validatedCount)) {
+      throw new Error("JXL decode error: Failed to create parallel runner");
+    }
+  }
+
+  decode(input: Uint8Array | ArrayBuffer, crop?: CropRect): JXLImageData {
+    const session = this.native();
+    const data = input instanceof ArrayBuffer ? new Uint8Array(input) : input;
+    const nativeCrop = validateCrop(crop);
+    const inputPtr = copyToWasm(this.module, data);
+
+    let result;
+    try {
+      result = session.decode(inputPtr, data.length, nativeCrop);
+    } finally {
+      this.module._free(inputPtr);
+    }
+
+    const { pixelData, outputDataType, outputDepth } = readPixels(result, this.module);
+
+    return {
+      data: pixelData,
+      dataType: outputDataType,
+      width: result.width,
+      height: result.height,
+      bitDepth: outputDepth,
+      channels: result.channels,
+      metadata: convertMetadata(result.metadata, this.module),
+    };
+  }
+
+  getImageInfo(input: Uint8Array | ArrayBuffer): JXLImageInfo {
+    const session = this.native();
+    const data = input instanceof ArrayBuffer ? new Uint8Array(input) : input;
+    const inputPtr = copyToWasm(this.module, data);
+
+    let result;
+    try {
+      result = session.getImageInfo(inputPtr, data.length);
+    } finally {
+      this.module._free(inputPtr);
+    }
+
+    return {
+      width: result.width,
+      height: result.height,
+      bitDepth: result.depth,
+      channels: result.channels,
+      metadata: convertMetadata(result.metadata, this.module),
+    };
+  }
+
+  /**
+   * Usage of the session's native memory pool. The pool lives as long as
+   * the session; memory libjxl frees between images is reused from it.
+   * `peak` restarts with each `decode()`.
+   */
+  getMemoryStats(): JXLMemoryStats {
+    const { peak, reserved, live } = this.native().getMemoryStats();
+    return { peak, reserved, live };
+  }
+
+  /** Release the native decoder and thread runner */
+  dispose(): void {
+    this.session?.delete();
+    this.session = null;
+  }
+
+  private native(): JxlDecoderSession {
+    if (!this.session) {
+      throw new Error("JXLDecoderSession has been disposed");
+    }
+    return this.session;
+  }
+}
+
+/**
+ * Create a persistent decoder session (see {@link JXLDecoderSession}).
+ */
+export async function createDecoderSession(
+  options: Pick<JXLDecodeOptions, "maxThreads"> = {},
+  config?: InitConfig,
+): Promise<JXLDecoderSession> {
+  await init(config);
+
+  const session = new JXLDecoderSession(decoderModule!, 1);
+  session.setMaxThreads(options.maxThreads ?? DEFAULT_DECODE_OPTIONS.maxThreads);
+  return session;
+}
+
+/**
+ * Intermediate render produced while streaming a progressive JXL.
+ * Always full resolution; `downsampling` tells how much detail it carries
+ * (8 = DC only, 1 = final).
+ */
+export type JXLPartialImage = Omit<JXLImageData, "metadata"> & {
+  downsampling: number;
+};
+
+export type JXLStreamState = "needMoreInput" | "progress" | "complete";
+
+export interface JXLStreamUpdate {
+  state: JXLStreamState;
+  /** Current render, present when state is "progress" or "complete" */
+  image?: JXLPartialImage;
+}
+
+function readStreamStatus(status: StreamStatus, module: MainModule): JXLStreamUpdate {
+  if (status.state === "error") {
+    throw new Error(`JXL decode error: ${status.error}`);
+  }
+
+  const update: JXLStreamUpdate = { state: status.state as JXLStreamState };
+  if (status.dataPtr !== 0) {
+    const dataType = status.dataType as JXLDataType;
+    const bytesPerElement = dataType === "float32" ? 4 :
+                            dataType === "uint16" || dataType === "float16" ? 2 : 1;
+    update.image = {
+      data: copyFromWasmByType(module, status.dataPtr, status.dataSize / bytesPerElement, dataType),
+      dataType,
+      width: status.width,
+      height: status.height,
+      bitDepth: status.depth as 8 | 10 | 12 | 16 | 32,
+      channels: status.channels,
+      downsampling: status.downsampling,
+    };
+  }
+  return update;
+}
+
+/**
+ * Incremental decoder: feed bytes as they arrive and get intermediate
+ * renders after the DC and each progressive pass. Decodes the first frame
+ * of animated images. Call `dispose()` when done.
+ */
+export class JXLStreamingDecoder {
+  private decoder: JxlStreamingDecoder | null;
+
+  /** @internal Use {@link createStreamingDecoder} */
+  constructor(
+    private readonly module: MainModule,
+    maxThreads: number,
+  ) {
+    this.decoder = new module.JxlStreamingDecoder(maxThreads);
+  }
+
+  /** Append a chunk of the file and decode as far as possible */
+  push(chunk: Uint8Array): JXLStreamUpdate {
+    const decoder = this.native();
+    const chunkPtr = copyToWasm(this.module, chunk);
+    try {
+      return readStreamStatus(decoder.push(chunkPtr, chunk.length), this.module);
+    } finally {
+      this.module._free(chunkPtr);
+    }
+  }
+
+  /** Signal end of input. Throws if the data ends before the image does. */
+  close(): JXLStreamUpdate {
+    return readStreamStatus(this.native().close(), this.module);
+  }
+
+  /** Take the final image. Only valid after a "complete" update. */
+  result(): JXLImageData {
+    const result = this.native().takeResult();
+    const { pixelData, outputDataType, outputDepth } = readPixels(result, this.module);
+
+    return {
+      data: pixelData,
+      dataType: outputDataType,
+      width: result.width,
+      height: result.height,
+      bitDepth: outputDepth,
+      channels: result.channels,
+      metadata: convertMetadata(result.metadata, this.module),
+    };
+  }
+
+  /** Release the native decoder */
+  dispose(): void {
+    this.decoder?.delete();
+    this.decoder = null;
+  }
+
+  private native(): JxlStreamingDecoder {
+    if (!this.decoder) {
+      throw new Error("JXLStreamingDecoder has been disposed");
+    }
+    return this.decoder;
+  }
+}
+
+/**
+ * Create an incremental decoder (see {@link JXLStreamingDecoder}).
+ */
+export async function createStreamingDecoder(
+  options: Pick<JXLDecodeOptions, "maxThreads"> = {},
+  config?: InitConfig,
+): Promise<JXLStreamingDecoder> {
+  await init(config);
+
+  const validation = validateThreadCount(
+    options.maxThreads ?? DEFAULT_DECODE_OPTIONS.maxThreads,
+    maxThreads,
+    isMultiThreadedModule,
+    "jcodecs-jxl",
+  );
+  if (validation.warning) {
+    console.warn(validation.warning);
+  }
+
+  return new JXLStreamingDecoder(decoderModule!, validation.validatedCount);
+}
+
+/**
+ * Decode a JXL from a stream of chunks (e.g. `fetch().body`), reporting
+ * intermediate renders of progressive images through `onProgress`.
+ */
+export async function decodeStream(
+  stream: AsyncIterable<Uint8Array> | ReadableStream<Uint8Array>,
+  options: JXLDecodeOptions & {
+    onProgress?: (image: JXLPartialImage) => void;
+  } = {},
+  config?: InitConfig,
+): Promise<JXLImageData> {
+  const decoder = await createStreamingDecoder(options, config);
+  try {
+    let update: JXLStreamUpdate = { state: "needMoreInput" };
+    for await (const chunk of readChunks(stream)) {
+      update = decoder.push(chunk);
+      if (update.state === "progress" && update.image) {
+        options.onProgress?.(update.image);
+      }
+      if (update.state === "complete") break;
+    }
+    if (update.state !== "complete") {
+      update = decoder.close();
+    }
+    return decoder.result();
+  } finally {
+    decoder.dispose();
+  }
+}
+
+/**
+ * One frame of an animated JXL.
+ * With `coalesce: false` this is the raw layer: `x0`/`y0` give its position on
+ * the canvas and `blendMode`/`blendSource` how to composite it.
+ */
+export type JXLFrame = Omit<JXLImageData, "metadata"> & {
+  index: number;
+  x0: number;
+  y0: number;
+  /** Duration in animation ticks */
+  duration: number;
+  durationMs: number;
+  blendMode: "replace" | "add" | "blend" | "muladd" | "mul";
+  blendSource: number;
+  isLast: boolean;
+};
+
+export interface JXLAnimationInfo extends JXLImageInfo {
+  frameCount: number;
+  /** Ticks per second as a fraction */
+  ticksPerSecond: [numerator: number, denominator: number];
+  /** 0 = loop forever */
+  numLoops: number;
+  durationMs: number;
+}
+
+export interface JXLFrameDecodeOptions extends JXLDecodeOptions {
+  /**
+   * Composite frames onto the full canvas (true) or return raw layers (false).
+   * @default true
+   */
+  coalesce?: boolean;
+}
+
+/**
+ * Iterates over the frames of an animated JXL, decoding one frame per
+ * `next()` call. `seek()` skips frames without rendering them.
+ * Call `dispose()` when done.
+ */
+export class JXLFrameIterator implements Iterable<JXLFrame> {
+  readonly info: JXLAnimationInfo;
+  private readonly dataType: JXLDataType;
+  private iterator: JxlFrameIterator | null;
+
+  /** @internal Use {@link decodeFrames} */
+  constructor(
+    private readonly module: MainModule,
+    iterator: JxlFrameIterator,
+  ) {
+    this.iterator = iterator;
+
+    const info = iterator.getInfo();
+    const metadata = convertMetadata(info.metadata, module);
+    if (info.error) {
+      iterator.delete();
+      throw new Error(`JXL decode error: ${info.error}`);
+    }
+
+    this.info = {
+      width: info.width,
+      height: info.height,
+      bitDepth: info.depth,
+      channels: info.channels,
+      metadata,
+      frameCount: info.frameCount,
+      ticksPerSecond: [info.tpsNumerator, info.tpsDenominator],
+      numLoops: info.numLoops,
+      durationMs: info.durationMs,
+    };
+    this.dataType = info.dataType as JXLDataType;
+  }
+
+  /** Index of the frame the next call to `next()` returns */
+  get position(): number {
+    return this.native().getFrameIndex();
+  }
+
+  /** Decode the next frame, or return null after the last one */
+  next(): JXLFrame | null {
+    const frame = this.native().next();
+    if (frame.error) {
+      throw new Error(`JXL decode error: ${frame.error}`);
+    }
+    if (frame.done) {
+      return null;
+    }
+
+    const bytesPerElement = this.dataType === "float32" ? 4 :
+                            this.dataType === "uint16" || this.dataType === "float16" ? 2 : 1;
+    const data = copyFromWasmByType(
+      this.module,
+      frame.dataPtr,
+      frame.dataSize / bytesPerElement,
+      this.dataType,
+    );
+    this.module._free(frame.dataPtr);
+
+    return {
+      data,
+      dataType: this.dataType,
+      width: frame.width,
+      height: frame.height,
+      bitDepth: this.info.bitDepth as 8 | 10 | 12 | 16 | 32,
+      channels: this.info.channels,
+      index: frame.index,
+      x0: frame.x0,
+      y0: frame.y0,
+      duration: frame.duration,
+      durationMs: frame.durationMs,
+      blendMode: frame.blendMode as JXLFrame["blendMode"],
+      blendSource: frame.blendSource,
+      isLast: frame.isLast,
+    };
+  }
+
+  /** Make the next call to `next()` return frame `index` */
+  seek(index: number): void {
+    if (!this.native().seek(index)) {
+      throw new RangeError(`Frame ${index} out of range (0..${this.info.frameCount - 1})`);
+    }
+  }
+
+  /** Skip `count` frames without decoding them */
+  skip(count: number): void {
+    this.seek(this.position + count);
+  }
+
+  *[Symbol.iterator](): Iterator<JXLFrame> {
+    for (let frame = this.next(); frame; frame = this.next()) {
+      yield frame;
+    }
+  }
+
+  /** Release the native decoder */
+  dispose(): void {
+    this.iterator?.delete();
+    this.iterator = null;
+  }
+
+  private native(): JxlFrameIterator {
+    if (!this.iterator) {
+      throw new Error("JXLFrameIterator has been disposed");
+    }
+    return this.iterator;
+  }
+}
+
+/**
+ * Open an (animated) JXL for frame-by-frame decoding.
+ */
+export async function decodeFrames(
+  input: Uint8Array | ArrayBuffer,
+  options: JXLFrameDecodeOptions = {},
+  config?: InitConfig,
+): Promise<JXLFrameIterator> {
+  await init(config);
+
+  const data = input instanceof ArrayBuffer ? new Uint8Array(input) : input;
+  const module = decoderModule!;
+
+  const validation = validateThreadCount(
+    options.maxThreads ?? DEFAULT_DECODE_OPTIONS.maxThreads,
+    maxThreads,
+    isMultiThreadedModule,
+    "jcodecs-jxl",
+  );
+  if (validation.warning) {
+    console.warn(validation.warning);
+  }
+
+  // The native iterator keeps its own copy of the input
+  const inputPtr = copyToWasm(module, data);
+  let iterator;
+  try {
+    iterator = new module.JxlFrameIterator(
+      inputPtr,
+      data.length,
+      validation.validatedCount,
+      options.coalesce ?? true,
+    );
+  } finally {
+    module._free(inputPtr);
+  }
+
+  return new JXLFrameIterator(module, iterator);
+}
+
+/**
+ * Usage of the native memory pool shared by the one-shot decode functions.
+ * The pool is released in bulk after every image and its chunks are kept
+ * for the next one, so `reserved` stays at the largest image's need.
+ * Returns null before the decoder is initialized.
+ */
+export function getMemoryStats(): JXLMemoryStats | null {
+  if (!decoderModule) return null;
+  const { peak, reserved, live } = decoderModule.getMemoryStats();
+  return { peak, reserved, live };
+}
+
+/**
+ * Return the pooled chunks of the one-shot decode functions to the wasm
+ * heap, e.g. after an unusually large image. The heap itself never shrinks,
+ * but the memory becomes available to other allocations.
+ */
+export function releaseMemory(): void {
+  decoderModule?.releaseMemory();
+}
+
+/**
+ * Measure how close `distorted` is to `reference` (PSNR, SSIM,
+ * SSIMULACRA2). Runs natively in the decoder module; both images must have
+ * the same size and channel count, sample types may differ.
+ */
+export async function compareImages(
+  reference: ExtendedImageData,
+  distorted: ExtendedImageData,
+  options: MetricsOptions = {},
+  config?: InitConfig,
+): Promise<ImageMetrics> {
+  await init(config);
+  return compareImagesInWasm(decoderModule!, reference, distorted, options);
+}
+
+export interface JXLCompareOptions extends MetricsOptions {
+  /** Options for decoding the JXL under test */
+  decode?: JXLDecodeOptions;
+}
+
+/**
+ * Decode a JXL and compare it against the original pixels. The decoded
+ * image stays in the WASM heap and is measured there, so only the reference
+ * is copied in.
+ */
+export async function decodeAndCompare(
+  input: Uint8Array | ArrayBuffer,
+  reference: ExtendedImageData,
+  options: JXLCompareOptions = {},
+  config?: InitConfig,
+): Promise<ImageMetrics> {
+  await init(config);
+
+  const { decode: decodeOptions, ...metricsOptions } = options;
+  const data = input instanceof ArrayBuffer ? new Uint8Array(input) : input;
+  const opts = { ...DEFAULT_DECODE_OPTIONS, ...decodeOptions };
+  const module = decoderModule!;
+
+  const validation = validateThreadCount(
+    opts.maxThreads,
+    maxThreads,
+    isMultiThreadedModule,
+    "jcodecs-jxl",
+  );
+  if (validation.warning) {
+    console.warn(validation.warning);
+  }
+
+  const inputPtr = copyToWasm(module, data);
+  let result;
+  try {
+    result = module.decode(
+      inputPtr,
+      data.length,
+      validation.validatedCount,
+      validateCrop(opts.crop),
+    );
+  } finally {
+    module._free(inputPtr);
+  }
+
+  if (result.error) {
+    throw new Error(`JXL decode error: ${result.error}`);
+  }
+  if (result.metadata.iccProfilePtr !== 0) {
+    module._free(result.metadata.iccProfilePtr);
+  }
+
+  try {
+    return compareWithWasm(
+      module,
+      reference,
+      {
+        dataPtr: result.dataPtr,
+        dataSize: result.dataSize,
+        width: result.width,
+        height: result.height,
+        channels: result.channels,
+        dataType: result.dataType as JXLDataType,
+        bitDepth: result.depth,
+      },
+      metricsOptions,
+    );
+  } finally {
+    module._free(result.dataPtr);
+  }
+}
+
 export function isInitialized(): boolean {
   return decoderModule !== null;
 }
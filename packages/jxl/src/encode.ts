@@ -6,11 +6,31 @@ import {
   copyToWasm16f,
   copyToWasm32f,
 } from "@dimkatet/jcodecs-core";
-import type { JXLEncodeOptions } from "./options";
-import { DEFAULT_ENCODE_OPTIONS } from "./options";
-import type { JXLImageData } from "./types";
+import type {
+  JXLAnimationOptions,
+  JXLEncodeOptions,
+  JXLFrameOptions,
+  JXLRecompressOptions,
+  JXLTargetSizeOptions,
+} from "./options";
+import {
+  DEFAULT_ANIMATION_OPTIONS,
+  DEFAULT_ENCODE_OPTIONS,
+  DEFAULT_TARGET_SIZE_OPTIONS,
+} from "./options";
+import type {
+  JXLDataType,
+  JXLImageData,
+  JXLMemoryStats,
+  JXLTargetSizeResult,
+} from "./types";
 import { validateDataType, validateDataTypeMatch } from "./validation";
-import type { MainModule, EncodeOptions } from "./wasm/jxl_enc";
+import type {
+  MainModule,
+  EncodeOptions,
+  AnimationOptions,
+  JxlAnimationEncoder,
+} from "./wasm/jxl_enc";
 import { mtEncoderUrl, stEncoderUrl } from "./urls";
 
 type WasmModule = typeof import("./wasm/jxl_enc_mt");
@@ -91,19 +111,28 @@ export async function init({ jsUrl, preferMT }: InitConfig = {}): Promise<void>
   await initPromise;
 }
 
+interface CopiedPixels {
+  inputPtr: number;
+  inputSize: number;
+  width: number;
+  height: number;
+  channels: number;
+  inputBitDepth: number;
+  dataType: JXLDataType;
+}
+
+interface PreparedInput extends CopiedPixels {
+  wasmOptions: EncodeOptions;
+}
+
 /**
- * Encode image data to JXL format
+ * Merge defaults, clamp maxThreads and build the native options struct
  */
-export async function encode(
-  imageData: ImageData | ExtendedImageData,
-  options: JXLEncodeOptions = {},
-  config?: InitConfig,
-): Promise<Uint8Array> {
-  await init(config);
-  const t0 = profilingEnabled ? performance.now() : 0;
-
+function buildWasmOptions(
+  options: JXLEncodeOptions,
+  dataType: JXLDataType,
+): EncodeOptions {
   const opts = { ...DEFAULT_ENCODE_OPTIONS, ...options };
-  const module = encoderModule!;
 
   // Validate maxThreads
   const validation = validateThreadCount(
@@ -115,8 +144,28 @@ export async function encode(
   if (validation.warning) {
     console.warn(validation.warning);
   }
-  opts.maxThreads = validation.validatedCount;
 
+  return {
+    quality: opts.quality,
+    effort: opts.effort,
+    lossless: opts.lossless,
+    bitDepth: opts.bitDepth,
+    colorSpace: opts.colorSpace,
+    transferFunction: opts.transferFunction,
+    progressive: opts.progressive,
+    maxThreads: validation.validatedCount,
+    dataType: dataType,
+  };
+}
+
+/**
+ * Validate the image and copy its pixels to the WASM heap.
+ * Caller must free `inputPtr`.
+ */
+function copyPixels(
+  module: MainModule,
+  imageData: ImageData | ExtendedImageData,
+): CopiedPixels {
   // Determine input format
   const width = imageData.width;
   const height = imageData.height;
@@ -163,7 +212,6 @@ export async function encode(
   }
 
   // Copy input data to WASM heap using appropriate function
-  const t1 = profilingEnabled ? performance.now() : 0;
   let inputPtr: number;
   let inputSize: number;
 
@@ -181,20 +229,38 @@ export async function encode(
     inputSize = (pixelData as Uint8Array).length;
   }
 
-  const t2 = profilingEnabled ? performance.now() : 0;
+  return { inputPtr, inputSize, width, height, channels, inputBitDepth, dataType };
+}
 
-  // Prepare WASM options
-  const wasmOptions: EncodeOptions = {
-    quality: opts.quality,
-    effort: opts.effort,
-    lossless: opts.lossless,
-    bitDepth: opts.bitDepth,
-    colorSpace: opts.colorSpace,
-    transferFunction: opts.transferFunction,
-    progressive: opts.progressive,
-    maxThreads: opts.maxThreads,
-    dataType: dataType,
-  };
+/**
+ * Validate options and copy pixels to the WASM heap.
+ * Caller must free `inputPtr`.
+ */
+function prepareInput(
+  module: MainModule,
+  imageData: ImageData | ExtendedImageData,
+  options: JXLEncodeOptions,
+): PreparedInput {
+  const pixels = copyPixels(module, imageData);
+  return { ...pixels, wasmOptions: buildWasmOptions(options, pixels.dataType) };
+}
+
+/**
+ * Encode image data to JXL format
+ */
+export async function encode(
+  imageData: ImageData | ExtendedImageData,
+  options: JXLEncodeOptions = {},
+  config?: InitConfig,
+): Promise<Uint8Array> {
+  await init(config);
+  const t0 = profilingEnabled ? performance.now() : 0;
+  const module = encoderModule!;
+
+  const t1 = profilingEnabled ? performance.now() : 0;
+  const { inputPtr, inputSize, width, height, channels, inputBitDepth, wasmOptions } =
+    prepareInput(module, imageData, options);
+  const t2 = profilingEnabled ? performance.now() : 0;
 
   let result;
   try {
@@ -230,7 +296,7 @@ export async function encode(
       outputSize: result.dataSize,
       dimensions: `${width}x${height}`,
       inputBitDepth,
-      outputBitDepth: opts.bitDepth,
+      outputBitDepth: wasmOptions.bitDepth,
       copyToWasm: t2 - t1,
       wasmEncode: t3 - t2,
       copyFromWasm: t4 - t3,
@@ -239,13 +305,464 @@ export async function encode(
   }
 
   // Call progress callback if provided
-  if (opts.onProgress) {
-    opts.onProgress(1, "complete");
+  if (options.onProgress) {
+    options.onProgress(1, "complete");
+  }
+
+  return output;
+}
+
+/**
+ * Wrap a chunk callback for the native encoder. The native view is copied
+ * before it is handed out. Nothing may throw through the native call (its
+ * destructors would never run), so a failure is returned as `false`, which
+ * aborts the encode, and `rethrow()` raises it after the call has returned.
+ */
+function forwardChunks(onChunk: (chunk: Uint8Array) => void) {
+  let failure: { error: unknown } | undefined;
+  return {
+    callback: (view: Uint8Array): boolean => {
+      if (failure) return false;
+      try {
+        onChunk(view.slice());
+        return true;
+      } catch (error) {
+        failure = { error };
+        return false;
+      }
+    },
+    rethrow() {
+      if (failure) throw failure.error;
+    },
+  };
+}
+
+/**
+ * Encode image data to JXL, passing output to `onChunk` as soon as the
+ * encoder finalizes it instead of collecting the whole file in the WASM
+ * heap. Chunks arrive in file order; concatenated they form the file.
+ *
+ * @returns Total number of bytes emitted
+ */
+export async function encodeChunked(
+  imageData: ImageData | ExtendedImageData,
+  onChunk: (chunk: Uint8Array) => void,
+  options: JXLEncodeOptions = {},
+  config?: InitConfig,
+): Promise<number> {
+  await init(config);
+  const module = encoderModule!;
+
+  const { inputPtr, inputSize, width, height, channels, inputBitDepth, wasmOptions } =
+    prepareInput(module, imageData, options);
+
+  const chunks = forwardChunks(onChunk);
+  let result;
+  try {
+    result = module.encodeStreaming(
+      inputPtr,
+      inputSize,
+      width,
+      height,
+      channels,
+      inputBitDepth,
+      wasmOptions,
+      chunks.callback,
+    );
+  } finally {
+    module._free(inputPtr);
+  }
+
+  chunks.rethrow();
+  if (result.error) {
+    throw new Error(`JXL encode error: ${result.error}`);
+  }
+
+  if (options.onProgress) {
+    options.onProgress(1, "complete");
+  }
+
+  return result.dataSize;
+}
+
+/**
+ * Encode to the highest quality that fits in `options.maxBytes`. The
+ * quality search runs natively on one reused encoder, so basic info,
+ * colour setup and the input copy are shared by all candidates (typically
+ * 4-7 encodes).
+ */
+export async function encodeToSize(
+  imageData: ImageData | ExtendedImageData,
+  options: JXLTargetSizeOptions,
+  config?: InitConfig,
+): Promise<JXLTargetSizeResult> {
+  await init(config);
+  const module = encoderModule!;
+
+  const { maxBytes, minQuality, maxQuality, tolerance, ...encodeOptions } = {
+    ...DEFAULT_TARGET_SIZE_OPTIONS,
+    ...options,
+  };
+  if (!(maxBytes > 0)) {
+    throw new Error("JXL encode error: maxBytes must be greater than 0");
+  }
+
+  const { inputPtr, inputSize, width, height, channels, inputBitDepth, wasmOptions } =
+    prepareInput(module, imageData, { ...encodeOptions, lossless: false });
+
+  let result;
+  try {
+    result = module.encodeToSize(
+      inputPtr,
+      inputSize,
+      width,
+      height,
+      channels,
+      inputBitDepth,
+      wasmOptions,
+      { maxBytes, minQuality, maxQuality, tolerance },
+    );
+  } finally {
+    module._free(inputPtr);
+  }
+
+  if (result.error) {
+    throw new Error(`JXL encode error: ${result.error}`);
+  }
+
+  const data = new Uint8Array(result.dataSize);
+  data.set(new Uint8Array(module.HEAPU8.buffer, result.dataPtr, result.dataSize));
+  module._free(result.dataPtr);
+
+  return {
+    data,
+    quality: result.quality,
+    attempts: result.attempts,
+    targetMet: result.targetMet,
+  };
+}
+
+/**
+ * Image supplied tile by tile for {@link encodeTiled}
+ */
+export interface JXLTiledSource {
+  width: number;
+  height: number;
+  /** 1 (gray), 2 (gray+alpha), 3 (RGB) or 4 (RGBA) */
+  channels: number;
+  /** @default "uint8" */
+  dataType?: JXLDataType;
+  /** Real precision of integer samples. @default 8 for uint8, 16 otherwise */
+  bitDepth?: number;
+  /**
+   * Return the interleaved, row-major pixels of the given rectangle
+   * (`width * height * channels` samples of `dataType`).
+   * Called synchronously from inside the encoder, possibly many times.
+   * A thrown error aborts the encode and is rethrown by the encode call.
+   */
+  getTile(
+    x: number,
+    y: number,
+    width: number,
+    height: number,
+  ): Uint8Array | Uint16Array | Float16Array | Float32Array;
+}
+
+function runTiledEncode(
+  module: MainModule,
+  source: JXLTiledSource,
+  options: JXLEncodeOptions,
+  onChunk: ((chunk: Uint8Array) => void) | undefined,
+) {
+  const dataType = source.dataType ?? "uint8";
+  validateDataType(dataType);
+  const inputBitDepth = source.bitDepth ?? (dataType === "uint8" ? 8 : 16);
+  const wasmOptions = buildWasmOptions(options, dataType);
+
+  // Tiles are copied into native buffers owned by the encoder. Nothing may
+  // throw through the native call (its destructors would never run), so a
+  // failure is reported as `false` and rethrown after the call returns.
+  let sourceError: { error: unknown } | undefined;
+  const getTile = (x: number, y: number, w: number, h: number, dest: Uint8Array): boolean => {
+    if (sourceError) return false;
+    try {
+      const tile = source.getTile(x, y, w, h);
+      if (tile.byteLength !== dest.byteLength) {
+        throw new RangeError(
+          `getTile(${x}, ${y}, ${w}, ${h}) returned ${tile.byteLength} bytes, expected ${dest.byteLength}`,
+        );
+      }
+      dest.set(new Uint8Array(tile.buffer, tile.byteOffset, tile.byteLength));
+      return true;
+    } catch (error) {
+      sourceError = { error };
+      return false;
+    }
+  };
+
+  const chunks = onChunk ? forwardChunks(onChunk) : undefined;
+  const result = module.encodeTiled(
+    source.width,
+    source.height,
+    source.channels,
+    inputBitDepth,
+    wasmOptions,
+    getTile,
+    chunks?.callback,
+  );
+
+  if (sourceError) {
+    throw sourceError.error;
+  }
+  chunks?.rethrow();
+  if (result.error) {
+    throw new Error(`JXL encode error: ${result.error}`);
+  }
+  return result;
+}
+
+/**
+ * Encode an image that is pulled tile by tile from `source.getTile`,
+ * so the full frame never has to be in the WASM heap at once. Use
+ * {@link encodeTiledChunked} to also stream the output.
+ */
+export async function encodeTiled(
+  source: JXLTiledSource,
+  options: JXLEncodeOptions = {},
+  config?: InitConfig,
+): Promise<Uint8Array> {
+  await init(config);
+  const module = encoderModule!;
+
+  const result = runTiledEncode(module, source, options, undefined);
+
+  const output = module.HEAPU8.slice(result.dataPtr, result.dataPtr + result.dataSize);
+  module._free(result.dataPtr);
+
+  if (options.onProgress) {
+    options.onProgress(1, "complete");
+  }
+  return output;
+}
+
+/**
+ * Tiled input and chunked output: memory stays bounded by the encoder's
+ * working set regardless of image size.
+ *
+ * @returns Total number of bytes emitted
+ */
+export async function encodeTiledChunked(
+  source: JXLTiledSource,
+  onChunk: (chunk: Uint8Array) => void,
+  options: JXLEncodeOptions = {},
+  config?: InitConfig,
+): Promise<number> {
+  await init(config);
+  const module = encoderModule!;
+
+  const result = runTiledEncode(module, source, options, onChunk);
+
+  if (options.onProgress) {
+    options.onProgress(1, "complete");
+  }
+  return result.dataSize;
+}
+
+/**
+ * Losslessly recompress a JPEG file into JXL without decoding to pixels.
+ * The result keeps the JPEG bitstream metadata, so `reconstructJPEG()`
+ * returns the original file byte for byte.
+ */
+export async function recompressJPEG(
+  jpeg: Uint8Array | ArrayBuffer,
+  options: JXLRecompressOptions = {},
+  config?: InitConfig,
+): Promise<Uint8Array> {
+  await init(config);
+  const module = encoderModule!;
+  const data = jpeg instanceof ArrayBuffer ? new Uint8Array(jpeg) : jpeg;
+
+  const validation = validateThreadCount(
+    options.maxThreads ?? DEFAULT_ENCODE_OPTIONS.maxThreads,
+    maxThreads,
+    isMultiThreadedModule,
+    "jcodecs-jxl",
+  );
+  if (validation.warning) {
+    console.warn(validation.warning);
+  }
+
+  const inputPtr = copyToWasm(module, data);
+  let result;
+  try {
+    result = module.recompressJPEG(
+      inputPtr,
+      data.length,
+      options.effort ?? DEFAULT_ENCODE_OPTIONS.effort,
+      validation.validatedCount,
+    );
+  } finally {
+    module._free(inputPtr);
+  }
+
+  if (result.error) {
+    throw new Error(`JXL encode error: ${result.error}`);
   }
 
+  const output = module.HEAPU8.slice(result.dataPtr, result.dataPtr + result.dataSize);
+  module._free(result.dataPtr);
   return output;
 }
 
+// ============================================================================
+// Animation
+// ============================================================================
+
+interface FrameLayout {
+  channels: number;
+  inputBitDepth: number;
+  dataType: JXLDataType;
+}
+
+/**
+ * Builds an animated JXL frame by frame. Only the newest frame is held in
+ * the WASM heap, so animations of any length can be encoded without having
+ * every frame in memory. Frames must share channels, data type and bit
+ * depth; they may be smaller than the canvas and placed with `x`/`y`.
+ * Call `finish()` to get the file, or `dispose()` to abandon it.
+ */
+export class JXLAnimationEncoder {
+  private encoder: JxlAnimationEncoder | null = null;
+  private layout: FrameLayout | null = null;
+  private disposed = false;
+
+  /** @internal Use {@link createAnimationEncoder} */
+  constructor(
+    private readonly module: MainModule,
+    private readonly options: JXLAnimationOptions,
+    private readonly animation: AnimationOptions,
+  ) {}
+
+  /** Number of frames added so far */
+  get frameCount(): number {
+    return this.encoder?.getFrameCount() ?? 0;
+  }
+
+  addFrame(
+    imageData: ImageData | ExtendedImageData,
+    frame: JXLFrameOptions,
+  ): void {
+    if (this.disposed) {
+      throw new Error("JXLAnimationEncoder has been disposed");
+    }
+
+    const pixels = copyPixels(this.module, imageData);
+    let error;
+    try {
+      const encoder = this.native(pixels);
+      error = encoder.addFrame(pixels.inputPtr, pixels.inputSize, pixels.width, pixels.height, {
+        duration: frame.duration,
+        blendMode: frame.blendMode ?? "replace",
+        blendSource: frame.blendSource ?? 0,
+        saveAsReference: frame.saveAsReference ?? 0,
+        x: frame.x ?? 0,
+        y: frame.y ?? 0,
+      });
+    } finally {
+      this.module._free(pixels.inputPtr);
+    }
+
+    if (error) {
+      throw new Error(`JXL encode error: ${error}`);
+    }
+  }
+
+  /** Encode the last frame and return the JXL file */
+  finish(): Uint8Array {
+    if (!this.encoder) {
+      throw new Error("JXL encode error: No frames added");
+    }
+
+    const result = this.encoder.finish();
+    this.dispose();
+    if (result.error) {
+      throw new Error(`JXL encode error: ${result.error}`);
+    }
+
+    const output = this.module.HEAPU8.slice(result.dataPtr, result.dataPtr + result.dataSize);
+    this.module._free(result.dataPtr);
+    return output;
+  }
+
+  /** Release the native encoder */
+  dispose(): void {
+    this.encoder?.delete();
+    this.encoder = null;
+    this.disposed = true;
+  }
+
+  // The native encoder is created lazily from the first frame's layout
+  private native(pixels: CopiedPixels): JxlAnimationEncoder {
+    if (this.encoder && this.layout) {
+      const l = this.layout;
+      if (
+        pixels.channels !== l.channels ||
+        pixels.dataType !== l.dataType ||
+        pixels.inputBitDepth !== l.inputBitDepth
+      ) {
+        throw new Error(
+          `JXL encode error: frame ${pixels.channels}ch ${pixels.dataType} @${pixels.inputBitDepth}bit ` +
+            `does not match animation ${l.channels}ch ${l.dataType} @${l.inputBitDepth}bit`,
+        );
+      }
+      return this.encoder;
+    }
+
+    const encoder = new this.module.JxlAnimationEncoder(
+      this.options.width ?? pixels.width,
+      this.options.height ?? pixels.height,
+      pixels.channels,
+      pixels.inputBitDepth,
+      buildWasmOptions(this.options, pixels.dataType),
+      this.animation,
+    );
+    const error = encoder.getError();
+    if (error) {
+      encoder.delete();
+      throw new Error(`JXL encode error: ${error}`);
+    }
+
+    this.encoder = encoder;
+    this.layout = {
+      channels: pixels.channels,
+      inputBitDepth: pixels.inputBitDepth,
+      dataType: pixels.dataType,
+    };
+    return encoder;
+  }
+}
+
+/**
+ * Start encoding an animated JXL.
+ */
+export async function createAnimationEncoder(
+  options: JXLAnimationOptions = {},
+  config?: InitConfig,
+): Promise<JXLAnimationEncoder> {
+  await init(config);
+
+  const { tpsNumerator, tpsDenominator, numLoops } = {
+    ...DEFAULT_ANIMATION_OPTIONS,
+    ...options,
+  };
+
+  return new JXLAnimationEncoder(encoderModule!, options, {
+    tpsNumerator,
+    tpsDenominator,
+    numLoops,
+  });
+}
+
 /**
  * Encode ImageData to JXL with simple options
  */
@@ -256,6 +773,26 @@ export async function encodeSimple(
   return encode(imageData, { quality });
 }
 
+/**
+ * Usage of the native memory pool shared by the one-shot encode functions.
+ * The pool is released in bulk after every image and its chunks are kept
+ * for the next one. Animation encoders use a pool of their own.
+ * Returns null before the encoder is initialized.
+ */
+export function getMemoryStats(): JXLMemoryStats | null {
+  if (!encoderModule) return null;
+  const { peak, reserved, live } = encoderModule.getMemoryStats();
+  return { peak, reserved, live };
+}
+
+/**
+ * Return the pooled chunks of the one-shot encode functions to the wasm
+ * heap, e.g. after an unusually large image.
+ */
+export function releaseMemory(): void {
+  encoderModule?.releaseMemory();
+}
+
 /**
  * Check if encoder is initialized
  */
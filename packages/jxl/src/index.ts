@@ -1,39 +1,88 @@
 // Main exports
 export {
   encode,
+  encodeChunked,
+  encodeToSize,
+  encodeTiled,
+  encodeTiledChunked,
+  recompressJPEG,
+  createAnimationEncoder,
+  JXLAnimationEncoder,
   encodeSimple,
+  getMemoryStats as getEncoderMemoryStats,
+  releaseMemory as releaseEncoderMemory,
   init as initEncoder,
   isInitialized as isEncoderInitialized,
 } from './encode';
 
-export type { InitConfig as EncoderInitConfig } from './encode';
+export type { InitConfig as EncoderInitConfig, JXLTiledSource } from './encode';
 
 export {
   decode,
   decodeToImageData,
   getImageInfo,
+  probeImageInfo,
+  getImageInfoFromRanges,
+  decodeThumbnail,
+  reconstructJPEG,
+  createDecoderSession,
+  JXLDecoderSession,
+  createStreamingDecoder,
+  decodeStream,
+  JXLStreamingDecoder,
+  decodeFrames,
+  JXLFrameIterator,
+  getMemoryStats as getDecoderMemoryStats,
+  releaseMemory as releaseDecoderMemory,
+  compareImages,
+  decodeAndCompare,
   init as initDecoder,
   isInitialized as isDecoderInitialized,
   isMultiThreaded as isDecoderMultiThreaded,
 } from './decode';
 
-export type { InitConfig as DecoderInitConfig } from './decode';
+export type {
+  InitConfig as DecoderInitConfig,
+  JXLInfoProbe,
+  JXLPartialImage,
+  JXLStreamState,
+  JXLStreamUpdate,
+  JXLFrame,
+  JXLAnimationInfo,
+  JXLFrameDecodeOptions,
+  JXLThumbnail,
+  JXLThumbnailOptions,
+  JXLThumbnailSource,
+  JXLCompareOptions,
+} from './decode';
 
 // Options
 export type {
   JXLEncodeOptions,
+  JXLAnimationOptions,
+  JXLFrameOptions,
+  JXLBlendMode,
   JXLDecodeOptions,
+  JXLRecompressOptions,
+  JXLTargetSizeOptions,
   ColorSpace,
   TransferFunctionOption,
 } from './options';
 
-export { DEFAULT_ENCODE_OPTIONS, DEFAULT_DECODE_OPTIONS } from './options';
+export {
+  DEFAULT_ENCODE_OPTIONS,
+  DEFAULT_ANIMATION_OPTIONS,
+  DEFAULT_TARGET_SIZE_OPTIONS,
+  DEFAULT_DECODE_OPTIONS,
+} from './options';
 
 // JXL-specific types
 export type {
   JXLMetadata,
   JXLImageData,
   JXLImageInfo,
+  JXLMemoryStats,
+  JXLTargetSizeResult,
   ColorPrimaries,
   TransferFunction,
   MatrixCoefficients,
@@ -56,4 +105,10 @@ export type { WorkerPoolConfig, JXLWorkerClient } from './worker-api';
 
 // Re-export from core
 export { isMultiThreadSupported } from '@dimkatet/jcodecs-core';
-export type { ExtendedImageData, ImageInfo } from '@dimkatet/jcodecs-core';
+export type {
+  ExtendedImageData,
+  ImageInfo,
+  RangeReader,
+  ImageMetrics,
+  MetricsOptions,
+} from '@dimkatet/jcodecs-core';
@@ -1,4 +1,4 @@
-import type { ProgressCallback } from "@dimkatet/jcodecs-core";
+import type { CropRect, ProgressCallback } from "@dimkatet/jcodecs-core";
 import type { JXLMetadata } from "./types";
 
 /**
@@ -84,6 +84,127 @@ export interface JXLEncodeOptions {
   onProgress?: ProgressCallback;
 }
 
+/**
+ * Options for encoding an animation.
+ * Per-image options apply to every frame.
+ */
+export interface JXLAnimationOptions
+  extends Omit<JXLEncodeOptions, "metadata" | "onProgress"> {
+  /**
+   * Canvas size. Frames can be smaller and placed anywhere on it.
+   * @default size of the first frame
+   */
+  width?: number;
+  height?: number;
+
+  /**
+   * Tick rate as a fraction (ticks per second = numerator / denominator).
+   * Frame durations are given in ticks. Use 30000/1001 for NTSC rates.
+   * @default 1000 / 1 (milliseconds)
+   */
+  tpsNumerator?: number;
+  tpsDenominator?: number;
+
+  /**
+   * Number of times to play the animation. 0 = loop forever.
+   * @default 0
+   */
+  numLoops?: number;
+}
+
+/**
+ * How a frame is combined with the reference frame it is drawn onto.
+ * - 'replace': Overwrite the covered area
+ * - 'blend': Alpha-composite over the reference
+ * - 'add', 'mul', 'muladd': Arithmetic blending
+ */
+export type JXLBlendMode = "replace" | "blend" | "add" | "mul" | "muladd";
+
+/**
+ * Per-frame options for animation encoding
+ */
+export interface JXLFrameOptions {
+  /**
+   * Display duration in ticks. 0 makes the frame a layer that is
+   * composited with the next one instead of being shown on its own.
+   */
+  duration: number;
+
+  /**
+   * @default 'replace'
+   */
+  blendMode?: JXLBlendMode;
+
+  /**
+   * Reference slot (0-3) the frame is blended onto.
+   * @default 0
+   */
+  blendSource?: number;
+
+  /**
+   * Reference slot (0-3) to keep the blended frame in, so later frames can
+   * blend onto it and only encode what changed. For frames with a nonzero
+   * duration, slot 0 means the frame is not kept.
+   * @default 0
+   */
+  saveAsReference?: number;
+
+  /**
+   * Position of the frame on the canvas. A frame smaller than the canvas
+   * only encodes that region.
+   * @default 0
+   */
+  x?: number;
+  y?: number;
+}
+
+/**
+ * Options for `encodeToSize()`. Quality is searched between `minQuality`
+ * and `maxQuality`; the other encode options apply to every candidate.
+ */
+export interface JXLTargetSizeOptions
+  extends Omit<JXLEncodeOptions, "quality" | "lossless"> {
+  /** Size budget for the encoded file, in bytes */
+  maxBytes: number;
+
+  /**
+   * Lowest quality to try. Returned (with `targetMet: false`) when even
+   * it exceeds the budget.
+   * @default 10
+   */
+  minQuality?: number;
+
+  /**
+   * Highest quality to try.
+   * @default 90
+   */
+  maxQuality?: number;
+
+  /**
+   * Stop searching once a candidate lands within this fraction below
+   * `maxBytes` (0.05 = anything from 95% to 100% of the budget).
+   * @default 0.05
+   */
+  tolerance?: number;
+}
+
+/**
+ * Lossless JPEG recompression options
+ */
+export interface JXLRecompressOptions {
+  /**
+   * Encoder effort (1-10). Higher is smaller and slower.
+   * @default 7
+   */
+  effort?: number;
+
+  /**
+   * Maximum number of threads to use (only effective with MT encoder).
+   * @default 0
+   */
+  maxThreads?: number;
+}
+
 /**
  * JXL decoding options
  */
@@ -100,6 +221,13 @@ export interface JXLDecodeOptions {
    * @default 0
    */
   maxThreads?: number;
+
+  /**
+   * Decode only this region. The output buffer covers just the crop;
+   * the rest of the frame is decoded but never stored.
+   * @default undefined (full image)
+   */
+  crop?: CropRect;
 }
 
 /**
@@ -118,10 +246,32 @@ export const DEFAULT_ENCODE_OPTIONS: Required<
   maxThreads: 0,
 };
 
+/**
+ * Default target size search options
+ */
+export const DEFAULT_TARGET_SIZE_OPTIONS: Required<
+  Pick<JXLTargetSizeOptions, "minQuality" | "maxQuality" | "tolerance">
+> = {
+  minQuality: 10,
+  maxQuality: 90,
+  tolerance: 0.05,
+};
+
+/**
+ * Default animation-specific options
+ */
+export const DEFAULT_ANIMATION_OPTIONS: Required<
+  Pick<JXLAnimationOptions, "tpsNumerator" | "tpsDenominator" | "numLoops">
+> = {
+  tpsNumerator: 1000,
+  tpsDenominator: 1,
+  numLoops: 0,
+};
+
 /**
  * Default decode options
  */
-export const DEFAULT_DECODE_OPTIONS: Required<JXLDecodeOptions> = {
+export const DEFAULT_DECODE_OPTIONS: Required<Omit<JXLDecodeOptions, "crop">> = {
   ignoreColorProfile: false,
   maxThreads: 0,
 };
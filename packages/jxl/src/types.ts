@@ -105,6 +105,30 @@ export type JXLImageData = ExtendedImageData<JXLDataType, JXLMetadata>;
 /** JXL image info (without pixel data) */
 export type JXLImageInfo = ImageInfo<JXLMetadata>;
 
+/** Result of `encodeToSize()` */
+export interface JXLTargetSizeResult {
+  data: Uint8Array;
+  /** Quality of the returned encode */
+  quality: number;
+  /** Number of candidate encodes the search ran */
+  attempts: number;
+  /** false when even `minQuality` exceeded `maxBytes` */
+  targetMet: boolean;
+}
+
+/**
+ * Native memory pool usage in bytes (see `getDecoderMemoryStats`,
+ * `getEncoderMemoryStats` and `JXLDecoderSession.getMemoryStats`)
+ */
+export interface JXLMemoryStats {
+  /** Highest pool usage while processing the current (or last) image */
+  peak: number;
+  /** Bytes the pool holds from the wasm heap, in use or kept for reuse */
+  reserved: number;
+  /** Bytes currently allocated by libjxl */
+  live: number;
+}
+
 // ============================================================================
 // Default metadata
 // ============================================================================
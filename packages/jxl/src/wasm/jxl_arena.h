@@ -0,0 +1,259 @@
+#pragma once
+
+#include <jxl/memory_manager.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+// ============================================================================
+// Pooled JxlMemoryManager
+// ============================================================================
+
+// Memory use of an arena, in bytes
+struct ArenaStats
+{
+    double peak;     // Highest live total during the current (or last) image
+    double reserved; // Held from malloc: chunks plus live large blocks
+    double live;     // Currently handed out to libjxl
+};
+
+// Pool allocator handed to libjxl as its JxlMemoryManager. Blocks are carved
+// from large chunks and recycled through power-of-two free lists, so libjxl's
+// many short-lived allocations no longer go through (and fragment) dlmalloc.
+// reset() drops every block at once after an image and keeps the chunks for
+// the next one: a worker decoding mixed sizes levels off at the footprint of
+// its largest image instead of growing with fragmentation.
+//
+// Requests above the largest size class go straight to malloc. All entry
+// points are locked since libjxl may allocate from runner threads.
+class JxlArena
+{
+public:
+    explicit JxlArena(size_t chunkSize = kDefaultChunkSize)
+        : chunkSize_(chunkSize)
+    {
+        manager_.opaque = this;
+        manager_.alloc = &JxlArena::allocate;
+        manager_.free = &JxlArena::release;
+        std::fill(std::begin(freeLists_), std::end(freeLists_), nullptr);
+    }
+
+    ~JxlArena()
+    {
+        for (Chunk &chunk : chunks_)
+            free(chunk.base);
+    }
+
+    JxlArena(const JxlArena &) = delete;
+    JxlArena &operator=(const JxlArena &) = delete;
+
+    // Pass to JxlDecoderMake / JxlEncoderMake. The arena must outlive the
+    // decoder or encoder created with it.
+    const JxlMemoryManager *manager() const { return &manager_; }
+
+    // Bulk release: rewind all chunks and clear the free lists. Only takes
+    // effect once libjxl has returned every block (its decoder or encoder is
+    // destroyed), so calling it while something is still live is harmless.
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (live_ != 0)
+            return;
+        for (Chunk &chunk : chunks_)
+            chunk.used = 0;
+        current_ = 0;
+        std::fill(std::begin(freeLists_), std::end(freeLists_), nullptr);
+        if (peak_ != 0)
+        {
+            lastPeak_ = peak_;
+            peak_ = 0;
+        }
+    }
+
+    // Measure the peak from what is live now. For owners whose decoder keeps
+    // blocks across images (JxlDecoderSession) and so never reaches reset()
+    void resetPeak()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        peak_ = live_;
+        lastPeak_ = 0;
+    }
+
+    // reset() and also give the chunks back to malloc
+    void trim()
+    {
+        reset();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (live_ != 0)
+            return;
+        for (Chunk &chunk : chunks_)
+            free(chunk.base);
+        reserved_ -= chunkBytes_;
+        chunkBytes_ = 0;
+        chunks_.clear();
+    }
+
+    ArenaStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ArenaStats stats;
+        stats.peak = static_cast<double>(peak_ != 0 ? peak_ : lastPeak_);
+        stats.reserved = static_cast<double>(reserved_);
+        stats.live = static_cast<double>(live_);
+        return stats;
+    }
+
+private:
+    static constexpr size_t kDefaultChunkSize = 4 << 20;
+    static constexpr size_t kMinClassSize = 64;
+    static constexpr int kNumClasses = 15; // 64 B .. 1 MB blocks
+    static constexpr uint32_t kLargeClass = UINT32_MAX;
+
+    // Precedes every block; 16 bytes keeps the payload 16-byte aligned
+    struct alignas(16) BlockHeader
+    {
+        uint32_t sizeClass;
+        size_t blockSize;
+    };
+
+    struct Chunk
+    {
+        char *base;
+        size_t size;
+        size_t used;
+    };
+
+    static void *allocate(void *opaque, size_t size)
+    {
+        return static_cast<JxlArena *>(opaque)->allocateBlock(size);
+    }
+
+    static void release(void *opaque, void *address)
+    {
+        if (address)
+            static_cast<JxlArena *>(opaque)->releaseBlock(address);
+    }
+
+    void *allocateBlock(size_t size)
+    {
+        size_t needed = size + sizeof(BlockHeader);
+        uint32_t sizeClass = 0;
+        size_t blockSize = kMinClassSize;
+        while (blockSize < needed && sizeClass < kNumClasses)
+        {
+            blockSize <<= 1;
+            ++sizeClass;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        BlockHeader *header;
+        if (sizeClass == kNumClasses)
+        {
+            sizeClass = kLargeClass;
+            blockSize = needed;
+            header = static_cast<BlockHeader *>(malloc(blockSize));
+            if (!header)
+                return nullptr;
+            reserved_ += blockSize;
+        }
+        else if (freeLists_[sizeClass])
+        {
+            header = static_cast<BlockHeader *>(freeLists_[sizeClass]);
+            freeLists_[sizeClass] = *reinterpret_cast<void **>(header + 1);
+        }
+        else
+        {
+            header = static_cast<BlockHeader *>(carve(blockSize));
+            if (!header)
+                return nullptr;
+        }
+
+        header->sizeClass = sizeClass;
+        header->blockSize = blockSize;
+        live_ += blockSize;
+        peak_ = std::max(peak_, live_);
+        return header + 1;
+    }
+
+    void releaseBlock(void *address)
+    {
+        BlockHeader *header = static_cast<BlockHeader *>(address) - 1;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        live_ -= header->blockSize;
+        if (header->sizeClass == kLargeClass)
+        {
+            reserved_ -= header->blockSize;
+            free(header);
+            return;
+        }
+        // Free blocks link through their payload
+        *reinterpret_cast<void **>(header + 1) = freeLists_[header->sizeClass];
+        freeLists_[header->sizeClass] = header;
+    }
+
+    // Bump-allocate from the current chunk, moving on to retained chunks
+    // (after a reset) before asking malloc for a new one
+    void *carve(size_t blockSize)
+    {
+        for (; current_ < chunks_.size(); ++current_)
+        {
+            Chunk &chunk = chunks_[current_];
+            if (chunk.size - chunk.used >= blockSize)
+            {
+                void *block = chunk.base + chunk.used;
+                chunk.used += blockSize;
+                return block;
+            }
+        }
+
+        size_t size = std::max(chunkSize_, blockSize);
+        char *base = static_cast<char *>(malloc(size));
+        if (!base)
+            return nullptr;
+        chunks_.push_back({base, size, blockSize});
+        current_ = chunks_.size() - 1;
+        chunkBytes_ += size;
+        reserved_ += size;
+        return base;
+    }
+
+    JxlMemoryManager manager_;
+    size_t chunkSize_;
+    std::vector<Chunk> chunks_;
+    size_t current_ = 0;
+    void *freeLists_[kNumClasses];
+    size_t chunkBytes_ = 0;
+    size_t reserved_ = 0;
+    size_t live_ = 0;
+    size_t peak_ = 0;
+    size_t lastPeak_ = 0;
+    mutable std::mutex mutex_;
+};
+
+// Arena for the one-shot entry points of a module; bulk-released after each
+// call by ArenaScope. Long-lived objects (sessions, iterators) own their own
+// arena, since a reset must never happen while their blocks are live.
+inline JxlArena &sharedArena()
+{
+    static JxlArena arena;
+    return arena;
+}
+
+// Resets the arena on scope exit. Declare it before the decoder or encoder so
+// the reset runs after they are destroyed.
+class ArenaScope
+{
+public:
+    explicit ArenaScope(JxlArena &arena) : arena_(arena) {}
+    ~ArenaScope() { arena_.reset(); }
+
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+private:
+    JxlArena &arena_;
+};
@@ -3,13 +3,18 @@
 #include <emscripten.h>
 #include <jxl/decode.h>
 #include <jxl/decode_cxx.h>
-#include <jxl/thread_parallel_runner.h>
-#include <jxl/thread_parallel_runner_cxx.h>
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "jxl_arena.h"
+#include "jxl_thread_pool.h"
+#include "metrics.h"
+
 using namespace emscripten;
 
 // Max threads constant (defined via CMake for MT builds)
@@ -64,6 +69,25 @@ bool isHDRTransfer(JxlTransferFunction tf)
     return tf == JXL_TRANSFER_FUNCTION_PQ || tf == JXL_TRANSFER_FUNCTION_HLG;
 }
 
+std::string blendModeToString(JxlBlendMode mode)
+{
+    switch (mode)
+    {
+    case JXL_BLEND_REPLACE:
+        return "replace";
+    case JXL_BLEND_ADD:
+        return "add";
+    case JXL_BLEND_BLEND:
+        return "blend";
+    case JXL_BLEND_MULADD:
+        return "muladd";
+    case JXL_BLEND_MUL:
+        return "mul";
+    default:
+        return "unknown";
+    }
+}
+
 // ============================================================================
 // Timing structure
 // ============================================================================
@@ -74,7 +98,6 @@ struct DecodeTimings
     double basicInfo;
     double colorInfo;
     double decode;
-    double memcpy;
     double total;
 };
 
@@ -148,50 +171,314 @@ struct ImageInfo
     ImageMetadata metadata;
 };
 
+// Result of probeImageInfo on a (possibly partial) file
+struct InfoProbe
+{
+    bool complete;      // `info` holds the header fields
+    double bytesNeeded; // Prefix size to try next when not complete
+    ImageInfo info;
+    std::string error;
+};
+
+struct ThumbnailResult
+{
+    uintptr_t dataPtr;  // Caller must free via Module._free
+    size_t dataSize;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t channels;
+    std::string dataType;
+    // "preview" (embedded preview), "dc" (stopped after the DC pass)
+    // or "full" (no early exit possible, full decode downscaled)
+    std::string source;
+    ImageMetadata metadata;
+    std::string error;
+    DecodeTimings timings;
+};
+
+struct JPEGResult
+{
+    uintptr_t dataPtr;  // Caller must free via Module._free
+    size_t dataSize;
+    std::string error;
+};
+
+// Animation-level info reported by JxlFrameIterator
+struct AnimationInfo
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t channels;
+    std::string dataType;
+    uint32_t frameCount;
+    // Tick rate: one tick lasts tpsDenominator / tpsNumerator seconds
+    uint32_t tpsNumerator;
+    uint32_t tpsDenominator;
+    uint32_t numLoops;  // 0 = infinite
+    double durationMs;
+    ImageMetadata metadata;
+    std::string error;
+};
+
+// One frame produced by JxlFrameIterator::next
+struct FrameResult
+{
+    uintptr_t dataPtr;  // Caller must free via Module._free
+    size_t dataSize;
+    uint32_t index;
+    // Frame size and offset on the canvas (full canvas at 0,0 when coalescing)
+    uint32_t width;
+    uint32_t height;
+    int32_t x0;
+    int32_t y0;
+    uint32_t duration;  // In ticks
+    double durationMs;
+    std::string blendMode;  // "replace", "add", "blend", "muladd", "mul"
+    uint32_t blendSource;   // Reference frame slot blended onto
+    bool isLast;
+    bool done;  // No frame left, no pixels returned
+    std::string error;
+};
+
+// Progress report from JxlStreamingDecoder::push/close
+struct StreamStatus
+{
+    std::string state;     // "needMoreInput", "progress", "complete", "error"
+    std::string error;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t channels;
+    std::string dataType;
+    // Current render, owned by the decoder (0 until the first render).
+    // Valid until the next call, do not free.
+    uintptr_t dataPtr;
+    size_t dataSize;
+    // Detail of the current render: 8 = DC only, 1 = full resolution, 0 = none yet
+    uint32_t downsampling;
+};
+
 // ============================================================================
-// Main decode function using libjxl streaming API
+// Shared decode helpers
 // ============================================================================
 
-DecodeResult decode(
-    uintptr_t inputPtr,
+// Color information collected at JXL_DEC_COLOR_ENCODING
+struct ColorInfo
+{
+    std::vector<uint8_t> iccProfile;
+    JxlColorEncoding colorEnc = {};
+    bool hasColorEnc = false;
+};
+
+void readColorInfo(JxlDecoder *dec, ColorInfo &color)
+{
+    // Try to get ICC profile size
+    size_t iccSize = 0;
+    if (JxlDecoderGetICCProfileSize(dec, JXL_COLOR_PROFILE_TARGET_DATA, &iccSize) == JXL_DEC_SUCCESS && iccSize > 0)
+    {
+        color.iccProfile.resize(iccSize);
+        if (JxlDecoderGetColorAsICCProfile(dec, JXL_COLOR_PROFILE_TARGET_DATA,
+                                            color.iccProfile.data(), iccSize) != JXL_DEC_SUCCESS)
+        {
+            color.iccProfile.clear();
+        }
+    }
+
+    // Try to get color encoding
+    if (JxlDecoderGetColorAsEncodedProfile(dec, JXL_COLOR_PROFILE_TARGET_DATA,
+                                            &color.colorEnc) == JXL_DEC_SUCCESS)
+    {
+        color.hasColorEnc = true;
+    }
+}
+
+// Fill color/HDR metadata. isAnimated and frameCount are left untouched.
+void fillMetadata(ImageMetadata &meta, const ColorInfo &color, uint32_t depth)
+{
+    if (color.hasColorEnc)
+    {
+        meta.colorPrimaries = colorPrimariesToString(color.colorEnc.primaries);
+        meta.transferFunction = transferFunctionToString(color.colorEnc.transfer_function);
+    }
+    else
+    {
+        meta.colorPrimaries = "unknown";
+        meta.transferFunction = "unknown";
+    }
+    meta.matrixCoefficients = "identity";  // JXL decodes to RGB
+    meta.fullRange = true;  // JXL always full range for RGB output
+
+    // Copy ICC profile to malloc'd buffer (caller must free via Module._free)
+    meta.iccProfilePtr = 0;
+    meta.iccProfileSize = 0;
+    if (!color.iccProfile.empty())
+    {
+        uint8_t *iccPtr = static_cast<uint8_t *>(malloc(color.iccProfile.size()));
+        if (iccPtr)
+        {
+            std::memcpy(iccPtr, color.iccProfile.data(), color.iccProfile.size());
+            meta.iccProfilePtr = reinterpret_cast<uintptr_t>(iccPtr);
+            meta.iccProfileSize = color.iccProfile.size();
+        }
+    }
+
+    // HDR detection
+    meta.isHDR = (color.hasColorEnc && isHDRTransfer(color.colorEnc.transfer_function)) ||
+                 depth > 8;
+
+    // Content light level (JXL may not have this)
+    meta.maxCLL = 0;
+    meta.maxPALL = 0;
+    meta.masteringDisplay.present = false;
+}
+
+// Pick the output pixel format - auto-detect float vs integer from file.
+// Returns an error message, or an empty string on success.
+std::string selectOutputFormat(
+    const JxlBasicInfo &info,
+    uint32_t channels,
+    JxlPixelFormat &format,
+    uint32_t &depth,
+    std::string &dataType)
+{
+    format.num_channels = channels;
+    format.endianness = JXL_NATIVE_ENDIAN;
+    format.align = 0;
+
+    // Check if the image is in float format
+    if (info.exponent_bits_per_sample > 0) {
+        // Float format detected
+        if (info.exponent_bits_per_sample == 5 && info.bits_per_sample == 16) {
+            // float16 (5-bit exponent, 16-bit total)
+            format.data_type = JXL_TYPE_FLOAT16;
+            depth = 16;
+            dataType = "float16";
+        } else if (info.exponent_bits_per_sample == 8 && info.bits_per_sample == 32) {
+            // float32 (8-bit exponent, 32-bit total)
+            format.data_type = JXL_TYPE_FLOAT;
+            depth = 32;
+            dataType = "float32";
+        } else {
+            return "Unsupported float format";
+        }
+    } else {
+        // Integer format
+        int outDepth = static_cast<int>(info.bits_per_sample);
+        if (outDepth < 8)
+            outDepth = 8;
+        if (outDepth > 16)
+            outDepth = 16;
+
+        format.data_type = (outDepth > 8) ? JXL_TYPE_UINT16 : JXL_TYPE_UINT8;
+        depth = static_cast<uint32_t>(outDepth);
+        dataType = (outDepth > 8) ? "uint16" : "uint8";
+    }
+
+    return "";
+}
+
+size_t bytesPerSample(JxlDataType type)
+{
+    switch (type)
+    {
+    case JXL_TYPE_FLOAT:
+        return 4;
+    case JXL_TYPE_UINT16:
+    case JXL_TYPE_FLOAT16:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
+// Region of interest in image coordinates; width/height of 0 means full image
+struct CropRect
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+};
+
+// Clip `crop` to the image. Returns false if nothing of it is inside.
+// A zero-size crop selects the whole image.
+bool clipCrop(CropRect &crop, uint32_t imageWidth, uint32_t imageHeight)
+{
+    if (crop.width == 0 || crop.height == 0)
+    {
+        crop = {0, 0, imageWidth, imageHeight};
+        return true;
+    }
+    if (crop.x >= imageWidth || crop.y >= imageHeight)
+        return false;
+
+    crop.width = std::min(crop.width, imageWidth - crop.x);
+    crop.height = std::min(crop.height, imageHeight - crop.y);
+    return true;
+}
+
+// Copies the part of each delivered row that falls inside the crop.
+// Rows are disjoint, so this is safe to call from several threads.
+struct CropTarget
+{
+    uint8_t *pixels;
+    CropRect rect;
+    size_t bytesPerPixel;
+};
+
+void cropRowCallback(void *opaque, size_t x, size_t y, size_t numPixels, const void *pixels)
+{
+    const CropTarget *target = static_cast<const CropTarget *>(opaque);
+    const CropRect &rect = target->rect;
+    if (y < rect.y || y >= rect.y + rect.height)
+        return;
+
+    size_t begin = std::max<size_t>(x, rect.x);
+    size_t end = std::min<size_t>(x + numPixels, rect.x + rect.width);
+    if (begin >= end)
+        return;
+
+    const uint8_t *src = static_cast<const uint8_t *>(pixels) + (begin - x) * target->bytesPerPixel;
+    uint8_t *dst = target->pixels +
+                   ((y - rect.y) * rect.width + (begin - rect.x)) * target->bytesPerPixel;
+    std::memcpy(dst, src, (end - begin) * target->bytesPerPixel);
+}
+
+// ============================================================================
+// Decode core (shared by decode() and JxlDecoderSession)
+// ============================================================================
+
+// Decode an image with a freshly created or reset decoder.
+// `runner` is a PoolRunner on the shared thread pool, or null for single-threaded.
+// With a non-empty `crop` only that region is written out; libjxl still
+// decodes the whole frame, but the output buffer is sized to the crop.
+DecodeResult decodeWithDecoder(
+    JxlDecoder *dec,
+    void *runner,
+    const uint8_t *jxlData,
     size_t inputSize,
-    int maxThreads)
+    CropRect crop,
+    DecodeTimings &timings)
 {
-    double tStart = emscripten_get_now();
-    DecodeTimings timings = {0};
     DecodeResult result = {};
     result.dataPtr = 0;
     result.dataSize = 0;
     result.depth = 8;
 
-    const uint8_t *jxlData = reinterpret_cast<const uint8_t *>(inputPtr);
-
     double t0 = emscripten_get_now();
 
-    // Create decoder
-    auto dec = JxlDecoderMake(nullptr);
-    if (!dec)
-    {
-        result.error = "Failed to create JXL decoder";
-        return result;
-    }
-
-    // Setup thread runner for MT builds
-    JxlThreadParallelRunnerPtr runner = nullptr;
 #if MAX_THREADS > 1
-    if (maxThreads > 1)
+    if (runner && JxlDecoderSetParallelRunner(dec, PoolRunner::run, runner) != JXL_DEC_SUCCESS)
     {
-        runner = JxlThreadParallelRunnerMake(nullptr, static_cast<size_t>(maxThreads));
-        if (JxlDecoderSetParallelRunner(dec.get(), JxlThreadParallelRunner, runner.get()) != JXL_DEC_SUCCESS)
-        {
-            result.error = "Failed to set parallel runner";
-            return result;
-        }
+        result.error = "Failed to set parallel runner";
+        return result;
     }
 #endif
 
     // Subscribe to events
-    if (JxlDecoderSubscribeEvents(dec.get(),
+    if (JxlDecoderSubscribeEvents(dec,
                                    JXL_DEC_BASIC_INFO |
                                        JXL_DEC_COLOR_ENCODING |
                                        JXL_DEC_FULL_IMAGE) != JXL_DEC_SUCCESS)
@@ -201,22 +488,24 @@ DecodeResult decode(
     }
 
     // Set input
-    JxlDecoderSetInput(dec.get(), jxlData, inputSize);
-    JxlDecoderCloseInput(dec.get());
+    JxlDecoderSetInput(dec, jxlData, inputSize);
+    JxlDecoderCloseInput(dec);
 
-    timings.setup = emscripten_get_now() - t0;
+    timings.setup += emscripten_get_now() - t0;
 
     JxlBasicInfo info;
     JxlPixelFormat format;
-    std::vector<uint8_t> pixels;
-    std::vector<uint8_t> iccProfile;
-    JxlColorEncoding colorEnc = {};
-    bool hasColorEnc = false;
+    // Output buffer handed to libjxl, released to the caller on success
+    std::unique_ptr<uint8_t, decltype(&free)> pixels(nullptr, &free);
+    size_t pixelsSize = 0;
+    ColorInfo color;
+    CropTarget cropTarget = {};
+    bool useCrop = false;
 
     // Process decoder events
     for (;;)
     {
-        JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
+        JxlDecoderStatus status = JxlDecoderProcessInput(dec);
 
         if (status == JXL_DEC_ERROR)
         {
@@ -231,14 +520,21 @@ DecodeResult decode(
         else if (status == JXL_DEC_BASIC_INFO)
         {
             t0 = emscripten_get_now();
-            if (JxlDecoderGetBasicInfo(dec.get(), &info) != JXL_DEC_SUCCESS)
+            if (JxlDecoderGetBasicInfo(dec, &info) != JXL_DEC_SUCCESS)
             {
                 result.error = "Failed to get basic info";
                 return result;
             }
 
-            result.width = info.xsize;
-            result.height = info.ysize;
+            if (!clipCrop(crop, info.xsize, info.ysize))
+            {
+                result.error = "Crop rectangle is outside the image";
+                return result;
+            }
+            useCrop = crop.width != info.xsize || crop.height != info.ysize;
+
+            result.width = crop.width;
+            result.height = crop.height;
             result.depth = info.bits_per_sample;
             result.channels = info.num_color_channels + (info.alpha_bits > 0 ? 1 : 0);
             result.metadata.isAnimated = info.have_animation;
@@ -249,78 +545,58 @@ DecodeResult decode(
         else if (status == JXL_DEC_COLOR_ENCODING)
         {
             t0 = emscripten_get_now();
-
-            // Try to get ICC profile size
-            size_t iccSize = 0;
-            if (JxlDecoderGetICCProfileSize(dec.get(), JXL_COLOR_PROFILE_TARGET_DATA, &iccSize) == JXL_DEC_SUCCESS && iccSize > 0)
-            {
-                iccProfile.resize(iccSize);
-                if (JxlDecoderGetColorAsICCProfile(dec.get(), JXL_COLOR_PROFILE_TARGET_DATA,
-                                                    iccProfile.data(), iccSize) != JXL_DEC_SUCCESS)
-                {
-                    iccProfile.clear();
-                }
-            }
-
-            // Try to get color encoding
-            if (JxlDecoderGetColorAsEncodedProfile(dec.get(), JXL_COLOR_PROFILE_TARGET_DATA,
-                                                    &colorEnc) == JXL_DEC_SUCCESS)
-            {
-                hasColorEnc = true;
-            }
-
+            readColorInfo(dec, color);
             timings.colorInfo = emscripten_get_now() - t0;
         }
         else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER)
         {
             t0 = emscripten_get_now();
 
-            // Determine output format - auto-detect float vs integer from file
-            format.num_channels = result.channels;
-            format.endianness = JXL_NATIVE_ENDIAN;
-            format.align = 0;
-
-            // Check if the image is in float format
-            if (info.exponent_bits_per_sample > 0) {
-                // Float format detected
-                if (info.exponent_bits_per_sample == 5 && info.bits_per_sample == 16) {
-                    // float16 (5-bit exponent, 16-bit total)
-                    format.data_type = JXL_TYPE_FLOAT16;
-                    result.depth = 16;
-                    result.dataType = "float16";
-                } else if (info.exponent_bits_per_sample == 8 && info.bits_per_sample == 32) {
-                    // float32 (8-bit exponent, 32-bit total)
-                    format.data_type = JXL_TYPE_FLOAT;
-                    result.depth = 32;
-                    result.dataType = "float32";
-                } else {
-                    DecodeResult errorResult;
-                    errorResult.error = "Unsupported float format";
-                    return errorResult;
-                }
-            } else {
-                // Integer format
-                int outDepth = static_cast<int>(info.bits_per_sample);
-                if (outDepth < 8)
-                    outDepth = 8;
-                if (outDepth > 16)
-                    outDepth = 16;
-
-                format.data_type = (outDepth > 8) ? JXL_TYPE_UINT16 : JXL_TYPE_UINT8;
-                result.depth = static_cast<uint32_t>(outDepth);
-                result.dataType = (outDepth > 8) ? "uint16" : "uint8";
+            std::string formatError = selectOutputFormat(
+                info, result.channels, format, result.depth, result.dataType);
+            if (!formatError.empty())
+            {
+                result.error = formatError;
+                return result;
             }
 
             // Get required buffer size
             size_t bufferSize;
-            if (JxlDecoderImageOutBufferSize(dec.get(), &format, &bufferSize) != JXL_DEC_SUCCESS)
+            if (useCrop)
+            {
+                cropTarget.rect = crop;
+                cropTarget.bytesPerPixel = format.num_channels * bytesPerSample(format.data_type);
+                bufferSize = static_cast<size_t>(crop.width) * crop.height * cropTarget.bytesPerPixel;
+            }
+            else if (JxlDecoderImageOutBufferSize(dec, &format, &bufferSize) != JXL_DEC_SUCCESS)
             {
                 result.error = "Failed to get output buffer size";
                 return result;
             }
 
-            pixels.resize(bufferSize);
-            if (JxlDecoderSetImageOutBuffer(dec.get(), &format, pixels.data(), bufferSize) != JXL_DEC_SUCCESS)
+            // Decode straight into the buffer returned to JS (caller must free via Module._free).
+            // Animated frames reuse the same buffer, the last frame wins.
+            if (!pixels || pixelsSize != bufferSize)
+            {
+                pixels.reset(static_cast<uint8_t *>(malloc(bufferSize)));
+                if (!pixels)
+                {
+                    result.error = "Failed to allocate output buffer";
+                    return result;
+                }
+                pixelsSize = bufferSize;
+            }
+
+            if (useCrop)
+            {
+                cropTarget.pixels = pixels.get();
+                if (JxlDecoderSetImageOutCallback(dec, &format, cropRowCallback, &cropTarget) != JXL_DEC_SUCCESS)
+                {
+                    result.error = "Failed to set output callback";
+                    return result;
+                }
+            }
+            else if (JxlDecoderSetImageOutBuffer(dec, &format, pixels.get(), bufferSize) != JXL_DEC_SUCCESS)
             {
                 result.error = "Failed to set output buffer";
                 return result;
@@ -337,58 +613,65 @@ DecodeResult decode(
         }
     }
 
-    // Copy pixel data to malloc'd buffer (caller must free via Module._free)
-    t0 = emscripten_get_now();
-    void *dataPtr = malloc(pixels.size());
-    if (!dataPtr)
+    if (!pixels)
     {
-        result.error = "Failed to allocate output buffer";
+        result.error = "No image data decoded";
         return result;
     }
-    std::memcpy(dataPtr, pixels.data(), pixels.size());
-    result.dataPtr = reinterpret_cast<uintptr_t>(dataPtr);
-    result.dataSize = pixels.size();
-    timings.memcpy = emscripten_get_now() - t0;
 
-    // Fill metadata
-    if (hasColorEnc)
-    {
-        result.metadata.colorPrimaries = colorPrimariesToString(colorEnc.primaries);
-        result.metadata.transferFunction = transferFunctionToString(colorEnc.transfer_function);
-    }
-    else
+    // Ownership of the pixel buffer passes to the caller
+    result.dataPtr = reinterpret_cast<uintptr_t>(pixels.release());
+    result.dataSize = pixelsSize;
+
+    fillMetadata(result.metadata, color, result.depth);
+
+    return result;
+}
+
+// ============================================================================
+// Main decode function using libjxl streaming API
+// ============================================================================
+
+DecodeResult decode(
+    uintptr_t inputPtr,
+    size_t inputSize,
+    int maxThreads,
+    CropRect crop)
+{
+    double tStart = emscripten_get_now();
+    DecodeTimings timings = {0};
+    const uint8_t *jxlData = reinterpret_cast<const uint8_t *>(inputPtr);
+
+    double t0 = emscripten_get_now();
+
+    // Create decoder
+    ArenaScope arenaScope(sharedArena());
+    auto dec = JxlDecoderMake(sharedArena().manager());
+    if (!dec)
     {
-        result.metadata.colorPrimaries = "unknown";
-        result.metadata.transferFunction = "unknown";
+        DecodeResult result = {};
+        result.error = "Failed to create JXL decoder";
+        return result;
     }
-    result.metadata.matrixCoefficients = "identity";  // JXL decodes to RGB
-    result.metadata.fullRange = true;  // JXL always full range for RGB output
 
-    // Copy ICC profile to malloc'd buffer
-    if (!iccProfile.empty())
+    // Setup thread runner for MT builds
+    PoolRunnerPtr runner = nullptr;
+#if MAX_THREADS > 1
+    if (maxThreads > 1)
     {
-        uint8_t *iccPtr = static_cast<uint8_t *>(malloc(iccProfile.size()));
-        if (iccPtr)
+        runner = makePoolRunner(static_cast<size_t>(maxThreads));
+        if (!runner)
         {
-            std::memcpy(iccPtr, iccProfile.data(), iccProfile.size());
-            result.metadata.iccProfilePtr = reinterpret_cast<uintptr_t>(iccPtr);
-            result.metadata.iccProfileSize = iccProfile.size();
+            DecodeResult result = {};
+            result.error = "Failed to create parallel runner";
+            return result;
         }
     }
-    else
-    {
-        result.metadata.iccProfilePtr = 0;
-        result.metadata.iccProfileSize = 0;
-    }
+#endif
 
-    // HDR detection
-    result.metadata.isHDR = (hasColorEnc && isHDRTransfer(colorEnc.transfer_function)) ||
-                            result.depth > 8;
+    timings.setup = emscripten_get_now() - t0;
 
-    // Content light level (JXL may not have this)
-    result.metadata.maxCLL = 0;
-    result.metadata.maxPALL = 0;
-    result.metadata.masteringDisplay.present = false;
+    DecodeResult result = decodeWithDecoder(dec.get(), runner.get(), jxlData, inputSize, crop, timings);
 
     timings.total = emscripten_get_now() - tStart;
     result.timings = timings;
@@ -400,40 +683,51 @@ DecodeResult decode(
 // Get image info without full decode
 // ============================================================================
 
-ImageInfo getImageInfo(uintptr_t inputPtr, size_t inputSize)
+// Read the header fields. With `inputComplete` false the data may be just
+// a prefix of the file; if it is too short, `bytesNeeded` receives the
+// prefix size to try next and the returned info is incomplete.
+ImageInfo getImageInfoWithDecoder(
+    JxlDecoder *dec,
+    const uint8_t *jxlData,
+    size_t inputSize,
+    bool inputComplete = true,
+    size_t *bytesNeeded = nullptr)
 {
     ImageInfo info = {};
-    const uint8_t *jxlData = reinterpret_cast<const uint8_t *>(inputPtr);
-
-    auto dec = JxlDecoderMake(nullptr);
-    if (!dec)
-        return info;
 
-    if (JxlDecoderSubscribeEvents(dec.get(),
+    if (JxlDecoderSubscribeEvents(dec,
                                    JXL_DEC_BASIC_INFO | JXL_DEC_COLOR_ENCODING) != JXL_DEC_SUCCESS)
     {
         return info;
     }
 
-    JxlDecoderSetInput(dec.get(), jxlData, inputSize);
-    JxlDecoderCloseInput(dec.get());
+    JxlDecoderSetInput(dec, jxlData, inputSize);
+    if (inputComplete)
+        JxlDecoderCloseInput(dec);
 
     JxlBasicInfo basicInfo;
-    JxlColorEncoding colorEnc = {};
-    bool hasColorEnc = false;
-    std::vector<uint8_t> iccProfile;
+    ColorInfo color;
 
     for (;;)
     {
-        JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
+        JxlDecoderStatus status = JxlDecoderProcessInput(dec);
 
-        if (status == JXL_DEC_ERROR || status == JXL_DEC_NEED_MORE_INPUT)
+        if (status == JXL_DEC_NEED_MORE_INPUT && !inputComplete && bytesNeeded)
+        {
+            // libjxl can estimate the size up to the basic info; the color
+            // encoding (possibly a large ICC profile) has no hint, so grow
+            // the prefix geometrically from there
+            size_t hint = info.width == 0 ? JxlDecoderSizeHintBasicInfo(dec) : 0;
+            *bytesNeeded = std::max(hint, std::max<size_t>(inputSize * 2, 64));
+            return info;
+        }
+        else if (status == JXL_DEC_ERROR || status == JXL_DEC_NEED_MORE_INPUT)
         {
             return info;
         }
         else if (status == JXL_DEC_BASIC_INFO)
         {
-            if (JxlDecoderGetBasicInfo(dec.get(), &basicInfo) != JXL_DEC_SUCCESS)
+            if (JxlDecoderGetBasicInfo(dec, &basicInfo) != JXL_DEC_SUCCESS)
             {
                 return info;
             }
@@ -447,30 +741,7 @@ ImageInfo getImageInfo(uintptr_t inputPtr, size_t inputSize)
         }
         else if (status == JXL_DEC_COLOR_ENCODING)
         {
-            // Get ICC profile
-            size_t iccSize = 0;
-            if (JxlDecoderGetICCProfileSize(dec.get(), JXL_COLOR_PROFILE_TARGET_DATA, &iccSize) == JXL_DEC_SUCCESS && iccSize > 0)
-            {
-                iccProfile.resize(iccSize);
-                if (JxlDecoderGetColorAsICCProfile(dec.get(), JXL_COLOR_PROFILE_TARGET_DATA,
-                                                    iccProfile.data(), iccSize) == JXL_DEC_SUCCESS)
-                {
-                    uint8_t *iccPtr = static_cast<uint8_t *>(malloc(iccProfile.size()));
-                    if (iccPtr)
-                    {
-                        std::memcpy(iccPtr, iccProfile.data(), iccProfile.size());
-                        info.metadata.iccProfilePtr = reinterpret_cast<uintptr_t>(iccPtr);
-                        info.metadata.iccProfileSize = iccProfile.size();
-                    }
-                }
-            }
-
-            // Get color encoding
-            if (JxlDecoderGetColorAsEncodedProfile(dec.get(), JXL_COLOR_PROFILE_TARGET_DATA,
-                                                    &colorEnc) == JXL_DEC_SUCCESS)
-            {
-                hasColorEnc = true;
-            }
+            readColorInfo(dec, color);
 
             // We have all the info we need
             break;
@@ -481,37 +752,1040 @@ ImageInfo getImageInfo(uintptr_t inputPtr, size_t inputSize)
         }
     }
 
-    // Fill metadata
-    if (hasColorEnc)
-    {
-        info.metadata.colorPrimaries = colorPrimariesToString(colorEnc.primaries);
-        info.metadata.transferFunction = transferFunctionToString(colorEnc.transfer_function);
-    }
-    else
-    {
-        info.metadata.colorPrimaries = "unknown";
-        info.metadata.transferFunction = "unknown";
-    }
-    info.metadata.matrixCoefficients = "identity";
-    info.metadata.fullRange = true;
-    info.metadata.isHDR = (hasColorEnc && isHDRTransfer(colorEnc.transfer_function)) ||
-                          info.depth > 8;
-    info.metadata.maxCLL = 0;
-    info.metadata.maxPALL = 0;
-    info.metadata.masteringDisplay.present = false;
+    fillMetadata(info.metadata, color, info.depth);
 
     return info;
 }
 
-// ============================================================================
-// Emscripten bindings
-// ============================================================================
-
-EMSCRIPTEN_BINDINGS(jxl_decoder)
+ImageInfo getImageInfo(uintptr_t inputPtr, size_t inputSize)
 {
-    value_object<MasteringDisplay>("MasteringDisplay")
-        .field("redX", &MasteringDisplay::redX)
-        .field("redY", &MasteringDisplay::redY)
+    const uint8_t *jxlData = reinterpret_cast<const uint8_t *>(inputPtr);
+
+    ArenaScope arenaScope(sharedArena());
+    auto dec = JxlDecoderMake(sharedArena().manager());
+    if (!dec)
+        return ImageInfo{};
+
+    return getImageInfoWithDecoder(dec.get(), jxlData, inputSize);
+}
+
+// Header info from a prefix of the file, so callers can read just the
+// first bytes of large files and extend the prefix on demand
+InfoProbe probeImageInfo(uintptr_t inputPtr, size_t inputSize, bool inputComplete)
+{
+    InfoProbe probe = {};
+
+    ArenaScope arenaScope(sharedArena());
+    auto dec = JxlDecoderMake(sharedArena().manager());
+    if (!dec)
+    {
+        probe.error = "Failed to create JXL decoder";
+        return probe;
+    }
+
+    size_t bytesNeeded = 0;
+    ImageInfo info = getImageInfoWithDecoder(
+        dec.get(), reinterpret_cast<const uint8_t *>(inputPtr), inputSize, inputComplete, &bytesNeeded);
+    if (bytesNeeded > 0)
+    {
+        probe.bytesNeeded = static_cast<double>(bytesNeeded);
+        return probe;
+    }
+    if (info.width == 0)
+    {
+        probe.error = "Invalid or truncated JXL header";
+        return probe;
+    }
+
+    probe.complete = true;
+    probe.info = info;
+    return probe;
+}
+
+// ============================================================================
+// Thumbnail decode (embedded preview or DC pass)
+// ============================================================================
+
+// Point-samples rows delivered by JxlDecoderSetImageOutCallback into a
+// buffer downscaled by `scale`. Rows are disjoint, so this is thread-safe.
+struct DownscaleTarget
+{
+    uint8_t *pixels;
+    uint32_t width;
+    uint32_t height;
+    uint32_t scale;
+    size_t bytesPerPixel;
+};
+
+void downscaleRowCallback(void *opaque, size_t x, size_t y, size_t numPixels, const void *pixels)
+{
+    const DownscaleTarget *target = static_cast<const DownscaleTarget *>(opaque);
+    if (y % target->scale != 0)
+        return;
+
+    const uint8_t *src = static_cast<const uint8_t *>(pixels);
+    uint8_t *dstRow = target->pixels + (y / target->scale) * target->width * target->bytesPerPixel;
+
+    // First sampled column at or after x
+    size_t sx = (x + target->scale - 1) / target->scale * target->scale;
+    for (; sx < x + numPixels; sx += target->scale)
+    {
+        std::memcpy(dstRow + (sx / target->scale) * target->bytesPerPixel,
+                    src + (sx - x) * target->bytesPerPixel,
+                    target->bytesPerPixel);
+    }
+}
+
+// Decode a small version of the image and stop as early as possible:
+// the embedded preview when present, otherwise the progressive DC pass
+// (1:8 detail) point-sampled down by `scale` (power of two >= 2, anything
+// smaller selects the default of 8; JS rejects it before getting here).
+ThumbnailResult decodeThumbnail(
+    uintptr_t inputPtr,
+    size_t inputSize,
+    int scale,
+    int maxThreads)
+{
+    double tStart = emscripten_get_now();
+    ThumbnailResult result = {};
+    DecodeTimings timings = {0};
+    const uint8_t *jxlData = reinterpret_cast<const uint8_t *>(inputPtr);
+
+    uint32_t downscale = scale > 1 ? static_cast<uint32_t>(scale) : 8;
+
+    double t0 = emscripten_get_now();
+    ArenaScope arenaScope(sharedArena());
+    auto dec = JxlDecoderMake(sharedArena().manager());
+    if (!dec)
+    {
+        result.error = "Failed to create JXL decoder";
+        return result;
+    }
+
+    PoolRunnerPtr runner = nullptr;
+#if MAX_THREADS > 1
+    if (maxThreads > 1)
+    {
+        runner = makePoolRunner(static_cast<size_t>(maxThreads));
+        if (!runner ||
+            JxlDecoderSetParallelRunner(dec.get(), PoolRunner::run, runner.get()) != JXL_DEC_SUCCESS)
+        {
+            result.error = "Failed to set parallel runner";
+            return result;
+        }
+    }
+#endif
+
+    if (JxlDecoderSubscribeEvents(dec.get(),
+                                   JXL_DEC_BASIC_INFO |
+                                       JXL_DEC_COLOR_ENCODING |
+                                       JXL_DEC_PREVIEW_IMAGE |
+                                       JXL_DEC_FRAME_PROGRESSION |
+                                       JXL_DEC_FULL_IMAGE) != JXL_DEC_SUCCESS)
+    {
+        result.error = "Failed to subscribe to events";
+        return result;
+    }
+    JxlDecoderSetProgressiveDetail(dec.get(), kDC);
+
+    JxlDecoderSetInput(dec.get(), jxlData, inputSize);
+    JxlDecoderCloseInput(dec.get());
+    timings.setup = emscripten_get_now() - t0;
+
+    JxlBasicInfo info;
+    JxlPixelFormat format;
+    ColorInfo color;
+    std::unique_ptr<uint8_t, decltype(&free)> pixels(nullptr, &free);
+    DownscaleTarget target = {};
+
+    t0 = emscripten_get_now();
+    bool done = false;
+    while (!done)
+    {
+        JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
+
+        if (status == JXL_DEC_ERROR)
+        {
+            result.error = "Decoder error";
+            return result;
+        }
+        else if (status == JXL_DEC_NEED_MORE_INPUT)
+        {
+            result.error = "Incomplete input data";
+            return result;
+        }
+        else if (status == JXL_DEC_BASIC_INFO)
+        {
+            double t1 = emscripten_get_now();
+            if (JxlDecoderGetBasicInfo(dec.get(), &info) != JXL_DEC_SUCCESS)
+            {
+                result.error = "Failed to get basic info";
+                return result;
+            }
+
+            result.channels = info.num_color_channels + (info.alpha_bits > 0 ? 1 : 0);
+            result.metadata.isAnimated = info.have_animation;
+            result.metadata.frameCount = result.metadata.isAnimated ? 0 : 1;
+
+            std::string formatError = selectOutputFormat(
+                info, result.channels, format, result.depth, result.dataType);
+            if (!formatError.empty())
+            {
+                result.error = formatError;
+                return result;
+            }
+            timings.basicInfo = emscripten_get_now() - t1;
+        }
+        else if (status == JXL_DEC_COLOR_ENCODING)
+        {
+            double t1 = emscripten_get_now();
+            readColorInfo(dec.get(), color);
+            timings.colorInfo = emscripten_get_now() - t1;
+        }
+        else if (status == JXL_DEC_NEED_PREVIEW_OUT_BUFFER)
+        {
+            size_t bufferSize;
+            if (JxlDecoderPreviewOutBufferSize(dec.get(), &format, &bufferSize) != JXL_DEC_SUCCESS)
+            {
+                result.error = "Failed to get preview buffer size";
+                return result;
+            }
+
+            pixels.reset(static_cast<uint8_t *>(malloc(bufferSize)));
+            if (!pixels)
+            {
+                result.error = "Failed to allocate output buffer";
+                return result;
+            }
+            result.dataSize = bufferSize;
+            result.width = info.preview.xsize;
+            result.height = info.preview.ysize;
+
+            if (JxlDecoderSetPreviewOutBuffer(dec.get(), &format, pixels.get(), bufferSize) != JXL_DEC_SUCCESS)
+            {
+                result.error = "Failed to set preview buffer";
+                return result;
+            }
+        }
+        else if (status == JXL_DEC_PREVIEW_IMAGE)
+        {
+            result.source = "preview";
+            done = true;
+        }
+        else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER)
+        {
+            // Output at 1/scale resolution, rows are sampled in the callback
+            target.scale = downscale;
+            target.width = (info.xsize + downscale - 1) / downscale;
+            target.height = (info.ysize + downscale - 1) / downscale;
+            target.bytesPerPixel = format.num_channels * bytesPerSample(format.data_type);
+
+            result.dataSize = static_cast<size_t>(target.width) * target.height * target.bytesPerPixel;
+            pixels.reset(static_cast<uint8_t *>(malloc(result.dataSize)));
+            if (!pixels)
+            {
+                result.error = "Failed to allocate output buffer";
+                return result;
+            }
+            target.pixels = pixels.get();
+            result.width = target.width;
+            result.height = target.height;
+
+            if (JxlDecoderSetImageOutCallback(dec.get(), &format, downscaleRowCallback, &target) != JXL_DEC_SUCCESS)
+            {
+                result.error = "Failed to set output callback";
+                return result;
+            }
+        }
+        else if (status == JXL_DEC_FRAME_PROGRESSION)
+        {
+            // Stop once the decoded detail is enough for the requested scale
+            size_t ratio = JxlDecoderGetIntendedDownsamplingRatio(dec.get());
+            if (ratio <= downscale && JxlDecoderFlushImage(dec.get()) == JXL_DEC_SUCCESS)
+            {
+                result.source = "dc";
+                done = true;
+            }
+        }
+        else if (status == JXL_DEC_FULL_IMAGE)
+        {
+            result.source = "full";
+            done = true;
+        }
+        else if (status == JXL_DEC_SUCCESS)
+        {
+            break;
+        }
+    }
+    timings.decode = emscripten_get_now() - t0;
+
+    if (!pixels || result.source.empty())
+    {
+        result.error = "No image data decoded";
+        return result;
+    }
+
+    result.dataPtr = reinterpret_cast<uintptr_t>(pixels.release());
+    fillMetadata(result.metadata, color, result.depth);
+
+    timings.total = emscripten_get_now() - tStart;
+    result.timings = timings;
+    return result;
+}
+
+// ============================================================================
+// JPEG reconstruction
+// ============================================================================
+
+// Rebuild the original JPEG file from a JXL produced by lossless JPEG
+// recompression. Fails if the file has no JPEG reconstruction data.
+JPEGResult reconstructJPEG(uintptr_t inputPtr, size_t inputSize, int maxThreads)
+{
+    JPEGResult result = {};
+    const uint8_t *jxlData = reinterpret_cast<const uint8_t *>(inputPtr);
+
+    ArenaScope arenaScope(sharedArena());
+    auto dec = JxlDecoderMake(sharedArena().manager());
+    if (!dec)
+    {
+        result.error = "Failed to create JXL decoder";
+        return result;
+    }
+
+    PoolRunnerPtr runner = nullptr;
+#if MAX_THREADS > 1
+    if (maxThreads > 1)
+    {
+        runner = makePoolRunner(static_cast<size_t>(maxThreads));
+        if (!runner ||
+            JxlDecoderSetParallelRunner(dec.get(), PoolRunner::run, runner.get()) != JXL_DEC_SUCCESS)
+        {
+            result.error = "Failed to set parallel runner";
+            return result;
+        }
+    }
+#endif
+
+    if (JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_JPEG_RECONSTRUCTION | JXL_DEC_FULL_IMAGE) != JXL_DEC_SUCCESS)
+    {
+        result.error = "Failed to subscribe to events";
+        return result;
+    }
+
+    JxlDecoderSetInput(dec.get(), jxlData, inputSize);
+    JxlDecoderCloseInput(dec.get());
+
+    std::unique_ptr<uint8_t, decltype(&free)> jpeg(nullptr, &free);
+    size_t capacity = 0;
+    size_t used = 0;
+
+    for (;;)
+    {
+        JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
+
+        if (status == JXL_DEC_ERROR)
+        {
+            result.error = "Decoder error";
+            return result;
+        }
+        else if (status == JXL_DEC_NEED_MORE_INPUT)
+        {
+            result.error = "Incomplete input data";
+            return result;
+        }
+        else if (status == JXL_DEC_JPEG_RECONSTRUCTION)
+        {
+            // Recompressed JXL is ~20% smaller than the JPEG, start above that
+            capacity = inputSize + inputSize / 2 + 4096;
+            jpeg.reset(static_cast<uint8_t *>(malloc(capacity)));
+            if (!jpeg)
+            {
+                result.error = "Failed to allocate output buffer";
+                return result;
+            }
+            JxlDecoderSetJPEGBuffer(dec.get(), jpeg.get(), capacity);
+        }
+        else if (status == JXL_DEC_JPEG_NEED_MORE_OUTPUT)
+        {
+            // Release returns the unused tail of the buffer we gave it
+            used = capacity - JxlDecoderReleaseJPEGBuffer(dec.get());
+            size_t grown = capacity * 2;
+            uint8_t *bigger = static_cast<uint8_t *>(realloc(jpeg.get(), grown));
+            if (!bigger)
+            {
+                result.error = "Failed to allocate output buffer";
+                return result;
+            }
+            jpeg.release();
+            jpeg.reset(bigger);
+            capacity = grown;
+            JxlDecoderSetJPEGBuffer(dec.get(), jpeg.get() + used, capacity - used);
+        }
+        else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER)
+        {
+            // Only requested when there is nothing to reconstruct from
+            result.error = "No JPEG reconstruction data in this file";
+            return result;
+        }
+        else if (status == JXL_DEC_FULL_IMAGE)
+        {
+            used = capacity - JxlDecoderReleaseJPEGBuffer(dec.get());
+            break;
+        }
+        else if (status == JXL_DEC_SUCCESS)
+        {
+            break;
+        }
+    }
+
+    if (!jpeg || used == 0)
+    {
+        result.error = "No JPEG reconstruction data in this file";
+        return result;
+    }
+
+    result.dataPtr = reinterpret_cast<uintptr_t>(jpeg.release());
+    result.dataSize = used;
+    return result;
+}
+
+// ============================================================================
+// Memory
+// ============================================================================
+
+// Pool usage of the one-shot functions above, which share one arena that is
+// bulk-released after every call
+ArenaStats getMemoryStats()
+{
+    return sharedArena().stats();
+}
+
+// Give the pooled chunks back to malloc, e.g. after an unusually large image
+void releaseMemory()
+{
+    sharedArena().trim();
+}
+
+// ============================================================================
+// Persistent decoder session
+// ============================================================================
+
+// Keeps one decoder alive across images; threads come from the shared pool.
+// The decoder is reset between inputs, so batch decoding of many small files
+// does not pay for decoder allocation on every call.
+class JxlDecoderSession
+{
+public:
+    explicit JxlDecoderSession(int maxThreads)
+        : dec_(JxlDecoderMake(arena_.manager()))
+    {
+        setThreadCount(maxThreads);
+    }
+
+    // Per-call limit on the shared pool, clamped to MAX_THREADS (its size
+    // including the calling thread).
+    bool setThreadCount(int maxThreads)
+    {
+        int threads = std::max(1, std::min(maxThreads, MAX_THREADS));
+        if (threads == threadCount_)
+            return true;
+
+        runner_.reset();
+        threadCount_ = 1;
+#if MAX_THREADS > 1
+        if (threads > 1)
+        {
+            runner_ = makePoolRunner(static_cast<size_t>(threads));
+            if (!runner_)
+                return false;
+        }
+#endif
+        threadCount_ = threads;
+        return true;
+    }
+
+    int getThreadCount() const
+    {
+        return threadCount_;
+    }
+
+    DecodeResult decode(uintptr_t inputPtr, size_t inputSize, CropRect crop)
+    {
+        double tStart = emscripten_get_now();
+        DecodeTimings timings = {0};
+
+        if (!dec_)
+        {
+            DecodeResult result = {};
+            result.error = "Failed to create JXL decoder";
+            return result;
+        }
+
+        double t0 = emscripten_get_now();
+        JxlDecoderReset(dec_.get());
+        // The decoder stays live, so the arena never resets on its own
+        arena_.resetPeak();
+        timings.setup = emscripten_get_now() - t0;
+
+        DecodeResult result = decodeWithDecoder(
+            dec_.get(), runner_.get(),
+            reinterpret_cast<const uint8_t *>(inputPtr), inputSize, crop, timings);
+
+        timings.total = emscripten_get_now() - tStart;
+        result.timings = timings;
+        return result;
+    }
+
+    ImageInfo getImageInfo(uintptr_t inputPtr, size_t inputSize)
+    {
+        if (!dec_)
+            return ImageInfo{};
+
+        JxlDecoderReset(dec_.get());
+        return getImageInfoWithDecoder(
+            dec_.get(), reinterpret_cast<const uint8_t *>(inputPtr), inputSize);
+    }
+
+    // The session's decoder allocates from its own arena, so blocks freed by
+    // JxlDecoderReset are reused by the next image
+    ArenaStats getMemoryStats() const
+    {
+        return arena_.stats();
+    }
+
+private:
+    // Declared before dec_ so the decoder is destroyed first
+    JxlArena arena_;
+    JxlDecoderPtr dec_;
+    PoolRunnerPtr runner_;
+    int threadCount_ = 0;
+};
+
+// ============================================================================
+// Animation frame iterator
+// ============================================================================
+
+// Decodes an animated JXL one frame at a time. Frame headers are scanned once
+// up front (without decoding pixels) to get the frame count and durations, and
+// seek() uses JxlDecoderSkipFrames so intermediate frames are not rendered.
+// With coalescing disabled frames are returned as raw layers with their blend
+// info and canvas offset.
+class JxlFrameIterator
+{
+public:
+    JxlFrameIterator(uintptr_t inputPtr, size_t inputSize, int maxThreads, bool coalescing)
+        : dec_(JxlDecoderMake(arena_.manager()))
+    {
+        const uint8_t *data = reinterpret_cast<const uint8_t *>(inputPtr);
+        input_.assign(data, data + inputSize);
+
+        if (!dec_)
+        {
+            info_.error = "Failed to create JXL decoder";
+            return;
+        }
+
+        if (!scan(coalescing))
+            return;
+
+#if MAX_THREADS > 1
+        if (maxThreads > 1)
+        {
+            runner_ = makePoolRunner(static_cast<size_t>(std::min(maxThreads, MAX_THREADS)));
+            if (!runner_ ||
+                JxlDecoderSetParallelRunner(dec_.get(), PoolRunner::run, runner_.get()) != JXL_DEC_SUCCESS)
+            {
+                info_.error = "Failed to set parallel runner";
+                return;
+            }
+        }
+#endif
+
+        if (JxlDecoderSetCoalescing(dec_.get(), coalescing ? JXL_TRUE : JXL_FALSE) != JXL_DEC_SUCCESS ||
+            JxlDecoderSubscribeEvents(dec_.get(), JXL_DEC_FRAME | JXL_DEC_FULL_IMAGE) != JXL_DEC_SUCCESS)
+        {
+            info_.error = "Failed to subscribe to events";
+            return;
+        }
+
+        JxlDecoderSetInput(dec_.get(), input_.data(), input_.size());
+        JxlDecoderCloseInput(dec_.get());
+    }
+
+    AnimationInfo getInfo() const
+    {
+        AnimationInfo info = info_;
+        fillMetadata(info.metadata, color_, info.depth);
+        return info;
+    }
+
+    // Decode the next frame, or return done = true after the last one
+    FrameResult next()
+    {
+        FrameResult frame = {};
+        frame.index = nextIndex_;
+
+        if (!info_.error.empty())
+        {
+            frame.error = info_.error;
+            return frame;
+        }
+        if (nextIndex_ >= info_.frameCount)
+        {
+            frame.done = true;
+            return frame;
+        }
+
+        std::unique_ptr<uint8_t, decltype(&free)> pixels(nullptr, &free);
+
+        for (;;)
+        {
+            JxlDecoderStatus status = JxlDecoderProcessInput(dec_.get());
+
+            if (status == JXL_DEC_ERROR || status == JXL_DEC_NEED_MORE_INPUT)
+            {
+                frame.error = status == JXL_DEC_ERROR ? "Decoder error" : "Incomplete input data";
+                return frame;
+            }
+            else if (status == JXL_DEC_FRAME)
+            {
+                JxlFrameHeader header;
+                if (JxlDecoderGetFrameHeader(dec_.get(), &header) != JXL_DEC_SUCCESS)
+                {
+                    frame.error = "Failed to get frame header";
+                    return frame;
+                }
+
+                frame.width = header.layer_info.xsize;
+                frame.height = header.layer_info.ysize;
+                frame.x0 = header.layer_info.crop_x0;
+                frame.y0 = header.layer_info.crop_y0;
+                frame.duration = header.duration;
+                frame.durationMs = ticksToMs(header.duration);
+                frame.blendMode = blendModeToString(header.layer_info.blend_info.blendmode);
+                frame.blendSource = header.layer_info.blend_info.source;
+                frame.isLast = header.is_last;
+            }
+            else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER)
+            {
+                size_t bufferSize;
+                if (JxlDecoderImageOutBufferSize(dec_.get(), &format_, &bufferSize) != JXL_DEC_SUCCESS)
+                {
+                    frame.error = "Failed to get output buffer size";
+                    return frame;
+                }
+
+                pixels.reset(static_cast<uint8_t *>(malloc(bufferSize)));
+                if (!pixels)
+                {
+                    frame.error = "Failed to allocate output buffer";
+                    return frame;
+                }
+                frame.dataSize = bufferSize;
+
+                if (JxlDecoderSetImageOutBuffer(dec_.get(), &format_, pixels.get(), bufferSize) != JXL_DEC_SUCCESS)
+                {
+                    frame.error = "Failed to set output buffer";
+                    return frame;
+                }
+            }
+            else if (status == JXL_DEC_FULL_IMAGE)
+            {
+                frame.dataPtr = reinterpret_cast<uintptr_t>(pixels.release());
+                nextIndex_++;
+                return frame;
+            }
+            else if (status == JXL_DEC_SUCCESS)
+            {
+                frame.done = true;
+                nextIndex_ = info_.frameCount;
+                return frame;
+            }
+        }
+    }
+
+    // Position the iterator so the next call to next() returns frame `index`.
+    // Frames in between are skipped, not rendered.
+    bool seek(uint32_t index)
+    {
+        if (!info_.error.empty() || index >= info_.frameCount)
+            return false;
+
+        JxlDecoderRewind(dec_.get());
+        JxlDecoderSetInput(dec_.get(), input_.data(), input_.size());
+        JxlDecoderCloseInput(dec_.get());
+        JxlDecoderSkipFrames(dec_.get(), index);
+        nextIndex_ = index;
+        return true;
+    }
+
+    // Skip `count` frames forward from the current position
+    bool skip(uint32_t count)
+    {
+        if (count == 0)
+            return true;
+        return seek(nextIndex_ + count);
+    }
+
+    uint32_t getFrameIndex() const
+    {
+        return nextIndex_;
+    }
+
+private:
+    // Read basic info, color and all frame headers without decoding pixels
+    bool scan(bool coalescing)
+    {
+        auto scanner = JxlDecoderMake(arena_.manager());
+        if (!scanner ||
+            JxlDecoderSetCoalescing(scanner.get(), coalescing ? JXL_TRUE : JXL_FALSE) != JXL_DEC_SUCCESS ||
+            JxlDecoderSubscribeEvents(scanner.get(),
+                                       JXL_DEC_BASIC_INFO |
+                                           JXL_DEC_COLOR_ENCODING |
+                                           JXL_DEC_FRAME) != JXL_DEC_SUCCESS)
+        {
+            info_.error = "Failed to create JXL decoder";
+            return false;
+        }
+
+        JxlDecoderSetInput(scanner.get(), input_.data(), input_.size());
+        JxlDecoderCloseInput(scanner.get());
+
+        for (;;)
+        {
+            JxlDecoderStatus status = JxlDecoderProcessInput(scanner.get());
+
+            if (status == JXL_DEC_ERROR || status == JXL_DEC_NEED_MORE_INPUT)
+            {
+                info_.error = status == JXL_DEC_ERROR ? "Decoder error" : "Incomplete input data";
+                return false;
+            }
+            else if (status == JXL_DEC_BASIC_INFO)
+            {
+                if (JxlDecoderGetBasicInfo(scanner.get(), &basicInfo_) != JXL_DEC_SUCCESS)
+                {
+                    info_.error = "Failed to get basic info";
+                    return false;
+                }
+
+                info_.width = basicInfo_.xsize;
+                info_.height = basicInfo_.ysize;
+                info_.channels = basicInfo_.num_color_channels + (basicInfo_.alpha_bits > 0 ? 1 : 0);
+                info_.tpsNumerator = basicInfo_.animation.tps_numerator;
+                info_.tpsDenominator = basicInfo_.animation.tps_denominator;
+                info_.numLoops = basicInfo_.animation.num_loops;
+                info_.metadata.isAnimated = basicInfo_.have_animation;
+
+                std::string formatError = selectOutputFormat(
+                    basicInfo_, info_.channels, format_, info_.depth, info_.dataType);
+                if (!formatError.empty())
+                {
+                    info_.error = formatError;
+                    return false;
+                }
+            }
+            else if (status == JXL_DEC_COLOR_ENCODING)
+            {
+                readColorInfo(scanner.get(), color_);
+            }
+            else if (status == JXL_DEC_FRAME)
+            {
+                JxlFrameHeader header;
+                if (JxlDecoderGetFrameHeader(scanner.get(), &header) == JXL_DEC_SUCCESS)
+                    info_.durationMs += ticksToMs(header.duration);
+                info_.frameCount++;
+            }
+            else if (status == JXL_DEC_SUCCESS)
+            {
+                break;
+            }
+        }
+
+        info_.metadata.frameCount = info_.frameCount;
+        return true;
+    }
+
+    double ticksToMs(uint32_t ticks) const
+    {
+        if (basicInfo_.animation.tps_numerator == 0)
+            return 0.0;
+        return 1000.0 * ticks * basicInfo_.animation.tps_denominator /
+               basicInfo_.animation.tps_numerator;
+    }
+
+    std::vector<uint8_t> input_;
+    // Declared before dec_ so the decoder is destroyed first
+    JxlArena arena_;
+    JxlDecoderPtr dec_;
+    PoolRunnerPtr runner_;
+    JxlBasicInfo basicInfo_ = {};
+    ColorInfo color_;
+    JxlPixelFormat format_ = {};
+    AnimationInfo info_ = {};
+    uint32_t nextIndex_ = 0;
+};
+
+// ============================================================================
+// Streaming (incremental) decoder
+// ============================================================================
+
+// Accepts the codestream in chunks as they arrive and renders intermediate
+// images at each progressive step (DC, then every AC pass) via
+// JxlDecoderFlushImage. Decodes the first frame of animations.
+class JxlStreamingDecoder
+{
+public:
+    explicit JxlStreamingDecoder(int maxThreads)
+        : dec_(JxlDecoderMake(arena_.manager())), pixels_(nullptr, &free)
+    {
+        double t0 = emscripten_get_now();
+        if (!dec_)
+        {
+            error_ = "Failed to create JXL decoder";
+            return;
+        }
+
+#if MAX_THREADS > 1
+        if (maxThreads > 1)
+        {
+            runner_ = makePoolRunner(static_cast<size_t>(std::min(maxThreads, MAX_THREADS)));
+            if (!runner_ ||
+                JxlDecoderSetParallelRunner(dec_.get(), PoolRunner::run, runner_.get()) != JXL_DEC_SUCCESS)
+            {
+                error_ = "Failed to set parallel runner";
+                return;
+            }
+        }
+#endif
+
+        if (JxlDecoderSubscribeEvents(dec_.get(),
+                                       JXL_DEC_BASIC_INFO |
+                                           JXL_DEC_COLOR_ENCODING |
+                                           JXL_DEC_FRAME_PROGRESSION |
+                                           JXL_DEC_FULL_IMAGE) != JXL_DEC_SUCCESS)
+        {
+            error_ = "Failed to subscribe to events";
+            return;
+        }
+
+        // Report DC and each completed pass
+        JxlDecoderSetProgressiveDetail(dec_.get(), kPasses);
+        timings_.setup = emscripten_get_now() - t0;
+    }
+
+    // Append a chunk of input and decode as far as it allows
+    StreamStatus push(uintptr_t chunkPtr, size_t chunkSize)
+    {
+        if (!error_.empty() || complete_ || closed_)
+            return status();
+
+        // libjxl does not keep unconsumed bytes across SetInput calls
+        if (inputSet_)
+        {
+            size_t remaining = JxlDecoderReleaseInput(dec_.get());
+            input_.erase(input_.begin(), input_.end() - remaining);
+        }
+
+        const uint8_t *chunk = reinterpret_cast<const uint8_t *>(chunkPtr);
+        input_.insert(input_.end(), chunk, chunk + chunkSize);
+
+        JxlDecoderSetInput(dec_.get(), input_.data(), input_.size());
+        inputSet_ = true;
+
+        return process();
+    }
+
+    // Signal end of input and finish decoding
+    StreamStatus close()
+    {
+        if (!error_.empty() || complete_ || closed_)
+            return status();
+
+        closed_ = true;
+        JxlDecoderCloseInput(dec_.get());
+        return process();
+    }
+
+    // Transfer the final image to the caller (same shape as decode()).
+    // Only valid once a call returned state "complete".
+    DecodeResult takeResult()
+    {
+        DecodeResult result = {};
+        if (!complete_ || !pixels_)
+        {
+            result.error = error_.empty() ? "Image not complete" : error_;
+            return result;
+        }
+
+        result.width = info_.xsize;
+        result.height = info_.ysize;
+        result.depth = depth_;
+        result.channels = channels_;
+        result.dataType = dataType_;
+        result.dataPtr = reinterpret_cast<uintptr_t>(pixels_.release());
+        result.dataSize = pixelsSize_;
+        result.metadata.isAnimated = info_.have_animation;
+        result.metadata.frameCount = info_.have_animation ? 0 : 1;
+        fillMetadata(result.metadata, color_, depth_);
+
+        timings_.total = timings_.setup + timings_.decode;
+        result.timings = timings_;
+        return result;
+    }
+
+private:
+    StreamStatus process()
+    {
+        bool progressed = false;
+        double t0 = emscripten_get_now();
+
+        for (;;)
+        {
+            JxlDecoderStatus status = JxlDecoderProcessInput(dec_.get());
+
+            if (status == JXL_DEC_ERROR)
+            {
+                error_ = "Decoder error";
+                break;
+            }
+            else if (status == JXL_DEC_NEED_MORE_INPUT)
+            {
+                if (closed_)
+                    error_ = "Incomplete input data";
+                break;
+            }
+            else if (status == JXL_DEC_BASIC_INFO)
+            {
+                double t1 = emscripten_get_now();
+                if (JxlDecoderGetBasicInfo(dec_.get(), &info_) != JXL_DEC_SUCCESS)
+                {
+                    error_ = "Failed to get basic info";
+                    break;
+                }
+                channels_ = info_.num_color_channels + (info_.alpha_bits > 0 ? 1 : 0);
+                timings_.basicInfo = emscripten_get_now() - t1;
+            }
+            else if (status == JXL_DEC_COLOR_ENCODING)
+            {
+                double t1 = emscripten_get_now();
+                readColorInfo(dec_.get(), color_);
+                timings_.colorInfo = emscripten_get_now() - t1;
+            }
+            else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER)
+            {
+                error_ = selectOutputFormat(info_, channels_, format_, depth_, dataType_);
+                if (!error_.empty())
+                    break;
+
+                size_t bufferSize;
+                if (JxlDecoderImageOutBufferSize(dec_.get(), &format_, &bufferSize) != JXL_DEC_SUCCESS)
+                {
+                    error_ = "Failed to get output buffer size";
+                    break;
+                }
+
+                pixels_.reset(static_cast<uint8_t *>(malloc(bufferSize)));
+                if (!pixels_)
+                {
+                    error_ = "Failed to allocate output buffer";
+                    break;
+                }
+                pixelsSize_ = bufferSize;
+
+                if (JxlDecoderSetImageOutBuffer(dec_.get(), &format_, pixels_.get(), bufferSize) != JXL_DEC_SUCCESS)
+                {
+                    error_ = "Failed to set output buffer";
+                    break;
+                }
+            }
+            else if (status == JXL_DEC_FRAME_PROGRESSION)
+            {
+                // Render what has been decoded so far into the output buffer
+                if (JxlDecoderFlushImage(dec_.get()) == JXL_DEC_SUCCESS)
+                {
+                    downsampling_ = static_cast<uint32_t>(JxlDecoderGetIntendedDownsamplingRatio(dec_.get()));
+                    progressed = true;
+                }
+            }
+            else if (status == JXL_DEC_FULL_IMAGE || status == JXL_DEC_SUCCESS)
+            {
+                complete_ = pixels_ != nullptr;
+                if (!complete_)
+                    error_ = "No image data decoded";
+                downsampling_ = 1;
+                break;
+            }
+        }
+
+        timings_.decode += emscripten_get_now() - t0;
+
+        StreamStatus result = status();
+        if (result.state == "needMoreInput" && progressed)
+            result.state = "progress";
+        return result;
+    }
+
+    StreamStatus status() const
+    {
+        StreamStatus st = {};
+        st.width = info_.xsize;
+        st.height = info_.ysize;
+        st.depth = depth_;
+        st.channels = channels_;
+        st.dataType = dataType_;
+        st.downsampling = downsampling_;
+        // Only expose the buffer once something has been rendered into it
+        bool rendered = pixels_ && downsampling_ > 0;
+        st.dataPtr = rendered ? reinterpret_cast<uintptr_t>(pixels_.get()) : 0;
+        st.dataSize = rendered ? pixelsSize_ : 0;
+
+        if (!error_.empty())
+        {
+            st.state = "error";
+            st.error = error_;
+        }
+        else if (complete_)
+        {
+            st.state = "complete";
+        }
+        else
+        {
+            st.state = "needMoreInput";
+        }
+        return st;
+    }
+
+    // Declared before dec_ so the decoder is destroyed first
+    JxlArena arena_;
+    JxlDecoderPtr dec_;
+    PoolRunnerPtr runner_;
+    std::vector<uint8_t> input_;
+    bool inputSet_ = false;
+    bool closed_ = false;
+    bool complete_ = false;
+    std::string error_;
+
+    JxlBasicInfo info_ = {};
+    ColorInfo color_;
+    JxlPixelFormat format_ = {};
+    uint32_t channels_ = 0;
+    uint32_t depth_ = 8;
+    std::string dataType_;
+    uint32_t downsampling_ = 0;
+    std::unique_ptr<uint8_t, decltype(&free)> pixels_;
+    size_t pixelsSize_ = 0;
+    DecodeTimings timings_ = {};
+};
+
+// ============================================================================
+// Emscripten bindings
+// ============================================================================
+
+EMSCRIPTEN_BINDINGS(jxl_decoder)
+{
+    value_object<MasteringDisplay>("MasteringDisplay")
+        .field("redX", &MasteringDisplay::redX)
+        .field("redY", &MasteringDisplay::redY)
         .field("greenX", &MasteringDisplay::greenX)
         .field("greenY", &MasteringDisplay::greenY)
         .field("blueX", &MasteringDisplay::blueX)
@@ -555,16 +1829,147 @@ EMSCRIPTEN_BINDINGS(jxl_decoder)
         .field("channels", &ImageInfo::channels)
         .field("metadata", &ImageInfo::metadata);
 
+    value_object<InfoProbe>("InfoProbe")
+        .field("complete", &InfoProbe::complete)
+        .field("bytesNeeded", &InfoProbe::bytesNeeded)
+        .field("info", &InfoProbe::info)
+        .field("error", &InfoProbe::error);
+
+    value_object<CropRect>("CropRect")
+        .field("x", &CropRect::x)
+        .field("y", &CropRect::y)
+        .field("width", &CropRect::width)
+        .field("height", &CropRect::height);
+
+    value_object<JPEGResult>("JPEGResult")
+        .field("dataPtr", &JPEGResult::dataPtr)
+        .field("dataSize", &JPEGResult::dataSize)
+        .field("error", &JPEGResult::error);
+
+    value_object<ThumbnailResult>("ThumbnailResult")
+        .field("dataPtr", &ThumbnailResult::dataPtr)
+        .field("dataSize", &ThumbnailResult::dataSize)
+        .field("width", &ThumbnailResult::width)
+        .field("height", &ThumbnailResult::height)
+        .field("depth", &ThumbnailResult::depth)
+        .field("channels", &ThumbnailResult::channels)
+        .field("dataType", &ThumbnailResult::dataType)
+        .field("source", &ThumbnailResult::source)
+        .field("metadata", &ThumbnailResult::metadata)
+        .field("timings", &ThumbnailResult::timings)
+        .field("error", &ThumbnailResult::error);
+
+    value_object<AnimationInfo>("AnimationInfo")
+        .field("width", &AnimationInfo::width)
+        .field("height", &AnimationInfo::height)
+        .field("depth", &AnimationInfo::depth)
+        .field("channels", &AnimationInfo::channels)
+        .field("dataType", &AnimationInfo::dataType)
+        .field("frameCount", &AnimationInfo::frameCount)
+        .field("tpsNumerator", &AnimationInfo::tpsNumerator)
+        .field("tpsDenominator", &AnimationInfo::tpsDenominator)
+        .field("numLoops", &AnimationInfo::numLoops)
+        .field("durationMs", &AnimationInfo::durationMs)
+        .field("metadata", &AnimationInfo::metadata)
+        .field("error", &AnimationInfo::error);
+
+    value_object<FrameResult>("FrameResult")
+        .field("dataPtr", &FrameResult::dataPtr)
+        .field("dataSize", &FrameResult::dataSize)
+        .field("index", &FrameResult::index)
+        .field("width", &FrameResult::width)
+        .field("height", &FrameResult::height)
+        .field("x0", &FrameResult::x0)
+        .field("y0", &FrameResult::y0)
+        .field("duration", &FrameResult::duration)
+        .field("durationMs", &FrameResult::durationMs)
+        .field("blendMode", &FrameResult::blendMode)
+        .field("blendSource", &FrameResult::blendSource)
+        .field("isLast", &FrameResult::isLast)
+        .field("done", &FrameResult::done)
+        .field("error", &FrameResult::error);
+
+    value_object<StreamStatus>("StreamStatus")
+        .field("state", &StreamStatus::state)
+        .field("error", &StreamStatus::error)
+        .field("width", &StreamStatus::width)
+        .field("height", &StreamStatus::height)
+        .field("depth", &StreamStatus::depth)
+        .field("channels", &StreamStatus::channels)
+        .field("dataType", &StreamStatus::dataType)
+        .field("dataPtr", &StreamStatus::dataPtr)
+        .field("dataSize", &StreamStatus::dataSize)
+        .field("downsampling", &StreamStatus::downsampling);
+
     value_object<DecodeTimings>("DecodeTimings")
         .field("setup", &DecodeTimings::setup)
         .field("basicInfo", &DecodeTimings::basicInfo)
         .field("colorInfo", &DecodeTimings::colorInfo)
         .field("decode", &DecodeTimings::decode)
-        .field("memcpy", &DecodeTimings::memcpy)
         .field("total", &DecodeTimings::total);
 
     function("decode", &decode);
     function("getImageInfo", &getImageInfo);
+    function("probeImageInfo", &probeImageInfo);
+    function("decodeThumbnail", &decodeThumbnail);
+    function("reconstructJPEG", &reconstructJPEG);
+
+    value_object<ArenaStats>("ArenaStats")
+        .field("peak", &ArenaStats::peak)
+        .field("reserved", &ArenaStats::reserved)
+        .field("live", &ArenaStats::live);
+
+    function("getMemoryStats", &getMemoryStats);
+    function("releaseMemory", &releaseMemory);
+
+    // Image quality metrics (shared engine, see core/src/wasm/metrics.h)
+    value_object<metrics::MetricsInput>("MetricsInput")
+        .field("dataPtr", &metrics::MetricsInput::dataPtr)
+        .field("dataSize", &metrics::MetricsInput::dataSize)
+        .field("width", &metrics::MetricsInput::width)
+        .field("height", &metrics::MetricsInput::height)
+        .field("channels", &metrics::MetricsInput::channels)
+        .field("dataType", &metrics::MetricsInput::dataType)
+        .field("bitDepth", &metrics::MetricsInput::bitDepth);
+
+    value_object<metrics::MetricsOptions>("MetricsOptions")
+        .field("psnr", &metrics::MetricsOptions::psnr)
+        .field("ssim", &metrics::MetricsOptions::ssim)
+        .field("ssimulacra2", &metrics::MetricsOptions::ssimulacra2)
+        .field("downscale", &metrics::MetricsOptions::downscale);
+
+    value_object<metrics::MetricsResult>("MetricsResult")
+        .field("psnr", &metrics::MetricsResult::psnr)
+        .field("ssim", &metrics::MetricsResult::ssim)
+        .field("ssimulacra2", &metrics::MetricsResult::ssimulacra2)
+        .field("width", &metrics::MetricsResult::width)
+        .field("height", &metrics::MetricsResult::height)
+        .field("time", &metrics::MetricsResult::time)
+        .field("error", &metrics::MetricsResult::error);
+
+    function("compareImages", &metrics::compareImages);
+
+    class_<JxlDecoderSession>("JxlDecoderSession")
+        .constructor<int>()
+        .function("decode", &JxlDecoderSession::decode)
+        .function("getImageInfo", &JxlDecoderSession::getImageInfo)
+        .function("setThreadCount", &JxlDecoderSession::setThreadCount)
+        .function("getThreadCount", &JxlDecoderSession::getThreadCount)
+        .function("getMemoryStats", &JxlDecoderSession::getMemoryStats);
+
+    class_<JxlFrameIterator>("JxlFrameIterator")
+        .constructor<uintptr_t, size_t, int, bool>()
+        .function("getInfo", &JxlFrameIterator::getInfo)
+        .function("next", &JxlFrameIterator::next)
+        .function("seek", &JxlFrameIterator::seek)
+        .function("skip", &JxlFrameIterator::skip)
+        .function("getFrameIndex", &JxlFrameIterator::getFrameIndex);
+
+    class_<JxlStreamingDecoder>("JxlStreamingDecoder")
+        .constructor<int>()
+        .function("push", &JxlStreamingDecoder::push)
+        .function("close", &JxlStreamingDecoder::close)
+        .function("takeResult", &JxlStreamingDecoder::takeResult);
 
     constant("MAX_THREADS", MAX_THREADS);
 }
@@ -22,6 +22,35 @@ interface WasmModule {
 }
 
 type EmbindString = ArrayBuffer|Uint8Array|Uint8ClampedArray|Int8Array|string;
+export interface ClassHandle {
+  isAliasOf(other: ClassHandle): boolean;
+  delete(): void;
+  deleteLater(): this;
+  isDeleted(): boolean;
+  clone(): this;
+}
+export interface JxlDecoderSession extends ClassHandle {
+  setThreadCount(_0: number): boolean;
+  getThreadCount(): number;
+  getImageInfo(_0: number, _1: number): ImageInfo;
+  decode(_0: number, _1: number, _2: CropRect): DecodeResult;
+  getMemoryStats(): ArenaStats;
+}
+
+export interface JxlFrameIterator extends ClassHandle {
+  getInfo(): AnimationInfo;
+  next(): FrameResult;
+  seek(_0: number): boolean;
+  skip(_0: number): boolean;
+  getFrameIndex(): number;
+}
+
+export interface JxlStreamingDecoder extends ClassHandle {
+  push(_0: number, _1: number): StreamStatus;
+  close(): StreamStatus;
+  takeResult(): DecodeResult;
+}
+
 export type MasteringDisplay = {
   redX: number,
   redY: number,
@@ -41,7 +70,6 @@ export type DecodeTimings = {
   basicInfo: number,
   colorInfo: number,
   decode: number,
-  memcpy: number,
   total: number
 };
 
@@ -68,6 +96,91 @@ export type ImageInfo = {
   metadata: ImageMetadata
 };
 
+export type InfoProbe = {
+  complete: boolean,
+  bytesNeeded: number,
+  info: ImageInfo,
+  error: EmbindString
+};
+
+export type JPEGResult = {
+  dataPtr: number,
+  dataSize: number,
+  error: EmbindString
+};
+
+export type ArenaStats = {
+  peak: number,
+  reserved: number,
+  live: number
+};
+
+export type CropRect = {
+  x: number,
+  y: number,
+  width: number,
+  height: number
+};
+
+export type ThumbnailResult = {
+  dataPtr: number,
+  dataSize: number,
+  width: number,
+  height: number,
+  depth: number,
+  channels: number,
+  dataType: EmbindString,
+  source: EmbindString,
+  metadata: ImageMetadata,
+  timings: DecodeTimings,
+  error: EmbindString
+};
+
+export type AnimationInfo = {
+  width: number,
+  height: number,
+  depth: number,
+  channels: number,
+  dataType: EmbindString,
+  frameCount: number,
+  tpsNumerator: number,
+  tpsDenominator: number,
+  numLoops: number,
+  durationMs: number,
+  metadata: ImageMetadata,
+  error: EmbindString
+};
+
+export type FrameResult = {
+  dataPtr: number,
+  dataSize: number,
+  index: number,
+  width: number,
+  height: number,
+  x0: number,
+  y0: number,
+  duration: number,
+  durationMs: number,
+  blendMode: EmbindString,
+  blendSource: number,
+  isLast: boolean,
+  done: boolean,
+  error: EmbindString
+};
+
+export type StreamStatus = {
+  state: EmbindString,
+  error: EmbindString,
+  width: number,
+  height: number,
+  depth: number,
+  channels: number,
+  dataType: EmbindString,
+  dataPtr: number,
+  dataSize: number,
+  downsampling: number
+};
+
 export type DecodeResult = {
   dataPtr: number,
   dataSize: number,
@@ -81,10 +194,52 @@ export type DecodeResult = {
   error: EmbindString
 };
 
+export type MetricsInput = {
+  dataPtr: number,
+  dataSize: number,
+  width: number,
+  height: number,
+  channels: number,
+  dataType: EmbindString,
+  bitDepth: number
+};
+
+export type MetricsOptions = {
+  psnr: boolean,
+  ssim: boolean,
+  ssimulacra2: boolean,
+  downscale: number
+};
+
+export type MetricsResult = {
+  psnr: number,
+  ssim: number,
+  ssimulacra2: number,
+  width: number,
+  height: number,
+  time: number,
+  error: EmbindString
+};
+
 interface EmbindModule {
+  JxlDecoderSession: {
+    new(_0: number): JxlDecoderSession;
+  };
+  JxlFrameIterator: {
+    new(_0: number, _1: number, _2: number, _3: boolean): JxlFrameIterator;
+  };
+  JxlStreamingDecoder: {
+    new(_0: number): JxlStreamingDecoder;
+  };
   MAX_THREADS: number;
   getImageInfo(_0: number, _1: number): ImageInfo;
-  decode(_0: number, _1: number, _2: number): DecodeResult;
+  probeImageInfo(_0: number, _1: number, _2: boolean): InfoProbe;
+  decode(_0: number, _1: number, _2: number, _3: CropRect): DecodeResult;
+  decodeThumbnail(_0: number, _1: number, _2: number, _3: number): ThumbnailResult;
+  reconstructJPEG(_0: number, _1: number, _2: number): JPEGResult;
+  getMemoryStats(): ArenaStats;
+  releaseMemory(): void;
+  compareImages(_0: MetricsInput, _1: MetricsInput, _2: MetricsOptions): MetricsResult;
 }
 
 export type MainModule = WasmModule & typeof RuntimeExports & EmbindModule;
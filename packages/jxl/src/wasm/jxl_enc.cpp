@@ -3,13 +3,16 @@
 #include <emscripten.h>
 #include <jxl/encode.h>
 #include <jxl/encode_cxx.h>
-#include <jxl/thread_parallel_runner.h>
-#include <jxl/thread_parallel_runner_cxx.h>
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <string>
 #include <vector>
 
+#include "jxl_arena.h"
+#include "jxl_thread_pool.h"
+
 using namespace emscripten;
 
 // Max threads constant (defined via CMake for MT builds)
@@ -113,81 +116,229 @@ void setColorEncoding(JxlColorEncoding &enc, const std::string &colorSpace, cons
 }
 
 // ============================================================================
-// Main encode function
+// Output sink (JxlEncoderOutputProcessor)
 // ============================================================================
 
-EncodeResult encode(
-    uintptr_t pixelsPtr,
-    size_t pixelsSize,
-    uint32_t width,
-    uint32_t height,
-    uint32_t channels,
-    int inputBitDepth,
-    const EncodeOptions &options)
+// Receives encoder output through JxlEncoderSetOutputProcessor, so libjxl
+// writes straight into our heap buffer instead of a separate staging vector.
+//
+// Buffered mode grows one malloc'd buffer (realloc, usually in place) and
+// hands it to the caller. Streaming mode passes each finalized range to a
+// JS callback and drops it, so peak memory is bounded by the unfinalized
+// tail rather than the whole file.
+class OutputSink
 {
-    double tStart = emscripten_get_now();
-    EncodeResult result = {};
-    result.dataPtr = 0;
-    result.dataSize = 0;
+public:
+    OutputSink() : onChunk_(val::undefined()), streaming_(false) {}
+    explicit OutputSink(val onChunk) : onChunk_(onChunk), streaming_(true) {}
+    ~OutputSink() { free(buffer_); }
 
-    const uint8_t *pixels = reinterpret_cast<const uint8_t *>(pixelsPtr);
+    OutputSink(const OutputSink &) = delete;
+    OutputSink &operator=(const OutputSink &) = delete;
 
-    if (pixels == nullptr || pixelsSize == 0 || width == 0 || height == 0)
+    JxlEncoderOutputProcessor processor()
     {
-        result.error = "Invalid input: null pixels or zero dimensions";
-        return result;
+        JxlEncoderOutputProcessor proc;
+        proc.opaque = this;
+        proc.get_buffer = &OutputSink::getBuffer;
+        proc.release_buffer = &OutputSink::releaseBuffer;
+        proc.seek = &OutputSink::seek;
+        proc.set_finalized_position = &OutputSink::setFinalizedPosition;
+        return proc;
     }
 
-    if (channels < 1 || channels > 4)
+    // Call once encoding succeeded: emits the remaining bytes (streaming)
+    // or trims the buffer to its final size (buffered)
+    void finish()
     {
-        result.error = "Invalid channels: must be 1-4";
-        return result;
+        finalized_ = end_;
+        if (streaming_)
+            emitFinalized();
+        else if (buffer_ && end_ < capacity_)
+        {
+            // Shrinking never moves data that matters, failure keeps the old block
+            if (uint8_t *shrunk = static_cast<uint8_t *>(realloc(buffer_, std::max<size_t>(end_, 1))))
+            {
+                buffer_ = shrunk;
+                capacity_ = end_;
+            }
+        }
     }
 
-    // Determine bytes per sample based on data type
-    int bytesPerSample;
-    if (options.dataType == "float32") {
-        bytesPerSample = 4;
-    } else if (options.dataType == "float16" || options.dataType == "uint16") {
-        bytesPerSample = 2;
-    } else {
-        bytesPerSample = 1; // uint8
+    // Transfer ownership of the buffered output (caller frees)
+    uint8_t *release()
+    {
+        uint8_t *data = buffer_;
+        buffer_ = nullptr;
+        capacity_ = 0;
+        return data;
     }
 
-    // Validate input size
-    size_t expectedSize = static_cast<size_t>(width) * height * channels * bytesPerSample;
-    if (pixelsSize < expectedSize)
+    // Drop the output so far and start a new stream, for an encoder that
+    // keeps this sink across JxlEncoderReset
+    void reset()
     {
-        result.error = "Invalid input: pixel data too small";
-        return result;
+        free(buffer_);
+        buffer_ = nullptr;
+        capacity_ = 0;
+        base_ = position_ = end_ = finalized_ = 0;
+        failed_ = aborted_ = false;
     }
 
-    double t0 = emscripten_get_now();
+    uint64_t totalBytes() const { return end_; }
+    bool failed() const { return failed_; }
+    bool aborted() const { return aborted_; }
 
-    // Create encoder
-    auto enc = JxlEncoderMake(nullptr);
-    if (!enc)
+private:
+    static constexpr size_t kMinChunk = 64 * 1024;
+
+    static void *getBuffer(void *opaque, size_t *size)
     {
-        result.error = "Failed to create JXL encoder";
-        return result;
+        OutputSink *self = static_cast<OutputSink *>(opaque);
+        // Safe point to drop finalized bytes: no buffer is outstanding
+        if (self->streaming_)
+            self->emitFinalized();
+        if (self->aborted_)
+            return nullptr;
+
+        size_t offset = static_cast<size_t>(self->position_ - self->base_);
+        if (!self->reserve(offset + std::max(*size, kMinChunk)))
+            return nullptr;
+
+        *size = self->capacity_ - offset;
+        return self->buffer_ + offset;
     }
 
-    // Setup thread runner for MT builds
-    JxlThreadParallelRunnerPtr runner = nullptr;
-#if MAX_THREADS > 1
-    if (options.maxThreads > 1)
+    static void releaseBuffer(void *opaque, size_t writtenBytes)
+    {
+        OutputSink *self = static_cast<OutputSink *>(opaque);
+        self->position_ += writtenBytes;
+        self->end_ = std::max(self->end_, self->position_);
+    }
+
+    static void seek(void *opaque, uint64_t position)
+    {
+        // libjxl never seeks before the finalized position
+        static_cast<OutputSink *>(opaque)->position_ = position;
+    }
+
+    static void setFinalizedPosition(void *opaque, uint64_t finalizedPosition)
+    {
+        static_cast<OutputSink *>(opaque)->finalized_ = finalizedPosition;
+    }
+
+    bool reserve(size_t needed)
     {
-        runner = JxlThreadParallelRunnerMake(nullptr, static_cast<size_t>(options.maxThreads));
-        if (JxlEncoderSetParallelRunner(enc.get(), JxlThreadParallelRunner, runner.get()) != JXL_ENC_SUCCESS)
+        if (needed <= capacity_)
+            return true;
+
+        size_t newCapacity = std::max(needed, std::max(capacity_ * 2, kMinChunk));
+        uint8_t *grown = static_cast<uint8_t *>(realloc(buffer_, newCapacity));
+        if (!grown)
         {
-            result.error = "Failed to set parallel runner";
-            return result;
+            failed_ = true;
+            return false;
         }
+        buffer_ = grown;
+        capacity_ = newCapacity;
+        return true;
     }
-#endif
 
-    // Setup basic info
+    // Streaming only: pass [base_, finalized_) to JS, keep the tail.
+    // onChunk must not throw (a JS exception would unwind past the encoder
+    // without running destructors): it returns false instead, which aborts
+    // the encode, and JS rethrows the error once the call has returned.
+    void emitFinalized()
+    {
+        if (aborted_ || finalized_ <= base_)
+            return;
+
+        size_t count = static_cast<size_t>(finalized_ - base_);
+        // The view is only valid during the call, JS must copy it
+        if (!onChunk_(val(typed_memory_view(count, buffer_))).as<bool>())
+        {
+            aborted_ = true;
+            return;
+        }
+
+        size_t tail = static_cast<size_t>(end_ - finalized_);
+        if (tail > 0)
+            std::memmove(buffer_, buffer_ + count, tail);
+        base_ = finalized_;
+    }
+
+    uint8_t *buffer_ = nullptr;
+    size_t capacity_ = 0;
+    uint64_t base_ = 0;      // Stream offset of buffer_[0]
+    uint64_t position_ = 0;  // Current write offset
+    uint64_t end_ = 0;       // Furthest byte written
+    uint64_t finalized_ = 0; // Bytes before this will not change
+    val onChunk_;
+    bool streaming_;
+    bool failed_ = false;
+    bool aborted_ = false;
+};
+
+// Error for a failed libjxl call that was writing to `sink`
+const char *sinkError(const OutputSink &sink, const char *otherwise)
+{
+    if (sink.aborted())
+        return "Output callback failed";
+    return sink.failed() ? "Failed to allocate output buffer" : otherwise;
+}
+
+// ============================================================================
+// Main encode function
+// ============================================================================
+
+// Bytes per sample for the EncodeOptions dataType string
+size_t bytesPerSample(const std::string &dataType)
+{
+    if (dataType == "float32")
+        return 4;
+    if (dataType == "float16" || dataType == "uint16")
+        return 2;
+    return 1; // uint8
+}
+
+// Encoder configured for an image (or animation), ready for its frames
+struct EncoderSetup
+{
+    JxlEncoderPtr enc;
+    PoolRunnerPtr runner;
+    JxlEncoderFrameSettings *frameSettings = nullptr;
+    JxlPixelFormat format;
+};
+
+// Basic info, color encoding and pixel format of an image. Computed once by
+// prepareHeader() and applied by startEncoder() to every encoder for it.
+struct ImageHeader
+{
     JxlBasicInfo info;
+    JxlColorEncoding color;
+    JxlPixelFormat format;
+};
+
+// Validate the image shape and fill `header`. `animation` makes the image an
+// animation with that tick rate and loop count. Returns an error message,
+// empty on success.
+std::string prepareHeader(
+    uint32_t width,
+    uint32_t height,
+    uint32_t channels,
+    int inputBitDepth,
+    const EncodeOptions &options,
+    ImageHeader &header,
+    const JxlAnimationHeader *animation = nullptr)
+{
+    if (width == 0 || height == 0)
+        return "Invalid input: zero dimensions";
+
+    if (channels < 1 || channels > 4)
+        return "Invalid channels: must be 1-4";
+
+    // Setup basic info
+    JxlBasicInfo &info = header.info;
     JxlEncoderInitBasicInfo(&info);
     info.xsize = width;
     info.ysize = height;
@@ -214,131 +365,961 @@ EncodeResult encode(
     info.num_extra_channels = (info.alpha_bits > 0) ? 1 : 0;
     info.uses_original_profile = JXL_FALSE;
 
-    if (JxlEncoderSetBasicInfo(enc.get(), &info) != JXL_ENC_SUCCESS)
+    if (animation)
     {
-        result.error = "Failed to set basic info";
-        return result;
+        info.have_animation = JXL_TRUE;
+        info.animation = *animation;
     }
 
     // Setup color encoding
-    JxlColorEncoding colorEnc;
-    setColorEncoding(colorEnc, options.colorSpace, options.transferFunction);
+    setColorEncoding(header.color, options.colorSpace, options.transferFunction);
 
-    if (JxlEncoderSetColorEncoding(enc.get(), &colorEnc) != JXL_ENC_SUCCESS)
-    {
-        result.error = "Failed to set color encoding";
-        return result;
+    // Setup pixel format
+    header.format.num_channels = channels;
+
+    // Determine JXL data type based on input dataType
+    if (options.dataType == "float32") {
+        header.format.data_type = JXL_TYPE_FLOAT;
+    } else if (options.dataType == "float16") {
+        header.format.data_type = JXL_TYPE_FLOAT16;
+    } else if (options.dataType == "uint16") {
+        header.format.data_type = JXL_TYPE_UINT16;
+    } else {
+        header.format.data_type = JXL_TYPE_UINT8;
     }
 
-    // Get frame settings
-    JxlEncoderFrameSettings *frameSettings = JxlEncoderFrameSettingsCreate(enc.get(), nullptr);
-    if (!frameSettings)
+    header.format.endianness = JXL_NATIVE_ENDIAN;
+    header.format.align = 0;
+
+    return "";
+}
+
+// Create the encoder (or reset the one already in `setup`, keeping its
+// runner), apply `header`, set frame settings and route output to `sink`.
+// The encoder allocates from `arena`. Returns an error message, empty on
+// success.
+std::string startEncoder(
+    const ImageHeader &header,
+    const EncodeOptions &options,
+    OutputSink &sink,
+    JxlArena &arena,
+    EncoderSetup &setup)
+{
+    // Create encoder
+    if (setup.enc)
+        JxlEncoderReset(setup.enc.get());
+    else
+        setup.enc = JxlEncoderMake(arena.manager());
+    if (!setup.enc)
+        return "Failed to create JXL encoder";
+    JxlEncoder *enc = setup.enc.get();
+
+    // Setup thread runner for MT builds
+#if MAX_THREADS > 1
+    if (options.maxThreads > 1)
     {
-        result.error = "Failed to create frame settings";
-        return result;
+        if (!setup.runner)
+            setup.runner = makePoolRunner(static_cast<size_t>(options.maxThreads));
+        if (JxlEncoderSetParallelRunner(enc, PoolRunner::run, setup.runner.get()) != JXL_ENC_SUCCESS)
+            return "Failed to set parallel runner";
     }
+#endif
+
+    if (JxlEncoderSetBasicInfo(enc, &header.info) != JXL_ENC_SUCCESS)
+        return "Failed to set basic info";
+
+    if (JxlEncoderSetColorEncoding(enc, &header.color) != JXL_ENC_SUCCESS)
+        return "Failed to set color encoding";
+
+    // Get frame settings
+    setup.frameSettings = JxlEncoderFrameSettingsCreate(enc, nullptr);
+    if (!setup.frameSettings)
+        return "Failed to create frame settings";
 
     // Set encoding quality
     if (options.lossless)
     {
-        JxlEncoderSetFrameLossless(frameSettings, JXL_TRUE);
-        JxlEncoderSetFrameDistance(frameSettings, 0.0f);
+        JxlEncoderSetFrameLossless(setup.frameSettings, JXL_TRUE);
+        JxlEncoderSetFrameDistance(setup.frameSettings, 0.0f);
     }
     else
     {
         float distance = qualityToDistance(options.quality, false);
-        JxlEncoderSetFrameDistance(frameSettings, distance);
+        JxlEncoderSetFrameDistance(setup.frameSettings, distance);
     }
 
     // Set effort (1-10)
     int effort = options.effort;
     if (effort < 1) effort = 1;
     if (effort > 10) effort = 10;
-    JxlEncoderFrameSettingsSetOption(frameSettings, JXL_ENC_FRAME_SETTING_EFFORT, effort);
+    JxlEncoderFrameSettingsSetOption(setup.frameSettings, JXL_ENC_FRAME_SETTING_EFFORT, effort);
 
     // Progressive decoding support
     if (options.progressive)
     {
-        JxlEncoderFrameSettingsSetOption(frameSettings, JXL_ENC_FRAME_SETTING_RESPONSIVE, 1);
+        JxlEncoderFrameSettingsSetOption(setup.frameSettings, JXL_ENC_FRAME_SETTING_RESPONSIVE, 1);
     }
 
-    result.timings.setup = emscripten_get_now() - t0;
+    setup.format = header.format;
 
-    // Setup pixel format
-    JxlPixelFormat format;
-    format.num_channels = channels;
+    // Route output through the sink; must be set before adding frames
+    if (JxlEncoderSetOutputProcessor(enc, sink.processor()) != JXL_ENC_SUCCESS)
+        return "Failed to set output processor";
 
-    // Determine JXL data type based on input dataType
-    if (options.dataType == "float32") {
-        format.data_type = JXL_TYPE_FLOAT;
-    } else if (options.dataType == "float16") {
-        format.data_type = JXL_TYPE_FLOAT16;
-    } else if (options.dataType == "uint16") {
-        format.data_type = JXL_TYPE_UINT16;
-    } else {
-        format.data_type = JXL_TYPE_UINT8;
+    return "";
+}
+
+// prepareHeader() and startEncoder() in one go, for a single encode
+std::string setupEncoder(
+    uint32_t width,
+    uint32_t height,
+    uint32_t channels,
+    int inputBitDepth,
+    const EncodeOptions &options,
+    OutputSink &sink,
+    JxlArena &arena,
+    EncoderSetup &setup,
+    const JxlAnimationHeader *animation = nullptr)
+{
+    ImageHeader header;
+    std::string error = prepareHeader(width, height, channels, inputBitDepth, options, header, animation);
+    if (!error.empty())
+        return error;
+    return startEncoder(header, options, sink, arena, setup);
+}
+
+// Close input, write out everything left and finalize the sink
+void finishEncode(EncoderSetup &setup, OutputSink &sink, EncodeResult &result, double tEncode)
+{
+    JxlEncoderCloseInput(setup.enc.get());
+    if (JxlEncoderFlushInput(setup.enc.get()) != JXL_ENC_SUCCESS)
+    {
+        result.error = sinkError(sink, "Encoding failed");
+        return;
     }
+    result.timings.encode = emscripten_get_now() - tEncode;
 
-    format.endianness = JXL_NATIVE_ENDIAN;
-    format.align = 0;
+    double t0 = emscripten_get_now();
+    sink.finish();
+    if (sink.aborted())
+        result.error = sinkError(sink, "Encoding failed");
+    result.timings.output = emscripten_get_now() - t0;
+}
+
+// Shared by encode() and encodeStreaming(): configures the encoder, routes
+// its output to `sink` and encodes. Fills error and timings in `result`.
+void encodeToSink(
+    uintptr_t pixelsPtr,
+    size_t pixelsSize,
+    uint32_t width,
+    uint32_t height,
+    uint32_t channels,
+    int inputBitDepth,
+    const EncodeOptions &options,
+    OutputSink &sink,
+    EncodeResult &result)
+{
+    const uint8_t *pixels = reinterpret_cast<const uint8_t *>(pixelsPtr);
+
+    if (pixels == nullptr || pixelsSize == 0)
+    {
+        result.error = "Invalid input: null pixels or zero dimensions";
+        return;
+    }
+
+    // Validate input size
+    size_t expectedSize = static_cast<size_t>(width) * height * channels * bytesPerSample(options.dataType);
+    if (pixelsSize < expectedSize)
+    {
+        result.error = "Invalid input: pixel data too small";
+        return;
+    }
+
+    double t0 = emscripten_get_now();
+    ArenaScope arenaScope(sharedArena());
+    EncoderSetup setup;
+    result.error = setupEncoder(width, height, channels, inputBitDepth, options, sink, sharedArena(), setup);
+    if (!result.error.empty())
+        return;
+    result.timings.setup = emscripten_get_now() - t0;
 
     // Add image frame
     t0 = emscripten_get_now();
-    if (JxlEncoderAddImageFrame(frameSettings, &format, pixels, pixelsSize) != JXL_ENC_SUCCESS)
+    if (JxlEncoderAddImageFrame(setup.frameSettings, &setup.format, pixels, pixelsSize) != JXL_ENC_SUCCESS)
+    {
+        result.error = sinkError(sink, "Failed to add image frame");
+        return;
+    }
+
+    finishEncode(setup, sink, result, t0);
+}
+
+EncodeResult encode(
+    uintptr_t pixelsPtr,
+    size_t pixelsSize,
+    uint32_t width,
+    uint32_t height,
+    uint32_t channels,
+    int inputBitDepth,
+    const EncodeOptions &options)
+{
+    double tStart = emscripten_get_now();
+    EncodeResult result = {};
+    result.dataPtr = 0;
+    result.dataSize = 0;
+
+    OutputSink sink;
+    encodeToSink(pixelsPtr, pixelsSize, width, height, channels, inputBitDepth, options, sink, result);
+    if (!result.error.empty())
+        return result;
+
+    // The sink buffer already holds the final file, hand it over as is
+    result.dataSize = static_cast<size_t>(sink.totalBytes());
+    result.dataPtr = reinterpret_cast<uintptr_t>(sink.release());
+    result.timings.total = emscripten_get_now() - tStart;
+
+    return result;
+}
+
+// Encode and pass the output to `onChunk(Uint8Array)` as soon as libjxl
+// finalizes it. The view passed to JS is only valid during the call.
+// dataPtr stays 0; dataSize is the total number of bytes emitted.
+EncodeResult encodeStreaming(
+    uintptr_t pixelsPtr,
+    size_t pixelsSize,
+    uint32_t width,
+    uint32_t height,
+    uint32_t channels,
+    int inputBitDepth,
+    const EncodeOptions &options,
+    val onChunk)
+{
+    double tStart = emscripten_get_now();
+    EncodeResult result = {};
+    result.dataPtr = 0;
+    result.dataSize = 0;
+
+    OutputSink sink(onChunk);
+    encodeToSink(pixelsPtr, pixelsSize, width, height, channels, inputBitDepth, options, sink, result);
+    if (!result.error.empty())
+        return result;
+
+    result.dataSize = static_cast<size_t>(sink.totalBytes());
+    result.timings.total = emscripten_get_now() - tStart;
+
+    return result;
+}
+
+// ============================================================================
+// Target file size
+// ============================================================================
+
+struct TargetSizeOptions
+{
+    double maxBytes;  // Size budget for the output file
+    int minQuality;   // Search range, 0-100
+    int maxQuality;
+    double tolerance; // Stop once within this fraction below maxBytes
+};
+
+struct TargetSizeResult
+{
+    uintptr_t dataPtr;
+    size_t dataSize;
+    int quality;       // Quality of the returned encode
+    int attempts;      // Number of candidate encodes
+    bool targetMet;    // false: even minQuality exceeds maxBytes
+    std::string error;
+    EncodeTimings timings;
+};
+
+// Make `candidate` the returned encode, dropping the previous one
+void keepCandidate(TargetSizeResult &result, EncodeResult &candidate, int quality)
+{
+    free(reinterpret_cast<void *>(result.dataPtr));
+    result.dataPtr = candidate.dataPtr;
+    result.dataSize = candidate.dataSize;
+    result.quality = quality;
+    candidate.dataPtr = 0;
+}
+
+// Binary search over quality for the best encode that fits in maxBytes.
+// The header is prepared once, and one encoder and runner are reset and
+// reused for every candidate. If even minQuality does not fit, that
+// (smallest) encode is returned with targetMet = false.
+TargetSizeResult encodeToSize(
+    uintptr_t pixelsPtr,
+    size_t pixelsSize,
+    uint32_t width,
+    uint32_t height,
+    uint32_t channels,
+    int inputBitDepth,
+    const EncodeOptions &options,
+    const TargetSizeOptions &target)
+{
+    double tStart = emscripten_get_now();
+    TargetSizeResult result = {};
+    const uint8_t *pixels = reinterpret_cast<const uint8_t *>(pixelsPtr);
+
+    if (pixels == nullptr || pixelsSize == 0)
     {
-        result.error = "Failed to add image frame";
+        result.error = "Invalid input: null pixels or zero dimensions";
+        return result;
+    }
+    if (pixelsSize < static_cast<size_t>(width) * height * channels * bytesPerSample(options.dataType))
+    {
+        result.error = "Invalid input: pixel data too small";
+        return result;
+    }
+    if (options.lossless)
+    {
+        result.error = "Target size requires lossy encoding";
+        return result;
+    }
+    if (!(target.maxBytes > 0))
+    {
+        result.error = "Invalid target size: must be greater than 0";
         return result;
     }
 
-    // Close input (signal no more frames)
-    JxlEncoderCloseInput(enc.get());
+    double t0 = emscripten_get_now();
+    ImageHeader header;
+    result.error = prepareHeader(width, height, channels, inputBitDepth, options, header);
+    if (!result.error.empty())
+        return result;
 
-    result.timings.encode = emscripten_get_now() - t0;
+    int lo = std::max(0, std::min(target.minQuality, 100));
+    int hi = std::max(lo, std::min(target.maxQuality, 100));
+    double accept = target.maxBytes * (1.0 - std::max(0.0, target.tolerance));
+    EncodeOptions candidateOptions = options;
 
-    // Process encoder output
-    t0 = emscripten_get_now();
-    std::vector<uint8_t> output;
-    output.resize(64 * 1024);  // Start with 64KB
+    ArenaScope arenaScope(sharedArena());
+    // The encoder keeps a pointer to the sink, so the sink must outlive it
+    OutputSink sink;
+    EncoderSetup setup;
+    result.timings.setup = emscripten_get_now() - t0;
+
+    while (lo <= hi)
+    {
+        int quality = lo + (hi - lo) / 2;
+        candidateOptions.quality = static_cast<float>(quality);
+
+        EncodeResult candidate = {};
+        sink.reset();
+        t0 = emscripten_get_now();
+        candidate.error = startEncoder(header, candidateOptions, sink, sharedArena(), setup);
+        if (candidate.error.empty() &&
+            JxlEncoderAddImageFrame(setup.frameSettings, &setup.format, pixels, pixelsSize) != JXL_ENC_SUCCESS)
+            candidate.error = sinkError(sink, "Failed to add image frame");
+        if (candidate.error.empty())
+            finishEncode(setup, sink, candidate, t0);
+
+        result.attempts++;
+        result.timings.encode += candidate.timings.encode;
+        result.timings.output += candidate.timings.output;
+        if (!candidate.error.empty())
+        {
+            result.error = candidate.error;
+            break;
+        }
+        candidate.dataSize = static_cast<size_t>(sink.totalBytes());
+        candidate.dataPtr = reinterpret_cast<uintptr_t>(sink.release());
 
-    uint8_t *nextOut = output.data();
-    size_t availOut = output.size();
+        if (candidate.dataSize <= target.maxBytes)
+        {
+            keepCandidate(result, candidate, quality);
+            result.targetMet = true;
+            if (candidate.dataSize >= accept)
+                break;
+            lo = quality + 1;
+        }
+        else
+        {
+            // Over budget: only worth keeping while nothing fits yet
+            if (!result.targetMet)
+                keepCandidate(result, candidate, quality);
+            hi = quality - 1;
+        }
+        free(reinterpret_cast<void *>(candidate.dataPtr));
+    }
 
-    JxlEncoderStatus status;
-    while ((status = JxlEncoderProcessOutput(enc.get(), &nextOut, &availOut)) == JXL_ENC_NEED_MORE_OUTPUT)
+    if (!result.error.empty())
     {
-        size_t offset = nextOut - output.data();
-        output.resize(output.size() * 2);
-        nextOut = output.data() + offset;
-        availOut = output.size() - offset;
+        free(reinterpret_cast<void *>(result.dataPtr));
+        result.dataPtr = 0;
+        result.dataSize = 0;
     }
 
-    if (status != JXL_ENC_SUCCESS)
+    result.timings.total = emscripten_get_now() - tStart;
+    return result;
+}
+
+// ============================================================================
+// Lossless JPEG recompression
+// ============================================================================
+
+// Recompress a JPEG file into JXL without decoding to pixels. The DCT
+// coefficients are kept as is and JPEG bitstream metadata is stored, so
+// JxlDecoderSetJPEGBuffer can reconstruct the original file bit-exactly.
+EncodeResult recompressJPEG(
+    uintptr_t jpegPtr,
+    size_t jpegSize,
+    int effort,
+    int maxThreads)
+{
+    double tStart = emscripten_get_now();
+    EncodeResult result = {};
+    result.dataPtr = 0;
+    result.dataSize = 0;
+
+    const uint8_t *jpeg = reinterpret_cast<const uint8_t *>(jpegPtr);
+    if (jpeg == nullptr || jpegSize == 0)
     {
-        result.error = "Encoding failed";
+        result.error = "Invalid input: empty JPEG data";
         return result;
     }
 
-    // Calculate actual output size
-    size_t outputSize = nextOut - output.data();
+    double t0 = emscripten_get_now();
+    OutputSink sink;
+    ArenaScope arenaScope(sharedArena());
+    EncoderSetup setup;
+    setup.enc = JxlEncoderMake(sharedArena().manager());
+    if (!setup.enc)
+    {
+        result.error = "Failed to create JXL encoder";
+        return result;
+    }
+    JxlEncoder *enc = setup.enc.get();
 
-    // Copy to malloc'd buffer for JS to read
-    uint8_t *outputPtr = static_cast<uint8_t *>(malloc(outputSize));
-    if (!outputPtr)
+#if MAX_THREADS > 1
+    if (maxThreads > 1)
     {
-        result.error = "Failed to allocate output buffer";
+        setup.runner = makePoolRunner(static_cast<size_t>(maxThreads));
+        if (JxlEncoderSetParallelRunner(enc, PoolRunner::run, setup.runner.get()) != JXL_ENC_SUCCESS)
+        {
+            result.error = "Failed to set parallel runner";
+            return result;
+        }
+    }
+#endif
+
+    // Keep the jbrd box needed for bit-exact reconstruction
+    if (JxlEncoderStoreJPEGMetadata(enc, JXL_TRUE) != JXL_ENC_SUCCESS)
+    {
+        result.error = "Failed to enable JPEG metadata";
+        return result;
+    }
+
+    setup.frameSettings = JxlEncoderFrameSettingsCreate(enc, nullptr);
+    if (!setup.frameSettings)
+    {
+        result.error = "Failed to create frame settings";
         return result;
     }
 
-    std::memcpy(outputPtr, output.data(), outputSize);
-    result.dataPtr = reinterpret_cast<uintptr_t>(outputPtr);
-    result.dataSize = outputSize;
+    if (effort < 1) effort = 1;
+    if (effort > 10) effort = 10;
+    JxlEncoderFrameSettingsSetOption(setup.frameSettings, JXL_ENC_FRAME_SETTING_EFFORT, effort);
 
-    result.timings.output = emscripten_get_now() - t0;
+    if (JxlEncoderSetOutputProcessor(enc, sink.processor()) != JXL_ENC_SUCCESS)
+    {
+        result.error = "Failed to set output processor";
+        return result;
+    }
+    result.timings.setup = emscripten_get_now() - t0;
+
+    t0 = emscripten_get_now();
+    if (JxlEncoderAddJPEGFrame(setup.frameSettings, jpeg, jpegSize) != JXL_ENC_SUCCESS)
+    {
+        result.error = sink.failed() ? "Failed to allocate output buffer" : "Failed to add JPEG frame (unsupported or corrupt JPEG)";
+        return result;
+    }
+
+    finishEncode(setup, sink, result, t0);
+    if (!result.error.empty())
+        return result;
+
+    result.dataSize = static_cast<size_t>(sink.totalBytes());
+    result.dataPtr = reinterpret_cast<uintptr_t>(sink.release());
+    result.timings.total = emscripten_get_now() - tStart;
+
+    return result;
+}
+
+// ============================================================================
+// Tiled input (JxlEncoderAddChunkedFrame)
+// ============================================================================
+
+// Pulls rectangular tiles from JS on demand, so the full interleaved image
+// never has to live in the WASM heap. libjxl requests tiles from the thread
+// that called JxlEncoderAddChunkedFrame, which keeps the JS call legal.
+//
+// getTile(x, y, width, height, dest) must synchronously fill `dest`, a
+// byte view of width * height * channels interleaved samples.
+class TiledInput
+{
+public:
+    TiledInput(val getTile, const JxlPixelFormat &format, size_t bytesPerSample)
+        : getTile_(getTile), format_(format),
+          bytesPerPixel_(format.num_channels * bytesPerSample), bytesPerSample_(bytesPerSample),
+          hasAlpha_(format.num_channels == 2 || format.num_channels == 4) {}
+
+    // libjxl has released every buffer by the time AddChunkedFrame returns
+    ~TiledInput() { free(tile_.data); }
+
+    TiledInput(const TiledInput &) = delete;
+    TiledInput &operator=(const TiledInput &) = delete;
+
+    JxlChunkedFrameInputSource source()
+    {
+        JxlChunkedFrameInputSource src;
+        src.opaque = this;
+        src.get_color_channels_pixel_format = &TiledInput::getColorFormat;
+        src.get_color_channel_data_at = &TiledInput::getColorData;
+        src.get_extra_channel_pixel_format = &TiledInput::getExtraFormat;
+        src.get_extra_channel_data_at = &TiledInput::getExtraData;
+        src.release_buffer = &TiledInput::releaseBuffer;
+        return src;
+    }
+
+    bool failed() const { return failed_; }
+    bool aborted() const { return aborted_; }
+
+private:
+    // The last tile from getTile. libjxl asks for colour and alpha of a
+    // region separately, both are served from it so getTile runs once per
+    // region.
+    enum class ColorUse
+    {
+        Pending,     // Colour not handed out yet
+        Outstanding, // Handed out, libjxl still reads it
+        Released
+    };
+    struct Tile
+    {
+        size_t x = 0, y = 0, w = 0, h = 0;
+        uint8_t *data = nullptr;
+        ColorUse color = ColorUse::Pending;
+        bool alphaTaken = false;
+    };
+
+    static void getColorFormat(void *opaque, JxlPixelFormat *format)
+    {
+        *format = static_cast<TiledInput *>(opaque)->format_;
+    }
+
+    static const void *getColorData(void *opaque, size_t x, size_t y, size_t w, size_t h, size_t *rowOffset)
+    {
+        TiledInput *self = static_cast<TiledInput *>(opaque);
+        uint8_t *tile = self->tileAt(x, y, w, h);
+        if (!tile)
+            return nullptr;
+
+        self->tile_.color = ColorUse::Outstanding;
+        *rowOffset = w * self->bytesPerPixel_;
+        return tile;
+    }
+
+    // Alpha is interleaved in the tiles, split it out when asked separately
+    static void getExtraFormat(void *opaque, size_t, JxlPixelFormat *format)
+    {
+        *format = static_cast<TiledInput *>(opaque)->format_;
+        format->num_channels = 1;
+    }
+
+    static const void *getExtraData(void *opaque, size_t, size_t x, size_t y, size_t w, size_t h, size_t *rowOffset)
+    {
+        TiledInput *self = static_cast<TiledInput *>(opaque);
+        uint8_t *tile = self->tileAt(x, y, w, h);
+        if (!tile)
+            return nullptr;
+
+        const size_t sampleSize = self->bytesPerSample_;
+        uint8_t *alpha = static_cast<uint8_t *>(malloc(w * h * sampleSize));
+        if (!alpha)
+        {
+            self->failed_ = true;
+            return nullptr;
+        }
+
+        const uint8_t *src = tile + self->bytesPerPixel_ - sampleSize;
+        for (size_t i = 0; i < w * h; ++i)
+            std::memcpy(alpha + i * sampleSize, src + i * self->bytesPerPixel_, sampleSize);
+        self->tile_.alphaTaken = true;
+        self->freeTileIfDone();
+
+        *rowOffset = w * sampleSize;
+        return alpha;
+    }
+
+    // Alpha copies and tiles replaced while libjxl still read their colour
+    // are freed here; the current tile once alpha is split out too
+    static void releaseBuffer(void *opaque, const void *buf)
+    {
+        TiledInput *self = static_cast<TiledInput *>(opaque);
+        if (buf == self->tile_.data)
+        {
+            self->tile_.color = ColorUse::Released;
+            self->freeTileIfDone();
+            return;
+        }
+        free(const_cast<void *>(buf));
+    }
+
+    uint8_t *tileAt(size_t x, size_t y, size_t w, size_t h)
+    {
+        if (tile_.data && tile_.x == x && tile_.y == y && tile_.w == w && tile_.h == h)
+            return tile_.data;
+
+        // An outstanding colour buffer is freed by releaseBuffer instead
+        if (tile_.color != ColorUse::Outstanding)
+            free(tile_.data);
+        tile_ = Tile();
+
+        uint8_t *data = fetch(x, y, w, h);
+        if (!data)
+            return nullptr;
+        tile_.x = x;
+        tile_.y = y;
+        tile_.w = w;
+        tile_.h = h;
+        tile_.data = data;
+        tile_.alphaTaken = !hasAlpha_;
+        return data;
+    }
+
+    void freeTileIfDone()
+    {
+        if (tile_.color == ColorUse::Released && tile_.alphaTaken)
+        {
+            free(tile_.data);
+            tile_ = Tile();
+        }
+    }
+
+    // getTile must not throw: a JS exception would unwind past the encoder
+    // without running destructors. It returns false instead, and JS rethrows
+    // the error once encodeTiled() has returned.
+    uint8_t *fetch(size_t x, size_t y, size_t w, size_t h)
+    {
+        if (aborted_)
+            return nullptr;
+
+        size_t size = w * h * bytesPerPixel_;
+        uint8_t *tile = static_cast<uint8_t *>(malloc(size));
+        if (!tile)
+        {
+            failed_ = true;
+            return nullptr;
+        }
+        if (!getTile_(x, y, w, h, val(typed_memory_view(size, tile))).as<bool>())
+        {
+            aborted_ = true;
+            free(tile);
+            return nullptr;
+        }
+        return tile;
+    }
+
+    val getTile_;
+    JxlPixelFormat format_;
+    size_t bytesPerPixel_;
+    size_t bytesPerSample_;
+    bool hasAlpha_;
+    Tile tile_;
+    bool failed_ = false;
+    bool aborted_ = false;
+};
+
+// Encode an image supplied tile by tile through getTile (see TiledInput).
+// With onChunk set, output is streamed as in encodeStreaming() and
+// dataPtr stays 0; otherwise the result holds the whole file.
+// Memory then stays bounded by libjxl's per-group working set instead of
+// the full frame.
+EncodeResult encodeTiled(
+    uint32_t width,
+    uint32_t height,
+    uint32_t channels,
+    int inputBitDepth,
+    const EncodeOptions &options,
+    val getTile,
+    val onChunk)
+{
+    double tStart = emscripten_get_now();
+    EncodeResult result = {};
+    result.dataPtr = 0;
+    result.dataSize = 0;
+
+    const bool streaming = !onChunk.isUndefined() && !onChunk.isNull();
+    OutputSink bufferedSink;
+    OutputSink streamingSink(onChunk);
+    OutputSink &sink = streaming ? streamingSink : bufferedSink;
+
+    double t0 = emscripten_get_now();
+    ArenaScope arenaScope(sharedArena());
+    EncoderSetup setup;
+    result.error = setupEncoder(width, height, channels, inputBitDepth, options, sink, sharedArena(), setup);
+    if (!result.error.empty())
+        return result;
+
+    // Stream both input and output for anything larger than one group
+    JxlEncoderFrameSettingsSetOption(setup.frameSettings, JXL_ENC_FRAME_SETTING_BUFFERING, 2);
+    result.timings.setup = emscripten_get_now() - t0;
+
+    t0 = emscripten_get_now();
+    TiledInput input(getTile, setup.format, bytesPerSample(options.dataType));
+    if (JxlEncoderAddChunkedFrame(setup.frameSettings, JXL_TRUE, input.source()) != JXL_ENC_SUCCESS)
+    {
+        if (input.aborted())
+            result.error = "Tile source failed";
+        else if (input.failed())
+            result.error = "Failed to allocate buffer";
+        else
+            result.error = sinkError(sink, "Failed to add chunked frame");
+        return result;
+    }
+
+    finishEncode(setup, sink, result, t0);
+    if (!result.error.empty())
+        return result;
+
+    result.dataSize = static_cast<size_t>(sink.totalBytes());
+    if (!streaming)
+        result.dataPtr = reinterpret_cast<uintptr_t>(sink.release());
     result.timings.total = emscripten_get_now() - tStart;
 
     return result;
 }
 
+// ============================================================================
+// Memory
+// ============================================================================
+
+// Pool usage of the one-shot encode functions above, which share one arena
+// that is bulk-released after every call
+ArenaStats getMemoryStats()
+{
+    return sharedArena().stats();
+}
+
+// Give the pooled chunks back to malloc, e.g. after an unusually large image
+void releaseMemory()
+{
+    sharedArena().trim();
+}
+
+// ============================================================================
+// Animation (multi-frame encode session)
+// ============================================================================
+
+struct AnimationOptions
+{
+    uint32_t tpsNumerator; // Ticks per second = tpsNumerator / tpsDenominator
+    uint32_t tpsDenominator;
+    uint32_t numLoops;     // 0 = loop forever
+};
+
+struct FrameOptions
+{
+    uint32_t duration;     // In ticks; 0 = layer composited with the next frame
+    std::string blendMode; // "replace", "blend", "add", "mul", "muladd"
+    int blendSource;       // Reference slot (0-3) the frame is blended onto
+    int saveAsReference;   // Reference slot (0-3) the blended result is kept in
+    int x;                 // Frame position on the canvas (partial frames)
+    int y;
+};
+
+bool parseBlendMode(const std::string &mode, JxlBlendMode &out)
+{
+    if (mode == "replace")
+        out = JXL_BLEND_REPLACE;
+    else if (mode == "blend")
+        out = JXL_BLEND_BLEND;
+    else if (mode == "add")
+        out = JXL_BLEND_ADD;
+    else if (mode == "mul")
+        out = JXL_BLEND_MUL;
+    else if (mode == "muladd")
+        out = JXL_BLEND_MULADD;
+    else
+        return false;
+    return true;
+}
+
+// Encodes an animation one frame at a time. libjxl only marks a frame as
+// the last one if input is closed before the frame is processed, so the
+// newest frame stays queued (libjxl keeps its own copy) and is flushed when
+// the next frame arrives or on finish(). At most one frame of input is held
+// in the heap, however long the animation.
+class JxlAnimationEncoder
+{
+public:
+    JxlAnimationEncoder(
+        uint32_t width,
+        uint32_t height,
+        uint32_t channels,
+        int inputBitDepth,
+        const EncodeOptions &options,
+        const AnimationOptions &animation)
+        : width_(width), height_(height), channels_(channels), dataType_(options.dataType)
+    {
+        double t0 = emscripten_get_now();
+        timings_ = {0, 0, 0, 0};
+
+        if (animation.tpsNumerator == 0 || animation.tpsDenominator == 0)
+        {
+            error_ = "Invalid tick rate: numerator and denominator must be greater than 0";
+            return;
+        }
+
+        JxlAnimationHeader header = {};
+        header.tps_numerator = animation.tpsNumerator;
+        header.tps_denominator = animation.tpsDenominator;
+        header.num_loops = animation.numLoops;
+        header.have_timecodes = JXL_FALSE;
+
+        error_ = setupEncoder(width, height, channels, inputBitDepth, options, sink_, arena_, setup_, &header);
+        timings_.setup = emscripten_get_now() - t0;
+    }
+
+    JxlAnimationEncoder(const JxlAnimationEncoder &) = delete;
+    JxlAnimationEncoder &operator=(const JxlAnimationEncoder &) = delete;
+
+    std::string getError() const { return error_; }
+
+    int getFrameCount() const { return frameCount_; }
+
+    // Add a frame of frameWidth x frameHeight interleaved pixels, placed at
+    // (frame.x, frame.y). Returns an error message, empty on success.
+    std::string addFrame(
+        uintptr_t pixelsPtr,
+        size_t pixelsSize,
+        uint32_t frameWidth,
+        uint32_t frameHeight,
+        const FrameOptions &frame)
+    {
+        if (!error_.empty())
+            return error_;
+        if (finished_)
+            return "Animation already finished";
+
+        const uint8_t *pixels = reinterpret_cast<const uint8_t *>(pixelsPtr);
+        if (pixels == nullptr || pixelsSize == 0 || frameWidth == 0 || frameHeight == 0)
+            return "Invalid input: null pixels or zero dimensions";
+
+        size_t expectedSize = static_cast<size_t>(frameWidth) * frameHeight * channels_ * bytesPerSample(dataType_);
+        if (pixelsSize < expectedSize)
+            return "Invalid input: pixel data too small";
+
+        JxlFrameHeader header;
+        JxlEncoderInitFrameHeader(&header);
+        if (!parseBlendMode(frame.blendMode, header.layer_info.blend_info.blendmode))
+            return "Invalid blend mode: " + frame.blendMode;
+        if (frame.blendSource < 0 || frame.blendSource > 3 || frame.saveAsReference < 0 || frame.saveAsReference > 3)
+            return "Invalid reference slot: must be 0-3";
+
+        header.duration = frame.duration;
+        header.layer_info.have_crop =
+            (frame.x != 0 || frame.y != 0 || frameWidth != width_ || frameHeight != height_) ? JXL_TRUE : JXL_FALSE;
+        header.layer_info.crop_x0 = frame.x;
+        header.layer_info.crop_y0 = frame.y;
+        header.layer_info.xsize = frameWidth;
+        header.layer_info.ysize = frameHeight;
+        header.layer_info.blend_info.source = static_cast<uint32_t>(frame.blendSource);
+        header.layer_info.blend_info.alpha = 0;
+        header.layer_info.blend_info.clamp = JXL_FALSE;
+        header.layer_info.save_as_reference = static_cast<uint32_t>(frame.saveAsReference);
+
+        double t0 = emscripten_get_now();
+
+        // The queued frame is not the last one, encode it now
+        if (frameCount_ > 0 && JxlEncoderFlushInput(setup_.enc.get()) != JXL_ENC_SUCCESS)
+        {
+            error_ = sink_.failed() ? "Failed to allocate output buffer" : "Encoding failed";
+            return error_;
+        }
+
+        // The previous frame is already flushed, so a failure here leaves
+        // the encoder unusable too
+        if (JxlEncoderSetFrameHeader(setup_.frameSettings, &header) != JXL_ENC_SUCCESS)
+        {
+            error_ = "Failed to set frame header";
+            return error_;
+        }
+
+        // Alpha is blended the same way as color
+        if (channels_ == 2 || channels_ == 4)
+        {
+            if (JxlEncoderSetExtraChannelBlendInfo(setup_.frameSettings, 0, &header.layer_info.blend_info) != JXL_ENC_SUCCESS)
+            {
+                error_ = "Failed to set alpha blend info";
+                return error_;
+            }
+        }
+
+        if (JxlEncoderAddImageFrame(setup_.frameSettings, &setup_.format, pixels, pixelsSize) != JXL_ENC_SUCCESS)
+        {
+            error_ = sink_.failed() ? "Failed to allocate output buffer" : "Failed to add image frame";
+            return error_;
+        }
+        timings_.encode += emscripten_get_now() - t0;
+
+        frameCount_++;
+        return "";
+    }
+
+    // Encode the queued frame as the last one and finalize the file
+    EncodeResult finish()
+    {
+        EncodeResult result = {};
+        result.dataPtr = 0;
+        result.dataSize = 0;
+
+        if (!error_.empty())
+        {
+            result.error = error_;
+            return result;
+        }
+        if (finished_)
+        {
+            result.error = "Animation already finished";
+            return result;
+        }
+        if (frameCount_ == 0)
+        {
+            result.error = "No frames added";
+            return result;
+        }
+        finished_ = true;
+
+        finishEncode(setup_, sink_, result, emscripten_get_now());
+        result.timings.setup = timings_.setup;
+        result.timings.encode += timings_.encode;
+        if (!result.error.empty())
+            return result;
+
+        result.dataSize = static_cast<size_t>(sink_.totalBytes());
+        result.dataPtr = reinterpret_cast<uintptr_t>(sink_.release());
+        result.timings.total = result.timings.setup + result.timings.encode + result.timings.output;
+
+        return result;
+    }
+
+private:
+    // Declared before setup_ so the encoder is destroyed first
+    OutputSink sink_;
+    JxlArena arena_;
+    EncoderSetup setup_;
+    uint32_t width_;
+    uint32_t height_;
+    uint32_t channels_;
+    std::string dataType_;
+    int frameCount_ = 0;
+    bool finished_ = false;
+    EncodeTimings timings_;
+    std::string error_;
+};
+
 // ============================================================================
 // Emscripten bindings
 // ============================================================================
@@ -369,6 +1350,54 @@ EMSCRIPTEN_BINDINGS(jxl_encoder)
         .field("timings", &EncodeResult::timings);
 
     function("encode", &encode);
+    function("encodeStreaming", &encodeStreaming);
+    function("encodeTiled", &encodeTiled);
+    function("recompressJPEG", &recompressJPEG);
+
+    value_object<TargetSizeOptions>("TargetSizeOptions")
+        .field("maxBytes", &TargetSizeOptions::maxBytes)
+        .field("minQuality", &TargetSizeOptions::minQuality)
+        .field("maxQuality", &TargetSizeOptions::maxQuality)
+        .field("tolerance", &TargetSizeOptions::tolerance);
+
+    value_object<TargetSizeResult>("TargetSizeResult")
+        .field("dataPtr", &TargetSizeResult::dataPtr)
+        .field("dataSize", &TargetSizeResult::dataSize)
+        .field("quality", &TargetSizeResult::quality)
+        .field("attempts", &TargetSizeResult::attempts)
+        .field("targetMet", &TargetSizeResult::targetMet)
+        .field("error", &TargetSizeResult::error)
+        .field("timings", &TargetSizeResult::timings);
+
+    function("encodeToSize", &encodeToSize);
+
+    value_object<ArenaStats>("ArenaStats")
+        .field("peak", &ArenaStats::peak)
+        .field("reserved", &ArenaStats::reserved)
+        .field("live", &ArenaStats::live);
+
+    function("getMemoryStats", &getMemoryStats);
+    function("releaseMemory", &releaseMemory);
+
+    value_object<AnimationOptions>("AnimationOptions")
+        .field("tpsNumerator", &AnimationOptions::tpsNumerator)
+        .field("tpsDenominator", &AnimationOptions::tpsDenominator)
+        .field("numLoops", &AnimationOptions::numLoops);
+
+    value_object<FrameOptions>("FrameOptions")
+        .field("duration", &FrameOptions::duration)
+        .field("blendMode", &FrameOptions::blendMode)
+        .field("blendSource", &FrameOptions::blendSource)
+        .field("saveAsReference", &FrameOptions::saveAsReference)
+        .field("x", &FrameOptions::x)
+        .field("y", &FrameOptions::y);
+
+    class_<JxlAnimationEncoder>("JxlAnimationEncoder")
+        .constructor<uint32_t, uint32_t, uint32_t, int, const EncodeOptions &, const AnimationOptions &>()
+        .function("getError", &JxlAnimationEncoder::getError)
+        .function("getFrameCount", &JxlAnimationEncoder::getFrameCount)
+        .function("addFrame", &JxlAnimationEncoder::addFrame)
+        .function("finish", &JxlAnimationEncoder::finish);
 
     constant("MAX_THREADS", MAX_THREADS);
 }
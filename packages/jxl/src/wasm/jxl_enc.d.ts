@@ -22,6 +22,20 @@ interface WasmModule {
 }
 
 type EmbindString = ArrayBuffer|Uint8Array|Uint8ClampedArray|Int8Array|string;
+export interface ClassHandle {
+  isAliasOf(other: ClassHandle): boolean;
+  delete(): void;
+  deleteLater(): this;
+  isDeleted(): boolean;
+  clone(): this;
+}
+export interface JxlAnimationEncoder extends ClassHandle {
+  getFrameCount(): number;
+  getError(): string;
+  addFrame(_0: number, _1: number, _2: number, _3: number, _4: FrameOptions): string;
+  finish(): EncodeResult;
+}
+
 export type EncodeTimings = {
   setup: number,
   encode: number,
@@ -48,9 +62,56 @@ export type EncodeResult = {
   timings: EncodeTimings
 };
 
+export type ArenaStats = {
+  peak: number,
+  reserved: number,
+  live: number
+};
+
+export type TargetSizeOptions = {
+  maxBytes: number,
+  minQuality: number,
+  maxQuality: number,
+  tolerance: number
+};
+
+export type TargetSizeResult = {
+  dataPtr: number,
+  dataSize: number,
+  quality: number,
+  attempts: number,
+  targetMet: boolean,
+  error: EmbindString,
+  timings: EncodeTimings
+};
+
+export type AnimationOptions = {
+  tpsNumerator: number,
+  tpsDenominator: number,
+  numLoops: number
+};
+
+export type FrameOptions = {
+  duration: number,
+  blendMode: EmbindString,
+  blendSource: number,
+  saveAsReference: number,
+  x: number,
+  y: number
+};
+
 interface EmbindModule {
   MAX_THREADS: number;
   encode(_0: number, _1: number, _2: number, _3: number, _4: number, _5: number, _6: EncodeOptions): EncodeResult;
+  encodeStreaming(_0: number, _1: number, _2: number, _3: number, _4: number, _5: number, _6: EncodeOptions, _7: any): EncodeResult;
+  encodeTiled(_0: number, _1: number, _2: number, _3: number, _4: EncodeOptions, _5: any, _6: any): EncodeResult;
+  recompressJPEG(_0: number, _1: number, _2: number, _3: number): EncodeResult;
+  encodeToSize(_0: number, _1: number, _2: number, _3: number, _4: number, _5: number, _6: EncodeOptions, _7: TargetSizeOptions): TargetSizeResult;
+  getMemoryStats(): ArenaStats;
+  releaseMemory(): void;
+  JxlAnimationEncoder: {
+    new(_0: number, _1: number, _2: number, _3: number, _4: EncodeOptions, _5: AnimationOptions): JxlAnimationEncoder;
+  };
 }
 
 export type MainModule = WasmModule & typeof RuntimeExports & EmbindModule;
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <jxl/parallel_runner.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Max threads constant (defined via CMake for MT builds)
+#ifndef MAX_THREADS
+#define MAX_THREADS 1  // Single-threaded fallback
+#endif
+
+#if MAX_THREADS > 1
+
+// ============================================================================
+// Shared thread pool and JxlParallelRunner
+// ============================================================================
+
+// One process-wide set of MAX_THREADS - 1 workers, started on first use and
+// shared by every decode/encode call. The calling thread takes part in each
+// job, so a call limited to N threads uses itself plus N - 1 pool workers.
+// Unlike one JxlThreadParallelRunner per call, no threads are created per
+// image and concurrent jobs never ask for more pthreads than
+// PTHREAD_POOL_SIZE provides: they just share the same workers.
+class ThreadPool
+{
+public:
+    static ThreadPool &instance()
+    {
+        static ThreadPool pool(MAX_THREADS - 1);
+        return pool;
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread &worker : workers_)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Run func over [start, end) on up to `threads` threads, the caller
+    // included. Each participant starts on its own contiguous slice of the
+    // range and steals from the other slices when it runs dry.
+    JxlParallelRetCode run(
+        size_t threads,
+        void *jpegxlOpaque,
+        JxlParallelRunInit init,
+        JxlParallelRunFunction func,
+        uint32_t start,
+        uint32_t end)
+    {
+        if (start >= end)
+            return 0;
+
+        uint32_t tasks = end - start;
+        threads = std::max<size_t>(1, std::min<size_t>({threads, tasks, workers_.size() + 1}));
+        if (JxlParallelRetCode rc = init(jpegxlOpaque, threads))
+            return rc;
+
+        Job job(threads, jpegxlOpaque, func, start, end);
+        if (threads == 1)
+        {
+            job.work(0);
+            return 0;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(&job);
+        }
+        wake_.notify_all();
+
+        job.work(0);
+
+        // No new helpers once the caller is done; wait for the ones that joined
+        std::unique_lock<std::mutex> lock(mutex_);
+        queue_.erase(std::find(queue_.begin(), queue_.end(), &job));
+        done_.wait(lock, [&]
+                   { return job.finished == job.joined; });
+        return 0;
+    }
+
+    size_t workerCount() const { return workers_.size(); }
+
+private:
+    struct alignas(64) Slice
+    {
+        std::atomic<uint32_t> next;
+        uint32_t end;
+    };
+
+    struct Job
+    {
+        Job(size_t threads, void *opaque, JxlParallelRunFunction func, uint32_t start, uint32_t end)
+            : threads(threads), opaque(opaque), func(func)
+        {
+            uint32_t tasks = end - start;
+            for (size_t i = 0; i < threads; ++i)
+            {
+                slices[i].next.store(start + static_cast<uint32_t>(tasks * i / threads), std::memory_order_relaxed);
+                slices[i].end = start + static_cast<uint32_t>(tasks * (i + 1) / threads);
+            }
+        }
+
+        void work(size_t id)
+        {
+            for (size_t k = 0; k < threads; ++k)
+            {
+                Slice &slice = slices[(id + k) % threads];
+                for (;;)
+                {
+                    uint32_t task = slice.next.fetch_add(1, std::memory_order_relaxed);
+                    if (task >= slice.end)
+                        break;
+                    func(opaque, task, id);
+                }
+            }
+        }
+
+        size_t threads;
+        void *opaque;
+        JxlParallelRunFunction func;
+        Slice slices[MAX_THREADS];
+        size_t joined = 0;   // Pool workers that took an id (under mutex_)
+        size_t finished = 0; // ...and are done with the job (under mutex_)
+    };
+
+    explicit ThreadPool(size_t workers)
+    {
+        workers_.reserve(workers);
+        for (size_t i = 0; i < workers; ++i)
+            workers_.emplace_back([this]
+                                  { workerLoop(); });
+    }
+
+    void workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;)
+        {
+            Job *job = nullptr;
+            wake_.wait(lock, [&]
+                       { return stop_ || (job = openJob()) != nullptr; });
+            if (stop_)
+                return;
+
+            size_t id = ++job->joined;
+            lock.unlock();
+            job->work(id);
+            lock.lock();
+            if (++job->finished == job->joined)
+                done_.notify_all();
+        }
+    }
+
+    // First queued job that still has a free participant slot
+    Job *openJob()
+    {
+        for (Job *job : queue_)
+        {
+            if (job->joined + 1 < job->threads)
+                return job;
+        }
+        return nullptr;
+    }
+
+    std::vector<std::thread> workers_;
+    std::vector<Job *> queue_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    bool stop_ = false;
+};
+
+// Per-call parallelism limit on the shared pool; pass PoolRunner::run and
+// the runner to JxlDecoderSetParallelRunner / JxlEncoderSetParallelRunner
+class PoolRunner
+{
+public:
+    explicit PoolRunner(size_t threads) : threads_(threads) {}
+
+    size_t threads() const { return threads_; }
+
+    static JxlParallelRetCode run(
+        void *runnerOpaque,
+        void *jpegxlOpaque,
+        JxlParallelRunInit init,
+        JxlParallelRunFunction func,
+        uint32_t startRange,
+        uint32_t endRange)
+    {
+        PoolRunner *runner = static_cast<PoolRunner *>(runnerOpaque);
+        return ThreadPool::instance().run(runner->threads_, jpegxlOpaque, init, func, startRange, endRange);
+    }
+
+private:
+    size_t threads_;
+};
+
+#else
+
+// Single-threaded builds: same interface, runs inline on the caller
+class PoolRunner
+{
+public:
+    explicit PoolRunner(size_t threads) : threads_(threads) {}
+
+    size_t threads() const { return threads_; }
+
+    static JxlParallelRetCode run(
+        void *, void *jpegxlOpaque, JxlParallelRunInit init, JxlParallelRunFunction func,
+        uint32_t startRange, uint32_t endRange)
+    {
+        if (JxlParallelRetCode rc = init(jpegxlOpaque, 1))
+            return rc;
+        for (uint32_t i = startRange; i < endRange; ++i)
+            func(jpegxlOpaque, i, 0);
+        return 0;
+    }
+
+private:
+    size_t threads_;
+};
+
+#endif
+
+using PoolRunnerPtr = std::unique_ptr<PoolRunner>;
+
+inline PoolRunnerPtr makePoolRunner(size_t threads)
+{
+    return PoolRunnerPtr(new PoolRunner(threads));
+}
@@ -7,9 +7,17 @@
 
 import { describe, it, expect, beforeAll } from "vitest";
 import {
+  createDecoderSession,
+  createStreamingDecoder,
   decode,
+  decodeFrames,
+  decodeStream,
+  decodeThumbnail,
   encode,
+  getDecoderMemoryStats,
   getImageInfo,
+  probeImageInfo,
+  getImageInfoFromRanges,
   initDecoder,
   initEncoder,
 } from "@dimkatet/jcodecs-jxl";
@@ -402,3 +410,244 @@ describe.skip("JXL Decoder", () => {
     });
   });
 });
+
+// Decoder features beyond one-shot decode: header probing, sessions,
+// streaming, frame iteration, crop and thumbnails
+describe("JXL Decoder features", () => {
+  beforeAll(async () => {
+    await initDecoder();
+    await initEncoder();
+  });
+
+  describe("probe and range reads", () => {
+    it("should ask for more bytes when the prefix is too short", async () => {
+      const encoded = await encode(createTestImageData(64, 48));
+      const probe = await probeImageInfo(encoded.subarray(0, 4));
+
+      expect(probe.info).toBeNull();
+      expect(probe.bytesNeeded).toBeGreaterThan(4);
+    });
+
+    it("should read info from a prefix through range reads", async () => {
+      const encoded = await encode(createTestImageData(256, 256), { quality: 100 });
+      let bytesRead = 0;
+      const info = await getImageInfoFromRanges(
+        async (start, end) => {
+          const range = encoded.slice(start, end);
+          bytesRead += range.length;
+          return range;
+        },
+        { initialBytes: 16 },
+      );
+
+      expect(info.width).toBe(256);
+      expect(info.height).toBe(256);
+      expect(bytesRead).toBeLessThan(encoded.length);
+    });
+  });
+
+  describe("decoder session", () => {
+    it("should decode several images with one session", async () => {
+      const session = await createDecoderSession();
+      try {
+        for (const [width, height] of [[16, 16], [32, 24], [8, 40]]) {
+          const encoded = await encode(createTestImageData(width, height));
+          const result = session.decode(encoded);
+
+          expect(result.width).toBe(width);
+          expect(result.height).toBe(height);
+          expect(result.data.length).toBe(width * height * result.channels);
+        }
+      } finally {
+        session.dispose();
+      }
+    });
+
+    it("should match one-shot decode and getImageInfo", async () => {
+      const encoded = await encode(createTestImageData(32, 32), { bitDepth: 10 });
+      const session = await createDecoderSession();
+      try {
+        const info = session.getImageInfo(encoded);
+        const result = session.decode(encoded);
+        const reference = await decode(encoded);
+
+        expect(info.width).toBe(reference.width);
+        expect(info.bitDepth).toBe(reference.bitDepth);
+        expect(result.dataType).toBe(reference.dataType);
+        expect(result.data).toEqual(reference.data);
+      } finally {
+        session.dispose();
+      }
+    });
+
+    it("should reuse its memory pool between images", async () => {
+      const encoded = await encode(createTestImageData(64, 64));
+      const session = await createDecoderSession();
+      try {
+        session.decode(encoded);
+        const reserved = session.getMemoryStats().reserved;
+        session.decode(encoded);
+
+        expect(session.getMemoryStats().reserved).toBe(reserved);
+      } finally {
+        session.dispose();
+      }
+    });
+
+    it("should restart the session peak with each decode", async () => {
+      const large = await encode(createTestImageData(512, 512));
+      const small = await encode(createTestImageData(16, 16));
+      const session = await createDecoderSession({ maxThreads: 1 });
+      try {
+        session.decode(large);
+        const largePeak = session.getMemoryStats().peak;
+        session.decode(small);
+
+        expect(session.getMemoryStats().peak).toBeLessThan(largePeak);
+      } finally {
+        session.dispose();
+      }
+    });
+
+    it("should report the one-shot pool high-water mark", async () => {
+      await decode(await encode(createTestImageData(64, 64)));
+      const stats = getDecoderMemoryStats()!;
+
+      expect(stats.live).toBe(0);
+      expect(stats.peak).toBeGreaterThan(0);
+    });
+
+    it("should throw after dispose", async () => {
+      const session = await createDecoderSession();
+      session.dispose();
+      expect(() => session.decode(new Uint8Array(8))).toThrow();
+    });
+  });
+
+  describe("streaming decode", () => {
+    async function* chunked(data: Uint8Array, size: number) {
+      for (let i = 0; i < data.length; i += size) {
+        yield data.subarray(i, i + size);
+      }
+    }
+
+    it("should decode a stream of chunks to the same pixels", async () => {
+      const encoded = await encode(createTestImageData(64, 64), { progressive: true });
+      const reference = await decode(encoded);
+      const result = await decodeStream(chunked(encoded, 97));
+
+      expect(result.width).toBe(reference.width);
+      expect(result.height).toBe(reference.height);
+      expect(result.data).toEqual(reference.data);
+    });
+
+    it("should report intermediate renders for progressive images", async () => {
+      const encoded = await encode(createTestImageData(256, 256), { progressive: true });
+      const downsampling: number[] = [];
+
+      await decodeStream(chunked(encoded, 256), {
+        onProgress: (image) => {
+          expect(image.width).toBe(256);
+          downsampling.push(image.downsampling);
+        },
+      });
+
+      expect(downsampling.length).toBeGreaterThan(0);
+      expect(downsampling[0]).toBeGreaterThan(1);
+    });
+
+    it("should fail on truncated input after close", async () => {
+      const encoded = await encode(createTestImageData(32, 32));
+      const decoder = await createStreamingDecoder();
+      try {
+        expect(decoder.push(encoded.subarray(0, encoded.length >> 1)).state).not.toBe("complete");
+        expect(() => decoder.close()).toThrow();
+      } finally {
+        decoder.dispose();
+      }
+    });
+  });
+
+  describe("frame iterator", () => {
+    it("should expose a still image as a single frame", async () => {
+      const encoded = await encode(createTestImageData(24, 16));
+      const reference = await decode(encoded);
+      const frames = await decodeFrames(encoded);
+      try {
+        expect(frames.info.frameCount).toBe(1);
+        expect(frames.info.metadata.frameCount).toBe(1);
+        expect(frames.info.width).toBe(24);
+
+        const frame = frames.next();
+        expect(frame).not.toBeNull();
+        expect(frame!.index).toBe(0);
+        expect(frame!.data).toEqual(reference.data);
+        expect(frames.next()).toBeNull();
+      } finally {
+        frames.dispose();
+      }
+    });
+
+    it("should seek back to a frame and reject out-of-range seeks", async () => {
+      const encoded = await encode(createTestImageData(16, 16));
+      const frames = await decodeFrames(encoded);
+      try {
+        expect([...frames]).toHaveLength(1);
+        frames.seek(0);
+        expect(frames.position).toBe(0);
+        expect(frames.next()).not.toBeNull();
+        expect(() => frames.seek(1)).toThrow(RangeError);
+      } finally {
+        frames.dispose();
+      }
+    });
+  });
+
+  describe("crop", () => {
+    it("should match the same region of a full decode", async () => {
+      const encoded = await encode(createTestImageData(40, 30), { lossless: true });
+      const full = await decode(encoded);
+      const crop = { x: 7, y: 3, width: 12, height: 9 };
+      const region = await decode(encoded, { crop });
+
+      expect(region.width).toBe(crop.width);
+      expect(region.height).toBe(crop.height);
+
+      const ch = full.channels;
+      for (let row = 0; row < crop.height; row++) {
+        const start = ((crop.y + row) * full.width + crop.x) * ch;
+        expect(region.data.subarray(row * crop.width * ch, (row + 1) * crop.width * ch))
+          .toEqual(full.data.subarray(start, start + crop.width * ch));
+      }
+    });
+
+    it("should reject empty crops", async () => {
+      const encoded = await encode(createTestImageData(16, 16));
+      await expect(
+        decode(encoded, { crop: { x: 0, y: 0, width: 0, height: 4 } }),
+      ).rejects.toThrow(RangeError);
+    });
+  });
+
+  describe("thumbnail decode", () => {
+    it("should return a 1:8 image with its source", async () => {
+      const encoded = await encode(createTestImageData(64, 40), { quality: 90 });
+      const thumb = await decodeThumbnail(encoded);
+
+      expect(["dc", "full"]).toContain(thumb.source);
+      expect(thumb.width).toBe(8);
+      expect(thumb.height).toBe(5);
+      expect(thumb.data.length).toBe(8 * 5 * thumb.channels);
+    });
+
+    it("should reject non power-of-two scales", async () => {
+      const encoded = await encode(createTestImageData(16, 16));
+      await expect(decodeThumbnail(encoded, { scale: 3 })).rejects.toThrow(RangeError);
+    });
+
+    it("should reject scale 1 instead of returning a 1:8 image", async () => {
+      const encoded = await encode(createTestImageData(16, 16));
+      await expect(decodeThumbnail(encoded, { scale: 1 })).rejects.toThrow(RangeError);
+    });
+  });
+});
@@ -8,11 +8,23 @@
 import { describe, it, expect, beforeAll } from "vitest";
 import {
   encode,
+  encodeChunked,
+  encodeToSize,
+  encodeTiled,
+  encodeTiledChunked,
+  recompressJPEG,
+  reconstructJPEG,
+  createAnimationEncoder,
   encodeSimple,
   decode,
+  decodeFrames,
+  compareImages,
+  decodeAndCompare,
   initEncoder,
   initDecoder,
   isEncoderInitialized,
+  getEncoderMemoryStats,
+  releaseEncoderMemory,
   DEFAULT_SRGB_METADATA,
 } from "@dimkatet/jcodecs-jxl";
 import type { JXLImageData } from "@dimkatet/jcodecs-jxl";
@@ -265,6 +277,349 @@ describe("JXL Encoder", () => {
     });
   });
 
+  describe("chunked output", () => {
+    it("should emit chunks that concatenate to the encode() result", async () => {
+      const imageData = createTestImageData(64, 48);
+      const expected = await encode(imageData, { lossless: true });
+
+      const chunks: Uint8Array[] = [];
+      const total = await encodeChunked(imageData, (chunk) => chunks.push(chunk), {
+        lossless: true,
+      });
+
+      expect(total).toBe(expected.length);
+      const joined = new Uint8Array(total);
+      let offset = 0;
+      for (const chunk of chunks) {
+        joined.set(chunk, offset);
+        offset += chunk.length;
+      }
+      expect(joined).toEqual(expected);
+    });
+
+    it("should rethrow an onChunk error and keep the encoder usable", async () => {
+      const imageData = createTestImageData(64, 48);
+      const failure = new Error("stream closed");
+
+      await expect(
+        encodeChunked(imageData, () => {
+          throw failure;
+        }),
+      ).rejects.toBe(failure);
+      expect(getEncoderMemoryStats()!.live).toBe(0);
+
+      const chunks: Uint8Array[] = [];
+      const total = await encodeChunked(imageData, (chunk) => chunks.push(chunk));
+      expect(total).toBeGreaterThan(0);
+      expect(chunks.reduce((n, c) => n + c.length, 0)).toBe(total);
+    });
+  });
+
+  describe("tiled input", () => {
+    function tiledSource(image: ImageData) {
+      const requested: number[][] = [];
+      return {
+        requested,
+        source: {
+          width: image.width,
+          height: image.height,
+          channels: 4,
+          getTile(x: number, y: number, w: number, h: number) {
+            requested.push([x, y, w, h]);
+            const tile = new Uint8Array(w * h * 4);
+            for (let row = 0; row < h; row++) {
+              const start = ((y + row) * image.width + x) * 4;
+              tile.set(image.data.subarray(start, start + w * 4), row * w * 4);
+            }
+            return tile;
+          },
+        },
+      };
+    }
+
+    it("should losslessly encode an image supplied in tiles", async () => {
+      const image = createTestImageData(300, 280);
+      const { source, requested } = tiledSource(image);
+
+      const encoded = await encodeTiled(source, { lossless: true });
+      const decoded = await decode(encoded);
+
+      expect(requested.length).toBeGreaterThan(0);
+      expect(decoded.width).toBe(300);
+      expect(decoded.height).toBe(280);
+      expect(decoded.data).toEqual(new Uint8Array(image.data.buffer));
+    });
+
+    it("should call getTile once per region for RGBA input", async () => {
+      // Larger than one 256x256 group, so colour and alpha cover several
+      const { source, requested } = tiledSource(createTestImageData(600, 300));
+
+      await encodeTiled(source, { lossless: true });
+
+      const regions = new Set(requested.map((r) => r.join(",")));
+      expect(requested.length).toBeGreaterThan(1);
+      expect(regions.size).toBe(requested.length);
+      expect(getEncoderMemoryStats()!.live).toBe(0);
+    });
+
+    it("should stream tiled output in chunks", async () => {
+      const image = createTestImageData(300, 280);
+      const chunks: Uint8Array[] = [];
+      const total = await encodeTiledChunked(
+        tiledSource(image).source,
+        (chunk) => chunks.push(chunk),
+        { lossless: true },
+      );
+
+      expect(chunks.reduce((n, c) => n + c.length, 0)).toBe(total);
+    });
+
+    it("should rethrow a getTile error and keep the encoder usable", async () => {
+      const image = createTestImageData(300, 280);
+      const failure = new Error("tile unavailable");
+      const source = {
+        ...tiledSource(image).source,
+        getTile() {
+          throw failure;
+        },
+      };
+
+      await expect(encodeTiled(source, { lossless: true })).rejects.toBe(failure);
+      expect(getEncoderMemoryStats()!.live).toBe(0);
+
+      const encoded = await encodeTiled(tiledSource(image).source, { lossless: true });
+      const decoded = await decode(encoded);
+      expect(decoded.data).toEqual(new Uint8Array(image.data.buffer));
+    });
+
+    it("should rethrow an onChunk error from a tiled encode", async () => {
+      const failure = new Error("backpressure");
+
+      await expect(
+        encodeTiledChunked(tiledSource(createTestImageData(300, 280)).source, () => {
+          throw failure;
+        }),
+      ).rejects.toBe(failure);
+      expect(getEncoderMemoryStats()!.live).toBe(0);
+    });
+
+    it("should reject a tile of the wrong size", async () => {
+      const image = createTestImageData(300, 280);
+      const source = {
+        ...tiledSource(image).source,
+        getTile: () => new Uint8Array(3),
+      };
+
+      await expect(encodeTiled(source)).rejects.toThrow(RangeError);
+      expect(getEncoderMemoryStats()!.live).toBe(0);
+    });
+  });
+
+  describe("JPEG recompression", () => {
+    async function createJPEG(width: number, height: number): Promise<Uint8Array> {
+      const canvas = new OffscreenCanvas(width, height);
+      canvas.getContext("2d")!.putImageData(createTestImageData(width, height), 0, 0);
+      const blob = await canvas.convertToBlob({ type: "image/jpeg", quality: 0.9 });
+      return new Uint8Array(await blob.arrayBuffer());
+    }
+
+    it("should round-trip a JPEG bit-exactly", async () => {
+      await initDecoder();
+      const jpeg = await createJPEG(64, 48);
+
+      const jxl = await recompressJPEG(jpeg);
+      expect(jxl.length).toBeGreaterThan(0);
+      expect(jxl.length).toBeLessThan(jpeg.length);
+
+      const restored = await reconstructJPEG(jxl);
+      expect(restored).toEqual(jpeg);
+
+      const decoded = await decode(jxl);
+      expect(decoded.width).toBe(64);
+      expect(decoded.height).toBe(48);
+    });
+
+    it("should reject files without JPEG reconstruction data", async () => {
+      await initDecoder();
+      const jxl = await encode(createTestImageData(16, 16));
+      await expect(reconstructJPEG(jxl)).rejects.toThrow();
+    });
+
+    it("should reject non-JPEG input", async () => {
+      await expect(recompressJPEG(new Uint8Array([1, 2, 3, 4]))).rejects.toThrow();
+    });
+  });
+
+  describe("animation", () => {
+    it("should encode frames with durations and loop count", async () => {
+      await initDecoder();
+      const encoder = await createAnimationEncoder({ lossless: true, numLoops: 2 });
+      encoder.addFrame(createSolidColorImageData(16, 16, 255, 0, 0), { duration: 100 });
+      encoder.addFrame(createSolidColorImageData(16, 16, 0, 255, 0), { duration: 250 });
+      expect(encoder.frameCount).toBe(2);
+      const encoded = encoder.finish();
+
+      const frames = await decodeFrames(encoded);
+      try {
+        expect(frames.info.frameCount).toBe(2);
+        expect(frames.info.numLoops).toBe(2);
+        expect(frames.info.ticksPerSecond).toEqual([1000, 1]);
+        expect(frames.info.durationMs).toBeCloseTo(350);
+
+        const [first, second] = [...frames];
+        expect(first.duration).toBe(100);
+        expect(second.duration).toBe(250);
+        expect(Array.from(second.data.slice(0, 3))).toEqual([0, 255, 0]);
+      } finally {
+        frames.dispose();
+      }
+    });
+
+    it("should composite partial frames onto the canvas", async () => {
+      await initDecoder();
+      const encoder = await createAnimationEncoder({ lossless: true });
+      encoder.addFrame(createSolidColorImageData(16, 16, 255, 0, 0), { duration: 100 });
+      encoder.addFrame(createSolidColorImageData(4, 4, 0, 0, 255), {
+        duration: 100,
+        x: 8,
+        y: 8,
+      });
+      const encoded = encoder.finish();
+
+      const frames = await decodeFrames(encoded);
+      try {
+        frames.seek(1);
+        const frame = frames.next()!;
+        expect(frame.width).toBe(16);
+        const pixel = (x: number, y: number) => {
+          const i = (y * 16 + x) * frame.channels;
+          return Array.from(frame.data.slice(i, i + 3));
+        };
+        expect(pixel(0, 0)).toEqual([255, 0, 0]);
+        expect(pixel(9, 9)).toEqual([0, 0, 255]);
+      } finally {
+        frames.dispose();
+      }
+    });
+
+    it("should reject frames with a different layout", async () => {
+      const encoder = await createAnimationEncoder();
+      try {
+        encoder.addFrame(createTestImageData(16, 16), { duration: 40 });
+        const rgb: JXLImageData = {
+          data: new Uint8Array(16 * 16 * 3),
+          dataType: "uint8",
+          width: 16,
+          height: 16,
+          channels: 3,
+          bitDepth: 8,
+          metadata: DEFAULT_SRGB_METADATA,
+        };
+        expect(() => encoder.addFrame(rgb, { duration: 40 })).toThrow(/does not match/);
+      } finally {
+        encoder.dispose();
+      }
+    });
+  });
+
+  describe("target size", () => {
+    it("should return the best quality that fits the budget", async () => {
+      const imageData = createTestImageData(128, 128);
+      const options = { effort: 3, maxThreads: 1 };
+      const budget = (await encode(imageData, { ...options, quality: 60 })).length;
+
+      const result = await encodeToSize(imageData, { ...options, maxBytes: budget });
+
+      expect(result.targetMet).toBe(true);
+      expect(result.data.length).toBeLessThanOrEqual(budget);
+      expect(result.attempts).toBeGreaterThan(0);
+      expect(result.data).toEqual(await encode(imageData, { ...options, quality: result.quality }));
+    });
+
+    it("should fall back to minQuality when the budget is unreachable", async () => {
+      const result = await encodeToSize(createTestImageData(64, 64), {
+        maxBytes: 10,
+        minQuality: 20,
+        effort: 3,
+      });
+
+      expect(result.targetMet).toBe(false);
+      expect(result.quality).toBe(20);
+      expect(result.data.length).toBeGreaterThan(10);
+    });
+  });
+
+  describe("quality metrics", () => {
+    function toExtended(imageData: ImageData): JXLImageData {
+      return {
+        data: new Uint8Array(imageData.data),
+        dataType: "uint8",
+        width: imageData.width,
+        height: imageData.height,
+        channels: 4,
+        bitDepth: 8,
+        metadata: DEFAULT_SRGB_METADATA,
+      };
+    }
+
+    it("should report a lossless round trip as a perfect match", async () => {
+      await initDecoder();
+      const imageData = createTestImageData(64, 64);
+      const encoded = await encode(imageData, { lossless: true, effort: 3 });
+
+      const metrics = await decodeAndCompare(encoded, toExtended(imageData));
+
+      expect(metrics.psnr).toBe(Infinity);
+      expect(metrics.ssim).toBeCloseTo(1, 6);
+      expect(metrics.ssimulacra2).toBeCloseTo(100, 6);
+    });
+
+    it("should score lower quality encodes lower", async () => {
+      await initDecoder();
+      const imageData = createTestImageData(128, 128);
+      const reference = toExtended(imageData);
+      const options = { effort: 3, maxThreads: 1 };
+
+      const high = await decodeAndCompare(await encode(imageData, { ...options, quality: 90 }), reference);
+      const low = await decodeAndCompare(await encode(imageData, { ...options, quality: 10 }), reference);
+
+      expect(high.ssimulacra2!).toBeGreaterThan(low.ssimulacra2!);
+      expect(high.psnr!).toBeGreaterThan(low.psnr!);
+    });
+
+    it("should compare decoded images directly", async () => {
+      const image = toExtended(createTestImageData(32, 32));
+      const metrics = await compareImages(image, image, { ssimulacra2: false });
+
+      expect(metrics.ssim).toBeCloseTo(1, 6);
+      expect(metrics.ssimulacra2).toBeUndefined();
+    });
+  });
+
+  describe("memory pool", () => {
+    it("should release the pool in bulk after each image", async () => {
+      await encode(createTestImageData(64, 64));
+      const stats = getEncoderMemoryStats()!;
+
+      expect(stats.live).toBe(0);
+      expect(stats.peak).toBeGreaterThan(0);
+      expect(stats.reserved).toBeGreaterThanOrEqual(stats.peak);
+    });
+
+    it("should keep the footprint flat across repeated encodes", async () => {
+      await encode(createTestImageData(128, 96));
+      const reserved = getEncoderMemoryStats()!.reserved;
+      for (let i = 0; i < 3; i++) {
+        await encode(createTestImageData(128, 96));
+      }
+
+      expect(getEncoderMemoryStats()!.reserved).toBe(reserved);
+
+      releaseEncoderMemory();
+      expect(getEncoderMemoryStats()!.reserved).toBe(0);
+    });
+  });
+
   describe("round-trip integrity", () => {
     it("should preserve image dimensions through encode-decode", async () => {
       const width = 48;